@@ -32,6 +32,7 @@
 
 #include <limits.h>
 #include <signal.h>
+#include <string.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <unistd.h>
@@ -40,6 +41,7 @@
 
 #include <libgds/assoc_array.h>
 #include <libgds/gds.h>
+#include <libgds/memory.h>
 #include <libgds/tokenizer.h>
 #include <libgds/tokens.h>
 
@@ -51,19 +53,28 @@
 #include <bgp/attr/path_hash.h>
 #include <bgp/attr/path_segment.h>
 #include <bgp/domain.h>
+#include <bgp/dp_rules.h>
 #include <bgp/filter/filter.h>
 #include <bgp/filter/registry.h>
 #include <bgp/mrtd.h>
+#include <bgp/peer.h>
+#include <bgp/rib.h>
 #include <bgp/filter/predicate_parser.h>
+#include <bgp/message.h>
 #include <bgp/qos.h>
 #include <bgp/aslevel/rexford.h>
 #include <bgp/route.h>
 #include <bgp/route_map.h>
 #include <cli/common.h>
+#include <cli/script.h>
+#include <net/icmp.h>
 #include <net/igp_domain.h>
 #include <net/netflow.h>
 #include <net/network.h>
+#include <net/node.h>
 #include <net/ntf.h>
+#include <net/protocol.h>
+#include <net/routing.h>
 #include <net/tm.h>
 #include <sim/simulator.h>
 #include <ui/help.h>
@@ -80,8 +91,38 @@
   "  See file COPYING for details.\n"					\
 
 
-static gds_assoc_array_t * _main_params= NULL;
-static param_lookup_t      _main_params_lookup;
+// -----[ libcbgp_ctx_t ]--------------------------------------------
+/**
+ * State of a simulation context. The fields hold the state of the
+ * modules while the context is not the current one. When the
+ * context is selected, its state is swapped into the modules (and
+ * its fields hold the state of the previous context, i.e. nothing).
+ */
+struct libcbgp_ctx_t {
+  gds_assoc_array_t * params;
+  param_lookup_t      params_lookup;
+  network_t         * network;
+  simulator_t       * sim;
+  bgp_domain_t     ** domains;
+  as_level_topo_t   * aslevel_topo;
+  gds_hash_set_t    * route_maps;
+  ptr_array_t       * path_exprs;
+  gds_hash_set_t    * path_exprs_hash;
+  gds_hash_set_t    * filters_hash;
+  bgp_msg_writer_t  * msg_monitor;
+  cli_t             * cli;
+  simulator_t       * icmp_sim;
+  /** Options are held by value in the modules. These always point
+      to a valid set of options (see _ctx_swap). */
+  bgp_options_t     * bgp_options;
+  dp_rules_options_t * dp_options;
+  route_options_t   * route_options;
+  libcbgp_ctx_t     * next;
+};
+
+static libcbgp_ctx_t * _ctx= NULL;
+static libcbgp_ctx_t * _default_ctx= NULL;
+static libcbgp_ctx_t * _ctx_list= NULL;
 
 // -----[ _signal_handler ]-------------------------------------------
 /**
@@ -347,28 +388,28 @@ void libcbgp_set_debug_file(const char * filename)
 CBGP_EXP_DECL
 void libcbgp_set_param(const char * name, const char * value)
 {
-  assoc_array_set(_main_params, name, strdup(value));
+  assoc_array_set(_ctx->params, name, strdup(value));
 }
 
 // -----[ libcbgp_get_param ]----------------------------------------
 CBGP_EXP_DECL
 const char * libcbgp_get_param(const char * name)
 {
-  return assoc_array_get(_main_params, name);
+  return assoc_array_get(_ctx->params, name);
 }
 
 // -----[ libcbgp_has_param ]----------------------------------------
 CBGP_EXP_DECL
 int libcbgp_has_param(const char * name)
 {
-  return assoc_array_exists(_main_params, name);
+  return assoc_array_exists(_ctx->params, name);
 }
 
 // -----[ libcbgp_get_param_lookup ]---------------------------------
 CBGP_EXP_DECL
 param_lookup_t libcbgp_get_param_lookup()
 {
-  return _main_params_lookup;
+  return _ctx->params_lookup;
 }
 
 // -----[ libcbgp_exec_cmd ]-----------------------------------------
@@ -383,6 +424,7 @@ CBGP_EXP_DECL
 int libcbgp_exec_file(const char * filename)
 {
   FILE * script= fopen(filename, "r");
+  int result;
 
   if (script == NULL) {
     stream_printf(gdserr, "Error: Unable to open script file \"%s\"\n",
@@ -390,13 +432,12 @@ int libcbgp_exec_file(const char * filename)
     return -1;
   }
   
-  if (libcbgp_exec_stream(script) != CLI_SUCCESS) {
-    fclose(script);
-    return -1;
-  }
-
+  if (cli_script_is_compiled(script))
+    result= cli_script_load(cli_get(), script);
+  else
+    result= libcbgp_exec_stream(script);
   fclose(script);
-  return 0;
+  return (result == CLI_SUCCESS)?0:-1;
 }
 
 // -----[ libcbgp_exec_stream ]--------------------------------------
@@ -409,6 +450,41 @@ int libcbgp_exec_stream(FILE * stream)
   return cli_execute_stream(cli_get(), stream);
 }
 
+// -----[ libcbgp_compile_file ]-------------------------------------
+/**
+ * Compile a CLI script into a binary command stream that is loaded
+ * faster by libcbgp_exec_file() (see cli/script.h).
+ */
+CBGP_EXP_DECL
+int libcbgp_compile_file(const char * filename, const char * out_name)
+{
+  FILE * script, * output;
+  int result;
+
+  script= fopen(filename, "r");
+  if (script == NULL) {
+    stream_printf(gdserr, "Error: Unable to open script file \"%s\"\n",
+		  filename);
+    return -1;
+  }
+  output= fopen(out_name, "wb");
+  if (output == NULL) {
+    stream_printf(gdserr, "Error: Unable to create file \"%s\"\n",
+		  out_name);
+    fclose(script);
+    return -1;
+  }
+
+  result= cli_script_compile(script, output);
+  fclose(script);
+  if (fclose(output) != 0)
+    result= -1;
+  if (result < 0)
+    stream_printf(gdserr, "Error: could not compile script \"%s\"\n",
+		  filename);
+  return result;
+}
+
 // -----[ libcbgp_interactive ]--------------------------------------
 /**
  *
@@ -454,7 +530,7 @@ int libcbgp_interactive()
 
 /////////////////////////////////////////////////////////////////////
 //
-// Initialization and configuration of the library (use with care).
+// Simulation contexts
 //
 /////////////////////////////////////////////////////////////////////
 
@@ -464,6 +540,461 @@ static void _param_destroy(void * item)
   free(item);
 }
 
+// -----[ _ctx_swap_options ]----------------------------------------
+/**
+ * Exchange the options of the modules with the options held by a
+ * context. The options are values: when the context is selected,
+ * its fields hold the options of the previous context, which are
+ * not used until they are swapped back.
+ */
+static inline void _ctx_swap_options(libcbgp_ctx_t * ctx)
+{
+  _bgp_options_swap(ctx->bgp_options);
+  _dp_rules_options_swap(ctx->dp_options);
+  _route_options_swap(ctx->route_options);
+}
+
+// -----[ _ctx_swap ]------------------------------------------------
+/**
+ * Exchange the state of the modules with the state held by a
+ * context.
+ */
+static inline void _ctx_swap(libcbgp_ctx_t * ctx)
+{
+  _network_swap(&ctx->network, &ctx->sim);
+  _bgp_domain_swap(&ctx->domains);
+  _aslevel_swap(&ctx->aslevel_topo);
+  _route_maps_swap(&ctx->route_maps);
+  _filter_swap(&ctx->path_exprs, &ctx->path_exprs_hash,
+	       &ctx->filters_hash);
+  _message_swap(&ctx->msg_monitor);
+  _cli_common_swap(&ctx->cli);
+  _icmp_swap(&ctx->icmp_sim);
+  _ctx_swap_options(ctx);
+}
+
+// -----[ libcbgp_ctx_select ]---------------------------------------
+CBGP_EXP_DECL
+libcbgp_ctx_t * libcbgp_ctx_select(libcbgp_ctx_t * ctx)
+{
+  libcbgp_ctx_t * prev= _ctx;
+
+  if (ctx == _ctx)
+    return prev;
+
+  if (_ctx != NULL)
+    _ctx_swap(_ctx);
+  if (ctx != NULL)
+    _ctx_swap(ctx);
+  _ctx= ctx;
+  return prev;
+}
+
+// -----[ libcbgp_ctx_create ]---------------------------------------
+CBGP_EXP_DECL
+libcbgp_ctx_t * libcbgp_ctx_create()
+{
+  libcbgp_ctx_t * ctx= (libcbgp_ctx_t *) MALLOC(sizeof(libcbgp_ctx_t));
+  libcbgp_ctx_t * prev;
+
+  ctx->params= assoc_array_create(_param_destroy);
+  ctx->params_lookup.lookup= default_lookup;
+  ctx->params_lookup.ctx   = ctx->params;
+  ctx->network= NULL;
+  ctx->sim= NULL;
+  ctx->domains= NULL;
+  ctx->aslevel_topo= NULL;
+  ctx->route_maps= NULL;
+  ctx->path_exprs= NULL;
+  ctx->path_exprs_hash= NULL;
+  ctx->filters_hash= NULL;
+  ctx->msg_monitor= NULL;
+  ctx->cli= NULL;
+  ctx->icmp_sim= NULL;
+  ctx->bgp_options= _bgp_options_create();
+  ctx->dp_options= _dp_rules_options_create();
+  ctx->route_options= _route_options_create();
+  ctx->next= _ctx_list;
+  _ctx_list= ctx;
+
+  // Initialize the modules' state within the new context
+  prev= libcbgp_ctx_select(ctx);
+  _network_init();
+  _bgp_domain_init();
+  _filter_path_regex_init();
+  _route_maps_init();
+  libcbgp_ctx_select(prev);
+
+  return ctx;
+}
+
+// -----[ libcbgp_ctx_destroy ]--------------------------------------
+CBGP_EXP_DECL
+void libcbgp_ctx_destroy(libcbgp_ctx_t ** ctx_ref)
+{
+  libcbgp_ctx_t * ctx= *ctx_ref;
+  libcbgp_ctx_t ** list_ref;
+  libcbgp_ctx_t * prev;
+
+  if (ctx == NULL)
+    return;
+
+  prev= libcbgp_ctx_select(ctx);
+  _cli_common_destroy();
+  _message_destroy();
+  _route_maps_destroy();
+  _filter_path_regex_destroy();
+  _bgp_domain_destroy();
+  _network_done();
+  _filter_destroy();
+  _aslevel_destroy();
+  _icmp_destroy();
+
+  /* The modules' state is now empty, the context does not need to
+     be swapped out, except for its options (released below). */
+  _ctx_swap_options(ctx);
+  _ctx= NULL;
+  if (ctx == _default_ctx)
+    _default_ctx= NULL;
+  if (prev == ctx)
+    prev= _default_ctx;
+  libcbgp_ctx_select(prev);
+
+  for (list_ref= &_ctx_list; *list_ref != ctx;
+       list_ref= &(*list_ref)->next)
+    ;
+  *list_ref= ctx->next;
+
+  assoc_array_destroy(&ctx->params);
+  _bgp_options_destroy(&ctx->bgp_options);
+  _dp_rules_options_destroy(&ctx->dp_options);
+  _route_options_destroy(&ctx->route_options);
+  FREE(ctx);
+  *ctx_ref= NULL;
+}
+
+// -----[ libcbgp_ctx_default ]--------------------------------------
+CBGP_EXP_DECL
+libcbgp_ctx_t * libcbgp_ctx_default()
+{
+  return _default_ctx;
+}
+
+// -----[ libcbgp_ctx_set_param ]------------------------------------
+CBGP_EXP_DECL
+void libcbgp_ctx_set_param(libcbgp_ctx_t * ctx, const char * name,
+			   const char * value)
+{
+  assoc_array_set(ctx->params, name, strdup(value));
+}
+
+// -----[ libcbgp_ctx_get_param ]------------------------------------
+CBGP_EXP_DECL
+const char * libcbgp_ctx_get_param(libcbgp_ctx_t * ctx, const char * name)
+{
+  return assoc_array_get(ctx->params, name);
+}
+
+// -----[ libcbgp_ctx_exec_cmd ]-------------------------------------
+CBGP_EXP_DECL
+int libcbgp_ctx_exec_cmd(libcbgp_ctx_t * ctx, const char * cmd)
+{
+  libcbgp_ctx_t * prev= libcbgp_ctx_select(ctx);
+  int result= libcbgp_exec_cmd(cmd);
+
+  libcbgp_ctx_select(prev);
+  return result;
+}
+
+// -----[ libcbgp_ctx_exec_file ]------------------------------------
+CBGP_EXP_DECL
+int libcbgp_ctx_exec_file(libcbgp_ctx_t * ctx, const char * filename)
+{
+  libcbgp_ctx_t * prev= libcbgp_ctx_select(ctx);
+  int result= libcbgp_exec_file(filename);
+
+  libcbgp_ctx_select(prev);
+  return result;
+}
+
+// -----[ libcbgp_ctx_exec_stream ]----------------------------------
+CBGP_EXP_DECL
+int libcbgp_ctx_exec_stream(libcbgp_ctx_t * ctx, FILE * stream)
+{
+  libcbgp_ctx_t * prev= libcbgp_ctx_select(ctx);
+  int result= libcbgp_exec_stream(stream);
+
+  libcbgp_ctx_select(prev);
+  return result;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Batch queries and injection
+//
+/////////////////////////////////////////////////////////////////////
+
+typedef struct {
+  libcbgp_route_f f;
+  void          * ctx;
+} _api_route_for_each_ctx_t;
+
+typedef struct {
+  libcbgp_rt_entry_f f;
+  void             * ctx;
+} _api_rt_for_each_ctx_t;
+
+// -----[ _api_get_bgp_router ]--------------------------------------
+static inline int _api_get_bgp_router(uint32_t addr,
+				      bgp_router_t ** router_ref)
+{
+  net_node_t * node= network_find_node(network_get_default(), addr);
+  net_protocol_t * protocol;
+
+  if (node == NULL)
+    return ENET_NODE_UNKNOWN;
+  protocol= protocols_get(node->protocols, NET_PROTOCOL_BGP);
+  if (protocol == NULL)
+    return ENET_PROTO_UNKNOWN;
+  *router_ref= (bgp_router_t *) protocol->handler;
+  return ESUCCESS;
+}
+
+// -----[ _api_route_from_record ]-----------------------------------
+static inline bgp_route_t *
+_api_route_from_record(const libcbgp_route_t * record)
+{
+  ip_pfx_t prefix= { .network= record->prefix.network,
+		     .mask= record->prefix.mask };
+  bgp_route_t * route;
+  bgp_path_t * path;
+  bgp_comms_t * comms= NULL;
+  unsigned int index;
+
+  if (record->prefix.mask > 32)
+    return NULL;
+
+  route= route_create(prefix, NULL, record->next_hop,
+		      (bgp_origin_t) record->origin);
+  route_localpref_set(route, record->local_pref);
+  route_med_set(route, record->med);
+
+  // AS-Paths are stored from the origin AS (see 'path_from_string')
+  path= path_create();
+  for (index= record->path_len; index > 0; index--)
+    path_append(&path, record->path[index-1]);
+  route_set_path(route, path);
+
+  if (record->num_comms > 0) {
+    comms= comms_create();
+    for (index= 0; index < record->num_comms; index++)
+      comms_add(&comms, record->comms[index]);
+  }
+  route_set_comm(route, comms);
+  return route;
+}
+
+// -----[ _api_route_to_record ]-------------------------------------
+static inline void _api_route_to_record(bgp_route_t * route,
+					libcbgp_route_t * record)
+{
+  int origin_as= path_first_as(route->attr->path_ref);
+
+  record->prefix.network= route->prefix.network;
+  record->prefix.mask= route->prefix.mask;
+  record->next_hop= route->attr->next_hop;
+  record->local_pref= route->attr->local_pref;
+  record->med= route->attr->med;
+  record->origin= route->attr->origin;
+  record->path= NULL;
+  record->path_len= path_length(route->attr->path_ref);
+  record->comms= NULL;
+  record->num_comms= ((route->attr->comms != NULL)?
+		      comms_length(route->attr->comms):0);
+  record->peer= ((route->peer != NULL)?route->peer->addr:0);
+  record->origin_as= ((origin_as < 0)?0:origin_as);
+  record->flags= route->flags;
+  record->route= route;
+}
+
+// -----[ _api_route_for_each ]--------------------------------------
+static int _api_route_for_each(uint32_t key, uint8_t key_len,
+			       void * item, void * ctx)
+{
+  _api_route_for_each_ctx_t * api_ctx= (_api_route_for_each_ctx_t *) ctx;
+  libcbgp_route_t record;
+
+  _api_route_to_record((bgp_route_t *) item, &record);
+  return api_ctx->f(&record, api_ctx->ctx);
+}
+
+// -----[ _api_rt_for_each ]-----------------------------------------
+static int _api_rt_for_each(uint32_t key, uint8_t key_len,
+			    void * item, void * ctx)
+{
+  _api_rt_for_each_ctx_t * api_ctx= (_api_rt_for_each_ctx_t *) ctx;
+  rt_info_t * rtinfo= (rt_info_t *) item;
+  const rt_entry_t * entry;
+  libcbgp_rt_entry_t record;
+  unsigned int index;
+  int result;
+
+  record.prefix.network= rtinfo->prefix.network;
+  record.prefix.mask= rtinfo->prefix.mask;
+  record.metric= rtinfo->metric;
+  record.type= rtinfo->type;
+  for (index= 0; index < rt_entries_size(rtinfo->entries); index++) {
+    entry= rt_entries_get_at(rtinfo->entries, index);
+    record.gateway= entry->gateway;
+    record.oif= ((entry->oif != NULL)?entry->oif->addr:0);
+    result= api_ctx->f(&record, api_ctx->ctx);
+    if (result != 0)
+      return result;
+  }
+  return 0;
+}
+
+// -----[ libcbgp_bgp_inject_routes ]--------------------------------
+CBGP_EXP_DECL
+int libcbgp_bgp_inject_routes(uint32_t addr,
+			      const libcbgp_route_t * routes,
+			      unsigned int num_routes)
+{
+  bgp_router_t * router;
+  bgp_route_t ** bgp_routes;
+  unsigned int index, num_bgp_routes= 0;
+  int result= _api_get_bgp_router(addr, &router);
+
+  if (result != ESUCCESS)
+    return result;
+  if (num_routes == 0)
+    return 0;
+
+  bgp_routes= (bgp_route_t **) MALLOC(num_routes*sizeof(bgp_route_t *));
+  for (index= 0; index < num_routes; index++) {
+    bgp_routes[num_bgp_routes]= _api_route_from_record(&routes[index]);
+    if (bgp_routes[num_bgp_routes] != NULL)
+      num_bgp_routes++;
+  }
+  result= bgp_router_inject_routes(router, bgp_routes, num_bgp_routes, 0);
+  FREE(bgp_routes);
+  return result;
+}
+
+// -----[ libcbgp_bgp_get_best_routes ]------------------------------
+CBGP_EXP_DECL
+int libcbgp_bgp_get_best_routes(uint32_t addr,
+				const libcbgp_pfx_t * prefixes,
+				unsigned int num_prefixes,
+				libcbgp_route_t * routes)
+{
+  bgp_router_t * router;
+  bgp_route_t * route;
+  ip_pfx_t prefix;
+  unsigned int index;
+  int num_found= 0;
+  int result= _api_get_bgp_router(addr, &router);
+
+  if (result != ESUCCESS)
+    return result;
+
+  for (index= 0; index < num_prefixes; index++) {
+    prefix.network= prefixes[index].network;
+    prefix.mask= prefixes[index].mask;
+    if (prefix.mask == 32)
+      route= rib_find_best(router->loc_rib, prefix);
+    else
+      route= rib_find_exact(router->loc_rib, prefix);
+    if (route != NULL) {
+      _api_route_to_record(route, &routes[index]);
+      num_found++;
+    } else {
+      memset(&routes[index], 0, sizeof(libcbgp_route_t));
+      routes[index].prefix= prefixes[index];
+    }
+  }
+  return num_found;
+}
+
+// -----[ libcbgp_bgp_rib_for_each ]---------------------------------
+CBGP_EXP_DECL
+int libcbgp_bgp_rib_for_each(uint32_t addr, libcbgp_route_f f, void * ctx)
+{
+  bgp_router_t * router;
+  _api_route_for_each_ctx_t api_ctx= { .f= f, .ctx= ctx };
+  int result= _api_get_bgp_router(addr, &router);
+
+  if (result != ESUCCESS)
+    return result;
+  return rib_for_each(router->loc_rib, _api_route_for_each, &api_ctx);
+}
+
+// -----[ libcbgp_bgp_adj_rib_for_each ]-----------------------------
+CBGP_EXP_DECL
+int libcbgp_bgp_adj_rib_for_each(uint32_t addr, uint32_t peer_addr,
+				 int in, libcbgp_route_f f, void * ctx)
+{
+  bgp_router_t * router;
+  bgp_peer_t * peer;
+  _api_route_for_each_ctx_t api_ctx= { .f= f, .ctx= ctx };
+  int result= _api_get_bgp_router(addr, &router);
+
+  if (result != ESUCCESS)
+    return result;
+  peer= bgp_router_find_peer(router, peer_addr);
+  if (peer == NULL)
+    return EBGP_PEER_UNKNOWN;
+  return rib_for_each(peer->adj_rib[in?RIB_IN:RIB_OUT],
+		      _api_route_for_each, &api_ctx);
+}
+
+// -----[ libcbgp_route_get_path ]-----------------------------------
+CBGP_EXP_DECL
+unsigned int libcbgp_route_get_path(const libcbgp_route_t * record,
+				    uint32_t * array, unsigned int size)
+{
+  if (record->route == NULL)
+    return 0;
+  return path_to_array(record->route->attr->path_ref, array, size);
+}
+
+// -----[ libcbgp_route_get_comms ]----------------------------------
+CBGP_EXP_DECL
+unsigned int libcbgp_route_get_comms(const libcbgp_route_t * record,
+				     uint32_t * array, unsigned int size)
+{
+  const bgp_comms_t * comms;
+  unsigned int index;
+
+  if (record->route == NULL)
+    return 0;
+  comms= record->route->attr->comms;
+  for (index= 0; (index < comms_length(comms)) && (index < size); index++)
+    array[index]= comms->values[index];
+  return comms_length(comms);
+}
+
+// -----[ libcbgp_node_rt_for_each ]---------------------------------
+CBGP_EXP_DECL
+int libcbgp_node_rt_for_each(uint32_t addr, libcbgp_rt_entry_f f,
+			     void * ctx)
+{
+  net_node_t * node= network_find_node(network_get_default(), addr);
+  _api_rt_for_each_ctx_t api_ctx= { .f= f, .ctx= ctx };
+
+  if (node == NULL)
+    return ENET_NODE_UNKNOWN;
+  return rt_for_each(node->rt, _api_rt_for_each, &api_ctx);
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// Initialization and configuration of the library (use with care).
+//
+/////////////////////////////////////////////////////////////////////
+
 // -----[ libcbgp_init2 ]--------------------------------------------
 void libcbgp_init2()
 {
@@ -471,51 +1002,47 @@ void libcbgp_init2()
   libcbgp_set_err_level(STREAM_LEVEL_WARNING);
   libcbgp_set_debug_level(STREAM_LEVEL_WARNING);
 
-  // Initialize global params
-  _main_params= assoc_array_create(_param_destroy);
-  _main_params_lookup.lookup= default_lookup;
-  _main_params_lookup.ctx   = _main_params;
-
   // Hash init code commented in order to allow parameter setup
   // through he command-line/script (initialization is performed
   // just-in-time).
   //_comm_hash_init();
   //_path_hash_init();
 
-  _network_init();
-  _bgp_domain_init();
   _ft_registry_init();
-  _filter_path_regex_init();
-  _route_maps_init();
   _ntf_init();
   _netflow_init();
   _tm_init();
   _cli_common_init();
+
+  // Create the default simulation context
+  _default_ctx= libcbgp_ctx_create();
+  libcbgp_ctx_select(_default_ctx);
 }
 
 // -----[ libcbgp_done2 ]--------------------------------------------
 void libcbgp_done2()
 {
-  _cli_common_destroy();
+  libcbgp_ctx_t * ctx;
+
+  // Destroy all the simulation contexts (default one included)
+  while (_ctx_list != NULL) {
+    ctx= _ctx_list;
+    libcbgp_ctx_destroy(&ctx);
+  }
+
   _tm_done();
   _netflow_done();
   _ntf_done();
-  _message_destroy();
-  _route_maps_destroy();
-  _filter_path_regex_destroy();
   _ft_registry_done();
-  _bgp_domain_destroy();
-  _network_done();
+  _icmp_destroy();
+  _routing_destroy();
   _mrtd_destroy();
   _path_hash_destroy();
   _comm_hash_destroy();
   _bgp_route_destroy();
-  _aslevel_destroy();
   _path_destroy();
   _path_segment_destroy();
   _comm_destroy();
-
-  assoc_array_destroy(&_main_params);
 }
 
 
@@ -79,6 +79,7 @@
 #include <libgds/libgds-config.h>
 #include <libgds/params.h>
 #include <libgds/stream.h>
+#include <libgds/types.h>
 
 #ifdef CYGWIN
 # define CBGP_EXP_DECL __declspec(dllexport)
@@ -163,10 +164,265 @@ extern "C" {
   CBGP_EXP_DECL int libcbgp_exec_file(const char * file_name);
   // -----[ libcbgp_exec_stream ]------------------------------------
   CBGP_EXP_DECL int libcbgp_exec_stream(FILE * stream);
+  // -----[ libcbgp_compile_file ]-----------------------------------
+  CBGP_EXP_DECL int libcbgp_compile_file(const char * file_name,
+					 const char * out_name);
   // -----[ libcbgp_interactive ]------------------------------------
   CBGP_EXP_DECL int libcbgp_interactive();
 
 
+  /*/////////////////////////////////////////////////////////////////
+  //
+  // Simulation contexts
+  //
+  /////////////////////////////////////////////////////////////////*/
+
+  /**
+   * A simulation context holds the state of an independent
+   * simulation: the network, the BGP domains, the AS-level
+   * topology, the route-maps, the AS-path regular expressions, the
+   * message monitor, the CLI, the parameters, the BGP options
+   * ("bgp options": flags, default local-pref, MED type, show mode,
+   * message listener) and the local simulator used by ping and
+   * traceroute.
+   *
+   * The library creates a default context in libcbgp_init(). The
+   * functions of the API that do not take a context operate on the
+   * current context, which is the default context unless another
+   * one has been selected with libcbgp_ctx_select().
+   *
+   * \attention
+   * Only one context is active at a time in a process: selecting a
+   * context swaps its state into the library's global variables.
+   * Calls to the library must therefore be serialized, even if they
+   * target different contexts. The following state is not part of
+   * a context and is shared by all the contexts of the process:
+   * - the GDS library (streams, memory allocator);
+   * - the interned AS-paths and communities (path_hash, comm_hash)
+   *   and the next-hop groups of the routing tables (net/routing.c).
+   *   These are reference-counted caches of values;
+   * - the parsers of the filter registry (ft_registry), of the
+   *   notification (ntf), NetFlow and traffic matrix files, and the
+   *   MRT loader (tokenizer, error message, line number and the
+   *   attribute cache statistics of the last load). They hold no
+   *   state between two commands.
+   */
+  typedef struct libcbgp_ctx_t libcbgp_ctx_t;
+
+  // -----[ libcbgp_ctx_create ]-------------------------------------
+  /**
+   * Create a new simulation context. The current context is left
+   * unchanged.
+   */
+  CBGP_EXP_DECL libcbgp_ctx_t * libcbgp_ctx_create();
+
+  // -----[ libcbgp_ctx_destroy ]------------------------------------
+  /**
+   * Destroy a simulation context. If the context is the current
+   * one, the default context becomes the current context.
+   */
+  CBGP_EXP_DECL void libcbgp_ctx_destroy(libcbgp_ctx_t ** ctx_ref);
+
+  // -----[ libcbgp_ctx_default ]------------------------------------
+  CBGP_EXP_DECL libcbgp_ctx_t * libcbgp_ctx_default();
+
+  // -----[ libcbgp_ctx_select ]-------------------------------------
+  /**
+   * Make a context the current context.
+   *
+   * \param ctx is the context to select.
+   * \retval the previously selected context.
+   */
+  CBGP_EXP_DECL libcbgp_ctx_t * libcbgp_ctx_select(libcbgp_ctx_t * ctx);
+
+  // -----[ libcbgp_ctx_set_param ]----------------------------------
+  CBGP_EXP_DECL void libcbgp_ctx_set_param(libcbgp_ctx_t * ctx,
+					   const char * name,
+					   const char * value);
+  // -----[ libcbgp_ctx_get_param ]----------------------------------
+  CBGP_EXP_DECL const char * libcbgp_ctx_get_param(libcbgp_ctx_t * ctx,
+						   const char * name);
+  // -----[ libcbgp_ctx_exec_cmd ]-----------------------------------
+  /**
+   * Execute a command in the given context. The current context is
+   * restored before returning.
+   */
+  CBGP_EXP_DECL int libcbgp_ctx_exec_cmd(libcbgp_ctx_t * ctx,
+					 const char * cmd);
+  // -----[ libcbgp_ctx_exec_file ]----------------------------------
+  CBGP_EXP_DECL int libcbgp_ctx_exec_file(libcbgp_ctx_t * ctx,
+					  const char * file_name);
+  // -----[ libcbgp_ctx_exec_stream ]--------------------------------
+  CBGP_EXP_DECL int libcbgp_ctx_exec_stream(libcbgp_ctx_t * ctx,
+					    FILE * stream);
+
+
+  /*/////////////////////////////////////////////////////////////////
+  //
+  // Batch queries and injection
+  //
+  // These functions operate on the current context. They avoid
+  // formatting and parsing text: routes are exchanged as compact
+  // records. Addresses are in host byte order. The functions return
+  // a negative error code if the node does not exist
+  // (ENET_NODE_UNKNOWN) or does not run BGP (ENET_PROTO_UNKNOWN).
+  //
+  /////////////////////////////////////////////////////////////////*/
+
+  // -----[ libcbgp_pfx_t ]------------------------------------------
+  /** IPv4 prefix. */
+  typedef struct libcbgp_pfx_t {
+    uint32_t network;
+    uint8_t  mask;
+  } libcbgp_pfx_t;
+
+  // -----[ libcbgp_route_t ]----------------------------------------
+  /**
+   * Compact record of a BGP route.
+   *
+   * On injection, \c path and \c comms are arrays provided by the
+   * caller. The AS-path is given in the usual order (neighbor AS
+   * first). The output-only fields are ignored.
+   *
+   * On output, \c path and \c comms are NULL, while \c path_len
+   * and \c num_comms give the size of the attributes. Their values
+   * are read with libcbgp_route_get_path() and
+   * libcbgp_route_get_comms(). The \c route field is a borrowed
+   * pointer to the library's route. It is only valid until the
+   * simulation is modified.
+   */
+  typedef struct libcbgp_route_t {
+    libcbgp_pfx_t    prefix;
+    uint32_t         next_hop;
+    uint32_t         local_pref;
+    uint32_t         med;
+    /** Origin (0 = IGP, 1 = EGP, 2 = INCOMPLETE). */
+    uint8_t          origin;
+    const uint32_t * path;
+    unsigned int     path_len;
+    const uint32_t * comms;
+    unsigned int     num_comms;
+
+    /** Address of the peer (output only, 0 for local routes). */
+    uint32_t         peer;
+    /** Origin AS (output only, 0 if the AS-path is empty). */
+    uint32_t         origin_as;
+    /** Route flags (output only, see bgp/route.h). */
+    uint16_t         flags;
+    /** Borrowed route (output only, NULL if there is no route). */
+    const struct bgp_route_t * route;
+  } libcbgp_route_t;
+
+  // -----[ libcbgp_rt_entry_t ]-------------------------------------
+  /**
+   * Compact record of a routing table (FIB) entry. A route with
+   * multiple next-hops yields one record per next-hop.
+   */
+  typedef struct libcbgp_rt_entry_t {
+    libcbgp_pfx_t prefix;
+    /** Gateway (0 if unspecified). */
+    uint32_t      gateway;
+    /** Address of the outgoing interface (0 if unspecified). */
+    uint32_t      oif;
+    uint32_t      metric;
+    /** Route type (1 = direct, 2 = static, 4 = IGP, 8 = BGP). */
+    uint8_t       type;
+  } libcbgp_rt_entry_t;
+
+  /** Callbacks of the iterators: return 0 to continue. */
+  typedef int (*libcbgp_route_f)(const libcbgp_route_t * route,
+				 void * ctx);
+  typedef int (*libcbgp_rt_entry_f)(const libcbgp_rt_entry_t * entry,
+				    void * ctx);
+
+  // -----[ libcbgp_bgp_inject_routes ]------------------------------
+  /**
+   * Inject routes into a BGP router, as "bgp router X load rib
+   * --bulk" would do. The peer of each route is found from its
+   * next-hop. The decision process is run once for each prefix
+   * after all the routes have been injected.
+   *
+   * \retval the number of routes injected, or a negative error
+   *   code.
+   */
+  CBGP_EXP_DECL int libcbgp_bgp_inject_routes(uint32_t router,
+					      const libcbgp_route_t * routes,
+					      unsigned int num_routes);
+
+  // -----[ libcbgp_bgp_get_best_routes ]----------------------------
+  /**
+   * Lookup the best routes of a BGP router for an array of
+   * prefixes. A /32 prefix is looked up with a longest-match, the
+   * other prefixes with an exact match. Prefixes without a route
+   * get a record whose \c route field is NULL.
+   *
+   * \param routes is an array of \c num_prefixes records, filled
+   *   by the function.
+   * \retval the number of prefixes with a route, or a negative
+   *   error code.
+   */
+  CBGP_EXP_DECL int libcbgp_bgp_get_best_routes(uint32_t router,
+						const libcbgp_pfx_t * prefixes,
+						unsigned int num_prefixes,
+						libcbgp_route_t * routes);
+
+  // -----[ libcbgp_bgp_rib_for_each ]-------------------------------
+  /**
+   * Call a function for each route in the Loc-RIB of a BGP router.
+   * The iteration stops as soon as the function returns a non-zero
+   * value (a non-zero value is then returned).
+   */
+  CBGP_EXP_DECL int libcbgp_bgp_rib_for_each(uint32_t router,
+					     libcbgp_route_f f,
+					     void * ctx);
+
+  // -----[ libcbgp_bgp_adj_rib_for_each ]---------------------------
+  /**
+   * Call a function for each route in an Adj-RIB of a BGP router
+   * (Adj-RIB-in if \c in is non-zero, Adj-RIB-out otherwise). The
+   * function returns EBGP_PEER_UNKNOWN if the peer does not exist.
+   */
+  CBGP_EXP_DECL int libcbgp_bgp_adj_rib_for_each(uint32_t router,
+						 uint32_t peer, int in,
+						 libcbgp_route_f f,
+						 void * ctx);
+
+  // -----[ libcbgp_route_get_path ]---------------------------------
+  /**
+   * Copy the AS-path of an output record into an array provided by
+   * the caller, neighbor AS first. The members of an AS-SET are
+   * copied one after the other. At most \c size AS numbers are
+   * written.
+   *
+   * \retval the number of AS numbers in the AS-path (if larger than
+   *   \c size, the output was truncated), or 0 if the record has no
+   *   route.
+   */
+  CBGP_EXP_DECL unsigned int
+  libcbgp_route_get_path(const libcbgp_route_t * route,
+			 uint32_t * array, unsigned int size);
+
+  // -----[ libcbgp_route_get_comms ]--------------------------------
+  /**
+   * Copy the communities of an output record into an array provided
+   * by the caller. At most \c size values are written.
+   *
+   * \retval the number of communities (if larger than \c size, the
+   *   output was truncated), or 0 if the record has no route.
+   */
+  CBGP_EXP_DECL unsigned int
+  libcbgp_route_get_comms(const libcbgp_route_t * route,
+			  uint32_t * array, unsigned int size);
+
+  // -----[ libcbgp_node_rt_for_each ]-------------------------------
+  /**
+   * Call a function for each entry in the routing table of a node.
+   */
+  CBGP_EXP_DECL int libcbgp_node_rt_for_each(uint32_t node,
+					     libcbgp_rt_entry_f f,
+					     void * ctx);
+
+
   
   /*/////////////////////////////////////////////////////////////////
   //
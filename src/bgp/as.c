@@ -84,13 +84,13 @@
 //
 /////////////////////////////////////////////////////////////////////
 
-typedef struct _options_t {
+struct bgp_options_t {
   uint8_t           flags;
   FBGPMsgListener   listener;
   void            * listener_ctx;
   uint32_t          local_pref;
-} _options_t;
-static _options_t _default_options= {
+};
+static bgp_options_t _default_options= {
   .flags       = 0,
   .listener    = NULL,
   .listener_ctx= NULL,
@@ -127,6 +127,39 @@ uint32_t bgp_options_get_local_pref()
   return _default_options.local_pref;
 }
 
+// -----[ _bgp_options_create ]--------------------------------------
+bgp_options_t * _bgp_options_create()
+{
+  bgp_options_t * options= (bgp_options_t *) MALLOC(sizeof(bgp_options_t));
+  options->flags= 0;
+  options->listener= NULL;
+  options->listener_ctx= NULL;
+  options->local_pref= 0;
+  return options;
+}
+
+// -----[ _bgp_options_destroy ]-------------------------------------
+void _bgp_options_destroy(bgp_options_t ** options_ref)
+{
+  if (*options_ref != NULL) {
+    FREE(*options_ref);
+    *options_ref= NULL;
+  }
+}
+
+// -----[ _bgp_options_swap ]----------------------------------------
+/**
+ * Exchange the current options with the given ones (used to switch
+ * between simulation contexts).
+ */
+void _bgp_options_swap(bgp_options_t * options)
+{
+  bgp_options_t tmp= _default_options;
+
+  _default_options= *options;
+  *options= tmp;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -305,6 +338,7 @@ int bgp_router_create(uint16_t asn, net_node_t * node,
   router->local_nets= routes_list_create(ROUTES_LIST_OPTION_REF);
   router->cluster_id= router->rid;
   router->reflector= 0;
+  router->num_dp_runs= 0;
 
   // Reference to the node running this BGP router
   router->node= node;
@@ -489,8 +523,7 @@ int bgp_router_del_network(bgp_router_t * router, ip_pfx_t prefix)
     // Withdraw this route
     // NOTE: this should be made through a call to
     // as_decision_process, but some details need to be fixed before:
-    // pOriginPeer is NULL, and the local networks should be
-    // advertised as other routes...
+    // the local networks should be advertised as other routes...
     /// *****
 
     // Remove the route from the Loc-RIB
@@ -1607,25 +1640,25 @@ void bgp_router_decision_process_update_best_route(bgp_router_t * router,
  * - an update has been received. The complete decision process has to
  * be run.
  */
-int bgp_router_decision_process(bgp_router_t * router,
-				bgp_peer_t * pOriginPeer,
-	 			ip_pfx_t prefix)
+int bgp_router_decision_process(bgp_router_t * router, ip_pfx_t prefix)
 {
   bgp_routes_t * routes;
-  int iIndex;
-  bgp_route_t * route, * pOldRoute;
-  int iRank;
+  unsigned int index;
+  bgp_route_t * route, * old_route;
+  int rank= 0;
 
 #ifdef __EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
-  bgp_routes_t * pEBGPRoutes= NULL;
-  bgp_route_t * pOldEBGPRoute= NULL;
-  int iRankEBGP, iEBGPRoutesCount;
+  bgp_routes_t * ebgp_routes= NULL;
+  bgp_route_t * old_ebgp_route= NULL;
+  unsigned int ebgp_index;
 #endif
 
+  router->num_dp_runs++;
+
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
-  pOldRoute= rib_find_one_exact(router->loc_rib, prefix, NULL);
+  old_route= rib_find_one_exact(router->loc_rib, prefix, NULL);
 #else
-  pOldRoute= rib_find_exact(router->loc_rib, prefix);
+  old_route= rib_find_exact(router->loc_rib, prefix);
 #endif
 
   STREAM_DEBUG_ENABLED(STREAM_LEVEL_DEBUG) {
@@ -1638,36 +1671,33 @@ int bgp_router_decision_process(bgp_router_t * router,
     bgp_router_dump_id(gdsdebug, router);
     stream_printf(gdsdebug, "\n");
     stream_printf(gdsdebug, "\told-best: ");
-    route_dump(gdsdebug, pOldRoute);
+    route_dump(gdsdebug, old_route);
     stream_printf(gdsdebug, "\n");
   }
 
   // Local routes can not be overriden and must be kept in Loc-RIB.
   // Decision process stops here in this case.
-  if ((pOldRoute != NULL) &&
-      route_flag_get(pOldRoute, ROUTE_FLAG_INTERNAL)) {
+  if ((old_route != NULL) &&
+      route_flag_get(old_route, ROUTE_FLAG_INTERNAL))
     return 0;
-  }
 
   /* Build list of eligible routes */
 #ifdef __EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
   routes= bgp_router_get_feasible_routes(router, prefix, 0);
-
-  pOldEBGPRoute = bgp_router_get_old_ebgp_route(routes, pOldRoute);
+  old_ebgp_route= bgp_router_get_old_ebgp_route(routes, old_route);
 #else
   routes= bgp_router_get_feasible_routes(router, prefix);
 #endif
 
   /* Reset DP_IGP flag, log eligibles */
-  for (iIndex= 0; iIndex < bgp_routes_size(routes); iIndex++) {
-    route= (bgp_route_t *) bgp_routes_at(routes, iIndex);
+  for (index= 0; index < bgp_routes_size(routes); index++) {
+    route= (bgp_route_t *) bgp_routes_at(routes, index);
 
     /* Clear flag that indicates that the route depends on the
        IGP. See 'dp_rule_nearest_next_hop' and 'bgp_router_scan_rib'
        for more information. */
     route_flag_set(route, ROUTE_FLAG_DP_IGP, 0);
 
-
     /* Log eligible route */
     STREAM_DEBUG_ENABLED(STREAM_LEVEL_DEBUG) {
       stream_printf(gdsdebug, "\teligible: ");
@@ -1687,26 +1717,20 @@ int bgp_router_decision_process(bgp_router_t * router,
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   bgp_router_walton_unsynchronized_all(router);
   // Compare eligible routes
-  iRank= 0;
   if (bgp_routes_size(routes) > 1) {
-    iRank= bgp_router_walton_decision_process_run(router, routes);
-    assert((bgp_routes_size(routes) == 0) ||
-	   (bgp_routes_size(routes) == 1));
+    rank= bgp_router_walton_decision_process_run(router, routes);
   } else {
     //TODO : do a loop on each iNextHopCount ...
-    if (bgp_routes_size(routes) != 0) {
-      //      STREAM_DEBUG(STREAM_LEVEL_DEBUG, "only one route known ... disseminating to all : %d\n", bgp_routes_size(routes));
+    if (bgp_routes_size(routes) != 0)
       bgp_router_walton_disseminate_select_peers(router, routes, 1);
-    }
   }
 #else
   // Compare eligible routes
-  iRank= 0;
   if (bgp_routes_size(routes) > 1) 
-    iRank= _bgp_router_decision_process_run(router, routes);
+    rank= _bgp_router_decision_process_run(router, routes);
+#endif
   assert((bgp_routes_size(routes) == 0) ||
 	 (bgp_routes_size(routes) == 1));
-#endif
 
   // If one best-route has been selected
   if (bgp_routes_size(routes) > 0) {
@@ -1717,23 +1741,23 @@ int bgp_router_decision_process(bgp_router_t * router,
       //If the Best route selected is not an EBGP one, run the decision process
       //against the set of EBGP routes.
       if (route->peer->asn == router->asn)
-	pEBGPRoutes = bgp_router_get_feasible_routes(router, prefix, 1);
+	ebgp_routes= bgp_router_get_feasible_routes(router, prefix, 1);
       else
 	route_flag_set(route, ROUTE_FLAG_EXTERNAL_BEST, 1);
-    
-      if (pEBGPRoutes != NULL) {
-	for (iEBGPRoutesCount = 0; iEBGPRoutesCount < bgp_routes_size(pEBGPRoutes); 
-								      iEBGPRoutesCount++){
-	  STREAM_DEBUG("\teligible external : ");
-	  STREAM_ENABLED_DEBUG() route_dump(log_get_stream(pMainLog), 
-	      pEBGPRoutes->data[iEBGPRoutesCount]);
-	  STREAM_DEBUG("\n");
-      }
-	if (bgp_routes_size(pEBGPRoutes) > 1) {
-	  iRankEBGP = bgp_router_walton_decision_process_run(router, pEBGPRoutes);
+
+      if (ebgp_routes != NULL) {
+	for (ebgp_index= 0; ebgp_index < bgp_routes_size(ebgp_routes);
+	     ebgp_index++) {
+	  STREAM_DEBUG_ENABLED(STREAM_LEVEL_DEBUG) {
+	    stream_printf(gdsdebug, "\teligible external : ");
+	    route_dump(gdsdebug, bgp_routes_at(ebgp_routes, ebgp_index));
+	    stream_printf(gdsdebug, "\n");
+	  }
 	}
-	assert((ptr_array_length(pEBGPRoutes) == 0) ||
-	   (ptr_array_length(pEBGPRoutes) == 1));
+	if (bgp_routes_size(ebgp_routes) > 1)
+	  bgp_router_walton_decision_process_run(router, ebgp_routes);
+	assert((bgp_routes_size(ebgp_routes) == 0) ||
+	       (bgp_routes_size(ebgp_routes) == 1));
       }
     }
 #endif //__EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
@@ -1746,43 +1770,41 @@ int bgp_router_decision_process(bgp_router_t * router,
 
 #ifdef __EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
     // New/updated route: install in Loc-RIB & advertise to peers
-    if ((pOldRoute == NULL) ||
-	!route_equals(pOldRoute, route)) {
+    if ((old_route == NULL) ||
+	!route_equals(old_route, route)) {
       bgp_router_decision_process_update_best_route(router, prefix, 
-			  routes, pOldRoute, route, iRank, pEBGPRoutes,
-			  pOldEBGPRoute);
+			  routes, old_route, route, rank, ebgp_routes,
+			  old_ebgp_route);
     } else {
       bgp_router_decision_process_unchanged_best_route(router, prefix, 
-			  routes, pOldRoute, route, iRank, pEBGPRoutes,
-			  pOldEBGPRoute);
+			  routes, old_route, route, rank, ebgp_routes,
+			  old_ebgp_route);
     }
 #else
     // New/updated route: install in Loc-RIB & advertise to peers
-    if ((pOldRoute == NULL) ||
-	!route_equals(pOldRoute, route)) {
+    if ((old_route == NULL) ||
+	!route_equals(old_route, route)) {
       bgp_router_decision_process_update_best_route(router, prefix, 
-				      routes, pOldRoute, route, iRank);
+				      routes, old_route, route, rank);
     } else {
       bgp_router_decision_process_unchanged_best_route(router, prefix, 
-				      routes, pOldRoute, route, iRank);
+				      routes, old_route, route, rank);
     }
 #endif //__EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
 
   } else {
-
 #ifdef __EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
-    bgp_router_decision_process_no_best_route(router, prefix, pOldRoute, 
-							    pOldEBGPRoute);
+    bgp_router_decision_process_no_best_route(router, prefix, old_route,
+					      old_ebgp_route);
 #else
-    bgp_router_decision_process_no_best_route(router, prefix, pOldRoute);
+    bgp_router_decision_process_no_best_route(router, prefix, old_route);
 #endif //__EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
-
   }
 
   routes_list_destroy(&routes);
-
 #ifdef __EXPERIMENTAL_ADVERTISE_BEST_EXTERNAL_TO_INTERNAL__
-  routes_list_destroy(&pEBGPRoutes);
+  if (ebgp_routes != NULL)
+    routes_list_destroy(&ebgp_routes);
 #endif
 
   STREAM_DEBUG(STREAM_LEVEL_DEBUG,
@@ -2211,7 +2233,7 @@ int bgp_router_scan_rib(bgp_router_t * router)
   if (iResult == 0)
     for (iIndex= 0; iIndex < _array_length(sCtx.pPrefixes); iIndex++) {
       _array_get_at(sCtx.pPrefixes, iIndex, &prefix);
-      bgp_router_decision_process(router, NULL, prefix);
+      bgp_router_decision_process(router, prefix);
     }
 
   _bgp_router_free_prefixes(&pPrefixes);
@@ -2238,7 +2260,7 @@ static int _bgp_router_rerun_for_each(uint32_t key, uint8_t key_len,
     stream_flush(gdsdebug);
   }
 
-  return bgp_router_decision_process(router, NULL, prefix);
+  return bgp_router_decision_process(router, prefix);
 }
 
 // -----[ bgp_router_rerun ]-----------------------------------------
@@ -2606,6 +2628,7 @@ typedef struct {
   unsigned int   routes_bad_target; //                  with bad target
   unsigned int   routes_bad_peer;   //                  with bad peer
   unsigned int   routes_ignored;    //                  ignored by API (ex: IP6)
+  gds_radix_tree_t * prefixes;      // Prefixes touched (bulk mode)
 } SBGP_LOAD_RIB_CTX;
   
 // -----[ _bgp_router_load_rib_handler ]-----------------------------
@@ -2620,7 +2643,8 @@ typedef struct {
  * 2). Check that the target router has a peer that corresponds to
  *     the route's next-hop.
  * 3). Inject the route into the target's Adj-RIB-in and runs the
- *     decision process for the route's prefix.
+ *     decision process for the route's prefix. In bulk mode, the
+ *     decision process is deferred: the prefix is only recorded.
  */
 static int _bgp_router_load_rib_handler(int status,
 					bgp_route_t * route,
@@ -2703,7 +2727,11 @@ static int _bgp_router_load_rib_handler(int status,
   // received routes in the Adj-RIB-in, but not run the decision
   // process.
 
-  bgp_router_decision_process(router, route->peer, route->prefix);
+  if (pCtx->prefixes != NULL)
+    radix_tree_add(pCtx->prefixes, route->prefix.network,
+		   route->prefix.mask, (void *) 1);
+  else
+    bgp_router_decision_process(router, route->prefix);
 
   pCtx->routes_ok++;
   return BGP_INPUT_SUCCESS;
@@ -2715,11 +2743,18 @@ static int _bgp_router_load_rib_handler(int status,
  * bgp router instance. The routes are considered local and will not
  * be replaced by routes received from peers. The routes are marked
  * as best and feasible and are directly installed into the Loc-RIB.
+ *
+ * With the BGP_ROUTER_LOAD_OPTIONS_BULK option, all the routes are
+ * first injected in the Adj-RIB-Ins. The decision process is then
+ * run once for each prefix that was touched. When the tables of
+ * several peers are loaded, each prefix is thus decided (and its
+ * final best route disseminated) only once.
  */
 int bgp_router_load_rib(bgp_router_t * router, const char * filename,
 			bgp_input_type_t format, uint8_t options)
 {
   int result;
+  unsigned int cache_hits, cache_misses;
   SBGP_LOAD_RIB_CTX sCtx= {
     .router           = router,
     .options          = options,
@@ -2728,11 +2763,23 @@ int bgp_router_load_rib(bgp_router_t * router, const char * filename,
     .routes_bad_target= 0,
     .routes_bad_peer  = 0,
     .routes_ignored   = 0,
+    .prefixes         = NULL,
   };
 
+  if (options & BGP_ROUTER_LOAD_OPTIONS_BULK)
+    _bgp_router_alloc_prefixes(&sCtx.prefixes);
+
   // Load routes
   result= bgp_routes_load(filename, format,
 			  _bgp_router_load_rib_handler, &sCtx);
+
+  // Run the deferred decision processes (bulk mode). This is also
+  // done if the load failed, for the routes already injected.
+  if (sCtx.prefixes != NULL) {
+    radix_tree_for_each(sCtx.prefixes, _bgp_router_rerun_for_each, router);
+    _bgp_router_free_prefixes(&sCtx.prefixes);
+  }
+
   if (result != BGP_INPUT_SUCCESS)
     return result;
 
@@ -2743,11 +2790,55 @@ int bgp_router_load_rib(bgp_router_t * router, const char * filename,
     stream_printf(gdsout, "Routes with bad target: %u\n", sCtx.routes_bad_target);
     stream_printf(gdsout, "Routes with bad peer  : %u\n", sCtx.routes_bad_peer);
     stream_printf(gdsout, "Routes ignored        : %u\n", sCtx.routes_ignored);
+    if (format != BGP_ROUTES_INPUT_CISCO) {
+      mrtd_cache_stats(&cache_hits, &cache_misses);
+      stream_printf(gdsout, "Attribute cache hits  : %u\n", cache_hits);
+      stream_printf(gdsout, "Attribute cache misses: %u\n", cache_misses);
+    }
   }
 
   return ESUCCESS;
 }
 
+// -----[ bgp_router_inject_routes ]---------------------------------
+/**
+ * Inject an array of routes into the router, as if they were loaded
+ * from a RIB dump (see bgp_router_load_rib): the peer of each route
+ * is found from its next-hop. The decision process is always
+ * deferred (BGP_ROUTER_LOAD_OPTIONS_BULK) and the routes are not
+ * checked against the router's address (as with the option
+ * BGP_ROUTER_LOAD_OPTIONS_FORCE).
+ *
+ * The routes are owned by the router after the call (the routes
+ * that could not be injected are destroyed).
+ *
+ * \retval the number of routes injected.
+ */
+int bgp_router_inject_routes(bgp_router_t * router, bgp_route_t ** routes,
+			     unsigned int num_routes, uint8_t options)
+{
+  unsigned int index;
+  SBGP_LOAD_RIB_CTX sCtx= {
+    .router           = router,
+    .options          = options | BGP_ROUTER_LOAD_OPTIONS_FORCE,
+    .return_code      = 0, // Ignore errors
+    .routes_ok        = 0,
+    .routes_bad_target= 0,
+    .routes_bad_peer  = 0,
+    .routes_ignored   = 0,
+    .prefixes         = NULL,
+  };
+
+  _bgp_router_alloc_prefixes(&sCtx.prefixes);
+  for (index= 0; index < num_routes; index++)
+    _bgp_router_load_rib_handler(BGP_INPUT_STATUS_OK, routes[index],
+				 router->rid, router->asn, &sCtx);
+  radix_tree_for_each(sCtx.prefixes, _bgp_router_rerun_for_each, router);
+  _bgp_router_free_prefixes(&sCtx.prefixes);
+
+  return sCtx.routes_ok;
+}
+
 // -----[ _bgp_router_save_route_mrtd ]------------------------------
 /**
  *
@@ -2806,6 +2897,7 @@ void bgp_router_show_stats(gds_stream_t * stream, bgp_router_t * router)
   }
   enum_destroy(&routes);
   stream_printf(stream, "num-best: %d\n", num_best);
+  stream_printf(stream, "num-dp-runs: %u\n", router->num_dp_runs);
 
   // Classification of best route selections
   stream_printf(stream, "rule-stats:");
@@ -49,6 +49,7 @@
 #define BGP_ROUTER_LOAD_OPTIONS_SUMMARY  0x01  /* Display a summary (stderr) */
 #define BGP_ROUTER_LOAD_OPTIONS_FORCE    0x02  /* Force the route to load */
 #define BGP_ROUTER_LOAD_OPTIONS_AUTOCONF 0x04  /* Create non-existing peers */
+#define BGP_ROUTER_LOAD_OPTIONS_BULK     0x08  /* Defer decision process */
 
 extern const net_protocol_def_t PROTOCOL_BGP;
 
@@ -56,6 +57,10 @@ extern const net_protocol_def_t PROTOCOL_BGP;
 // -----[ FBGPMsgListener ]-----
 typedef void (*FBGPMsgListener)(net_msg_t * msg, void * ctx);
 
+// -----[ bgp_options_t ]--------------------------------------------
+/** Global BGP options (see "bgp options"). */
+typedef struct bgp_options_t bgp_options_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -74,6 +79,12 @@ extern "C" {
   void bgp_options_set_local_pref(uint32_t local_pref);
   // -----[ bgp_options_get_local_pref ]-----------------------------
   uint32_t bgp_options_get_local_pref();
+  // -----[ _bgp_options_create ]------------------------------------
+  bgp_options_t * _bgp_options_create();
+  // -----[ _bgp_options_destroy ]-----------------------------------
+  void _bgp_options_destroy(bgp_options_t ** options_ref);
+  // -----[ _bgp_options_swap ]--------------------------------------
+  void _bgp_options_swap(bgp_options_t * options);
 
 
   ///////////////////////////////////////////////////////////////////
@@ -153,7 +164,6 @@ extern "C" {
 #endif
   // ----- bgp_router_decision_process ------------------------------
   int bgp_router_decision_process(bgp_router_t * router,
-				  bgp_peer_t * origin_peer,
 				  ip_pfx_t prefix);
   // ----- bgp_router_handle_message --------------------------------
   int bgp_router_handle_message(simulator_t * sim,
@@ -224,6 +234,11 @@ extern "C" {
   // ----- bgp_router_load_rib --------------------------------------
   int bgp_router_load_rib(bgp_router_t * router, const char * filename,
 			  bgp_input_type_t format, uint8_t options);
+  // -----[ bgp_router_inject_routes ]-------------------------------
+  int bgp_router_inject_routes(bgp_router_t * router,
+			       bgp_route_t ** routes,
+			       unsigned int num_routes,
+			       uint8_t options);
 
   ///////////////////////////////////////////////////////////////////
   // MISCELLANEOUS FUNCTIONS
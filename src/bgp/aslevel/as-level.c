@@ -34,6 +34,7 @@
 #endif
 
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <libgds/memory.h>
@@ -47,20 +48,21 @@
 #include <bgp/aslevel/caida.h>
 #include <bgp/aslevel/meulle.h>
 #include <bgp/attr/path.h>
+#include <bgp/dp_rt.h>
+#include <bgp/peer.h>
+#include <bgp/rib.h>
+#include <bgp/routes_list.h>
 #include <bgp/record-route.h>
 #include <bgp/aslevel/rexford.h>
 #include <bgp/filter/filter.h>
 #include <net/iface.h>
+#include <net/network.h>
 #include <net/node.h>
+#include <sim/simulator.h>
 
 // ----- Load AS-level topology -----
 static as_level_topo_t * _the_topo= NULL;
 
-// ----- Tagging/filtering communities -----
-/** communities used to enforce the valley-free property */
-#define COMM_PROV 1
-#define COMM_PEER 10
-
 #define ASLEVEL_TOPO_FOREACH_DOMAIN(T,I,D)		\
   for (I= 0; I < ptr_array_length(T->domains) && (D= (as_level_domain_t*) T->domains->data[I]); I++)
 
@@ -231,6 +233,12 @@ char * aslevel_strerror(int error)
     return "topology is already installed";
   case ASLEVEL_ERROR_ALREADY_RUNNING:
     return "topology is already running";
+  case ASLEVEL_ERROR_INVALID_STATE:
+    return "invalid topology state";
+  case ASLEVEL_ERROR_SIBLING:
+    return "sibling relationships are not supported";
+  case ASLEVEL_ERROR_MISMATCH:
+    return "solver and simulation routes differ";
   }
   return NULL;
 }
@@ -961,18 +969,31 @@ int aslevel_topo_build_network(as_level_topo_t * topo)
 }
 
 // -----[ aslevel_topo_setup_policies ]------------------------------
+/**
+ * Setup the input and output filters of all the sessions. The
+ * filters only depend on the business relationship: a single
+ * (interned) filter is built for each relationship and direction,
+ * and it is shared by all the corresponding peers.
+ */
 int aslevel_topo_setup_policies(as_level_topo_t * topo)
 {
   unsigned int index, index2;
   as_level_domain_t * domain, * neighbor;
   as_level_link_t * link;
-  bgp_filter_t * filter;
+  bgp_filter_t * filters_in[ASLEVEL_PEER_TYPE_SIBLING+1];
+  bgp_filter_t * filters_out[ASLEVEL_PEER_TYPE_SIBLING+1];
+  peer_type_t peer_type;
 
   if (topo->state < ASLEVEL_STATE_INSTALLED)
     return ASLEVEL_ERROR_NOT_INSTALLED;
   if (topo->state > ASLEVEL_STATE_POLICIES)
     return ASLEVEL_ERROR_ALREADY_RUNNING;
 
+  for (peer_type= 0; peer_type <= ASLEVEL_PEER_TYPE_SIBLING; peer_type++) {
+    filters_in[peer_type]= filter_intern(aslevel_filter_in(peer_type));
+    filters_out[peer_type]= filter_intern(aslevel_filter_out(peer_type));
+  }
+
   for (index= 0; index < ptr_array_length(topo->domains); index++) {
     domain= (as_level_domain_t *) topo->domains->data[index];
 
@@ -980,19 +1001,25 @@ int aslevel_topo_setup_policies(as_level_topo_t * topo)
 	 index2++) {
       link= (as_level_link_t *) domain->neighbors->data[index2];
       neighbor= link->neighbor;
+      peer_type= link->peer_type;
 
-      filter= aslevel_filter_in(link->peer_type);
       bgp_router_peer_set_filter(domain->router,
 				 neighbor->router->node->rid,
-				 FILTER_IN, filter);
-      filter= aslevel_filter_out(link->peer_type);
+				 FILTER_IN,
+				 filter_add_ref(filters_in[peer_type]));
       bgp_router_peer_set_filter(domain->router,
 				 neighbor->router->node->rid,
-				 FILTER_OUT, filter);
+				 FILTER_OUT,
+				 filter_add_ref(filters_out[peer_type]));
 
     }
   }
 
+  for (peer_type= 0; peer_type <= ASLEVEL_PEER_TYPE_SIBLING; peer_type++) {
+    filter_destroy(&filters_in[peer_type]);
+    filter_destroy(&filters_out[peer_type]);
+  }
+
   topo->state= ASLEVEL_STATE_POLICIES;
 
   return ASLEVEL_SUCCESS;
@@ -1081,6 +1108,10 @@ int aslevel_topo_run()
   if (_the_topo->state < ASLEVEL_STATE_INSTALLED)
     return ASLEVEL_ERROR_NOT_INSTALLED;
 
+  // Routes already computed by the solver
+  if (_the_topo->state == ASLEVEL_STATE_SOLVED)
+    return ASLEVEL_ERROR_ALREADY_RUNNING;
+
   for (index= 0; index < ptr_array_length(_the_topo->domains); index++) {
     domain= (as_level_domain_t *) _the_topo->domains->data[index];
     if (bgp_router_start(domain->router) != 0)
@@ -1092,6 +1123,199 @@ int aslevel_topo_run()
   return ASLEVEL_SUCCESS;
 }
 
+// -----[ _aslevel_dst_t ]-------------------------------------------
+typedef struct {
+  ip_pfx_t        prefix;
+  bgp_router_t  * router;
+} _aslevel_dst_t;
+
+// -----[ _aslevel_dst_cmp ]-----------------------------------------
+static int _aslevel_dst_cmp(const void * item1, const void * item2)
+{
+  const _aslevel_dst_t * dst1= (const _aslevel_dst_t *) item1;
+  const _aslevel_dst_t * dst2= (const _aslevel_dst_t *) item2;
+  return ip_prefix_cmp(&dst1->prefix, &dst2->prefix);
+}
+
+// -----[ _aslevel_topo_purge_prefix ]-------------------------------
+/**
+ * Remove all the state related to a prefix from the routers of the
+ * topology (local networks, Loc-RIBs, Adj-RIBs and routing tables),
+ * without exchanging any BGP message. The simulator must be idle.
+ */
+static void _aslevel_topo_purge_prefix(as_level_topo_t * topo,
+				       ip_pfx_t prefix)
+{
+  unsigned int index, index2;
+  bgp_router_t * router;
+  bgp_route_t * route;
+  bgp_peer_t * peer;
+
+  for (index= 0; index < ptr_array_length(topo->domains); index++) {
+    router= ((as_level_domain_t *) topo->domains->data[index])->router;
+
+    for (index2= 0; index2 < bgp_routes_size(router->local_nets);
+	 index2++) {
+      route= bgp_routes_at(router->local_nets, index2);
+      if (!ip_prefix_cmp(&route->prefix, &prefix)) {
+	routes_list_remove_at(router->local_nets, index2);
+	route_destroy(&route);
+	break;
+      }
+    }
+
+    route= rib_find_exact(router->loc_rib, prefix);
+    if (route != NULL) {
+      if (route->peer != NULL)
+	bgp_router_rt_del_route(router, prefix);
+      rib_remove_route(router->loc_rib, prefix);
+    }
+
+    for (index2= 0; index2 < bgp_peers_size(router->peers); index2++) {
+      peer= bgp_peers_at(router->peers, index2);
+      rib_remove_route(peer->adj_rib[RIB_IN], prefix);
+      rib_remove_route(peer->adj_rib[RIB_OUT], prefix);
+    }
+  }
+}
+
+// -----[ _aslevel_topo_run_rollback ]-------------------------------
+/**
+ * Bring the topology back to its state before a per-prefix run that
+ * failed: the pending events are dropped, the BGP sessions are
+ * closed, the state related to the prefixes is removed and the
+ * networks are originated again. The topology is left in the state
+ * it had before the run, so that it can be run again.
+ */
+static void _aslevel_topo_run_rollback(as_level_topo_t * topo,
+				       simulator_t * sim,
+				       _aslevel_dst_t * dsts,
+				       unsigned int num_dsts,
+				       uint8_t state)
+{
+  unsigned int index, index2;
+  bgp_router_t * router;
+  bgp_peer_t * peer;
+
+  sim_clear(sim);
+  for (index= 0; index < ptr_array_length(topo->domains); index++) {
+    router= ((as_level_domain_t *) topo->domains->data[index])->router;
+    for (index2= 0; index2 < bgp_peers_size(router->peers); index2++) {
+      peer= bgp_peers_at(router->peers, index2);
+      if (peer->session_state != SESSION_STATE_IDLE)
+	bgp_peer_close_session(peer);
+    }
+  }
+  // Drop the CLOSE messages
+  sim_clear(sim);
+
+  for (index= 0; index < num_dsts; index++)
+    _aslevel_topo_purge_prefix(topo, dsts[index].prefix);
+  for (index= 0; index < num_dsts; index++)
+    bgp_router_add_network(dsts[index].router, dsts[index].prefix);
+
+  topo->state= state;
+}
+
+// -----[ aslevel_topo_run_per_prefix ]------------------------------
+/**
+ * Run the topology one destination prefix at a time.
+ *
+ * The locally originated networks are first withdrawn from the
+ * routers, then the BGP sessions are established. Each prefix is
+ * then re-originated by its origin router(s) and the simulator is
+ * run until convergence before the next prefix is considered. This
+ * keeps the events queue small, as a single prefix is in flight.
+ *
+ * If a stream is provided, the routes recorded towards each prefix
+ * are written to it once the prefix has converged. If the
+ * ASLEVEL_RUN_DISCARD option is set, the state related to a prefix
+ * is discarded once it has been recorded, so that the memory used
+ * does not grow with the number of prefixes.
+ *
+ * If the run fails, the topology is brought back to its state before
+ * the run (see _aslevel_topo_run_rollback), with the same originated
+ * networks, so that it can be run again.
+ */
+int aslevel_topo_run_per_prefix(gds_stream_t * stream, uint8_t options)
+{
+  unsigned int index, index2, num_dsts;
+  as_level_domain_t * domain;
+  bgp_router_t * router;
+  _aslevel_dst_t * dsts;
+  simulator_t * sim;
+  uint8_t state;
+  int result= ASLEVEL_SUCCESS;
+
+  if (_the_topo == NULL)
+    return ASLEVEL_ERROR_NO_TOPOLOGY;
+
+  if (_the_topo->state < ASLEVEL_STATE_INSTALLED)
+    return ASLEVEL_ERROR_NOT_INSTALLED;
+
+  if (_the_topo->state >= ASLEVEL_STATE_RUNNING)
+    return ASLEVEL_ERROR_ALREADY_RUNNING;
+
+  // Restored if the run fails (see _aslevel_topo_run_rollback)
+  state= _the_topo->state;
+
+  if (ptr_array_length(_the_topo->domains) == 0)
+    return ASLEVEL_SUCCESS;
+
+  // Collect and withdraw the locally originated networks
+  num_dsts= 0;
+  for (index= 0; index < ptr_array_length(_the_topo->domains); index++) {
+    domain= (as_level_domain_t *) _the_topo->domains->data[index];
+    num_dsts+= bgp_routes_size(domain->router->local_nets);
+  }
+  dsts= (_aslevel_dst_t *) MALLOC(sizeof(_aslevel_dst_t)*(num_dsts+1));
+  num_dsts= 0;
+  for (index= 0; index < ptr_array_length(_the_topo->domains); index++) {
+    router= ((as_level_domain_t *) _the_topo->domains->data[index])->router;
+    while (bgp_routes_size(router->local_nets) > 0) {
+      dsts[num_dsts].prefix= bgp_routes_at(router->local_nets, 0)->prefix;
+      dsts[num_dsts].router= router;
+      bgp_router_del_network(router, dsts[num_dsts].prefix);
+      num_dsts++;
+    }
+  }
+  qsort(dsts, num_dsts, sizeof(_aslevel_dst_t), _aslevel_dst_cmp);
+
+  // Establish the BGP sessions
+  domain= (as_level_domain_t *) _the_topo->domains->data[0];
+  sim= network_get_simulator(domain->router->node->network);
+  result= aslevel_topo_run();
+  if ((result == ASLEVEL_SUCCESS) && (sim_run(sim) != 0))
+    result= ASLEVEL_ERROR_UNEXPECTED;
+
+  // Propagate each destination prefix in turn
+  for (index= 0; (result == ASLEVEL_SUCCESS) && (index < num_dsts);
+       index= index2) {
+    for (index2= index; (index2 < num_dsts) &&
+	   !ip_prefix_cmp(&dsts[index].prefix, &dsts[index2].prefix);
+	 index2++)
+      bgp_router_add_network(dsts[index2].router, dsts[index2].prefix);
+
+    if (sim_run(sim) != 0) {
+      result= ASLEVEL_ERROR_UNEXPECTED;
+      break;
+    }
+
+    if (stream != NULL)
+      aslevel_topo_record_route(stream, dsts[index].prefix, 0);
+
+    if (options & ASLEVEL_RUN_DISCARD)
+      _aslevel_topo_purge_prefix(_the_topo, dsts[index].prefix);
+  }
+
+  // Restore the configured networks if the run failed part-way
+  if (result != ASLEVEL_SUCCESS)
+    _aslevel_topo_run_rollback(_the_topo, sim, dsts, num_dsts, state);
+
+  FREE(dsts);
+  return result;
+}
+
 // -----[ aslevel_topo_policies ]------------------------------------
 int aslevel_topo_policies()
 {
@@ -1319,6 +1543,7 @@ int aslevel_topo_record_route(gds_stream_t * stream,
   int result;
   bgp_path_t * path= NULL;
   as_level_domain_t * domain;
+  bgp_rr_batch_t * batch;
 
   if (_the_topo == NULL)
     return ASLEVEL_ERROR_NO_TOPOLOGY;
@@ -1326,13 +1551,16 @@ int aslevel_topo_record_route(gds_stream_t * stream,
   if (_the_topo->state < ASLEVEL_STATE_INSTALLED)
     return ASLEVEL_ERROR_NOT_INSTALLED;
 
+  // All the traces share the downstream paths they have in common
+  batch= bgp_rr_batch_create(prefix, options);
   for (index= 0; index < ptr_array_length(_the_topo->domains); index++) {
     domain= (as_level_domain_t *) _the_topo->domains->data[index];
-    result= bgp_record_route(domain->router, prefix, &path, options);
+    result= bgp_rr_batch_record(batch, domain->router, &path);
     bgp_dump_recorded_route(stream, domain->router, prefix,
 			    path, result);
     path_destroy(&path);
   }
+  bgp_rr_batch_destroy(&batch);
 
   return 0;
 }
@@ -1538,3 +1766,12 @@ void _aslevel_destroy()
   if (_the_topo != NULL)
     aslevel_topo_destroy(&_the_topo);
 }
+
+// -----[ _aslevel_swap ]--------------------------------------------
+void _aslevel_swap(as_level_topo_t ** topo_ref)
+{
+  as_level_topo_t * topo= _the_topo;
+
+  _the_topo= *topo_ref;
+  *topo_ref= topo;
+}
@@ -51,12 +51,22 @@
 #define ASLEVEL_STATE_INSTALLED 1
 #define ASLEVEL_STATE_POLICIES  2
 #define ASLEVEL_STATE_RUNNING   3
+#define ASLEVEL_STATE_SOLVED    4
+
+// ----- Per-prefix run options -----
+/** discard the state of each prefix once it has been recorded */
+#define ASLEVEL_RUN_DISCARD 0x01
 
 // ----- Local preferences -----
 #define ASLEVEL_PREF_PROV 60
 #define ASLEVEL_PREF_PEER 80
 #define ASLEVEL_PREF_CUST 100
 
+// ----- Tagging/filtering communities -----
+/** communities used to enforce the valley-free property */
+#define COMM_PROV 1
+#define COMM_PEER 10
+
 // ----- Error codes -----
 #define ASLEVEL_SUCCESS                 0
 #define ASLEVEL_ERROR_UNEXPECTED        -1
@@ -80,6 +90,8 @@
 #define ASLEVEL_ERROR_NOT_INSTALLED     -19
 #define ASLEVEL_ERROR_ALREADY_INSTALLED -20
 #define ASLEVEL_ERROR_ALREADY_RUNNING   -21
+#define ASLEVEL_ERROR_SIBLING           -22
+#define ASLEVEL_ERROR_MISMATCH          -23
 
 // ----- Business relationships -----
 #define ASLEVEL_PEER_TYPE_CUSTOMER 0
@@ -185,6 +197,8 @@ extern "C" {
   int aslevel_topo_policies();
   // -----[ aslevel_topo_run ]---------------------------------------
   int aslevel_topo_run();
+  // -----[ aslevel_topo_run_per_prefix ]----------------------------
+  int aslevel_topo_run_per_prefix(gds_stream_t * stream, uint8_t options);
 
   // -----[ aslevel_get_topo ]---------------------------------------
   as_level_topo_t * aslevel_get_topo();
@@ -229,6 +243,8 @@ extern "C" {
 
   // -----[ _aslevel_destroy ]---------------------------------------
   void _aslevel_destroy();
+  // -----[ _aslevel_swap ]------------------------------------------
+  void _aslevel_swap(as_level_topo_t ** topo_ref);
 
 #ifdef __cplusplus
 }
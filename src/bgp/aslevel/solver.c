@@ -0,0 +1,567 @@
+// ==================================================================
+// @(#)solver.c
+//
+// Direct computation of the valley-free routes selected in an
+// AS-level topology with the canned Gao-Rexford policies.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
+
+#include <libgds/memory.h>
+#include <libgds/stream.h>
+
+#include <net/prefix.h>
+#include <bgp/as.h>
+#include <bgp/attr/path.h>
+#include <bgp/dp_rt.h>
+#include <bgp/peer.h>
+#include <bgp/rib.h>
+#include <bgp/route.h>
+#include <bgp/routes_list.h>
+#include <bgp/aslevel/as-level.h>
+#include <bgp/aslevel/solver.h>
+#include <bgp/aslevel/types.h>
+
+// ----- Route classes (in order of preference) -----
+#define _CLASS_NONE     0
+#define _CLASS_PROVIDER 1
+#define _CLASS_PEER     2
+#define _CLASS_CUSTOMER 3
+#define _CLASS_ORIGIN   4
+
+#define _NONE UINT_MAX
+
+// -----[ _solver_dst_t ]--------------------------------------------
+/** (prefix, originating domain) pair. */
+typedef struct {
+  ip_pfx_t     prefix;
+  unsigned int origin;
+} _solver_dst_t;
+
+// -----[ _solver_t ]------------------------------------------------
+/**
+ * Solver state. The topology is flattened in arrays indexed by
+ * domain index (position in topo->domains). The per-destination
+ * arrays are allocated once and reused for every destination.
+ */
+typedef struct {
+  unsigned int         num_domains;
+  as_level_domain_t ** domains;
+  net_addr_t         * rids;
+  unsigned int       * adj_start;  // first adjacency of each domain
+  unsigned int       * adj_nbr;    // neighbor index
+  peer_type_t        * adj_type;   // relationship of the neighbor
+
+  // Per-destination state
+  uint8_t            * cls;        // class of the selected route
+  unsigned int       * len;        // AS-Path length
+  unsigned int       * via;        // neighbor the route is learned from
+  unsigned int       * queue;      // BFS queue (phases 1 and 2)
+  unsigned int       * bucket;     // head of each length bucket (phase 3)
+  unsigned int       * next;       // next domain in same bucket
+  asn_t              * asns;       // AS-Path construction buffer
+} _solver_t;
+
+// -----[ _solver_destroy ]------------------------------------------
+static void _solver_destroy(_solver_t * solver)
+{
+  FREE(solver->rids);
+  FREE(solver->adj_start);
+  FREE(solver->adj_nbr);
+  FREE(solver->adj_type);
+  FREE(solver->cls);
+  FREE(solver->len);
+  FREE(solver->via);
+  FREE(solver->queue);
+  FREE(solver->bucket);
+  FREE(solver->next);
+  FREE(solver->asns);
+}
+
+// -----[ _solver_init ]---------------------------------------------
+/**
+ * Flatten the topology. The routers must have been built.
+ */
+static int _solver_init(_solver_t * solver, as_level_topo_t * topo)
+{
+  unsigned int * index_of;
+  unsigned int index, index2, num_links;
+  as_level_domain_t * domain;
+  as_level_link_t * link;
+  unsigned int n= ptr_array_length(topo->domains);
+
+  // Count links and check that there is no sibling relationship
+  num_links= 0;
+  for (index= 0; index < n; index++) {
+    domain= (as_level_domain_t *) topo->domains->data[index];
+    for (index2= 0; index2 < ptr_array_length(domain->neighbors); index2++) {
+      link= (as_level_link_t *) domain->neighbors->data[index2];
+      if (link->peer_type == ASLEVEL_PEER_TYPE_SIBLING)
+	return ASLEVEL_ERROR_SIBLING;
+    }
+    num_links+= ptr_array_length(domain->neighbors);
+  }
+
+  solver->num_domains= n;
+  solver->domains= (as_level_domain_t **) topo->domains->data;
+  solver->rids= (net_addr_t *) MALLOC(n * sizeof(net_addr_t));
+  solver->adj_start= (unsigned int *) MALLOC((n+1) * sizeof(unsigned int));
+  solver->adj_nbr= (unsigned int *) MALLOC((num_links+1) *
+					   sizeof(unsigned int));
+  solver->adj_type= (peer_type_t *) MALLOC((num_links+1) *
+					   sizeof(peer_type_t));
+  solver->cls= (uint8_t *) MALLOC(n * sizeof(uint8_t));
+  solver->len= (unsigned int *) MALLOC(n * sizeof(unsigned int));
+  solver->via= (unsigned int *) MALLOC(n * sizeof(unsigned int));
+  solver->queue= (unsigned int *) MALLOC(n * sizeof(unsigned int));
+  solver->bucket= (unsigned int *) MALLOC((n+1) * sizeof(unsigned int));
+  solver->next= (unsigned int *) MALLOC(n * sizeof(unsigned int));
+  solver->asns= (asn_t *) MALLOC(n * sizeof(asn_t));
+
+  // ASN to domain index
+  index_of= (unsigned int *) MALLOC(MAX_AS * sizeof(unsigned int));
+  for (index= 0; index < n; index++) {
+    domain= solver->domains[index];
+    index_of[domain->asn]= index;
+    solver->rids[index]= domain->router->rid;
+  }
+
+  num_links= 0;
+  for (index= 0; index < n; index++) {
+    domain= solver->domains[index];
+    solver->adj_start[index]= num_links;
+    for (index2= 0; index2 < ptr_array_length(domain->neighbors); index2++) {
+      link= (as_level_link_t *) domain->neighbors->data[index2];
+      solver->adj_nbr[num_links]= index_of[link->neighbor->asn];
+      solver->adj_type[num_links]= link->peer_type;
+      num_links++;
+    }
+  }
+  solver->adj_start[n]= num_links;
+
+  FREE(index_of);
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ _solver_offer ]--------------------------------------------
+/**
+ * Domain 'dst' receives from 'src' a route of class 'cls'. Keep it if
+ * it is better than the current one (higher class, then shorter
+ * AS-Path, then lower neighbor router-ID).
+ *
+ * Return 1 if the domain had no route before, 0 otherwise.
+ */
+static inline int _solver_offer(_solver_t * solver, unsigned int src,
+				unsigned int dst, uint8_t cls)
+{
+  unsigned int len= solver->len[src]+1;
+  uint8_t cur_cls= solver->cls[dst];
+
+  if (cur_cls == _CLASS_NONE) {
+    solver->cls[dst]= cls;
+    solver->len[dst]= len;
+    solver->via[dst]= src;
+    return 1;
+  }
+  if ((cur_cls > cls) ||
+      ((cur_cls == cls) && (solver->len[dst] < len)))
+    return 0;
+  if ((cur_cls < cls) || (solver->len[dst] > len) ||
+      (solver->rids[src] < solver->rids[solver->via[dst]])) {
+    solver->cls[dst]= cls;
+    solver->len[dst]= len;
+    solver->via[dst]= src;
+  }
+  return 0;
+}
+
+// -----[ _solver_solve ]--------------------------------------------
+/**
+ * Compute the best route of each domain towards a destination
+ * originated by the given domains.
+ */
+static void _solver_solve(_solver_t * solver, _solver_dst_t * origins,
+			  unsigned int num_origins)
+{
+  unsigned int n= solver->num_domains;
+  unsigned int head, tail, level_end, index, adj, src, dst, len;
+  unsigned int max_len;
+
+  for (index= 0; index < n; index++) {
+    solver->cls[index]= _CLASS_NONE;
+    solver->via[index]= _NONE;
+  }
+
+  tail= 0;
+  for (index= 0; index < num_origins; index++) {
+    dst= origins[index].origin;
+    if (solver->cls[dst] != _CLASS_NONE)
+      continue;
+    solver->cls[dst]= _CLASS_ORIGIN;
+    solver->len[dst]= 0;
+    solver->queue[tail++]= dst;
+  }
+
+  // Phase 1: customer routes, propagated upwards level by level.
+  // All the offers of a level are received before the next level
+  // is expanded, so that ties are broken on the router-ID.
+  head= 0;
+  while (head < tail) {
+    level_end= tail;
+    for (; head < level_end; head++) {
+      src= solver->queue[head];
+      for (adj= solver->adj_start[src]; adj < solver->adj_start[src+1]; adj++)
+	if (solver->adj_type[adj] == ASLEVEL_PEER_TYPE_PROVIDER)
+	  if (_solver_offer(solver, src, solver->adj_nbr[adj],
+			    _CLASS_CUSTOMER))
+	    solver->queue[tail++]= solver->adj_nbr[adj];
+    }
+  }
+
+  // Phase 2: a single peer-to-peer hop from customer routes
+  level_end= tail;
+  for (head= 0; head < level_end; head++) {
+    src= solver->queue[head];
+    for (adj= solver->adj_start[src]; adj < solver->adj_start[src+1]; adj++)
+      if (solver->adj_type[adj] == ASLEVEL_PEER_TYPE_PEER)
+	if (_solver_offer(solver, src, solver->adj_nbr[adj], _CLASS_PEER))
+	  solver->queue[tail++]= solver->adj_nbr[adj];
+  }
+
+  // Phase 3: any route propagated downwards, in order of increasing
+  // AS-Path length (bucket queue)
+  for (index= 0; index <= n; index++)
+    solver->bucket[index]= _NONE;
+  max_len= 0;
+  for (index= 0; index < tail; index++) {
+    src= solver->queue[index];
+    len= solver->len[src];
+    solver->next[src]= solver->bucket[len];
+    solver->bucket[len]= src;
+    if (len > max_len)
+      max_len= len;
+  }
+  for (len= 0; (len <= max_len) && (len < n); len++) {
+    for (src= solver->bucket[len]; src != _NONE; src= solver->next[src]) {
+      for (adj= solver->adj_start[src]; adj < solver->adj_start[src+1]; adj++) {
+	if (solver->adj_type[adj] != ASLEVEL_PEER_TYPE_CUSTOMER)
+	  continue;
+	dst= solver->adj_nbr[adj];
+	if (_solver_offer(solver, src, dst, _CLASS_PROVIDER)) {
+	  solver->next[dst]= solver->bucket[len+1];
+	  solver->bucket[len+1]= dst;
+	  if (len+1 > max_len)
+	    max_len= len+1;
+	}
+      }
+    }
+  }
+}
+
+// -----[ _solver_path ]---------------------------------------------
+/**
+ * Build the AS-Path of the route selected by a domain.
+ */
+static bgp_path_t * _solver_path(_solver_t * solver, unsigned int index)
+{
+  bgp_path_t * path= path_create();
+  unsigned int num_asns= 0;
+
+  do {
+    index= solver->via[index];
+    solver->asns[num_asns++]= solver->domains[index]->asn;
+  } while (solver->cls[index] != _CLASS_ORIGIN);
+
+  // path_append() adds an ASN in front of the AS-Path
+  while (num_asns > 0)
+    path_append(&path, solver->asns[--num_asns]);
+  return path;
+}
+
+// -----[ _solver_pref ]---------------------------------------------
+/**
+ * Local preference assigned by the input filters to a route class.
+ */
+static inline uint32_t _solver_pref(uint8_t cls)
+{
+  switch (cls) {
+  case _CLASS_CUSTOMER: return ASLEVEL_PREF_CUST;
+  case _CLASS_PEER: return ASLEVEL_PREF_PEER;
+  case _CLASS_PROVIDER: return ASLEVEL_PREF_PROV;
+  default:
+    abort();
+  }
+}
+
+// -----[ _solver_route ]--------------------------------------------
+/**
+ * Build the route selected by a domain, as it would be stored in
+ * its Adj-RIB-In after the input filter.
+ */
+static bgp_route_t * _solver_route(_solver_t * solver, ip_pfx_t prefix,
+				   unsigned int index)
+{
+  as_level_domain_t * domain= solver->domains[index];
+  as_level_link_t * link;
+  bgp_route_t * route;
+  unsigned int src= solver->via[index];
+
+  link= aslevel_as_get_link(domain, solver->domains[src]);
+  assert(link != NULL);
+
+  route= route_create(prefix, link->peer, solver->rids[src],
+		      BGP_ORIGIN_IGP);
+  route_set_path(route, _solver_path(solver, index));
+  route_med_clear(route);
+  if (solver->cls[index] == _CLASS_PEER)
+    route_comm_append(route, COMM_PEER);
+  else if (solver->cls[index] == _CLASS_PROVIDER)
+    route_comm_append(route, COMM_PROV);
+  route_localpref_set(route, _solver_pref(solver->cls[index]));
+  return route;
+}
+
+// -----[ _solver_dst_cmp ]------------------------------------------
+static int _solver_dst_cmp(const void * item1, const void * item2)
+{
+  _solver_dst_t * dst1= (_solver_dst_t *) item1;
+  _solver_dst_t * dst2= (_solver_dst_t *) item2;
+  int cmp= ip_prefix_cmp(&dst1->prefix, &dst2->prefix);
+
+  if (cmp != 0)
+    return cmp;
+  if (dst1->origin < dst2->origin)
+    return -1;
+  else if (dst1->origin > dst2->origin)
+    return 1;
+  return 0;
+}
+
+// -----[ _solver_destinations ]-------------------------------------
+/**
+ * List the (prefix, origin) pairs of the locally originated
+ * networks, sorted by prefix.
+ */
+static _solver_dst_t * _solver_destinations(_solver_t * solver,
+					    unsigned int * num_dsts)
+{
+  _solver_dst_t * dsts;
+  bgp_routes_t * local_nets;
+  unsigned int index, index2, num= 0;
+
+  for (index= 0; index < solver->num_domains; index++)
+    num+= bgp_routes_size(solver->domains[index]->router->local_nets);
+
+  dsts= (_solver_dst_t *) MALLOC((num+1) * sizeof(_solver_dst_t));
+  num= 0;
+  for (index= 0; index < solver->num_domains; index++) {
+    local_nets= solver->domains[index]->router->local_nets;
+    for (index2= 0; index2 < bgp_routes_size(local_nets); index2++) {
+      dsts[num].prefix= bgp_routes_at(local_nets, index2)->prefix;
+      dsts[num].origin= index;
+      num++;
+    }
+  }
+  qsort(dsts, num, sizeof(_solver_dst_t), _solver_dst_cmp);
+  *num_dsts= num;
+  return dsts;
+}
+
+// -----[ _solver_for_each_dst_f ]-----------------------------------
+typedef int (*_solver_for_each_dst_f)(_solver_t * solver, ip_pfx_t prefix,
+				      void * ctx);
+
+// -----[ _solver_for_each_dst ]-------------------------------------
+/**
+ * Solve each destination in turn and call a function on the result.
+ * The destinations are independent and share the solver's buffers.
+ */
+static int _solver_for_each_dst(as_level_topo_t * topo,
+				_solver_for_each_dst_f fct, void * ctx)
+{
+  _solver_t solver;
+  _solver_dst_t * dsts;
+  unsigned int num_dsts, index, index2;
+  int result;
+
+  result= _solver_init(&solver, topo);
+  if (result != ASLEVEL_SUCCESS)
+    return result;
+
+  dsts= _solver_destinations(&solver, &num_dsts);
+  for (index= 0; index < num_dsts; index= index2) {
+    index2= index+1;
+    while ((index2 < num_dsts) &&
+	   !ip_prefix_cmp(&dsts[index].prefix, &dsts[index2].prefix))
+      index2++;
+    _solver_solve(&solver, &dsts[index], index2-index);
+    result= fct(&solver, dsts[index].prefix, ctx);
+    if (result != ASLEVEL_SUCCESS)
+      break;
+  }
+
+  FREE(dsts);
+  _solver_destroy(&solver);
+  return result;
+}
+
+// -----[ _solver_install ]------------------------------------------
+/**
+ * Install the selected routes in the Adj-RIB-In and Loc-RIB of each
+ * router, as well as in the node's routing table. Only the best
+ * routes are stored in the Adj-RIB-Ins.
+ */
+static int _solver_install(_solver_t * solver, ip_pfx_t prefix,
+			   void * ctx)
+{
+  bgp_router_t * router;
+  bgp_route_t * route;
+  unsigned int index;
+
+  for (index= 0; index < solver->num_domains; index++) {
+    if ((solver->cls[index] == _CLASS_NONE) ||
+	(solver->cls[index] == _CLASS_ORIGIN))
+      continue;
+    router= solver->domains[index]->router;
+    route= _solver_route(solver, prefix, index);
+    route_flag_set(route, ROUTE_FLAG_FEASIBLE, 1);
+    route_flag_set(route, ROUTE_FLAG_ELIGIBLE, 1);
+    route_flag_set(route, ROUTE_FLAG_BEST, 1);
+    rib_replace_route(route->peer->adj_rib[RIB_IN], route);
+    route= route_copy(route);
+    rib_replace_route(router->loc_rib, route);
+    bgp_router_rt_add_route(router, route);
+  }
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_solver_run ]---------------------------------------
+int aslevel_solver_run(as_level_topo_t * topo)
+{
+  int result;
+
+  if (topo->state < ASLEVEL_STATE_INSTALLED)
+    return ASLEVEL_ERROR_NOT_INSTALLED;
+  if (topo->state < ASLEVEL_STATE_POLICIES)
+    return ASLEVEL_ERROR_INVALID_STATE;
+  if (topo->state > ASLEVEL_STATE_POLICIES)
+    return ASLEVEL_ERROR_ALREADY_RUNNING;
+
+  result= _solver_for_each_dst(topo, _solver_install, NULL);
+  if (result != ASLEVEL_SUCCESS)
+    return result;
+
+  topo->state= ASLEVEL_STATE_SOLVED;
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ _solver_check_ctx_t ]--------------------------------------
+typedef struct {
+  gds_stream_t * stream;
+  int            verbose;
+  unsigned int   num_routes;
+  unsigned int   num_mismatches;
+} _solver_check_ctx_t;
+
+// -----[ _solver_check ]--------------------------------------------
+static int _solver_check(_solver_t * solver, ip_pfx_t prefix, void * ctx)
+{
+  _solver_check_ctx_t * check_ctx= (_solver_check_ctx_t *) ctx;
+  bgp_route_t * route;
+  bgp_path_t * path;
+  unsigned int index;
+  int match;
+
+  for (index= 0; index < solver->num_domains; index++) {
+    if (solver->cls[index] == _CLASS_ORIGIN)
+      continue;
+    route= rib_find_exact(solver->domains[index]->router->loc_rib, prefix);
+    if ((route == NULL) && (solver->cls[index] == _CLASS_NONE))
+      continue;
+
+    check_ctx->num_routes++;
+    path= NULL;
+    if (solver->cls[index] != _CLASS_NONE)
+      path= _solver_path(solver, index);
+    match= ((route != NULL) && (path != NULL) &&
+	    (route->attr->next_hop == solver->rids[solver->via[index]]) &&
+	    (route->attr->local_pref == _solver_pref(solver->cls[index])) &&
+	    !path_cmp(route->attr->path_ref, path));
+    if (!match) {
+      check_ctx->num_mismatches++;
+      if (check_ctx->verbose) {
+	stream_printf(check_ctx->stream, "AS%u\t", solver->domains[index]->asn);
+	ip_prefix_dump(check_ctx->stream, prefix);
+	stream_printf(check_ctx->stream, "\tsolver: ");
+	if (path != NULL)
+	  path_dump(check_ctx->stream, path, 0);
+	else
+	  stream_printf(check_ctx->stream, "*");
+	stream_printf(check_ctx->stream, "\trib: ");
+	if (route != NULL)
+	  path_dump(check_ctx->stream, route->attr->path_ref, 0);
+	else
+	  stream_printf(check_ctx->stream, "*");
+	stream_printf(check_ctx->stream, "\n");
+      }
+    }
+    path_destroy(&path);
+  }
+  return ASLEVEL_SUCCESS;
+}
+
+// -----[ aslevel_solver_check ]-------------------------------------
+int aslevel_solver_check(as_level_topo_t * topo, gds_stream_t * stream,
+			 int verbose)
+{
+  _solver_check_ctx_t ctx= {
+    .stream        = stream,
+    .verbose       = verbose,
+    .num_routes    = 0,
+    .num_mismatches= 0,
+  };
+  int result;
+
+  if (topo->state < ASLEVEL_STATE_INSTALLED)
+    return ASLEVEL_ERROR_NOT_INSTALLED;
+  if (topo->state < ASLEVEL_STATE_POLICIES)
+    return ASLEVEL_ERROR_INVALID_STATE;
+
+  result= _solver_for_each_dst(topo, _solver_check, &ctx);
+  if (result != ASLEVEL_SUCCESS)
+    return result;
+
+  stream_printf(stream, "routes checked: %u\n", ctx.num_routes);
+  stream_printf(stream, "mismatches    : %u\n", ctx.num_mismatches);
+  if (ctx.num_mismatches > 0)
+    return ASLEVEL_ERROR_MISMATCH;
+  return ASLEVEL_SUCCESS;
+}
@@ -0,0 +1,90 @@
+// ==================================================================
+// @(#)solver.h
+//
+// Direct computation of the valley-free routes selected in an
+// AS-level topology with the canned Gao-Rexford policies.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+/**
+ * \file
+ * Provide an algorithmic solver for AS-level topologies whose
+ * routers run the policies installed by aslevel_topo_policies().
+ *
+ * For each destination prefix, the route selected by each AS is
+ * computed in three phases: customer routes are propagated upwards
+ * (providers), then over a single peer-to-peer hop and finally
+ * downwards (customers). Among the routes of the same class, the
+ * shortest AS-Path is preferred and the remaining ties are broken
+ * with the lowest neighbor router-ID, as in the decision process.
+ * The result is written into the Adj-RIB-Ins and Loc-RIBs of the
+ * routers, without exchanging any BGP message.
+ */
+
+#ifndef __BGP_ASLEVEL_SOLVER_H__
+#define __BGP_ASLEVEL_SOLVER_H__
+
+#include <libgds/stream.h>
+
+#include <bgp/aslevel/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ aslevel_solver_run ]-------------------------------------
+  /**
+   * Compute the routes towards all the prefixes originated in the
+   * topology and install them in the routers.
+   *
+   * The topology must be installed and its policies configured. It
+   * must not be running. Sibling relationships are not supported.
+   *
+   * \param topo is the AS-level topology.
+   * \retval ASLEVEL_SUCCESS in case of success,
+   *   or < 0 in case of error.
+   */
+  int aslevel_solver_run(as_level_topo_t * topo);
+
+  // -----[ aslevel_solver_check ]-----------------------------------
+  /**
+   * Compare the routes computed by the solver with the routes
+   * currently stored in the routers' Loc-RIBs (e.g. after a
+   * message-level simulation).
+   *
+   * \param topo    is the AS-level topology.
+   * \param stream  is the output stream (summary and mismatches).
+   * \param verbose tells if each mismatch must be reported.
+   * \retval ASLEVEL_SUCCESS if all the routes are equal,
+   *   ASLEVEL_ERROR_MISMATCH if they are not,
+   *   or < 0 in case of error.
+   */
+  int aslevel_solver_check(as_level_topo_t * topo, gds_stream_t * stream,
+			   int verbose);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_ASLEVEL_SOLVER_H__ */
@@ -35,6 +35,7 @@
 #include <bgp/attr.h>
 #include <bgp/attr/comm_hash.h>
 #include <bgp/attr/path_hash.h>
+#include <util/mem_stats.h>
 
 // -----[ Forward prototypes declaration ]---------------------------
 /* Note: functions starting with underscore (_) are intended to be
@@ -419,6 +420,7 @@ bgp_attr_t * bgp_attr_create(net_addr_t next_hop,
 			     uint32_t med)
 {
   bgp_attr_t * attr= (bgp_attr_t *) MALLOC(sizeof(bgp_attr_t));
+  mem_stats_alloc(MEM_TAG_ATTR, sizeof(bgp_attr_t));
   attr->next_hop= next_hop;
   attr->origin= origin;
   attr->local_pref= local_pref;
@@ -458,6 +460,7 @@ void bgp_attr_destroy(bgp_attr_t ** attr_ref)
 #endif
 
     FREE(*attr_ref);
+    mem_stats_free(MEM_TAG_ATTR, sizeof(bgp_attr_t));
   }
 }
 
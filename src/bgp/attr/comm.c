@@ -38,6 +38,7 @@
 #include <libgds/tokenizer.h>
 
 #include <bgp/attr/comm.h>
+#include <util/mem_stats.h>
 
 /**
  * Note: as we case 'uint32_t' variables to 'unsigned int' for
@@ -54,6 +55,7 @@ static gds_tokenizer_t * pCommTokenizer= NULL;
 bgp_comms_t * comms_create()
 {
   bgp_comms_t * comms= (bgp_comms_t *) MALLOC(sizeof(bgp_comms_t));
+  mem_stats_alloc(MEM_TAG_COMMS, sizeof(bgp_comms_t));
   comms->num= 0;
   return comms;
 }
@@ -64,6 +66,8 @@ void comms_destroy(bgp_comms_t ** comms_ref)
   bgp_comms_t * comms= *comms_ref;
   if (comms == NULL)
     return;
+  mem_stats_free(MEM_TAG_COMMS, sizeof(bgp_comms_t)+
+		 sizeof(bgp_comm_t)*comms->num);
   FREE(comms);
   *comms_ref= NULL;
 }
@@ -76,6 +80,8 @@ bgp_comms_t * comms_dup(const bgp_comms_t * comms)
 			     sizeof(bgp_comm_t)*comms->num);
   memcpy(new_comms, comms, sizeof(bgp_comms_t)+
 	 sizeof(bgp_comm_t)*comms->num);
+  mem_stats_alloc(MEM_TAG_COMMS, sizeof(bgp_comms_t)+
+		  sizeof(bgp_comm_t)*comms->num);
   return new_comms;
 }
 
@@ -97,6 +103,7 @@ int comms_add(bgp_comms_t ** comms_ref, bgp_comm_t comm)
     
   if (*comms_ref == NULL)
     return -1;
+  mem_stats_resize(MEM_TAG_COMMS, 0, sizeof(bgp_comm_t));
   (*comms_ref)->values[(*comms_ref)->num-1]= comm;
   return 0;
 }
@@ -128,8 +135,11 @@ void comms_remove(bgp_comms_t ** comms_ref, bgp_comm_t comm)
   if (comms->num == last_index)
     return;
 
+  mem_stats_resize(MEM_TAG_COMMS, sizeof(bgp_comm_t)*comms->num,
+		   sizeof(bgp_comm_t)*last_index);
   comms->num= last_index;
   if (comms->num == 0) {
+    mem_stats_free(MEM_TAG_COMMS, sizeof(bgp_comms_t));
     FREE(*comms_ref);
     *comms_ref= NULL;
   } else {
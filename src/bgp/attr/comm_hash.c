@@ -205,6 +205,17 @@ int comm_hash_set_method(uint8_t method)
   return 0;
 }
 
+// -----[ comm_hash_for_each ]---------------------------------------
+/**
+ * Call a function for each Communities attribute in the global
+ * repository. The traversal order is unspecified.
+ */
+int comm_hash_for_each(comm_hash_for_each_f for_each, void * ctx)
+{
+  _comm_hash_init();
+  return hash_set_for_each(_global_ref.hash, for_each, ctx);
+}
+
 // -----[ _comm_hash_content_for_each ]------------------------------
 /**
  *
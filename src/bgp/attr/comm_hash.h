@@ -35,6 +35,11 @@
 #define COMM_HASH_METHOD_STRING 0
 #define COMM_HASH_METHOD_ZEBRA 1
 
+// -----[ comm_hash_for_each_f ]-------------------------------------
+/** Callback used to traverse the Communities repository (item is a
+ *  bgp_comms_t). */
+typedef int (*comm_hash_for_each_f)(void * item, void * ctx);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -57,6 +62,9 @@ extern "C" {
   // -----[ comm_hash_set_method ]-----------------------------------
   int comm_hash_set_method(uint8_t method);
   
+  // -----[ comm_hash_for_each ]-------------------------------------
+  int comm_hash_for_each(comm_hash_for_each_f for_each, void * ctx);
+
   // -----[ comm_hash_content ]--------------------------------------
   void comm_hash_content(gds_stream_t * stream);
   // -----[ comm_hash_statistics ]-----------------------------------
@@ -40,6 +40,7 @@
 #include <bgp/attr/path_hash.h>
 #include <bgp/attr/path_segment.h>
 #include <bgp/filter/filter.h>
+#include <util/mem_stats.h>
 
 static gds_tokenizer_t * path_tokenizer= NULL;
 
@@ -64,6 +65,7 @@ bgp_path_t * path_create()
   path->segment= NULL;
   path->pPrevious= NULL;
 #endif
+  mem_stats_alloc(MEM_TAG_PATH, sizeof(bgp_path_t));
   return path;
 }
 
@@ -73,6 +75,8 @@ bgp_path_t * path_create()
  */
 void path_destroy(bgp_path_t ** ppath)
 {
+  if (*ppath != NULL)
+    mem_stats_free(MEM_TAG_PATH, sizeof(bgp_path_t));
 #ifndef __BGP_PATH_TYPE_TREE__
   ptr_array_destroy(ppath);
 #else
@@ -368,6 +372,43 @@ int path_first_as(bgp_path_t * path) {
 #endif
 }
 
+// -----[ path_to_array ]--------------------------------------------
+/**
+ * Write the AS-numbers of the AS-Path into an array, starting with
+ * the neighbor AS and ending with the origin AS (that is, in the
+ * order they are displayed). The members of an AS-SET are written
+ * one after the other. The function will not write outside of the
+ * array, based on the provided array size.
+ *
+ * Return value:
+ *   >= 0  number of AS-numbers in the AS-Path (if larger than the
+ *         array size, the output was truncated)
+ */
+int path_to_array(bgp_path_t * path, uint32_t * array, unsigned int size)
+{
+#ifndef __BGP_PATH_TYPE_TREE__
+  unsigned int index, seg_index;
+  unsigned int count= 0;
+  bgp_path_seg_t * seg;
+
+  if (path == NULL)
+    return 0;
+
+  // AS-Paths are stored from the origin AS (see 'path_from_string')
+  for (index= path_num_segments(path); index > 0; index--) {
+    seg= _path_segment_at(path, index-1);
+    for (seg_index= seg->length; seg_index > 0; seg_index--) {
+      if (count < size)
+	array[count]= seg->asns[seg_index-1];
+      count++;
+    }
+  }
+  return count;
+#else
+  cbgp_fatal("not implemented");
+#endif
+}
+
 // -----[ path_to_string ]-------------------------------------------
 /**
  * Convert the given AS-Path to a string. The string memory MUST have
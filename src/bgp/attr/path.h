@@ -61,6 +61,8 @@ extern "C" {
   int path_last_as(bgp_path_t * path);
   // -----[ path_first_as ]------------------------------------------
   int path_first_as(bgp_path_t * path);
+  // -----[ path_to_array ]------------------------------------------
+  int path_to_array(bgp_path_t * path, uint32_t * array, unsigned int size);
   // -----[ path_to_string ]-----------------------------------------
   int path_to_string(bgp_path_t * path, int reverse,
 		     char * dst, size_t tDstSize);
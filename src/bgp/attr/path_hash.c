@@ -175,6 +175,17 @@ int path_hash_set_method(uint8_t method)
   return 0;
 }
 
+// -----[ path_hash_for_each ]---------------------------------------
+/**
+ * Call a function for each AS-Path in the global repository. The
+ * traversal order is unspecified.
+ */
+int path_hash_for_each(path_hash_for_each_f for_each, void * ctx)
+{
+  _path_hash_init();
+  return hash_set_for_each(_global_ref.hash, for_each, ctx);
+}
+
 // -----[ path_hash_content_for_each ]-------------------------------
 /**
  *
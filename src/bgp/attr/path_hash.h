@@ -34,6 +34,11 @@
 #define PATH_HASH_METHOD_ZEBRA  1
 #define PATH_HASH_METHOD_OAT    2
 
+// -----[ path_hash_for_each_f ]-------------------------------------
+/** Callback used to traverse the AS-Path repository (item is a
+ *  bgp_path_t). */
+typedef int (*path_hash_for_each_f)(void * item, void * ctx);
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -53,6 +58,9 @@ extern "C" {
   // -----[ path_hash_set_method ]-----------------------------------
   int path_hash_set_method(uint8_t method);
   
+  // -----[ path_hash_for_each ]-------------------------------------
+  int path_hash_for_each(path_hash_for_each_f for_each, void * ctx);
+
   // -----[ path_hash_content ]--------------------------------------
   void path_hash_content(gds_stream_t * stream);
   // -----[ path_hash_statistics ]-----------------------------------
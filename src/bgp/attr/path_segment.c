@@ -38,6 +38,7 @@
 #include <bgp/attr/path.h>
 #include <bgp/attr/path_segment.h>
 #include <net/util.h>
+#include <util/mem_stats.h>
 
 // -----[ path segment delimiters ]-----
 /**
@@ -62,6 +63,8 @@ bgp_path_seg_t * path_segment_create(uint8_t type, uint8_t length)
   bgp_path_seg_t * seg=
     (bgp_path_seg_t *) MALLOC(sizeof(bgp_path_seg_t)+
 			     (length * sizeof(asn_t)));
+  mem_stats_alloc(MEM_TAG_PATH, sizeof(bgp_path_seg_t)+
+		  (length * sizeof(asn_t)));
   seg->type= type;
   seg->length= length;
   return seg;
@@ -74,6 +77,8 @@ bgp_path_seg_t * path_segment_create(uint8_t type, uint8_t length)
 void path_segment_destroy(bgp_path_seg_t ** seg_ref)
 {
   if (*seg_ref != NULL) {
+    mem_stats_free(MEM_TAG_PATH, sizeof(bgp_path_seg_t)+
+		   ((*seg_ref)->length * sizeof(asn_t)));
     FREE(*seg_ref);
     *seg_ref= NULL;
   }
@@ -270,6 +275,9 @@ static inline void _path_segment_resize(bgp_path_seg_t ** seg_ref,
   if (new_length == (*seg_ref)->length)
     return;
 
+  mem_stats_resize(MEM_TAG_PATH,
+		   (*seg_ref)->length * sizeof(asn_t),
+		   new_length * sizeof(asn_t));
   *seg_ref= (bgp_path_seg_t *) REALLOC(*seg_ref,
 				       sizeof(bgp_path_seg_t)+
 				       new_length * sizeof(asn_t));
@@ -406,6 +414,7 @@ bgp_path_seg_t * path_segment_remove_private(bgp_path_seg_t * seg)
 {
   unsigned int index;
   int resize= 0;
+  uint8_t old_length= seg->length;
   
   index= 0;
   while (index < seg->length) {
@@ -427,11 +436,15 @@ bgp_path_seg_t * path_segment_remove_private(bgp_path_seg_t * seg)
 
     // No more ASN in segment => free
     if (seg->length == 0) {
+      mem_stats_free(MEM_TAG_PATH, sizeof(bgp_path_seg_t)+
+		     old_length*sizeof(asn_t));
       FREE(seg);
       return NULL;
     }
 
     // Resize
+    mem_stats_resize(MEM_TAG_PATH, old_length*sizeof(asn_t),
+		     seg->length*sizeof(asn_t));
     return (bgp_path_seg_t *) REALLOC(seg,
 				    sizeof(bgp_path_seg_t)+
 				    seg->length*sizeof(asn_t));
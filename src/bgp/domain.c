@@ -39,7 +39,7 @@
 #include <net/network.h>
 
 #define BGP_DOMAINS_MAX 65536
-static bgp_domain_t * _domains[BGP_DOMAINS_MAX];
+static bgp_domain_t ** _domains= NULL;
 
 // ----- bgp_domain_create ------------------------------------------
 /**
@@ -105,6 +105,17 @@ void bgp_domain_add_router(bgp_domain_t * domain, bgp_router_t * router)
   router->domain= domain;
 }
 
+// -----[ bgp_domain_del_router ]------------------------------------
+/**
+ * Remove the reference to a router from the domain. This must be
+ * done before the router is destroyed.
+ */
+void bgp_domain_del_router(bgp_domain_t * domain, bgp_router_t * router)
+{
+  radix_tree_remove(domain->routers, router->node->rid, 32, 1);
+  router->domain= NULL;
+}
+
 // ----- bgp_domain_routers_for_each --------------------------------
 /**
  * Call the given callback function for all routers registered in the
@@ -294,6 +305,7 @@ void _bgp_domain_init()
 {
   unsigned int index;
 
+  _domains= (bgp_domain_t **) MALLOC(BGP_DOMAINS_MAX*sizeof(bgp_domain_t *));
   for (index= 0; index < BGP_DOMAINS_MAX; index++) {
     _domains[index]= NULL;
   }
@@ -307,7 +319,24 @@ void _bgp_domain_destroy()
 {
   unsigned int index;
 
+  if (_domains == NULL)
+    return;
   for (index= 0; index < BGP_DOMAINS_MAX; index++) {
     bgp_domain_destroy(&_domains[index]);
   }
+  FREE(_domains);
+  _domains= NULL;
+}
+
+// -----[ _bgp_domain_swap ]-----------------------------------------
+/**
+ * Exchange the array of domains with the given one (used to switch
+ * between simulation contexts).
+ */
+void _bgp_domain_swap(bgp_domain_t *** domains_ref)
+{
+  bgp_domain_t ** domains= _domains;
+
+  _domains= *domains_ref;
+  *domains_ref= domains;
 }
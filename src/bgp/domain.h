@@ -48,6 +48,8 @@ extern "C" {
   int bgp_domains_for_each(FBGPDomainsForEach for_each, void * ctx);
   // ----- bgp_domain_add_router ------------------------------------
   void bgp_domain_add_router(bgp_domain_t * domain, bgp_router_t * router);
+  // -----[ bgp_domain_del_router ]----------------------------------
+  void bgp_domain_del_router(bgp_domain_t * domain, bgp_router_t * router);
   // ----- bgp_domain_routers_for_each ------------------------------
   int bgp_domain_routers_for_each(bgp_domain_t * domain,
 				  FRadixTreeForEach for_each,
@@ -75,6 +77,8 @@ extern "C" {
   void _bgp_domain_init();
   // ----- _bgp_domain_destroy --------------------------------------
   void _bgp_domain_destroy();
+  // -----[ _bgp_domain_swap ]---------------------------------------
+  void _bgp_domain_swap(bgp_domain_t *** domains_ref);
 
 #ifdef __cplusplus
 }
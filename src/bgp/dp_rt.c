@@ -82,10 +82,13 @@ void bgp_router_rt_add_route(bgp_router_t * router, bgp_route_t * route)
 
   // Add a route with BGP nexthop as gateway and no outgoing
   // interface. Upon forwarding, a recursive lookup will be
-  // performed.
+  // performed. The entries are shared with all the routes that
+  // have the same BGP next-hop, so that an IGP change affects all
+  // of them through the next-hop's own route.
   rtinfo= rt_info_create(route->prefix, 0, NET_ROUTE_BGP);
   rt_entries_add(rtinfo->entries,
 		 rt_entry_create(NULL, route->attr->next_hop));
+  rt_info_intern(rtinfo);
   result= rt_add_route(router->node->rt, route->prefix, rtinfo);
 
   if (result)
@@ -30,6 +30,7 @@
 
 #include <assert.h>
 #include <string.h>
+#include <libgds/memory.h>
 #include <libgds/stream.h>
 
 #include <bgp/as.h>
@@ -56,10 +57,10 @@ struct dp_rule_t DP_RULES[DP_NUM_RULES]= {
 #endif
 };
 
-typedef struct _options_t {
+struct dp_rules_options_t {
   bgp_med_type_t med_type;
-} _options_t;
-static _options_t _default_options= {
+};
+static dp_rules_options_t _default_options= {
   .med_type= BGP_MED_TYPE_DETERMINISTIC,
 };
 
@@ -69,6 +70,33 @@ void dp_rules_options_set_med_type(bgp_med_type_t med_type)
   _default_options.med_type= med_type;
 }
 
+// -----[ _dp_rules_options_create ]---------------------------------
+dp_rules_options_t * _dp_rules_options_create()
+{
+  dp_rules_options_t * options=
+    (dp_rules_options_t *) MALLOC(sizeof(dp_rules_options_t));
+  options->med_type= BGP_MED_TYPE_DETERMINISTIC;
+  return options;
+}
+
+// -----[ _dp_rules_options_destroy ]--------------------------------
+void _dp_rules_options_destroy(dp_rules_options_t ** options_ref)
+{
+  if (*options_ref != NULL) {
+    FREE(*options_ref);
+    *options_ref= NULL;
+  }
+}
+
+// -----[ _dp_rules_options_swap ]-----------------------------------
+void _dp_rules_options_swap(dp_rules_options_t * options)
+{
+  dp_rules_options_t tmp= _default_options;
+
+  _default_options= *options;
+  *options= tmp;
+}
+
 // -----[ dp_rules_str2med_type ]------------------------------------
 net_error_t dp_rules_str2med_type(const char * str, bgp_med_type_t * med_type)
 {
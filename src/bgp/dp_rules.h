@@ -38,6 +38,10 @@ typedef enum {
   BGP_MED_TYPE_MAX
 } bgp_med_type_t;
 
+// -----[ dp_rules_options_t ]---------------------------------------
+/** Options of the decision process rules (see "bgp options med"). */
+typedef struct dp_rules_options_t dp_rules_options_t;
+
 // ----- FDPRule -----
 /**
  * Defines a decision process rule. A rule takes as arguments a router
@@ -83,6 +87,12 @@ extern "C" {
   // -----[ dp_rules_str2med_type ]----------------------------------
   net_error_t dp_rules_str2med_type(const char * str,
 				    bgp_med_type_t * med_type);
+  // -----[ _dp_rules_options_create ]-------------------------------
+  dp_rules_options_t * _dp_rules_options_create();
+  // -----[ _dp_rules_options_destroy ]------------------------------
+  void _dp_rules_options_destroy(dp_rules_options_t ** options_ref);
+  // -----[ _dp_rules_options_swap ]---------------------------------
+  void _dp_rules_options_swap(dp_rules_options_t * options);
 
 
   ///////////////////////////////////////////////////////////////////
@@ -69,6 +69,10 @@ ptr_array_t * paPathExpr = NULL;
 gds_hash_set_t * pHashPathExpr = NULL;
 static unsigned int  uHashPathRegExSize= 64;
 
+// ----- Table of interned filters -----
+static gds_hash_set_t * _filters_hash= NULL;
+static unsigned int     _filters_hash_size= 1024;
+
 // -----[ _filter_path_regex_hash_compare ]--------------------------
 static int _filter_path_regex_hash_compare(const void * item1,
 					   const void * item2, 
@@ -219,19 +223,243 @@ bgp_filter_t * filter_create()
 {
   bgp_filter_t * filter= (bgp_filter_t *) MALLOC(sizeof(bgp_filter_t));
   filter->rules= sequence_create(NULL, filter_rule_seq_destroy);
+  filter->ref_cnt= 1;
+  filter->interned= 0;
   return filter;
 }
 
 // ----- filter_destroy ---------------------------------------------
 /**
- *
+ * Release a reference to the filter. The filter is freed when its
+ * last reference is released.
  */
 void filter_destroy(bgp_filter_t ** filter_ref)
 {
-  if (*filter_ref != NULL) {
-    sequence_destroy(&(*filter_ref)->rules);
-    FREE(*filter_ref);
+  bgp_filter_t * filter= *filter_ref;
+
+  if (filter != NULL) {
     *filter_ref= NULL;
+    assert(filter->ref_cnt > 0);
+    filter->ref_cnt--;
+    if (filter->ref_cnt > 0)
+      return;
+    if (filter->interned && (_filters_hash != NULL))
+      hash_set_remove(_filters_hash, filter);
+    sequence_destroy(&filter->rules);
+    FREE(filter);
+  }
+}
+
+// -----[ filter_add_ref ]-------------------------------------------
+/**
+ * Add a reference to the filter. This is used to share the same
+ * filter between several peers: each call must be balanced by a call
+ * to filter_destroy().
+ */
+bgp_filter_t * filter_add_ref(bgp_filter_t * filter)
+{
+  if (filter != NULL)
+    filter->ref_cnt++;
+  return filter;
+}
+
+// -----[ _ft_matcher_copy ]-----------------------------------------
+static inline bgp_ft_matcher_t * _ft_matcher_copy(bgp_ft_matcher_t * matcher)
+{
+  bgp_ft_matcher_t * new_matcher;
+  size_t size;
+
+  if (matcher == NULL)
+    return NULL;
+  size= sizeof(bgp_ft_matcher_t)+matcher->size;
+  new_matcher= (bgp_ft_matcher_t *) MALLOC(size);
+  memcpy(new_matcher, matcher, size);
+  return new_matcher;
+}
+
+// -----[ _ft_action_copy ]------------------------------------------
+static inline bgp_ft_action_t * _ft_action_copy(bgp_ft_action_t * action)
+{
+  bgp_ft_action_t * new_action= NULL;
+  bgp_ft_action_t ** ref= &new_action;
+  size_t size;
+
+  while (action != NULL) {
+    size= sizeof(bgp_ft_action_t)+action->size;
+    *ref= (bgp_ft_action_t *) MALLOC(size);
+    memcpy(*ref, action, size);
+    ref= &(*ref)->next_action;
+    action= action->next_action;
+  }
+  return new_action;
+}
+
+// -----[ filter_copy ]----------------------------------------------
+/**
+ * Create a private copy of a filter (with a single reference).
+ */
+bgp_filter_t * filter_copy(bgp_filter_t * filter)
+{
+  bgp_filter_t * new_filter= filter_create();
+  bgp_ft_rule_t * rule;
+  unsigned int index;
+
+  for (index= 0; index < filter->rules->size; index++) {
+    rule= (bgp_ft_rule_t *) filter->rules->items[index];
+    filter_add_rule(new_filter, _ft_matcher_copy(rule->matcher),
+		    _ft_action_copy(rule->action));
+  }
+  return new_filter;
+}
+
+// -----[ _ft_matcher_equals ]---------------------------------------
+static inline int _ft_matcher_equals(bgp_ft_matcher_t * matcher1,
+				     bgp_ft_matcher_t * matcher2)
+{
+  if ((matcher1 == NULL) || (matcher2 == NULL))
+    return (matcher1 == matcher2);
+  return ((matcher1->size == matcher2->size) &&
+	  !memcmp(matcher1, matcher2,
+		  sizeof(bgp_ft_matcher_t)+matcher1->size));
+}
+
+// -----[ _ft_action_equals ]----------------------------------------
+static inline int _ft_action_equals(bgp_ft_action_t * action1,
+				    bgp_ft_action_t * action2)
+{
+  while ((action1 != NULL) && (action2 != NULL)) {
+    if ((action1->code != action2->code) ||
+	(action1->size != action2->size) ||
+	memcmp(action1->params, action2->params, action1->size))
+      return 0;
+    action1= action1->next_action;
+    action2= action2->next_action;
+  }
+  return (action1 == action2);
+}
+
+// -----[ filter_equals ]--------------------------------------------
+/**
+ * Test if two filters have the same rules.
+ */
+int filter_equals(bgp_filter_t * filter1, bgp_filter_t * filter2)
+{
+  bgp_ft_rule_t * rule1, * rule2;
+  unsigned int index;
+
+  if (filter1 == filter2)
+    return 1;
+  if ((filter1 == NULL) || (filter2 == NULL))
+    return 0;
+  if (filter1->rules->size != filter2->rules->size)
+    return 0;
+  for (index= 0; index < filter1->rules->size; index++) {
+    rule1= (bgp_ft_rule_t *) filter1->rules->items[index];
+    rule2= (bgp_ft_rule_t *) filter2->rules->items[index];
+    if (!_ft_matcher_equals(rule1->matcher, rule2->matcher) ||
+	!_ft_action_equals(rule1->action, rule2->action))
+      return 0;
+  }
+  return 1;
+}
+
+// -----[ _filters_hash_bytes ]--------------------------------------
+static inline uint32_t _filters_hash_bytes(uint32_t key, const void * data,
+					   size_t size)
+{
+  const unsigned char * bytes= (const unsigned char *) data;
+
+  while (size-- > 0)
+    key= key * 31 + *(bytes++);
+  return key;
+}
+
+// -----[ _filters_hash_compute ]------------------------------------
+static uint32_t _filters_hash_compute(const void * item,
+				      unsigned int hash_size)
+{
+  bgp_filter_t * filter= (bgp_filter_t *) item;
+  bgp_ft_rule_t * rule;
+  bgp_ft_action_t * action;
+  unsigned int index;
+  uint32_t key= filter->rules->size;
+
+  for (index= 0; index < filter->rules->size; index++) {
+    rule= (bgp_ft_rule_t *) filter->rules->items[index];
+    if (rule->matcher != NULL)
+      key= _filters_hash_bytes(key, rule->matcher,
+			       sizeof(bgp_ft_matcher_t)+rule->matcher->size);
+    for (action= rule->action; action != NULL; action= action->next_action) {
+      key= _filters_hash_bytes(key, &action->code, sizeof(action->code));
+      key= _filters_hash_bytes(key, action->params, action->size);
+    }
+  }
+  return key % hash_size;
+}
+
+// -----[ _filters_hash_compare ]------------------------------------
+static int _filters_hash_compare(const void * item1, const void * item2,
+				 unsigned int elt_size)
+{
+  if (filter_equals((bgp_filter_t *) item1, (bgp_filter_t *) item2))
+    return 0;
+  return (item1 < item2) ? -1 : 1;
+}
+
+// -----[ filter_intern ]--------------------------------------------
+/**
+ * Replace a filter by its canonical instance. If a filter with the
+ * same rules has already been interned, the given reference is
+ * released and a new reference to the existing filter is
+ * returned. Otherwise, the filter itself becomes the canonical
+ * instance.
+ *
+ * An interned filter must not be modified. Use filter_unshare()
+ * before modifying it.
+ */
+bgp_filter_t * filter_intern(bgp_filter_t * filter)
+{
+  bgp_filter_t * canonical;
+
+  if ((filter == NULL) || filter->interned)
+    return filter;
+
+  if (_filters_hash == NULL)
+    _filters_hash= hash_set_create(_filters_hash_size, 0,
+				   _filters_hash_compare, NULL,
+				   _filters_hash_compute);
+
+  canonical= (bgp_filter_t *) hash_set_search(_filters_hash, filter);
+  if (canonical != NULL) {
+    filter_destroy(&filter);
+    return filter_add_ref(canonical);
+  }
+
+  hash_set_add(_filters_hash, filter);
+  filter->interned= 1;
+  return filter;
+}
+
+// -----[ filter_unshare ]-------------------------------------------
+/**
+ * Make the referenced filter private before it gets modified. If
+ * the filter is shared, the reference is replaced by a copy. If it
+ * is interned but not shared, it is removed from the table of
+ * interned filters.
+ */
+void filter_unshare(bgp_filter_t ** filter_ref)
+{
+  bgp_filter_t * filter= *filter_ref;
+
+  if (filter == NULL)
+    return;
+
+  if (filter->ref_cnt > 1) {
+    *filter_ref= filter_copy(filter);
+    filter_destroy(&filter);
+  } else if (filter->interned) {
+    hash_set_remove(_filters_hash, filter);
+    filter->interned= 0;
   }
 }
 
@@ -1063,3 +1291,35 @@ void _filter_path_regex_destroy()
   ptr_array_destroy(&paPathExpr);
   hash_set_destroy(&pHashPathExpr);
 }
+
+// -----[ _filter_destroy ]------------------------------------------
+/**
+ * Free the table of interned filters. The filters themselves are
+ * owned by their users.
+ */
+void _filter_destroy()
+{
+  hash_set_destroy(&_filters_hash);
+}
+
+// -----[ _filter_swap ]---------------------------------------------
+/**
+ * Exchange the AS-path regular expressions and the table of
+ * interned filters with the given ones (used to switch between
+ * simulation contexts). Both go together as the path matchers of
+ * interned filters refer to regular expressions by index.
+ */
+void _filter_swap(ptr_array_t ** exprs_ref, gds_hash_set_t ** exprs_hash_ref,
+		  gds_hash_set_t ** filters_hash_ref)
+{
+  ptr_array_t * exprs= paPathExpr;
+  gds_hash_set_t * exprs_hash= pHashPathExpr;
+  gds_hash_set_t * filters_hash= _filters_hash;
+
+  paPathExpr= *exprs_ref;
+  pHashPathExpr= *exprs_hash_ref;
+  _filters_hash= *filters_hash_ref;
+  *exprs_ref= exprs;
+  *exprs_hash_ref= exprs_hash;
+  *filters_hash_ref= filters_hash;
+}
@@ -63,6 +63,16 @@ extern "C" {
   bgp_filter_t * filter_create();
   // ----- filter_destroy -------------------------------------------
   void filter_destroy(bgp_filter_t ** pfilter);
+  // -----[ filter_add_ref ]-----------------------------------------
+  bgp_filter_t * filter_add_ref(bgp_filter_t * filter);
+  // -----[ filter_copy ]--------------------------------------------
+  bgp_filter_t * filter_copy(bgp_filter_t * filter);
+  // -----[ filter_equals ]------------------------------------------
+  int filter_equals(bgp_filter_t * filter1, bgp_filter_t * filter2);
+  // -----[ filter_intern ]------------------------------------------
+  bgp_filter_t * filter_intern(bgp_filter_t * filter);
+  // -----[ filter_unshare ]-----------------------------------------
+  void filter_unshare(bgp_filter_t ** filter_ref);
   // ----- filter_matcher_destroy -----------------------------------
   void filter_matcher_destroy(bgp_ft_matcher_t ** pmatcher);
   // ----- filter_action_destroy ------------------------------------
@@ -159,6 +169,12 @@ extern "C" {
   void _filter_path_regex_init();
   // ----- filter_path_regex_destroy --------------------------------
   void _filter_path_regex_destroy();
+  // -----[ _filter_destroy ]---------------------------------------
+  void _filter_destroy();
+  // -----[ _filter_swap ]------------------------------------------
+  void _filter_swap(ptr_array_t ** exprs_ref,
+		    gds_hash_set_t ** exprs_hash_ref,
+		    gds_hash_set_t ** filters_hash_ref);
 
 #ifdef __cplusplus
 }
@@ -165,11 +165,21 @@ typedef struct {
 /**
  * Definition of a BGP filter.
  *
- * A filter is a sequence of rules.
+ * A filter is a sequence of rules. A filter can be shared by several
+ * peers: it is reference counted and must not be modified while it
+ * is shared (see filter_unshare()).
+ *
+ * \attention
+ * The sequence of rules must remain the first field: jump/call
+ * actions embed a copy of it in their parameters.
  */
 typedef struct bgp_filter_t {
   /** Sequence of rules. */
-  gds_seq_t * rules;
+  gds_seq_t    * rules;
+  /** Number of references. */
+  unsigned int   ref_cnt;
+  /** Tells if the filter is in the table of interned filters. */
+  uint8_t        interned;
 } bgp_filter_t;
 
 #endif /** __BGP_FILTER_TYPES_H__ */
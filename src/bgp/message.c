@@ -42,11 +42,13 @@
 
 #include <bgp/as.h>
 #include <bgp/message.h>
+#include <bgp/msg_writer.h>
 #include <bgp/attr/origin.h>
 #include <bgp/attr/path.h>
 #include <bgp/route.h>
 
 #include <sim/simulator.h>
+#include <util/mem_stats.h>
 
 typedef struct {
   uint16_t    uRemoteAS;
@@ -60,7 +62,7 @@ static char * bgp_msg_names[BGP_MSG_TYPE_MAX]= {
   "OPEN",
 };
 
-static gds_stream_t * pMonitor= NULL;
+static bgp_msg_writer_t * pMonitor= NULL;
 
 // ----- bgp_msg_update_create --------------------------------------
 /**
@@ -71,6 +73,7 @@ bgp_msg_t * bgp_msg_update_create(uint16_t peer_asn,
 {
   bgp_msg_update_t * msg=
     (bgp_msg_update_t *) MALLOC(sizeof(bgp_msg_update_t));
+  mem_stats_alloc(MEM_TAG_MSG, sizeof(bgp_msg_update_t));
   msg->header.type= BGP_MSG_TYPE_UPDATE;
   msg->header.peer_asn= peer_asn;
   msg->route= route;
@@ -92,6 +95,7 @@ bgp_msg_t * bgp_msg_withdraw_create(uint16_t peer_asn,
 {
   bgp_msg_withdraw_t * msg=
     (bgp_msg_withdraw_t *) MALLOC(sizeof(bgp_msg_withdraw_t));
+  mem_stats_alloc(MEM_TAG_MSG, sizeof(bgp_msg_withdraw_t));
   msg->header.type= BGP_MSG_TYPE_WITHDRAW;
   msg->header.peer_asn= peer_asn;
   memcpy(&(msg->prefix), &prefix, sizeof(ip_pfx_t));
@@ -116,6 +120,7 @@ bgp_msg_t * bgp_msg_close_create(uint16_t peer_asn)
 {
   bgp_msg_close_t * msg=
     (bgp_msg_close_t *) MALLOC(sizeof(bgp_msg_close_t));
+  mem_stats_alloc(MEM_TAG_MSG, sizeof(bgp_msg_close_t));
   msg->header.type= BGP_MSG_TYPE_CLOSE;
   msg->header.peer_asn= peer_asn;
   return (bgp_msg_t *) msg;
@@ -126,12 +131,25 @@ bgp_msg_t * bgp_msg_open_create(uint16_t peer_asn, net_addr_t router_id)
 {
   bgp_msg_open_t * msg=
     (bgp_msg_open_t *) MALLOC(sizeof(bgp_msg_open_t));
+  mem_stats_alloc(MEM_TAG_MSG, sizeof(bgp_msg_open_t));
   msg->header.type= BGP_MSG_TYPE_OPEN;
   msg->header.peer_asn= peer_asn;
   msg->router_id= router_id;
   return (bgp_msg_t *) msg;
 }
 
+// -----[ _bgp_msg_size ]--------------------------------------------
+static inline size_t _bgp_msg_size(bgp_msg_type_t type)
+{
+  switch (type) {
+  case BGP_MSG_TYPE_UPDATE: return sizeof(bgp_msg_update_t);
+  case BGP_MSG_TYPE_WITHDRAW: return sizeof(bgp_msg_withdraw_t);
+  case BGP_MSG_TYPE_CLOSE: return sizeof(bgp_msg_close_t);
+  case BGP_MSG_TYPE_OPEN: return sizeof(bgp_msg_open_t);
+  default: abort();
+  }
+}
+
 // ----- bgp_msg_destroy --------------------------------------------
 /**
  *
@@ -144,6 +162,7 @@ void bgp_msg_destroy(bgp_msg_t ** msg_ref)
 	((bgp_msg_withdraw_t *)(*msg_ref))->next_hop != NULL)
       FREE( ((SBGPMsgWithdraw *)(*msg_ref))->next_hop );
 #endif
+    mem_stats_free(MEM_TAG_MSG, _bgp_msg_size((*msg_ref)->type));
     FREE(*msg_ref);
     *msg_ref= NULL;
   }
@@ -156,8 +175,6 @@ void bgp_msg_destroy(bgp_msg_t ** msg_ref)
 int bgp_msg_send(net_node_t * node, net_addr_t src_addr,
 		 net_addr_t dst_addr, bgp_msg_t * msg)
 {
-  bgp_msg_monitor_write(msg, node, dst_addr);
-
   //fprintf(stdout, "(");
   //ip_address_dump(stdout, node->addr);
   //fprintf(stdout, ") bgp-msg-send from ");
@@ -173,14 +190,14 @@ int bgp_msg_send(net_node_t * node, net_addr_t src_addr,
 
 // -----[ _bgp_msg_header_dump ]-------------------------------------
 static inline void _bgp_msg_header_dump(gds_stream_t * stream,
-					net_node_t * node,
+					const net_addr_t * from,
 					bgp_msg_t * msg)
 {
   stream_printf(stream, "|%s", bgp_msg_names[msg->type]);
   // Peer IP
   stream_printf(stream, "|");
-  if (node != NULL) {
-    node_dump_id(stream, node);
+  if (from != NULL) {
+    ip_address_dump(stream, *from);
   } else {
     stream_printf(stream, "?");
   }
@@ -262,18 +279,18 @@ static inline void _bgp_msg_open_dump(gds_stream_t * stream,
   ip_address_dump(stream, msg->router_id);
 }
 
-// ----- bgp_msg_dump -----------------------------------------------
+// -----[ bgp_msg_dump_from ]----------------------------------------
 /**
- *
+ * Dump a message sent by the given address (unknown if NULL).
  */
-void bgp_msg_dump(gds_stream_t * stream,
-		  net_node_t * node,
-		  bgp_msg_t * msg)
+void bgp_msg_dump_from(gds_stream_t * stream,
+		       const net_addr_t * from,
+		       bgp_msg_t * msg)
 {
   assert(msg->type < BGP_MSG_TYPE_MAX);
 
   /* Dump header */
-  _bgp_msg_header_dump(stream, node, msg);
+  _bgp_msg_header_dump(stream, from, msg);
 
   /* Dump message content */
   switch (msg->type) {
@@ -294,6 +311,17 @@ void bgp_msg_dump(gds_stream_t * stream,
   } 
 }
 
+// ----- bgp_msg_dump -----------------------------------------------
+/**
+ *
+ */
+void bgp_msg_dump(gds_stream_t * stream,
+		  net_node_t * node,
+		  bgp_msg_t * msg)
+{
+  bgp_msg_dump_from(stream, (node != NULL) ? &node->rid : NULL, msg);
+}
+
 /////////////////////////////////////////////////////////////////////
 //
 // BGP MESSAGES MONITORING SECTION
@@ -301,44 +329,37 @@ void bgp_msg_dump(gds_stream_t * stream,
 /////////////////////////////////////////////////////////////////////
 //
 // This is enabled through the CLI with the following command
-// (see cli/bgp.c): bgp options msg-monitor <output-file>
+// (see cli/bgp.c):
+//   bgp options msg-monitor <output-file> [--format=text|binary|mrt]
 
 // ----- bgp_msg_monitor_open ---------------------------------------
 /**
- *
+ * Open the message monitor. In binary format, the messages are
+ * accumulated in memory and written to the file in large blocks (see
+ * bgp/msg_writer.h).
  */
-int bgp_msg_monitor_open(const char * file_name)
+int bgp_msg_monitor_open(const char * file_name, bgp_msg_format_t format)
 {
-  time_t tTime= time(NULL);
-
   bgp_msg_monitor_close();
 
   // Create new monitor
-  pMonitor= stream_create_file((char *) file_name);
+  pMonitor= bgp_msg_writer_create(file_name, format,
+				  BGP_MSG_WRITER_MONITOR);
   if (pMonitor == NULL) {
     STREAM_ERR(STREAM_LEVEL_SEVERE, "Unable to create monitor file\n");
     return -1;
   }
-
-  // Write monitor file header
-  stream_set_level(pMonitor, STREAM_LEVEL_EVERYTHING);
-  stream_printf(pMonitor, "# BGP message trace\n");
-  stream_printf(pMonitor, "# generated by C-BGP on %s",
-	  ctime(&tTime));
-  stream_printf(pMonitor, "# <dest-ip>|BGP4|<event-time>|<type>|"
-	  "<peer-ip>|<peer-as>|<prefix>|...\n");
   return 0;
 }
 
 // -----[ bgp_msg_monitor_close ]------------------------------------
 /**
- *
+ * Stop the message monitor. The buffered messages are written to
+ * the file.
  */
 void bgp_msg_monitor_close()
 {
-  // If monitor was previously enabled, stop it.
-  if (pMonitor != NULL)
-    stream_destroy(&pMonitor);
+  bgp_msg_writer_destroy(&pMonitor);
 }
 
 // ----- bgp_msg_monitor_write --------------------------------------
@@ -357,32 +378,17 @@ void bgp_msg_monitor_close()
  * destination's IP address
  *
  *   <dest-ip>|
- */
-void bgp_msg_monitor_write(bgp_msg_t * msg, net_node_t * node,
-			   net_addr_t addr)
-{
-  if (pMonitor != NULL) {
-
-    // Destination router (): this is not MRTD format but required to
-    // identify the destination of the messages
-    ip_address_dump(pMonitor, addr);
-    // Protocol and Time
-    stream_printf(pMonitor, "|BGP4|%.2f",
-	       sim_get_time(network_get_simulator(node->network)));
-
-    bgp_msg_dump(pMonitor, node, msg);
-
-    stream_printf(pMonitor, "\n");
-  }
-}
-
-// ----- bgp_msg_monitor_destroy ------------------------------------
-/**
  *
+ * The node is the sender of the message. The address and ASN are
+ * those of the recipient.
  */
-static inline void bgp_msg_monitor_destroy(gds_stream_t ** stream_ref)
+void bgp_msg_monitor_write(bgp_msg_t * msg, net_node_t * node,
+			   net_addr_t addr, asn_t asn)
 {
-  stream_destroy(stream_ref);
+  if (pMonitor != NULL)
+    bgp_msg_writer_write(pMonitor,
+			 sim_get_time(network_get_simulator(node->network)),
+			 node->rid, addr, asn, msg);
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -392,5 +398,14 @@ static inline void bgp_msg_monitor_destroy(gds_stream_t ** stream_ref)
 // -----[ _message_destroy ]-----------------------------------------
 void _message_destroy()
 {
-  bgp_msg_monitor_destroy(&pMonitor);
+  bgp_msg_monitor_close();
+}
+
+// -----[ _message_swap ]--------------------------------------------
+void _message_swap(bgp_msg_writer_t ** monitor_ref)
+{
+  bgp_msg_writer_t * monitor= pMonitor;
+
+  pMonitor= *monitor_ref;
+  *monitor_ref= monitor;
 }
@@ -32,6 +32,7 @@
 #include <libgds/types.h>
 
 #include <net/network.h>
+#include <bgp/msg_writer.h>
 #include <bgp/types.h>
 
 #ifdef _cplusplus
@@ -61,20 +62,26 @@ extern "C" {
   // ----- bgp_msg_send ---------------------------------------------
   int bgp_msg_send(net_node_t * node, net_addr_t src_addr,
 		   net_addr_t dst_addr, bgp_msg_t * msg);
+  // -----[ bgp_msg_dump_from ]--------------------------------------
+  void bgp_msg_dump_from(gds_stream_t * stream, const net_addr_t * from,
+			 bgp_msg_t * msg);
   // ----- bgp_msg_dump ---------------------------------------------
   void bgp_msg_dump(gds_stream_t * stream, net_node_t * node,
 		    bgp_msg_t * msg);
 
   // ----- bgp_msg_monitor_open -------------------------------------
-  int bgp_msg_monitor_open(const char * file_name);
+  int bgp_msg_monitor_open(const char * file_name,
+			   bgp_msg_format_t format);
   // -----[ bgp_msg_monitor_close ]----------------------------------
   void bgp_msg_monitor_close();
   // ----- bgp_msg_monitor_write ------------------------------------
   void bgp_msg_monitor_write(bgp_msg_t * msg, net_node_t * node,
-			     net_addr_t addr);
+			     net_addr_t addr, asn_t asn);
 
   // -----[ _message_destroy ]---------------------------------------
   void _message_destroy();
+  // -----[ _message_swap ]------------------------------------------
+  void _message_swap(bgp_msg_writer_t ** monitor_ref);
 
 #ifdef _cplusplus
 }
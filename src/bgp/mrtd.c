@@ -41,7 +41,13 @@
 #include <stdarg.h>
 #include <stdio.h>
 #include <string.h>
+#include <time.h>
+#include <sys/time.h>
 
+#include <libgds/enumerator.h>
+#include <libgds/hash.h>
+#include <libgds/memory.h>
+#include <libgds/radix-tree.h>
 #include <libgds/tokenizer.h>
 #include <libgds/tokens.h>
 
@@ -54,34 +60,47 @@
 #include <bgp/as.h>
 #include <bgp/filter/filter.h>
 #include <bgp/peer.h>
+#include <bgp/peer-list.h>
 #include <bgp/attr/comm.h>
+#include <bgp/attr/comm_hash.h>
 #include <bgp/attr/origin.h>
 #include <bgp/attr/path.h>
+#include <bgp/attr/path_hash.h>
 #include <bgp/attr/path_segment.h>
 #include <bgp/mrtd.h>
+#include <bgp/rib.h>
 #include <bgp/route.h>
+#include <bgp/route_reflector.h>
 #include <bgp/routes_list.h>
 
+#include <sim/simulator.h>
+
 //#define DEBUG
 #include <libgds/debug.h>
 
-#define MRT_MAX_LINE_LEN 1024
-
 #ifdef HAVE_LIBZ
 # include <zlib.h>
 typedef gzFile FILE_TYPE;
 # define FILE_OPEN(N,A) gzopen(N, A)
 # define FILE_DOPEN(N,A) gzdopen(N,A)
 # define FILE_CLOSE(F) gzclose(F)
-# define FILE_GETS(F,B,L) gzgets(F, B, L)
-# define FILE_EOF(F) gzeof(F)
+# define FILE_READ(F,B,L) gzread(F, B, L)
 #else
 typedef FILE * FILE_TYPE;
 # define FILE_OPEN(N,A) fopen(N, A)
 # define FILE_DOPEN(N,A) fdopen(N,A)
 # define FILE_CLOSE(F) fclose(F)
-# define FILE_GETS(F,B,L) fgets(B,L,F)
-# define FILE_EOF(F) feof(F)
+# define FILE_READ(F,B,L) ((int) fread(B,1,L,F))
+#endif
+
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#if defined(_POSIX_MAPPED_FILES) && (_POSIX_MAPPED_FILES > 0)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# define MRTD_USE_MMAP
 #endif
 
 #define MRT_UPDATE_MIN_FIELDS   11
@@ -122,6 +141,16 @@ const char * mrtd_strerror(int error)
     return "invalid protocol";
   case MRTD_MISSING_FIELDS:
     return "not enough fields";
+  case MRTD_ERROR_OPEN:
+    return "could not open file";
+  case MRTD_ERROR_WRITE:
+    return "could not write file";
+  case MRTD_TOO_MANY_PEERS:
+    return "too many peers";
+  case MRTD_RECORD_TOO_LARGE:
+    return "record too large";
+  case MRTD_ERROR_SCHEDULER:
+    return "dynamic scheduler required";
   default:
     return NULL;
   }
@@ -529,43 +558,728 @@ int mrtd_msg_from_line(bgp_router_t * router, bgp_peer_t * peer,
   return MRTD_SUCCESS;
 }
 
-// -----[ mrtd_ascii_load ]------------------------------------------
+/////////////////////////////////////////////////////////////////////
+//
+// ATTRIBUTE CACHE
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _mrt_cache_entry_t ]---------------------------------------
 /**
- * This function loads all the routes from a table dump in MRT
- * format. The filename must have previously been converted to ASCII
- * using 'route_btoa -m'.
+ * Entry of an attribute cache. The entry maps the external form of
+ * an AS-Path (or Communities) to the interned attribute. The
+ * external form is either the textual form found in ASCII dumps or
+ * the wire encoding found in binary dumps. The key is always
+ * followed by a NUL character so that a textual key can be used as
+ * a string.
  */
-int mrtd_ascii_load(const char * filename, bgp_route_handler_f handler,
-		    void * ctx)
+typedef struct {
+  void   * ref;
+  size_t   len;
+  char     data[];
+} _mrt_cache_entry_t;
+
+// -----[ _mrt_cache_t ]---------------------------------------------
+typedef struct {
+  gds_hash_set_t     * paths;
+  gds_hash_set_t     * comms;
+  /** Scratch entry used to lookup the caches. */
+  _mrt_cache_entry_t * key;
+  size_t               key_size;
+  /** ASN size of the binary AS-Paths held in the paths cache. */
+  uint8_t              path_asn_len;
+  /** Number of lookups that found / did not find an entry. */
+  unsigned int         hits;
+  unsigned int         misses;
+} _mrt_cache_t;
+
+/** Statistics of the cache used by the last load. */
+static unsigned int _cache_hits= 0;
+static unsigned int _cache_misses= 0;
+
+#define MRT_CACHE_SIZE 25000
+
+// -----[ _mrt_cache_item_compute ]----------------------------------
+/**
+ * One-at-a-time hash of the key (see path_hash_OAT).
+ */
+static uint32_t _mrt_cache_item_compute(const void * item,
+					unsigned int hash_size)
+{
+  const _mrt_cache_entry_t * entry= (const _mrt_cache_entry_t *) item;
+  uint32_t hash= 0;
+  size_t index;
+
+  for (index= 0; index < entry->len; index++) {
+    hash+= (unsigned char) entry->data[index];
+    hash+= (hash << 10);
+    hash^= (hash >> 6);
+  }
+  hash+= (hash << 3);
+  hash^= (hash >> 11);
+  hash+= (hash << 15);
+  return hash % hash_size;
+}
+
+// -----[ _mrt_cache_item_compare ]----------------------------------
+static int _mrt_cache_item_compare(const void * item1,
+				   const void * item2,
+				   unsigned int elt_size)
+{
+  const _mrt_cache_entry_t * entry1= (const _mrt_cache_entry_t *) item1;
+  const _mrt_cache_entry_t * entry2= (const _mrt_cache_entry_t *) item2;
+
+  if (entry1->len != entry2->len)
+    return (entry1->len < entry2->len)?-1:1;
+  return memcmp(entry1->data, entry2->data, entry1->len);
+}
+
+// -----[ _mrt_cache_path_destroy ]----------------------------------
+/**
+ * Release the reference held by the cache on an interned path. Note
+ * that the cache also remembers invalid/empty paths (NULL).
+ */
+static void _mrt_cache_path_destroy(void * item)
+{
+  _mrt_cache_entry_t * entry= (_mrt_cache_entry_t *) item;
+  if (entry->ref != NULL)
+    path_hash_remove((bgp_path_t *) entry->ref);
+  FREE(entry);
+}
+
+// -----[ _mrt_cache_comms_destroy ]---------------------------------
+static void _mrt_cache_comms_destroy(void * item)
+{
+  _mrt_cache_entry_t * entry= (_mrt_cache_entry_t *) item;
+  if (entry->ref != NULL)
+    comm_hash_remove((bgp_comms_t *) entry->ref);
+  FREE(entry);
+}
+
+// -----[ _mrt_cache_init ]------------------------------------------
+static void _mrt_cache_init(_mrt_cache_t * cache)
+{
+  cache->paths= hash_set_create(MRT_CACHE_SIZE, 0,
+				_mrt_cache_item_compare,
+				_mrt_cache_path_destroy,
+				_mrt_cache_item_compute);
+  cache->comms= hash_set_create(MRT_CACHE_SIZE, 0,
+				_mrt_cache_item_compare,
+				_mrt_cache_comms_destroy,
+				_mrt_cache_item_compute);
+  cache->key= NULL;
+  cache->key_size= 0;
+  cache->path_asn_len= 0;
+  cache->hits= 0;
+  cache->misses= 0;
+}
+
+// -----[ _mrt_cache_destroy ]---------------------------------------
+/**
+ * Destroy the caches. The references held on interned attributes
+ * are released. Attributes still used by routes remain interned.
+ */
+static void _mrt_cache_destroy(_mrt_cache_t * cache)
+{
+  hash_set_destroy(&cache->paths);
+  hash_set_destroy(&cache->comms);
+  if (cache->key != NULL)
+    FREE(cache->key);
+}
+
+// -----[ _mrt_cache_key ]-------------------------------------------
+/**
+ * Copy an external form into the scratch key used to lookup the
+ * caches.
+ */
+static inline _mrt_cache_entry_t * _mrt_cache_key(_mrt_cache_t * cache,
+						  const void * data,
+						  size_t len)
+{
+  if (len+1 > cache->key_size) {
+    cache->key_size= len+1;
+    cache->key= (_mrt_cache_entry_t *)
+      REALLOC(cache->key, sizeof(_mrt_cache_entry_t)+cache->key_size);
+  }
+  memcpy(cache->key->data, data, len);
+  cache->key->data[len]= '\0';
+  cache->key->len= len;
+  cache->key->ref= NULL;
+  return cache->key;
+}
+
+// -----[ _mrt_cache_lookup ]----------------------------------------
+/**
+ * Lookup a key in a cache. Return the cache entry or NULL if the
+ * key has never been seen.
+ */
+static inline _mrt_cache_entry_t * _mrt_cache_lookup(_mrt_cache_t * cache,
+						     gds_hash_set_t * set,
+						     _mrt_cache_entry_t * key)
+{
+  _mrt_cache_entry_t * entry=
+    (_mrt_cache_entry_t *) hash_set_search(set, key);
+  if (entry != NULL)
+    cache->hits++;
+  else
+    cache->misses++;
+  return entry;
+}
+
+// -----[ _mrt_cache_save_stats ]------------------------------------
+static inline void _mrt_cache_save_stats(_mrt_cache_t * cache)
+{
+  _cache_hits= cache->hits;
+  _cache_misses= cache->misses;
+}
+
+// -----[ _mrt_cache_insert ]----------------------------------------
+static inline void _mrt_cache_insert(gds_hash_set_t * set,
+				     _mrt_cache_entry_t * key, void * ref)
+{
+  _mrt_cache_entry_t * entry=
+    (_mrt_cache_entry_t *) MALLOC(sizeof(_mrt_cache_entry_t)+key->len+1);
+  entry->ref= ref;
+  entry->len= key->len;
+  memcpy(entry->data, key->data, key->len+1);
+  hash_set_add(set, entry);
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// FAST ASCII MRT LOADER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _mrt_field_t ]---------------------------------------------
+/**
+ * A field of an MRT record. The field is not NUL-terminated, it
+ * points directly into the input buffer.
+ */
+typedef struct {
+  const char * str;
+  size_t       len;
+} _mrt_field_t;
+
+#define MRT_MAX_FIELDS 12
+
+// -----[ _mrt_buffer_t ]--------------------------------------------
+typedef struct {
+  char   * data;
+  size_t   size;
+  int      mapped;
+} _mrt_buffer_t;
+
+// -----[ _mrt_buffer_read ]-----------------------------------------
+/**
+ * Read a whole (possibly compressed) stream into memory.
+ */
+static int _mrt_buffer_read(FILE_TYPE file, _mrt_buffer_t * buf)
+{
+  size_t capacity= 65536;
+  int len;
+
+  buf->data= (char *) MALLOC(capacity);
+  buf->size= 0;
+  buf->mapped= 0;
+  while ((len= FILE_READ(file, buf->data+buf->size,
+			 capacity-buf->size)) > 0) {
+    buf->size+= len;
+    if (buf->size == capacity) {
+      capacity*= 2;
+      buf->data= (char *) REALLOC(buf->data, capacity);
+    }
+  }
+  if (len < 0) {
+    FREE(buf->data);
+    return -1;
+  }
+  return 0;
+}
+
+// -----[ _mrt_buffer_open ]-----------------------------------------
+/**
+ * Make the content of an MRT file available in memory. Plain files
+ * are mapped when the platform supports it. Compressed files and the
+ * standard input are read (and decompressed) into memory.
+ */
+static int _mrt_buffer_open(const char * filename, _mrt_buffer_t * buf)
 {
   FILE_TYPE file;
-  char line[MRT_MAX_LINE_LEN];
+  int result;
+#ifdef MRTD_USE_MMAP
+  struct stat st;
+  int fd;
+#endif /* MRTD_USE_MMAP */
+
+  if ((filename == NULL) || !strcmp(filename, "-")) {
+    file= FILE_DOPEN(0, "r");
+    if (file == NULL)
+      return -1;
+    result= _mrt_buffer_read(file, buf);
+    FILE_CLOSE(file);
+    return result;
+  }
+
+#ifdef MRTD_USE_MMAP
+  fd= open(filename, O_RDONLY);
+  if (fd < 0)
+    return -1;
+  if (fstat(fd, &st) < 0) {
+    close(fd);
+    return -1;
+  }
+  buf->data= NULL;
+  buf->size= st.st_size;
+  buf->mapped= 1;
+  if (buf->size > 0) {
+    buf->data= mmap(NULL, buf->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (buf->data == MAP_FAILED) {
+      close(fd);
+      return -1;
+    }
+# ifdef MADV_SEQUENTIAL
+    madvise(buf->data, buf->size, MADV_SEQUENTIAL);
+# endif /* MADV_SEQUENTIAL */
+  }
+  close(fd);
+
+# ifdef HAVE_LIBZ
+  // gzip-compressed file: decompress it into memory
+  if ((buf->size >= 2) &&
+      ((unsigned char) buf->data[0] == 0x1f) &&
+      ((unsigned char) buf->data[1] == 0x8b)) {
+    munmap(buf->data, buf->size);
+    file= FILE_OPEN(filename, "r");
+    if (file == NULL)
+      return -1;
+    result= _mrt_buffer_read(file, buf);
+    FILE_CLOSE(file);
+    return result;
+  }
+# endif /* HAVE_LIBZ */
+  return 0;
+#else
+  file= FILE_OPEN(filename, "r");
+  if (file == NULL)
+    return -1;
+  result= _mrt_buffer_read(file, buf);
+  FILE_CLOSE(file);
+  return result;
+#endif /* MRTD_USE_MMAP */
+}
+
+// -----[ _mrt_buffer_close ]----------------------------------------
+static void _mrt_buffer_close(_mrt_buffer_t * buf)
+{
+#ifdef MRTD_USE_MMAP
+  if (buf->mapped) {
+    if (buf->size > 0)
+      munmap(buf->data, buf->size);
+    return;
+  }
+#endif /* MRTD_USE_MMAP */
+  FREE(buf->data);
+}
+
+// -----[ _mrt_parse_uint ]------------------------------------------
+static inline int _mrt_parse_uint(const _mrt_field_t * field,
+				  unsigned long max,
+				  unsigned long * value_ref)
+{
+  unsigned long value= 0;
+  size_t index;
+
+  if (field->len == 0)
+    return -1;
+  for (index= 0; index < field->len; index++) {
+    if ((field->str[index] < '0') || (field->str[index] > '9'))
+      return -1;
+    value= value*10 + (field->str[index]-'0');
+    if (value > max)
+      return -1;
+  }
+  *value_ref= value;
+  return 0;
+}
+
+// -----[ _mrt_parse_byte ]------------------------------------------
+/**
+ * Parse a decimal value in [0,max] at the beginning of a field and
+ * return the number of characters consumed (0 in case of error).
+ */
+static inline size_t _mrt_parse_byte(const char * str, size_t len,
+				     unsigned int max, uint32_t * value_ref)
+{
+  uint32_t value= 0;
+  size_t index= 0;
+
+  while ((index < len) && (str[index] >= '0') && (str[index] <= '9')) {
+    value= value*10 + (str[index]-'0');
+    if (value > max)
+      return 0;
+    index++;
+  }
+  *value_ref= value;
+  return index;
+}
+
+// -----[ _mrt_parse_addr ]------------------------------------------
+static inline int _mrt_parse_addr(const _mrt_field_t * field,
+				  net_addr_t * addr_ref)
+{
+  const char * str= field->str;
+  size_t len= field->len, used;
+  net_addr_t addr= 0;
+  uint32_t digit;
+  unsigned int index;
+
+  for (index= 0; index < 4; index++) {
+    used= _mrt_parse_byte(str, len, 255, &digit);
+    if (used == 0)
+      return -1;
+    addr= (addr << 8) + digit;
+    str+= used;
+    len-= used;
+    if (index < 3) {
+      if ((len == 0) || (*str != '.'))
+	return -1;
+      str++;
+      len--;
+    }
+  }
+  if (len != 0)
+    return -1;
+  *addr_ref= addr;
+  return 0;
+}
+
+// -----[ _mrt_parse_prefix ]----------------------------------------
+/**
+ * Parse a prefix. As with str2prefix(), the network part can be
+ * abbreviated (e.g. "10.0/16").
+ */
+static inline int _mrt_parse_prefix(const _mrt_field_t * field,
+				    ip_pfx_t * prefix)
+{
+  const char * str= field->str;
+  size_t len= field->len, used;
+  uint32_t digit;
+  unsigned int index;
+
+  prefix->network= 0;
+  for (index= 0; index < 4; index++) {
+    used= _mrt_parse_byte(str, len, 255, &digit);
+    if (used == 0)
+      return -1;
+    prefix->network= (prefix->network << 8) + digit;
+    str+= used;
+    len-= used;
+    if ((len == 0) || ((*str != '.') && (*str != '/')))
+      return -1;
+    str++;
+    len--;
+    if (str[-1] == '/')
+      break;
+  }
+  if ((index == 4) || (str[-1] != '/'))
+    return -1;
+  for (; index < 3; index++)
+    prefix->network<<= 8;
+  used= _mrt_parse_byte(str, len, 32, &digit);
+  if ((used == 0) || (used != len))
+    return -1;
+  prefix->mask= digit;
+  return 0;
+}
+
+// -----[ _mrt_parse_origin ]----------------------------------------
+static inline int _mrt_parse_origin(const _mrt_field_t * field,
+				    bgp_origin_t * origin_ref)
+{
+  bgp_origin_t origin;
+  const char * name;
+
+  for (origin= 0; origin < BGP_ORIGIN_MAX; origin++) {
+    name= bgp_origin_to_str(origin);
+    if ((strlen(name) == field->len) &&
+	!strncmp(name, field->str, field->len)) {
+      *origin_ref= origin;
+      return 0;
+    }
+  }
+  return -1;
+}
+
+// -----[ _mrt_field_equals ]----------------------------------------
+static inline int _mrt_field_equals(const _mrt_field_t * field,
+				    const char * str)
+{
+  return ((strlen(str) == field->len) &&
+	  !strncmp(str, field->str, field->len));
+}
+
+// -----[ _mrt_intern_path ]-----------------------------------------
+/**
+ * Return the interned AS-Path that corresponds to the given textual
+ * form. The path is only parsed the first time its textual form is
+ * encountered.
+ */
+static bgp_path_t * _mrt_intern_path(_mrt_cache_t * cache,
+				     const _mrt_field_t * field)
+{
+  _mrt_cache_entry_t * key= _mrt_cache_key(cache, field->str, field->len);
+  _mrt_cache_entry_t * entry;
+  bgp_path_t * path, * path_ref;
+
+  entry= _mrt_cache_lookup(cache, cache->paths, key);
+  if (entry != NULL)
+    return (bgp_path_t *) entry->ref;
+
+  path= path_from_string(key->data);
+  if (path == NULL)
+    return NULL;
+  path_ref= path_hash_add(path);
+  if (path_ref != path)
+    path_destroy(&path);
+  _mrt_cache_insert(cache->paths, key, path_ref);
+  return path_ref;
+}
+
+// -----[ _mrt_intern_comms ]----------------------------------------
+static bgp_comms_t * _mrt_intern_comms(_mrt_cache_t * cache,
+				       const _mrt_field_t * field)
+{
+  _mrt_cache_entry_t * key= _mrt_cache_key(cache, field->str, field->len);
+  _mrt_cache_entry_t * entry;
+  bgp_comms_t * comms, * comms_ref;
+
+  entry= _mrt_cache_lookup(cache, cache->comms, key);
+  if (entry != NULL)
+    return (bgp_comms_t *) entry->ref;
+
+  comms= comm_from_string(key->data);
+  if (comms == NULL)
+    return NULL;
+  comms_ref= comm_hash_add(comms);
+  if (comms_ref != comms)
+    comms_destroy(&comms);
+  _mrt_cache_insert(cache->comms, key, comms_ref);
+  return comms_ref;
+}
+
+// -----[ _mrt_split_line ]------------------------------------------
+/**
+ * Split a line into at most MRT_MAX_FIELDS pipe-separated fields.
+ * Additional fields are ignored. Return the number of fields.
+ */
+static inline unsigned int _mrt_split_line(const char * line, size_t len,
+					   _mrt_field_t * fields)
+{
+  unsigned int num_fields= 0;
+  const char * end= line+len;
+  const char * delim;
+
+  while (num_fields < MRT_MAX_FIELDS) {
+    delim= (const char *) memchr(line, '|', end-line);
+    fields[num_fields].str= line;
+    if (delim == NULL) {
+      fields[num_fields++].len= end-line;
+      break;
+    }
+    fields[num_fields++].len= delim-line;
+    line= delim+1;
+  }
+  return num_fields;
+}
+
+// -----[ _mrt_fast_create_route ]-----------------------------------
+/**
+ * Build a route from an MRT record. This is equivalent to
+ * _mrtd_create_route(), except that the fields are parsed in place
+ * and that the AS-Path and Communities are looked up in the
+ * attribute caches.
+ */
+static int _mrt_fast_create_route(_mrt_cache_t * cache,
+				  const char * line, size_t len,
+				  net_addr_t * peer_addr_ref,
+				  asn_t * peer_asn_ref,
+				  bgp_route_t ** route_ref)
+{
+  _mrt_field_t fields[MRT_MAX_FIELDS];
+  unsigned int num_fields, req_fields;
+  mrtd_input_t type;
+  ip_pfx_t prefix;
+  unsigned long value, pref, med;
+  bgp_origin_t origin;
+  net_addr_t next_hop;
+  bgp_path_t * path;
+  bgp_comms_t * comms= NULL;
+
+  *route_ref= NULL;
+  num_fields= _mrt_split_line(line, len, fields);
+
+  // Check the header (see _mrtd_check_header)
+  if (num_fields < MRT_WITHDRAW_MIN_FIELDS) {
+    _set_user_error("not enough fields in MRT input (%d/5)", num_fields);
+    return MRTD_MISSING_FIELDS;
+  }
+  if ((fields[2].len != 1) || (strchr("ABW", fields[2].str[0]) == NULL)) {
+    _set_user_error("invalid MRT record type field \"%.*s\"",
+		    (int) fields[2].len, fields[2].str);
+    return MRTD_INVALID_RECORD_TYPE;
+  }
+  type= fields[2].str[0];
+  if (!(((type == MRTD_TYPE_RIB) &&
+	 _mrt_field_equals(&fields[0], "TABLE_DUMP")) ||
+	((type != MRTD_TYPE_RIB) &&
+	 (_mrt_field_equals(&fields[0], "BGP") ||
+	  _mrt_field_equals(&fields[0], "BGP4"))))) {
+    _set_user_error("incorrect MRT record protocol \"%.*s\"",
+		    (int) fields[0].len, fields[0].str);
+    return MRTD_INVALID_PROTOCOL;
+  }
+  req_fields= (type == MRTD_TYPE_WITHDRAW)?
+    MRT_WITHDRAW_MIN_FIELDS:MRT_UPDATE_MIN_FIELDS;
+  if (num_fields < req_fields) {
+    _set_user_error("not enough fields in MRT input (%d/%d)",
+		    num_fields, req_fields);
+    return MRTD_MISSING_FIELDS;
+  }
+
+  if (_mrt_parse_addr(&fields[3], peer_addr_ref) < 0) {
+    _set_user_error("invalid peer IP address \"%.*s\"",
+		    (int) fields[3].len, fields[3].str);
+    return MRTD_INVALID_PEER_ADDR;
+  }
+  if (_mrt_parse_uint(&fields[4], MAX_AS, &value) < 0) {
+    _set_user_error("invalid peer ASN \"%.*s\"",
+		    (int) fields[4].len, fields[4].str);
+    return MRTD_INVALID_PEER_ASN;
+  }
+  *peer_asn_ref= (asn_t) value;
+  if (_mrt_parse_prefix(&fields[5], &prefix) < 0) {
+    _set_user_error("invalid prefix \"%.*s\"",
+		    (int) fields[5].len, fields[5].str);
+    return MRTD_INVALID_PREFIX;
+  }
+
+  if (type == MRTD_TYPE_WITHDRAW)
+    return type;
+
+  path= _mrt_intern_path(cache, &fields[6]);
+  if (path == NULL) {
+    _set_user_error("invalid AS-Path \"%.*s\"",
+		    (int) fields[6].len, fields[6].str);
+    return MRTD_INVALID_ASPATH;
+  }
+  if (_mrt_parse_origin(&fields[7], &origin) < 0) {
+    _set_user_error("invalid origin \"%.*s\"",
+		    (int) fields[7].len, fields[7].str);
+    return MRTD_INVALID_ORIGIN;
+  }
+  if (_mrt_parse_addr(&fields[8], &next_hop) < 0) {
+    _set_user_error("invalid next-hop \"%.*s\"",
+		    (int) fields[8].len, fields[8].str);
+    return MRTD_INVALID_NEXTHOP;
+  }
+  pref= 0;
+  if ((fields[9].len > 0) &&
+      (_mrt_parse_uint(&fields[9], UINT32_MAX, &pref) < 0)) {
+    _set_user_error("invalid local-preference \"%.*s\"",
+		    (int) fields[9].len, fields[9].str);
+    return MRTD_INVALID_LOCALPREF;
+  }
+  med= ROUTE_MED_MISSING;
+  if ((fields[10].len > 0) &&
+      (_mrt_parse_uint(&fields[10], UINT32_MAX, &med) < 0)) {
+    _set_user_error("invalid multi-exit-discriminator \"%.*s\"",
+		    (int) fields[10].len, fields[10].str);
+    return MRTD_INVALID_MED;
+  }
+  if (num_fields > MRT_UPDATE_MIN_FIELDS) {
+    comms= _mrt_intern_comms(cache, &fields[11]);
+    if (comms == NULL) {
+      _set_user_error("invalid communities \"%.*s\"",
+		      (int) fields[11].len, fields[11].str);
+      return MRTD_INVALID_COMMUNITIES;
+    }
+  }
+
+  // Only table dump records produce a route (see mrtd_route_from_line)
+  if (type != MRTD_TYPE_RIB)
+    return type;
+
+  *route_ref= route_create(prefix, NULL, next_hop, origin);
+  route_localpref_set(*route_ref, pref);
+  route_med_set(*route_ref, med);
+  route_set_path(*route_ref, path);
+  route_set_comm(*route_ref, comms);
+  route_flag_set(*route_ref, ROUTE_FLAG_BEST, 1);
+  route_flag_set(*route_ref, ROUTE_FLAG_ELIGIBLE, 1);
+  route_flag_set(*route_ref, ROUTE_FLAG_FEASIBLE, 1);
+  return type;
+}
+
+// -----[ _mrtd_ascii_load ]-----------------------------------------
+/**
+ * Load all the routes from an MRT ASCII table dump.
+ *
+ * The file is mapped in memory (or decompressed into memory) and
+ * split into lines. Unless legacy is set, the records are parsed in
+ * place, without copying the lines, and the AS-Paths and Communities
+ * are interned directly from their textual form through a cache, so
+ * that a path that appears many times in the dump is only parsed
+ * once. If legacy is set, each line is copied and parsed with the
+ * tokenizer-based mrtd_route_from_line().
+ */
+static int _mrtd_ascii_load(const char * filename,
+			    bgp_route_handler_f handler,
+			    void * ctx, int legacy)
+{
+  _mrt_buffer_t buf;
+  _mrt_cache_t cache;
+  const char * line, * end, * eol;
+  char * line_copy= NULL;
+  size_t len, line_copy_size= 0;
   bgp_route_t * route;
   int error= BGP_INPUT_SUCCESS;
   net_addr_t peer_addr;
   asn_t peer_asn;
   int result;
-  int status;
 
   _line_number= 0;
 
-  // Open input file
-  if ((filename == NULL) || !strcmp(filename, "-")) {
-    file= FILE_DOPEN(0, "r");
-  } else {
-    file= FILE_OPEN(filename, "r");
-  }
-  if (file == NULL)
+  if (_mrt_buffer_open(filename, &buf) < 0)
     return BGP_INPUT_ERROR_FILE_OPEN;
 
-  while (!FILE_EOF(file)) {
-    if (FILE_GETS(file, line, sizeof(line)) == NULL)
-      break;
+  _mrt_cache_init(&cache);
+
+  line= buf.data;
+  end= buf.data+buf.size;
+  while (line < end) {
+    eol= (const char *) memchr(line, '\n', end-line);
+    if (eol == NULL)
+      eol= end;
+    len= eol-line;
+    if ((len > 0) && (line[len-1] == '\r'))
+      len--;
 
     _line_number++;
 
     // Create a route from the file line
-    result= mrtd_route_from_line(line, &peer_addr, &peer_asn, &route);
+    if (legacy) {
+      if (len+1 > line_copy_size) {
+	line_copy_size= len+1;
+	line_copy= (char *) REALLOC(line_copy, line_copy_size);
+      }
+      memcpy(line_copy, line, len);
+      line_copy[len]= '\0';
+      result= mrtd_route_from_line(line_copy, &peer_addr, &peer_asn, &route);
+    } else
+      result= _mrt_fast_create_route(&cache, line, len,
+				     &peer_addr, &peer_asn, &route);
 
     // In case of error, the MRT record is ignored
     if (result < 0) {
@@ -575,19 +1289,59 @@ int mrtd_ascii_load(const char * filename, bgp_route_handler_f handler,
       break;
     }
 
-    status= BGP_INPUT_STATUS_OK;
-    if (handler(status, route, peer_addr, peer_asn, ctx) != 0) {
+    if (handler(BGP_INPUT_STATUS_OK, route, peer_addr, peer_asn,
+		ctx) != 0) {
       error= BGP_INPUT_ERROR_UNEXPECTED;
       break;
     }
-    
+
+    line= eol+1;
   }
-  
-  FILE_CLOSE(file);
+
+  if (line_copy != NULL)
+    FREE(line_copy);
+  _mrt_cache_save_stats(&cache);
+  _mrt_cache_destroy(&cache);
+  _mrt_buffer_close(&buf);
 
   return error;
 }
 
+// -----[ mrtd_ascii_load ]------------------------------------------
+/**
+ * This function loads all the routes from a table dump in MRT
+ * format. The filename must have previously been converted to ASCII
+ * using 'route_btoa -m'.
+ */
+int mrtd_ascii_load(const char * filename, bgp_route_handler_f handler,
+		    void * ctx)
+{
+  return _mrtd_ascii_load(filename, handler, ctx, 0);
+}
+
+// -----[ mrtd_cache_stats ]-----------------------------------------
+/**
+ * Return the number of hits and misses of the AS-Path and
+ * Communities cache during the last MRT load (ASCII or binary).
+ */
+void mrtd_cache_stats(unsigned int * hits, unsigned int * misses)
+{
+  *hits= _cache_hits;
+  *misses= _cache_misses;
+}
+
+// -----[ mrtd_ascii_load_legacy ]-----------------------------------
+/**
+ * Same as mrtd_ascii_load(), but each record is parsed with the
+ * original tokenizer-based parser. This loader is much slower; it
+ * is kept as a reference to validate the in-place parser.
+ */
+int mrtd_ascii_load_legacy(const char * filename,
+			   bgp_route_handler_f handler, void * ctx)
+{
+  return _mrtd_ascii_load(filename, handler, ctx, 1);
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -632,6 +1386,9 @@ bgp_comms_t * mrtd_process_community(struct community * com)
  *
  * This function only supports SETs and SEQUENCEs. If such a segment
  * is found, the function will fail (and return NULL).
+ *
+ * Paths encoded with 32-bits ASNs (TABLE_DUMP_V2) are accepted as
+ * long as all the ASNs fit in 16 bits.
  */
 #ifdef HAVE_BGPDUMP
 bgp_path_t * mrtd_process_aspath(const struct aspath * path)
@@ -643,15 +1400,17 @@ bgp_path_t * mrtd_process_aspath(const struct aspath * path)
   int asn_pos;
   struct assegment *assegment;
   unsigned int index;
+  unsigned int num_segs;
+  uint32_t asn;
   int result= 0;
 
   /* empty AS-path */
   if (path->length == 0)
     return NULL;
 
-  /* ASN size == 32 bits (not supported by c-bgp) */
-  if (path->asn_len != ASN16_LEN) {
-    STREAM_ERR(STREAM_LEVEL_SEVERE, "32-bits ASN are not supported.\n");
+  if ((path->asn_len != ASN16_LEN) && (path->asn_len != ASN32_LEN)) {
+    STREAM_ERR(STREAM_LEVEL_SEVERE, "invalid ASN size (%d).\n",
+	       path->asn_len);
     return NULL;
   }
 
@@ -677,6 +1436,7 @@ bgp_path_t * mrtd_process_aspath(const struct aspath * path)
     
     /* Check the AS-path segment length. */
     if ((pnt + (assegment->length * path->asn_len) + AS_HEADER_SIZE) > end) {
+      path_segment_destroy(&seg);
       result= -1;
       break;
     }
@@ -684,8 +1444,21 @@ bgp_path_t * mrtd_process_aspath(const struct aspath * path)
     /* Copy each AS number into the AS-path segment */
     for (index= 0; index < assegment->length; index++) {
       asn_pos = index * path->asn_len;
-      seg->asns[assegment->length-index-1]=
-	ntohs(*(u_int16_t *) (assegment->data + asn_pos));
+      if (path->asn_len == ASN32_LEN) {
+	memcpy(&asn, assegment->data + asn_pos, sizeof(asn));
+	asn= ntohl(asn);
+	if (asn >= MAX_AS) {
+	  STREAM_ERR(STREAM_LEVEL_SEVERE, "32-bits ASN are not supported.\n");
+	  result= -1;
+	  break;
+	}
+      } else
+	asn= ntohs(*(u_int16_t *) (assegment->data + asn_pos));
+      seg->asns[assegment->length-index-1]= asn;
+    }
+    if (result != 0) {
+      path_segment_destroy(&seg);
+      break;
     }
 
     /* Add the segment to the AS-path */
@@ -703,80 +1476,232 @@ bgp_path_t * mrtd_process_aspath(const struct aspath * path)
     cbgp_path= NULL;
   }
 
+  /* C-BGP stores the segments in reverse order (the origin segment
+     comes first), as it does with the ASNs of each segment. */
+  if (cbgp_path != NULL) {
+    num_segs= path_num_segments(cbgp_path);
+    for (index= 0; index < num_segs/2; index++) {
+      seg= cbgp_path->data[index];
+      cbgp_path->data[index]= cbgp_path->data[num_segs-index-1];
+      cbgp_path->data[num_segs-index-1]= seg;
+    }
+  }
+
   return cbgp_path;
 }
 #endif
 
-// -----[ mrtd_process_table_dump ]----------------------------------
+// -----[ _mrtd_intern_aspath ]-------------------------------------
 /**
- * Convert an MRT TABLE DUMP to a C-BGP route.
- *
- * This function currently only supports IPv4 address familly. In
- * addition, the function only retrive the following attributes:
- * next-hop, origin, local-pref, med, as-path
- *
- * todo: conversion of communities
+ * Return the interned AS-Path that corresponds to a bgpdump aspath.
+ * The cache is keyed on the wire encoding of the aspath, so that an
+ * AS-Path shared by many table dump entries is only converted once.
  */
 #ifdef HAVE_BGPDUMP
-bgp_route_t * mrtd_process_table_dump(BGPDUMP_ENTRY * entry)
+static bgp_path_t * _mrtd_intern_aspath(_mrt_cache_t * cache,
+					const struct aspath * path)
 {
-  BGPDUMP_MRTD_TABLE_DUMP * table_dump= &entry->body.mrtd_table_dump;
-  bgp_route_t * route= NULL;
-  ip_pfx_t prefix;
+  _mrt_cache_entry_t * key, * entry;
+  bgp_path_t * cbgp_path, * path_ref= NULL;
+
+  // The key only holds the segments, so that only paths encoded with
+  // the same ASN size can share the cache. A dump normally uses a
+  // single size (2 bytes in TABLE_DUMP, 4 bytes in TABLE_DUMP_V2).
+  if (cache->path_asn_len == 0)
+    cache->path_asn_len= path->asn_len;
+  if (path->asn_len != cache->path_asn_len)
+    return mrtd_process_aspath(path);
+
+  key= _mrt_cache_key(cache, path->data, path->length);
+  entry= _mrt_cache_lookup(cache, cache->paths, key);
+  if (entry != NULL)
+    return (bgp_path_t *) entry->ref;
+
+  cbgp_path= mrtd_process_aspath(path);
+  if (cbgp_path != NULL) {
+    path_ref= path_hash_add(cbgp_path);
+    if (path_ref != cbgp_path)
+      path_destroy(&cbgp_path);
+  }
+  _mrt_cache_insert(cache->paths, key, path_ref);
+  return path_ref;
+}
+#endif
+
+// -----[ _mrtd_intern_community ]-----------------------------------
+#ifdef HAVE_BGPDUMP
+static bgp_comms_t * _mrtd_intern_community(_mrt_cache_t * cache,
+					    struct community * com)
+{
+  _mrt_cache_entry_t * key, * entry;
+  bgp_comms_t * comms, * comms_ref= NULL;
+
+  key= _mrt_cache_key(cache, com->val, com->size * sizeof(uint32_t));
+  entry= _mrt_cache_lookup(cache, cache->comms, key);
+  if (entry != NULL)
+    return (bgp_comms_t *) entry->ref;
+
+  comms= mrtd_process_community(com);
+  if (comms != NULL) {
+    comms_ref= comm_hash_add(comms);
+    if (comms_ref != comms)
+      comms_destroy(&comms);
+  }
+  _mrt_cache_insert(cache->comms, key, comms_ref);
+  return comms_ref;
+}
+#endif
+
+// -----[ _mrtd_route_from_attr ]------------------------------------
+/**
+ * Build a C-BGP route towards a prefix from bgpdump attributes. If a
+ * cache is provided, the AS-Path and Communities are looked up in
+ * the cache instead of being converted for each entry.
+ */
+#ifdef HAVE_BGPDUMP
+static bgp_route_t * _mrtd_route_from_attr(ip_pfx_t prefix,
+					   struct attr * attr,
+					   _mrt_cache_t * cache)
+{
+  bgp_route_t * route;
   bgp_origin_t origin;
   net_addr_t next_hop;
 
-  if (entry->subtype == AFI_IP) {
+  if (attr == NULL)
+    return NULL;
 
-    prefix.network= ntohl(table_dump->prefix.v4_addr.s_addr);
-    prefix.mask= table_dump->mask;
-    if (entry->attr == NULL)
-      return NULL;
+  if ((attr->flag & ATTR_FLAG_BIT(BGP_ATTR_ORIGIN)) != 0)
+    origin= (bgp_origin_t) attr->origin;
+  else
+    return NULL;
 
-    if ((entry->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_ORIGIN)) != 0)
-      origin= (bgp_origin_t) entry->attr->origin;
+  if ((attr->flag & ATTR_FLAG_BIT(BGP_ATTR_NEXT_HOP)) != 0)
+    next_hop= ntohl(attr->nexthop.s_addr);
+  else
+    return NULL;
+
+  route= route_create(prefix, NULL, next_hop, origin);
+
+  if ((attr->flag & ATTR_FLAG_BIT(BGP_ATTR_AS_PATH)) != 0) {
+    if (cache != NULL)
+      route_set_path(route, _mrtd_intern_aspath(cache, attr->aspath));
     else
-      return NULL;
+      route_set_path(route, mrtd_process_aspath(attr->aspath));
+  }
 
-    if ((entry->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_NEXT_HOP)) != 0)
-      next_hop= ntohl(entry->attr->nexthop.s_addr);
+  if ((attr->flag & ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF)) != 0)
+    route_localpref_set(route, attr->local_pref);
+
+  if ((attr->flag & ATTR_FLAG_BIT(BGP_ATTR_MULTI_EXIT_DISC)) != 0)
+    route_med_set(route, attr->med);
+
+  if ((attr->flag & ATTR_FLAG_BIT(BGP_ATTR_COMMUNITIES)) != 0) {
+    if (cache != NULL)
+      route_set_comm(route, _mrtd_intern_community(cache, attr->community));
     else
-      return NULL;
+      route_set_comm(route, mrtd_process_community(attr->community));
+  }
 
-    route= route_create(prefix, NULL, next_hop, origin);
+  return route;
+}
+#endif
 
-    if ((entry->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_AS_PATH)) != 0)
-      route_set_path(route, mrtd_process_aspath(entry->attr->aspath));
+// -----[ _mrtd_process_table_dump ]---------------------------------
+/**
+ * Convert an MRT TABLE DUMP to a C-BGP route.
+ */
+#ifdef HAVE_BGPDUMP
+static bgp_route_t * _mrtd_process_table_dump(BGPDUMP_ENTRY * entry,
+					      _mrt_cache_t * cache)
+{
+  BGPDUMP_MRTD_TABLE_DUMP * table_dump= &entry->body.mrtd_table_dump;
+  ip_pfx_t prefix;
 
-    if ((entry->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF)) != 0)
-      route_localpref_set(route, entry->attr->local_pref);
+  if (entry->subtype != AFI_IP)
+    return NULL;
 
-    if ((entry->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_MULTI_EXIT_DISC)) != 0)
-      route_med_set(route, entry->attr->med);
+  prefix.network= ntohl(table_dump->prefix.v4_addr.s_addr);
+  prefix.mask= table_dump->mask;
+  return _mrtd_route_from_attr(prefix, entry->attr, cache);
+}
+#endif
 
-    if ((entry->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_COMMUNITIES)) != 0)
-      route_set_comm(route, mrtd_process_community(entry->attr->community));
+// -----[ _mrtd_process_table_dump_v2 ]------------------------------
+/**
+ * Convert an MRT TABLE_DUMP_V2 record to C-BGP routes. A RIB record
+ * holds the routes of all the peers towards a single prefix, so
+ * that the handler is called once per RIB entry. The peer index
+ * table is kept by bgpdump and referenced by the RIB entries.
+ */
+#ifdef HAVE_BGPDUMP
+static int _mrtd_process_table_dump_v2(BGPDUMP_ENTRY * entry,
+				       _mrt_cache_t * cache,
+				       bgp_route_handler_f handler,
+				       void * ctx)
+{
+  BGPDUMP_TABLE_DUMP_V2_PREFIX * rib= &entry->body.mrtd_table_dump_v2_prefix;
+  BGPDUMP_TABLE_DUMP_V2_ROUTE_ENTRY * rib_entry;
+  bgp_route_t * route;
+  ip_pfx_t prefix;
+  net_addr_t peer_addr;
+  int status;
+  unsigned int index;
 
+  switch (entry->subtype) {
+  case BGPDUMP_SUBTYPE_TABLE_DUMP_V2_PEER_INDEX_TABLE:
+    return BGP_INPUT_SUCCESS;
+  case BGPDUMP_SUBTYPE_TABLE_DUMP_V2_RIB_IPV4_UNICAST:
+    break;
+  default:
+    if (handler(BGP_INPUT_STATUS_IGNORED, NULL, IP_ADDR_ANY, 0, ctx) != 0)
+      return BGP_INPUT_ERROR_UNEXPECTED;
+    return BGP_INPUT_SUCCESS;
   }
 
-  return route;
+  prefix.network= ntohl(rib->prefix.v4_addr.s_addr);
+  prefix.mask= rib->prefix_length;
+
+  for (index= 0; index < rib->entry_count; index++) {
+    rib_entry= &rib->entries[index];
+    peer_addr= ntohl(rib_entry->peer->peer_ip.v4_addr.s_addr);
+    route= NULL;
+    if ((rib_entry->peer->afi == AFI_IP) &&
+	(rib_entry->peer->peer_as < MAX_AS))
+      route= _mrtd_route_from_attr(prefix, rib_entry->attr, cache);
+    status= (route == NULL)?BGP_INPUT_STATUS_IGNORED:BGP_INPUT_STATUS_OK;
+    if (handler(status, route, peer_addr, rib_entry->peer->peer_as, ctx) != 0)
+      return BGP_INPUT_ERROR_UNEXPECTED;
+  }
+  return BGP_INPUT_SUCCESS;
 }
 #endif
 
-// -----[ mrtd_process_entry ]---------------------------------------
+// -----[ mrtd_process_table_dump ]----------------------------------
 /**
- * Convert a bgpdump entry to a route. Only supports entries of type
- * TABLE DUMP, for adress family AF_IP (IPv4).
+ * Convert an MRT TABLE DUMP to a C-BGP route.
+ *
+ * This function currently only supports IPv4 address familly. In
+ * addition, the function only retrive the following attributes:
+ * next-hop, origin, local-pref, med, as-path, communities
  */
 #ifdef HAVE_BGPDUMP
-bgp_route_t * mrtd_process_entry(BGPDUMP_ENTRY * entry,
-				 net_addr_t * peer_addr_ref,
-				 unsigned int * peer_asn_ref)
+bgp_route_t * mrtd_process_table_dump(BGPDUMP_ENTRY * entry)
+{
+  return _mrtd_process_table_dump(entry, NULL);
+}
+#endif
+
+// -----[ _mrtd_process_entry ]--------------------------------------
+#ifdef HAVE_BGPDUMP
+static bgp_route_t * _mrtd_process_entry(BGPDUMP_ENTRY * entry,
+					 _mrt_cache_t * cache,
+					 net_addr_t * peer_addr_ref,
+					 unsigned int * peer_asn_ref)
 {
   bgp_route_t * route= NULL;
 
   if (entry->type == BGPDUMP_TYPE_MRTD_TABLE_DUMP) {
-    route= mrtd_process_table_dump(entry);
+    route= _mrtd_process_table_dump(entry, cache);
     *peer_addr_ref= ntohl(entry->body.mrtd_table_dump.peer_ip.v4_addr.s_addr);
     *peer_asn_ref= entry->body.mrtd_table_dump.peer_as;
   } else {
@@ -786,9 +1711,25 @@ bgp_route_t * mrtd_process_entry(BGPDUMP_ENTRY * entry,
 }
 #endif
 
+// -----[ mrtd_process_entry ]---------------------------------------
+/**
+ * Convert a bgpdump entry to a route. Only supports entries of type
+ * TABLE DUMP, for adress family AF_IP (IPv4).
+ */
+#ifdef HAVE_BGPDUMP
+bgp_route_t * mrtd_process_entry(BGPDUMP_ENTRY * entry,
+				 net_addr_t * peer_addr_ref,
+				 unsigned int * peer_asn_ref)
+{
+  return _mrtd_process_entry(entry, NULL, peer_addr_ref, peer_asn_ref);
+}
+#endif
+
 // -----[ mrtd_binary_load ]-----------------------------------------
 /**
- *
+ * Load the routes of a binary MRT table dump (TABLE_DUMP or
+ * TABLE_DUMP_V2). The AS-Paths and Communities of the entries are
+ * converted through attribute caches keyed on their wire encoding.
  */
 #ifdef HAVE_BGPDUMP
 int mrtd_binary_load(const char * filename, bgp_route_handler_f handler,
@@ -801,10 +1742,13 @@ int mrtd_binary_load(const char * filename, bgp_route_handler_f handler,
   int status;
   net_addr_t peer_addr;
   unsigned int peer_asn;
+  _mrt_cache_t cache;
 
   if ((dump= bgpdump_open_dump((char *) filename)) == NULL)
     return BGP_INPUT_ERROR_FILE_OPEN;
 
+  _mrt_cache_init(&cache);
+
   do {
 
     peer_addr= IP_ADDR_ANY;
@@ -821,7 +1765,15 @@ int mrtd_binary_load(const char * filename, bgp_route_handler_f handler,
       continue;
     }
 
-    route= mrtd_process_entry(entry, &peer_addr, &peer_asn);
+    if (entry->type == BGPDUMP_TYPE_TABLE_DUMP_V2) {
+      error= _mrtd_process_table_dump_v2(entry, &cache, handler, ctx);
+      bgpdump_free_mem(entry);
+      if (error != BGP_INPUT_SUCCESS)
+	break;
+      continue;
+    }
+
+    route= _mrtd_process_entry(entry, &cache, &peer_addr, &peer_asn);
     bgpdump_free_mem(entry);
 
     if (route == NULL)
@@ -837,12 +1789,1030 @@ int mrtd_binary_load(const char * filename, bgp_route_handler_f handler,
   } while (dump->eof == 0);
   
   bgpdump_close_dump(dump);
+  _mrt_cache_save_stats(&cache);
+  _mrt_cache_destroy(&cache);
 
   return error;
 }
 #endif
 
 
+/////////////////////////////////////////////////////////////////////
+//
+// BINARY MRT REPLAY (BGP4MP)
+//
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_BGPDUMP
+
+/** Maximum number of records delivered by a single replay event. */
+#define MRTD_REPLAY_CHUNK 256
+
+// -----[ _mrtd_replay_t ]-------------------------------------------
+/**
+ * State of an update-stream replay. Only the next record to be
+ * delivered is held in memory: the replay event reads the records
+ * that are due, then schedules itself at the time of the next one.
+ */
+typedef struct {
+  BGPDUMP         * dump;
+  BGPDUMP_ENTRY   * entry;
+  _mrt_cache_t      cache;
+  bgp_peer_t      * peer;
+  net_addr_t        src_addr;
+  double            speedup;
+  uint8_t           options;
+  /** MRT timestamp of the first record. */
+  time_t            first_ts;
+  /** Simulation time of the first record. */
+  double            start_time;
+  /** Time of the pending replay event. */
+  double            next_time;
+  struct timeval    wall_start;
+  double            max_lag;
+  unsigned int      records;
+  unsigned int      updates;
+  unsigned int      withdraws;
+  unsigned int      ignored;
+  int               started;
+} _mrtd_replay_t;
+
+// -----[ _mrtd_replay_wall_time ]-----------------------------------
+static inline double _mrtd_replay_wall_time(_mrtd_replay_t * replay)
+{
+  struct timeval tv;
+
+  // No lag is measured if the clock cannot be read
+  if (gettimeofday(&tv, NULL) < 0)
+    return 0;
+  return (double) (tv.tv_sec - replay->wall_start.tv_sec) +
+    ((double) (tv.tv_usec - replay->wall_start.tv_usec)) / 1000000;
+}
+
+// -----[ _mrtd_replay_due ]-----------------------------------------
+static inline double _mrtd_replay_due(_mrtd_replay_t * replay,
+				      BGPDUMP_ENTRY * entry)
+{
+  return replay->start_time +
+    ((double) (entry->time - replay->first_ts)) / replay->speedup;
+}
+
+// -----[ _mrtd_replay_next ]----------------------------------------
+/**
+ * Read the next IPv4 UPDATE message (BGP4MP_MESSAGE or
+ * BGP4MP_MESSAGE_AS4). The other records are skipped.
+ */
+static BGPDUMP_ENTRY * _mrtd_replay_next(_mrtd_replay_t * replay)
+{
+  BGPDUMP_ENTRY * entry;
+  BGPDUMP_ZEBRA_MESSAGE * msg;
+
+  while (replay->dump->eof == 0) {
+    entry= bgpdump_read_next(replay->dump);
+    if (entry == NULL)
+      continue;
+    replay->records++;
+    msg= &entry->body.zebra_message;
+    if ((entry->type == BGPDUMP_TYPE_ZEBRA_BGP) &&
+	((entry->subtype == BGPDUMP_SUBTYPE_ZEBRA_BGP_MESSAGE) ||
+	 (entry->subtype == BGPDUMP_SUBTYPE_ZEBRA_BGP_MESSAGE_AS4)) &&
+	(msg->type == BGP_MSG_UPDATE) &&
+	(msg->address_family == AFI_IP) &&
+	((replay->src_addr == IP_ADDR_ANY) ||
+	 (replay->src_addr == ntohl(msg->source_ip.v4_addr.s_addr))))
+      return entry;
+    replay->ignored++;
+    bgpdump_free_mem(entry);
+  }
+  return NULL;
+}
+
+// -----[ _mrtd_replay_deliver ]-------------------------------------
+/**
+ * Deliver the withdrawn and announced prefixes of an UPDATE message
+ * to the peer, as if they had been received in separate messages.
+ */
+static void _mrtd_replay_deliver(_mrtd_replay_t * replay,
+				 BGPDUMP_ENTRY * entry)
+{
+  BGPDUMP_ZEBRA_MESSAGE * zmsg= &entry->body.zebra_message;
+  bgp_peer_t * peer= replay->peer;
+  bgp_msg_t * msg;
+  bgp_route_t * route;
+  ip_pfx_t prefix;
+  unsigned int index;
+
+  for (index= 0; index < zmsg->withdraw_count; index++) {
+    prefix.network= ntohl(zmsg->withdraw[index].address.v4_addr.s_addr);
+    prefix.mask= zmsg->withdraw[index].len;
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+    msg= bgp_msg_withdraw_create(peer->asn, prefix, NULL);
+#else
+    msg= bgp_msg_withdraw_create(peer->asn, prefix);
+#endif
+    bgp_peer_handle_message(peer, msg);
+    bgp_msg_destroy(&msg);
+    replay->withdraws++;
+  }
+
+  for (index= 0; index < zmsg->announce_count; index++) {
+    prefix.network= ntohl(zmsg->announce[index].address.v4_addr.s_addr);
+    prefix.mask= zmsg->announce[index].len;
+    route= _mrtd_route_from_attr(prefix, entry->attr, &replay->cache);
+    if (route == NULL) {
+      replay->ignored++;
+      continue;
+    }
+    msg= bgp_msg_update_create(peer->asn, route);
+    bgp_peer_handle_message(peer, msg);
+    bgp_msg_destroy(&msg);
+    replay->updates++;
+  }
+}
+
+// -----[ _mrtd_replay_destroy ]-------------------------------------
+static void _mrtd_replay_destroy(void * ctx)
+{
+  _mrtd_replay_t * replay= (_mrtd_replay_t *) ctx;
+
+  if (replay->entry != NULL)
+    bgpdump_free_mem(replay->entry);
+  bgpdump_close_dump(replay->dump);
+  _mrt_cache_destroy(&replay->cache);
+  FREE(replay);
+}
+
+// -----[ _mrtd_replay_summary ]-------------------------------------
+static void _mrtd_replay_summary(gds_stream_t * stream,
+				 _mrtd_replay_t * replay,
+				 double sim_time)
+{
+  double wall_time= _mrtd_replay_wall_time(replay);
+  unsigned int msgs= replay->updates + replay->withdraws;
+
+  stream_printf(stream, "Records read      : %u\n", replay->records);
+  stream_printf(stream, "Updates replayed  : %u\n", replay->updates);
+  stream_printf(stream, "Withdraws replayed: %u\n", replay->withdraws);
+  stream_printf(stream, "Records ignored   : %u\n", replay->ignored);
+  stream_printf(stream, "Simulated time    : %.2f\n",
+		sim_time - replay->start_time);
+  stream_printf(stream, "Wall-clock time   : %.3f\n", wall_time);
+  stream_printf(stream, "Throughput        : %.0f msgs/s\n",
+		(wall_time > 0) ? msgs / wall_time : 0);
+  stream_printf(stream, "Max lag           : %.3f\n", replay->max_lag);
+}
+
+static sim_event_ops_t _mrtd_replay_ops;
+
+// -----[ _mrtd_replay_callback ]------------------------------------
+/**
+ * Deliver the records that are due (at most MRTD_REPLAY_CHUNK), then
+ * schedule the next replay event. The lag is the delay of the
+ * wall-clock processing behind the original update rate, accelerated
+ * by the speedup factor.
+ */
+static int _mrtd_replay_callback(simulator_t * sim, void * ctx)
+{
+  _mrtd_replay_t * replay= (_mrtd_replay_t *) ctx;
+  unsigned int count= 0;
+  double lag, time;
+
+  if (!replay->started) {
+    replay->started= 1;
+    replay->start_time= replay->next_time;
+    if (gettimeofday(&replay->wall_start, NULL) < 0) {
+      _mrtd_replay_destroy(replay);
+      return EUNEXPECTED;
+    }
+  }
+
+  while ((replay->entry != NULL) &&
+	 (_mrtd_replay_due(replay, replay->entry) <= replay->next_time) &&
+	 (count < MRTD_REPLAY_CHUNK)) {
+    lag= _mrtd_replay_wall_time(replay) -
+      ((double) (replay->entry->time - replay->first_ts)) / replay->speedup;
+    if (lag > replay->max_lag)
+      replay->max_lag= lag;
+    _mrtd_replay_deliver(replay, replay->entry);
+    bgpdump_free_mem(replay->entry);
+    replay->entry= _mrtd_replay_next(replay);
+    count++;
+  }
+
+  if (replay->entry == NULL) {
+    if (replay->options & MRTD_REPLAY_OPTIONS_SUMMARY)
+      _mrtd_replay_summary(gdsout, replay, replay->next_time);
+    _mrtd_replay_destroy(replay);
+    return 0;
+  }
+
+  // The simulation clock is less precise than a double
+  time= _mrtd_replay_due(replay, replay->entry);
+  if (time < sim_get_time(sim))
+    time= sim_get_time(sim);
+  replay->next_time= time;
+  return sim_post_event(sim, &_mrtd_replay_ops, replay, time, SIM_TIME_ABS);
+}
+
+// -----[ _mrtd_replay_dump ]----------------------------------------
+static void _mrtd_replay_dump(gds_stream_t * stream, void * ctx)
+{
+  _mrtd_replay_t * replay= (_mrtd_replay_t *) ctx;
+
+  stream_printf(stream, "mrt-replay [%s]", replay->dump->filename);
+}
+
+static sim_event_ops_t _mrtd_replay_ops= {
+  .callback= _mrtd_replay_callback,
+  .destroy = _mrtd_replay_destroy,
+  .dump    = _mrtd_replay_dump,
+};
+
+// -----[ mrtd_binary_replay ]---------------------------------------
+/**
+ * Schedule the replay of the UPDATE messages of a binary MRT file
+ * (BGP4MP) through a virtual peer. The messages are delivered at
+ * their original time, relative to the current simulation time and
+ * divided by the speedup factor. The file is read while the
+ * simulation runs.
+ */
+int mrtd_binary_replay(bgp_peer_t * peer, const char * filename,
+		       net_addr_t src_addr, double speedup,
+		       uint8_t options)
+{
+  simulator_t * sim= network_get_simulator(peer->router->node->network);
+  _mrtd_replay_t * replay;
+  BGPDUMP * dump;
+
+  if (sim->sched->type != SCHEDULER_DYNAMIC)
+    return MRTD_ERROR_SCHEDULER;
+
+  if ((dump= bgpdump_open_dump((char *) filename)) == NULL)
+    return MRTD_ERROR_OPEN;
+
+  replay= (_mrtd_replay_t *) MALLOC(sizeof(_mrtd_replay_t));
+  memset(replay, 0, sizeof(_mrtd_replay_t));
+  replay->dump= dump;
+  _mrt_cache_init(&replay->cache);
+  replay->peer= peer;
+  replay->src_addr= src_addr;
+  replay->speedup= speedup;
+  replay->options= options;
+  replay->entry= _mrtd_replay_next(replay);
+  if (replay->entry != NULL)
+    replay->first_ts= replay->entry->time;
+  replay->next_time= sim_get_time(sim);
+  return sim_post_event(sim, &_mrtd_replay_ops, replay,
+			replay->next_time, SIM_TIME_ABS);
+}
+#endif
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// BINARY MRT WRITER (TABLE_DUMP_V2 AND BGP4MP, RFC 6396)
+//
+/////////////////////////////////////////////////////////////////////
+
+#ifdef HAVE_BGPDUMP
+
+#define MRT_HEADER_SIZE   12
+#define MRT_MAX_PEERS     65535
+#define MRT_MAX_ATTR_LEN  65535
+#define BGP_MARKER_SIZE   16
+#define BGP_HOLD_TIME     180
+#define BGP_NOTIFY_CEASE  6
+
+// -----[ _mrt_writer_t ]--------------------------------------------
+typedef struct {
+  CFWFILE        * file;
+  /** Record being built (MRT header included). */
+  uint8_t        * data;
+  size_t           len;
+  size_t           size;
+  /** MRT type of the records. */
+  uint16_t         type;
+  uint32_t         timestamp;
+  uint32_t         seq_num;
+  /** Wire encoding of the AS-Path and Communities attributes, keyed
+      on the interned attribute (NULL if not cached). */
+  gds_hash_set_t * attrs;
+  int              error;
+} _mrt_writer_t;
+
+// -----[ _mrt_dump_peer_t ]-----------------------------------------
+/** Entry of the peer index table. */
+typedef struct {
+  net_addr_t bgp_id;
+  net_addr_t addr;
+  asn_t      asn;
+} _mrt_dump_peer_t;
+
+// -----[ _mrt_dump_src_t ]------------------------------------------
+/**
+ * RIB to be dumped. The routes of the RIB are attributed to the
+ * peer at index peer_index in the peer index table.
+ */
+typedef struct {
+  bgp_rib_t * rib;
+  uint16_t    peer_index;
+} _mrt_dump_src_t;
+
+// -----[ _mrt_dump_ctx_t ]------------------------------------------
+typedef struct {
+  _mrt_writer_t   * writer;
+  _mrt_dump_src_t * srcs;
+  unsigned int      num_srcs;
+} _mrt_dump_ctx_t;
+
+// -----[ _mrt_attr_compute ]----------------------------------------
+static uint32_t _mrt_attr_compute(const void * item,
+				  unsigned int hash_size)
+{
+  const _mrt_cache_entry_t * entry= (const _mrt_cache_entry_t *) item;
+  return (uint32_t) (((unsigned long) entry->ref) >> 3) % hash_size;
+}
+
+// -----[ _mrt_attr_compare ]----------------------------------------
+static int _mrt_attr_compare(const void * item1, const void * item2,
+			     unsigned int elt_size)
+{
+  const _mrt_cache_entry_t * entry1= (const _mrt_cache_entry_t *) item1;
+  const _mrt_cache_entry_t * entry2= (const _mrt_cache_entry_t *) item2;
+
+  if (entry1->ref < entry2->ref)
+    return -1;
+  else if (entry1->ref > entry2->ref)
+    return 1;
+  return 0;
+}
+
+// -----[ _mrt_attr_destroy ]----------------------------------------
+static void _mrt_attr_destroy(void * item)
+{
+  FREE(item);
+}
+
+// -----[ _mrt_wr_reserve ]------------------------------------------
+static inline uint8_t * _mrt_wr_reserve(_mrt_writer_t * w, size_t len)
+{
+  uint8_t * ptr;
+
+  if (w->len + len > w->size) {
+    while (w->len + len > w->size)
+      w->size*= 2;
+    w->data= (uint8_t *) REALLOC(w->data, w->size);
+  }
+  ptr= w->data + w->len;
+  w->len+= len;
+  return ptr;
+}
+
+// -----[ _mrt_wr ]--------------------------------------------------
+static inline void _mrt_wr(_mrt_writer_t * w, const void * data,
+			   size_t len)
+{
+  memcpy(_mrt_wr_reserve(w, len), data, len);
+}
+
+// -----[ _mrt_wr_u8 ]-----------------------------------------------
+static inline void _mrt_wr_u8(_mrt_writer_t * w, uint8_t value)
+{
+  *_mrt_wr_reserve(w, 1)= value;
+}
+
+// -----[ _mrt_wr_u16 ]----------------------------------------------
+static inline void _mrt_wr_u16(_mrt_writer_t * w, uint16_t value)
+{
+  value= htons(value);
+  _mrt_wr(w, &value, sizeof(value));
+}
+
+// -----[ _mrt_wr_u32 ]----------------------------------------------
+static inline void _mrt_wr_u32(_mrt_writer_t * w, uint32_t value)
+{
+  value= htonl(value);
+  _mrt_wr(w, &value, sizeof(value));
+}
+
+// -----[ _mrt_wr_patch_u16 ]----------------------------------------
+static inline void _mrt_wr_patch_u16(_mrt_writer_t * w, size_t offset,
+				     uint16_t value)
+{
+  value= htons(value);
+  memcpy(w->data + offset, &value, sizeof(value));
+}
+
+// -----[ _mrt_wr_patch_u32 ]----------------------------------------
+static inline void _mrt_wr_patch_u32(_mrt_writer_t * w, size_t offset,
+				     uint32_t value)
+{
+  value= htonl(value);
+  memcpy(w->data + offset, &value, sizeof(value));
+}
+
+// -----[ _mrt_wr_record_begin ]-------------------------------------
+/**
+ * Start a new record. The MRT header is written when the record is
+ * complete, since it holds the length of the record.
+ */
+static inline void _mrt_wr_record_begin(_mrt_writer_t * w)
+{
+  w->len= 0;
+  _mrt_wr_reserve(w, MRT_HEADER_SIZE);
+}
+
+// -----[ _mrt_wr_record_end ]---------------------------------------
+static inline void _mrt_wr_record_end(_mrt_writer_t * w,
+				      uint16_t subtype)
+{
+  _mrt_wr_patch_u32(w, 0, w->timestamp);
+  _mrt_wr_patch_u16(w, 4, w->type);
+  _mrt_wr_patch_u16(w, 6, subtype);
+  _mrt_wr_patch_u32(w, 8, w->len - MRT_HEADER_SIZE);
+  if (cfw_write(w->data, 1, w->len, w->file) != w->len)
+    w->error= MRTD_ERROR_WRITE;
+}
+
+// -----[ _mrt_wr_attr_header ]--------------------------------------
+static inline void _mrt_wr_attr_header(_mrt_writer_t * w, uint8_t flags,
+				       uint8_t type, size_t len)
+{
+  if (len > 255) {
+    _mrt_wr_u8(w, flags | BGP_ATTR_FLAG_EXTLEN);
+    _mrt_wr_u8(w, type);
+    _mrt_wr_u16(w, len);
+  } else {
+    _mrt_wr_u8(w, flags);
+    _mrt_wr_u8(w, type);
+    _mrt_wr_u8(w, len);
+  }
+}
+
+// -----[ _mrt_wr_cached ]-------------------------------------------
+/**
+ * Copy the cached encoding of an interned attribute. Return 0 if the
+ * attribute has not been encoded yet.
+ */
+static inline int _mrt_wr_cached(_mrt_writer_t * w, const void * ref)
+{
+  _mrt_cache_entry_t key= { .ref= (void *) ref, .len= 0 };
+  _mrt_cache_entry_t * entry;
+
+  if (w->attrs == NULL)
+    return 0;
+  entry= (_mrt_cache_entry_t *) hash_set_search(w->attrs, &key);
+  if (entry == NULL)
+    return 0;
+  _mrt_wr(w, entry->data, entry->len);
+  return 1;
+}
+
+// -----[ _mrt_wr_cache ]--------------------------------------------
+/**
+ * Remember the encoding of an interned attribute (the last bytes of
+ * the record, from offset start).
+ */
+static inline void _mrt_wr_cache(_mrt_writer_t * w, const void * ref,
+				 size_t start)
+{
+  size_t len= w->len - start;
+  _mrt_cache_entry_t * entry;
+
+  if (w->attrs == NULL)
+    return;
+  entry= (_mrt_cache_entry_t *) MALLOC(sizeof(_mrt_cache_entry_t)+len);
+  entry->ref= (void *) ref;
+  entry->len= len;
+  memcpy(entry->data, w->data + start, len);
+  hash_set_add(w->attrs, entry);
+}
+
+// -----[ _mrt_wr_aspath ]-------------------------------------------
+/**
+ * Write the AS_PATH attribute. TABLE_DUMP_V2 requires 4-bytes ASNs.
+ * The segments and the ASNs of each segment are stored in reverse
+ * order by C-BGP.
+ */
+static void _mrt_wr_aspath(_mrt_writer_t * w, bgp_path_t * path)
+{
+  bgp_path_seg_t * seg;
+  unsigned int num_segs, index, asn_index;
+  size_t len= 0, start;
+
+  if ((path == NULL) || (path_num_segments(path) == 0)) {
+    _mrt_wr_attr_header(w, BGP_ATTR_FLAG_TRANS, BGP_ATTR_AS_PATH, 0);
+    return;
+  }
+
+  if (_mrt_wr_cached(w, path))
+    return;
+
+  start= w->len;
+  num_segs= path_num_segments(path);
+  for (index= 0; index < num_segs; index++) {
+    seg= (bgp_path_seg_t *) path->data[index];
+    len+= AS_HEADER_SIZE + seg->length * ASN32_LEN;
+  }
+  _mrt_wr_attr_header(w, BGP_ATTR_FLAG_TRANS, BGP_ATTR_AS_PATH, len);
+  for (index= num_segs; index > 0; index--) {
+    seg= (bgp_path_seg_t *) path->data[index-1];
+    _mrt_wr_u8(w, (seg->type == AS_PATH_SEGMENT_SET)?AS_SET:AS_SEQUENCE);
+    _mrt_wr_u8(w, seg->length);
+    for (asn_index= seg->length; asn_index > 0; asn_index--)
+      _mrt_wr_u32(w, seg->asns[asn_index-1]);
+  }
+  _mrt_wr_cache(w, path, start);
+}
+
+// -----[ _mrt_wr_communities ]--------------------------------------
+static void _mrt_wr_communities(_mrt_writer_t * w, bgp_comms_t * comms)
+{
+  unsigned int index;
+  size_t start;
+
+  if (_mrt_wr_cached(w, comms))
+    return;
+
+  start= w->len;
+  _mrt_wr_attr_header(w, BGP_ATTR_FLAG_OPTIONAL | BGP_ATTR_FLAG_TRANS,
+		      BGP_ATTR_COMMUNITIES, comms->num * sizeof(bgp_comm_t));
+  for (index= 0; index < comms->num; index++)
+    _mrt_wr_u32(w, comms->values[index]);
+  _mrt_wr_cache(w, comms, start);
+}
+
+// -----[ _mrt_wr_attrs ]-------------------------------------------
+/**
+ * Write the path attributes of a route.
+ */
+static void _mrt_wr_attrs(_mrt_writer_t * w, bgp_attr_t * attr)
+{
+  unsigned int index;
+
+  _mrt_wr_attr_header(w, BGP_ATTR_FLAG_TRANS, BGP_ATTR_ORIGIN, 1);
+  _mrt_wr_u8(w, attr->origin);
+
+  _mrt_wr_aspath(w, attr->path_ref);
+
+  _mrt_wr_attr_header(w, BGP_ATTR_FLAG_TRANS, BGP_ATTR_NEXT_HOP, 4);
+  _mrt_wr_u32(w, attr->next_hop);
+
+  if (attr->med != ROUTE_MED_MISSING) {
+    _mrt_wr_attr_header(w, BGP_ATTR_FLAG_OPTIONAL,
+			BGP_ATTR_MULTI_EXIT_DISC, 4);
+    _mrt_wr_u32(w, attr->med);
+  }
+
+  _mrt_wr_attr_header(w, BGP_ATTR_FLAG_TRANS, BGP_ATTR_LOCAL_PREF, 4);
+  _mrt_wr_u32(w, attr->local_pref);
+
+  if ((attr->comms != NULL) && (attr->comms->num > 0))
+    _mrt_wr_communities(w, attr->comms);
+
+  if (attr->originator != NULL) {
+    _mrt_wr_attr_header(w, BGP_ATTR_FLAG_OPTIONAL,
+			BGP_ATTR_ORIGINATOR_ID, 4);
+    _mrt_wr_u32(w, *attr->originator);
+  }
+
+  if ((attr->cluster_list != NULL) &&
+      (cluster_list_length(attr->cluster_list) > 0)) {
+    _mrt_wr_attr_header(w, BGP_ATTR_FLAG_OPTIONAL, BGP_ATTR_CLUSTER_LIST,
+			cluster_list_length(attr->cluster_list) * 4);
+    for (index= 0; index < cluster_list_length(attr->cluster_list); index++)
+      _mrt_wr_u32(w, attr->cluster_list->data[index]);
+  }
+}
+
+// -----[ _mrt_wr_rib_entry ]----------------------------------------
+/**
+ * Write a RIB entry: peer index, originated time and the path
+ * attributes of the route.
+ */
+static void _mrt_wr_rib_entry(_mrt_writer_t * w, uint16_t peer_index,
+			      bgp_route_t * route)
+{
+  size_t len_offset, start;
+
+  _mrt_wr_u16(w, peer_index);
+  _mrt_wr_u32(w, w->timestamp);
+  len_offset= w->len;
+  _mrt_wr_u16(w, 0);
+  start= w->len;
+
+  _mrt_wr_attrs(w, route->attr);
+
+  if (w->len - start > MRT_MAX_ATTR_LEN)
+    w->error= MRTD_RECORD_TOO_LARGE;
+  _mrt_wr_patch_u16(w, len_offset, w->len - start);
+}
+
+// -----[ _mrt_wr_prefix ]-------------------------------------------
+static inline void _mrt_wr_prefix(_mrt_writer_t * w, ip_pfx_t prefix)
+{
+  uint32_t network= htonl(prefix.network);
+
+  _mrt_wr_u8(w, prefix.mask);
+  _mrt_wr(w, &network, (prefix.mask+7)/8);
+}
+
+// -----[ _mrt_wr_peer_index_table ]---------------------------------
+static void _mrt_wr_peer_index_table(_mrt_writer_t * w,
+				     net_addr_t collector_id,
+				     _mrt_dump_peer_t * peers,
+				     unsigned int num_peers)
+{
+  unsigned int index;
+
+  _mrt_wr_record_begin(w);
+  _mrt_wr_u32(w, collector_id);
+  _mrt_wr_u16(w, 0); // No view name
+  _mrt_wr_u16(w, num_peers);
+  for (index= 0; index < num_peers; index++) {
+    // Peer type: IPv4 address, 2-bytes ASN
+    _mrt_wr_u8(w, 0);
+    _mrt_wr_u32(w, peers[index].bgp_id);
+    _mrt_wr_u32(w, peers[index].addr);
+    _mrt_wr_u16(w, peers[index].asn);
+  }
+  _mrt_wr_record_end(w, BGPDUMP_SUBTYPE_TABLE_DUMP_V2_PEER_INDEX_TABLE);
+}
+
+// -----[ _mrt_dump_prefix ]-----------------------------------------
+/**
+ * Write the RIB record of a prefix. The record gathers the routes
+ * of all the dumped RIBs towards this prefix.
+ */
+static int _mrt_dump_prefix(uint32_t key, uint8_t key_len,
+			    void * item, void * ctx)
+{
+  _mrt_dump_ctx_t * dump_ctx= (_mrt_dump_ctx_t *) ctx;
+  _mrt_writer_t * w= dump_ctx->writer;
+  _mrt_dump_src_t * src;
+  bgp_route_t * route;
+  ip_pfx_t prefix;
+  uint16_t count= 0;
+  size_t count_offset;
+  unsigned int index;
+
+  prefix.network= key;
+  prefix.mask= key_len;
+
+  _mrt_wr_record_begin(w);
+  _mrt_wr_u32(w, w->seq_num++);
+  _mrt_wr_prefix(w, prefix);
+  count_offset= w->len;
+  _mrt_wr_u16(w, 0);
+
+  for (index= 0; index < dump_ctx->num_srcs; index++) {
+    src= &dump_ctx->srcs[index];
+    route= rib_find_exact(src->rib, prefix);
+    if (route == NULL)
+      continue;
+    _mrt_wr_rib_entry(w, src->peer_index, route);
+    count++;
+  }
+
+  _mrt_wr_patch_u16(w, count_offset, count);
+  _mrt_wr_record_end(w, BGPDUMP_SUBTYPE_TABLE_DUMP_V2_RIB_IPV4_UNICAST);
+  return w->error;
+}
+
+// -----[ _mrt_dump_collect_prefix ]---------------------------------
+static int _mrt_dump_collect_prefix(uint32_t key, uint8_t key_len,
+				    void * item, void * ctx)
+{
+  gds_radix_tree_t * prefixes= (gds_radix_tree_t *) ctx;
+  bgp_route_t * route= (bgp_route_t *) item;
+
+  radix_tree_add(prefixes, route->prefix.network,
+		 route->prefix.mask, (void *) 1);
+  return 0;
+}
+
+// -----[ _mrt_dump ]------------------------------------------------
+/**
+ * Write a TABLE_DUMP_V2 file: the peer index table followed by one
+ * RIB record per prefix. When several RIBs are dumped, the union of
+ * their prefixes is collected first so that each prefix is written
+ * once, with the routes of all the RIBs. The output is compressed
+ * when the file name ends with ".gz" or ".bz2".
+ */
+static int _mrt_dump(const char * filename, net_addr_t collector_id,
+		     _mrt_dump_peer_t * peers, unsigned int num_peers,
+		     _mrt_dump_src_t * srcs, unsigned int num_srcs)
+{
+  _mrt_writer_t w;
+  _mrt_dump_ctx_t ctx= {
+    .writer= &w,
+    .srcs= srcs,
+    .num_srcs= num_srcs,
+  };
+  gds_radix_tree_t * prefixes;
+  unsigned int index;
+
+  if (num_peers > MRT_MAX_PEERS)
+    return MRTD_TOO_MANY_PEERS;
+
+  w.file= cfw_open(filename);
+  if (w.file == NULL)
+    return MRTD_ERROR_OPEN;
+  w.size= 4096;
+  w.data= (uint8_t *) MALLOC(w.size);
+  w.len= 0;
+  w.type= BGPDUMP_TYPE_TABLE_DUMP_V2;
+  w.timestamp= (uint32_t) time(NULL);
+  w.seq_num= 0;
+  w.attrs= hash_set_create(MRT_CACHE_SIZE, 0, _mrt_attr_compare,
+			   _mrt_attr_destroy, _mrt_attr_compute);
+  w.error= MRTD_SUCCESS;
+
+  _mrt_wr_peer_index_table(&w, collector_id, peers, num_peers);
+
+  if (w.error == MRTD_SUCCESS) {
+    if (num_srcs == 1) {
+      rib_for_each(srcs[0].rib, _mrt_dump_prefix, &ctx);
+    } else {
+      prefixes= radix_tree_create(32, NULL);
+      for (index= 0; index < num_srcs; index++)
+	rib_for_each(srcs[index].rib, _mrt_dump_collect_prefix, prefixes);
+      radix_tree_for_each(prefixes, _mrt_dump_prefix, &ctx);
+      radix_tree_destroy(&prefixes);
+    }
+  }
+
+  if ((cfw_close(w.file) != 0) && (w.error == MRTD_SUCCESS))
+    w.error= MRTD_ERROR_WRITE;
+  hash_set_destroy(&w.attrs);
+  FREE(w.data);
+  return w.error;
+}
+
+// -----[ _mrt_dump_router_peers ]-----------------------------------
+/**
+ * Build the peer index table of a router: the router itself
+ * followed by its peers.
+ */
+static _mrt_dump_peer_t * _mrt_dump_router_peers(bgp_router_t * router,
+						 unsigned int * num_peers)
+{
+  _mrt_dump_peer_t * peers;
+  bgp_peer_t * peer;
+  unsigned int index;
+
+  *num_peers= bgp_peers_size(router->peers)+1;
+  peers= (_mrt_dump_peer_t *) MALLOC(sizeof(_mrt_dump_peer_t) * *num_peers);
+  peers[0].bgp_id= router->rid;
+  peers[0].addr= router->node->rid;
+  peers[0].asn= router->asn;
+  for (index= 0; index < bgp_peers_size(router->peers); index++) {
+    peer= bgp_peers_at(router->peers, index);
+    peers[index+1].bgp_id= peer->router_id;
+    peers[index+1].addr= peer->addr;
+    peers[index+1].asn= peer->asn;
+  }
+  return peers;
+}
+
+#endif /* HAVE_BGPDUMP */
+
+// -----[ mrtd_binary_save_rib ]-------------------------------------
+/**
+ * Save the Loc-RIB of a router in MRT TABLE_DUMP_V2 format. As in a
+ * dump collected by a route collector peering with the router, the
+ * peer index table only contains the router itself and all the
+ * routes are attributed to it. The dump can thus be loaded back
+ * into the same router (or into another one with --force).
+ */
+#ifdef HAVE_BGPDUMP
+int mrtd_binary_save_rib(bgp_router_t * router, const char * filename)
+{
+  _mrt_dump_src_t src= { .rib= router->loc_rib, .peer_index= 0 };
+  _mrt_dump_peer_t peer= {
+    .bgp_id= router->rid,
+    .addr  = router->node->rid,
+    .asn   = router->asn,
+  };
+
+  return _mrt_dump(filename, router->rid, &peer, 1, &src, 1);
+}
+#endif
+
+// -----[ mrtd_binary_save_adj_rib ]---------------------------------
+/**
+ * Save the Adj-RIB-In or Adj-RIB-Out of one peer (or of all the
+ * peers if peer is NULL) of a router in MRT TABLE_DUMP_V2 format.
+ */
+#ifdef HAVE_BGPDUMP
+int mrtd_binary_save_adj_rib(bgp_router_t * router, bgp_peer_t * peer,
+			     bgp_rib_dir_t dir, const char * filename)
+{
+  _mrt_dump_src_t * srcs;
+  _mrt_dump_peer_t * peers;
+  unsigned int num_peers, num_srcs= 0, index;
+  bgp_peer_t * src_peer;
+  int result;
+
+  peers= _mrt_dump_router_peers(router, &num_peers);
+  srcs= (_mrt_dump_src_t *) MALLOC(sizeof(_mrt_dump_src_t) * num_peers);
+  for (index= 0; index < bgp_peers_size(router->peers); index++) {
+    src_peer= bgp_peers_at(router->peers, index);
+    if ((peer != NULL) && (src_peer != peer))
+      continue;
+    srcs[num_srcs].rib= src_peer->adj_rib[dir];
+    srcs[num_srcs].peer_index= index+1;
+    num_srcs++;
+  }
+  result= _mrt_dump(filename, router->rid, peers, num_peers,
+		    srcs, num_srcs);
+  FREE(srcs);
+  FREE(peers);
+  return result;
+}
+#endif
+
+// -----[ mrtd_binary_save_network ]---------------------------------
+/**
+ * Save the Loc-RIBs of all the BGP routers of a network in a single
+ * MRT TABLE_DUMP_V2 file, as a route collector peering with every
+ * router would see them. Each router has an entry in the peer index
+ * table and the record of a prefix holds the best route of each
+ * router towards this prefix.
+ */
+#ifdef HAVE_BGPDUMP
+int mrtd_binary_save_network(network_t * network, const char * filename)
+{
+  _mrt_dump_src_t * srcs= NULL;
+  _mrt_dump_peer_t * peers= NULL;
+  unsigned int num_peers= 0, size= 0;
+  gds_enum_t * nodes;
+  net_node_t * node;
+  net_protocol_t * protocol;
+  bgp_router_t * router;
+  int result;
+
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    protocol= node_get_protocol(node, NET_PROTOCOL_BGP);
+    if (protocol == NULL)
+      continue;
+    router= (bgp_router_t *) protocol->handler;
+    if (num_peers >= size) {
+      size= (size == 0)?16:size*2;
+      peers= (_mrt_dump_peer_t *)
+	REALLOC(peers, sizeof(_mrt_dump_peer_t) * size);
+      srcs= (_mrt_dump_src_t *)
+	REALLOC(srcs, sizeof(_mrt_dump_src_t) * size);
+    }
+    peers[num_peers].bgp_id= router->rid;
+    peers[num_peers].addr= node->rid;
+    peers[num_peers].asn= router->asn;
+    srcs[num_peers].rib= router->loc_rib;
+    srcs[num_peers].peer_index= num_peers;
+    num_peers++;
+  }
+  enum_destroy(&nodes);
+
+  result= _mrt_dump(filename, IP_ADDR_ANY, peers, num_peers,
+		    srcs, num_peers);
+  if (peers != NULL) {
+    FREE(peers);
+    FREE(srcs);
+  }
+  return result;
+}
+#endif
+
+
+#ifdef HAVE_BGPDUMP
+
+// -----[ mrtd_bgp4mp_t ]--------------------------------------------
+struct mrtd_bgp4mp_t {
+  _mrt_writer_t w;
+};
+
+// -----[ _mrt_wr_bgp_msg ]------------------------------------------
+/**
+ * Write the wire encoding of a BGP message. A withdraw is an UPDATE
+ * with a single withdrawn route and a session close is a CEASE
+ * NOTIFICATION.
+ */
+static void _mrt_wr_bgp_msg(_mrt_writer_t * w, bgp_msg_t * msg)
+{
+  size_t start= w->len, len_offset, offset;
+  bgp_route_t * route;
+
+  memset(_mrt_wr_reserve(w, BGP_MARKER_SIZE), 0xFF, BGP_MARKER_SIZE);
+  len_offset= w->len;
+  _mrt_wr_u16(w, 0);
+
+  switch (msg->type) {
+  case BGP_MSG_TYPE_UPDATE:
+    route= ((bgp_msg_update_t *) msg)->route;
+    _mrt_wr_u8(w, BGP_MSG_UPDATE);
+    _mrt_wr_u16(w, 0); // No withdrawn route
+    offset= w->len;
+    _mrt_wr_u16(w, 0);
+    _mrt_wr_attrs(w, route->attr);
+    _mrt_wr_patch_u16(w, offset, w->len - offset - 2);
+    _mrt_wr_prefix(w, route->prefix);
+    break;
+  case BGP_MSG_TYPE_WITHDRAW:
+    _mrt_wr_u8(w, BGP_MSG_UPDATE);
+    offset= w->len;
+    _mrt_wr_u16(w, 0);
+    _mrt_wr_prefix(w, ((bgp_msg_withdraw_t *) msg)->prefix);
+    _mrt_wr_patch_u16(w, offset, w->len - offset - 2);
+    _mrt_wr_u16(w, 0); // No path attribute
+    break;
+  case BGP_MSG_TYPE_OPEN:
+    _mrt_wr_u8(w, BGP_MSG_OPEN);
+    _mrt_wr_u8(w, 4); // Version
+    _mrt_wr_u16(w, msg->peer_asn);
+    _mrt_wr_u16(w, BGP_HOLD_TIME);
+    _mrt_wr_u32(w, ((bgp_msg_open_t *) msg)->router_id);
+    _mrt_wr_u8(w, 0); // No optional parameter
+    break;
+  case BGP_MSG_TYPE_CLOSE:
+    _mrt_wr_u8(w, BGP_MSG_NOTIFY);
+    _mrt_wr_u8(w, BGP_NOTIFY_CEASE);
+    _mrt_wr_u8(w, 0);
+    break;
+  default:
+    abort();
+  }
+
+  _mrt_wr_patch_u16(w, len_offset, w->len - start);
+}
+
+// -----[ mrtd_bgp4mp_open ]-----------------------------------------
+/**
+ * Create a stream of BGP4MP_MESSAGE_AS4 records. The attributes are
+ * not cached since the interned attributes can be released while the
+ * stream is open.
+ */
+mrtd_bgp4mp_t * mrtd_bgp4mp_open(const char * filename)
+{
+  mrtd_bgp4mp_t * writer;
+  CFWFILE * file= cfw_open(filename);
+
+  if (file == NULL)
+    return NULL;
+  writer= (mrtd_bgp4mp_t *) MALLOC(sizeof(mrtd_bgp4mp_t));
+  writer->w.file= file;
+  writer->w.size= 4096;
+  writer->w.data= (uint8_t *) MALLOC(writer->w.size);
+  writer->w.len= 0;
+  writer->w.type= BGPDUMP_TYPE_ZEBRA_BGP;
+  writer->w.timestamp= 0;
+  writer->w.seq_num= 0;
+  writer->w.attrs= NULL;
+  writer->w.error= MRTD_SUCCESS;
+  return writer;
+}
+
+// -----[ mrtd_bgp4mp_write ]----------------------------------------
+int mrtd_bgp4mp_write(mrtd_bgp4mp_t * writer, uint32_t timestamp,
+		      net_addr_t peer_addr, asn_t peer_asn,
+		      net_addr_t local_addr, asn_t local_asn,
+		      bgp_msg_t * msg)
+{
+  _mrt_writer_t * w= &writer->w;
+
+  w->timestamp= timestamp;
+  _mrt_wr_record_begin(w);
+  _mrt_wr_u32(w, peer_asn);
+  _mrt_wr_u32(w, local_asn);
+  _mrt_wr_u16(w, 0); // Interface index
+  _mrt_wr_u16(w, AFI_IP);
+  _mrt_wr_u32(w, peer_addr);
+  _mrt_wr_u32(w, local_addr);
+  _mrt_wr_bgp_msg(w, msg);
+  _mrt_wr_record_end(w, BGPDUMP_SUBTYPE_ZEBRA_BGP_MESSAGE_AS4);
+  return w->error;
+}
+
+// -----[ mrtd_bgp4mp_close ]----------------------------------------
+int mrtd_bgp4mp_close(mrtd_bgp4mp_t ** writer_ref)
+{
+  mrtd_bgp4mp_t * writer= *writer_ref;
+  int result;
+
+  if (writer == NULL)
+    return MRTD_SUCCESS;
+  result= writer->w.error;
+  if ((cfw_close(writer->w.file) != 0) && (result == MRTD_SUCCESS))
+    result= MRTD_ERROR_WRITE;
+  FREE(writer->w.data);
+  FREE(writer);
+  *writer_ref= NULL;
+  return result;
+}
+
+#endif /* HAVE_BGPDUMP */
+
 /////////////////////////////////////////////////////////////////////
 //
 // INITIALIZATION AND FINALIZATION SECTION
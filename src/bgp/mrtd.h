@@ -38,6 +38,12 @@
 
 typedef uint8_t mrtd_input_t;
 
+struct aspath;
+
+// -----[ mrtd_bgp4mp_t ]--------------------------------------------
+/** Stream of BGP messages in MRT BGP4MP format. */
+typedef struct mrtd_bgp4mp_t mrtd_bgp4mp_t;
+
 // ----- MRT file types -----
 #define MRTD_TYPE_INVALID  0
 #define MRTD_TYPE_RIB      'B' /* Best route */
@@ -65,8 +71,16 @@ typedef enum {
   MRTD_INVALID_NEXTHOP    = LRP_ERROR_USER-11,
   MRTD_MISSING_FIELDS     = LRP_ERROR_USER-12,
   MRTD_INVALID_PROTOCOL   = LRP_ERROR_USER-13,
+  MRTD_ERROR_OPEN         = LRP_ERROR_USER-14,
+  MRTD_ERROR_WRITE        = LRP_ERROR_USER-15,
+  MRTD_TOO_MANY_PEERS     = LRP_ERROR_USER-16,
+  MRTD_RECORD_TOO_LARGE   = LRP_ERROR_USER-17,
+  MRTD_ERROR_SCHEDULER    = LRP_ERROR_USER-18,
 } mrtd_error_code_t;
 
+// ----- MRT replay options -----
+#define MRTD_REPLAY_OPTIONS_SUMMARY 0x01
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -88,6 +102,11 @@ extern "C" {
   // ----- mrtd_ascii_load_routes -----------------------------------
   int mrtd_ascii_load(const char * filename, bgp_route_handler_f handler,
 		      void * ctx);
+  // -----[ mrtd_ascii_load_legacy ]--------------------------------
+  int mrtd_ascii_load_legacy(const char * filename,
+			     bgp_route_handler_f handler, void * ctx);
+  // -----[ mrtd_cache_stats ]--------------------------------------
+  void mrtd_cache_stats(unsigned int * hits, unsigned int * misses);
   // -----[ mrtd_strerror ]------------------------------------------
   const char * mrtd_strerror(int result);
   // -----[ mrtd_perror ]--------------------------------------------
@@ -99,9 +118,45 @@ extern "C" {
   ///////////////////////////////////////////////////////////////////
 
 #ifdef HAVE_BGPDUMP
+  // -----[ mrtd_process_aspath ]------------------------------------
+  /**
+   * Convert a (wire-format) bgpdump AS-Path. The segments are
+   * stored in C-BGP order: the origin segment comes first.
+   */
+  bgp_path_t * mrtd_process_aspath(const struct aspath * path);
   // -----[ mrtd_binary_load ]---------------------------------------
   int mrtd_binary_load(const char * file_name, bgp_route_handler_f handler,
 		       void * ctx);
+  // -----[ mrtd_binary_save_rib ]-----------------------------------
+  int mrtd_binary_save_rib(bgp_router_t * router, const char * file_name);
+  // -----[ mrtd_binary_save_adj_rib ]-------------------------------
+  int mrtd_binary_save_adj_rib(bgp_router_t * router, bgp_peer_t * peer,
+			       bgp_rib_dir_t dir, const char * file_name);
+  // -----[ mrtd_binary_save_network ]-------------------------------
+  int mrtd_binary_save_network(network_t * network,
+			       const char * file_name);
+  // -----[ mrtd_binary_replay ]-------------------------------------
+  /**
+   * Replay the UPDATE messages of a BGP4MP file through a virtual
+   * peer, at their original relative time divided by the speedup.
+   * If src_addr is not IP_ADDR_ANY, only the messages sent by this
+   * address are replayed. Requires the dynamic scheduler.
+   */
+  int mrtd_binary_replay(bgp_peer_t * peer, const char * file_name,
+			 net_addr_t src_addr, double speedup,
+			 uint8_t options);
+  // -----[ mrtd_bgp4mp_open ]---------------------------------------
+  mrtd_bgp4mp_t * mrtd_bgp4mp_open(const char * file_name);
+  // -----[ mrtd_bgp4mp_write ]--------------------------------------
+  /**
+   * Append a BGP message sent by a peer to a local router.
+   */
+  int mrtd_bgp4mp_write(mrtd_bgp4mp_t * writer, uint32_t timestamp,
+			net_addr_t peer_addr, asn_t peer_asn,
+			net_addr_t local_addr, asn_t local_asn,
+			bgp_msg_t * msg);
+  // -----[ mrtd_bgp4mp_close ]--------------------------------------
+  int mrtd_bgp4mp_close(mrtd_bgp4mp_t ** writer_ref);
 #endif
 
 
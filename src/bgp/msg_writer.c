@@ -0,0 +1,674 @@
+// ==================================================================
+// @(#)msg_writer.c
+//
+// Buffered writers for the BGP message monitor and peer records.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <libgds/memory.h>
+
+#include <net/prefix.h>
+#include <bgp/attr/comm.h>
+#include <bgp/attr/path.h>
+#include <bgp/attr/path_segment.h>
+#include <bgp/message.h>
+#include <bgp/mrtd.h>
+#include <bgp/msg_writer.h>
+#include <bgp/route.h>
+#include <bgp/route_reflector.h>
+
+#define MSG_WRITER_MAGIC       "CBGM"
+#define MSG_WRITER_VERSION     1
+#define MSG_WRITER_HEADER_SIZE 16
+#define MSG_WRITER_BUFFER_SIZE 65536
+
+// Header of a binary record:
+//   length (u32), type (u8), time (u64), from (u32), to (u32),
+//   to-asn (u16), peer-asn (u16)
+#define MSG_RECORD_HEADER_SIZE 25
+
+// Optional attributes of an update record
+#define MSG_RECORD_COMMS       0x01
+#define MSG_RECORD_ORIGINATOR  0x02
+#define MSG_RECORD_CLUSTER     0x04
+
+static const char * const FORMAT_NAMES[BGP_MSG_FORMAT_MAX]= {
+  "text",
+  "binary",
+  "mrt",
+};
+
+// -----[ bgp_msg_writer_t ]-----------------------------------------
+struct bgp_msg_writer_t {
+  bgp_msg_format_t        format;
+  bgp_msg_writer_kind_t   kind;
+  /** Text output. */
+  gds_stream_t          * stream;
+  /** Binary output. */
+  FILE                  * file;
+  uint8_t               * buffer;
+  size_t                  len;
+  size_t                  size;
+#ifdef HAVE_BGPDUMP
+  /** MRT output. */
+  mrtd_bgp4mp_t         * mrt;
+#endif
+  int                     error;
+};
+
+// -----[ _mw_reader_t ]---------------------------------------------
+typedef struct {
+  const uint8_t * data;
+  size_t          len;
+  size_t          pos;
+  int             error;
+} _mw_reader_t;
+
+// -----[ bgp_msg_format_from_str ]----------------------------------
+int bgp_msg_format_from_str(const char * str, bgp_msg_format_t * format)
+{
+  bgp_msg_format_t index;
+
+  for (index= 0; index < BGP_MSG_FORMAT_MAX; index++)
+    if (!strcmp(str, FORMAT_NAMES[index])) {
+      *format= index;
+      return 0;
+    }
+  return -1;
+}
+
+// -----[ bgp_msg_writer_strerror ]----------------------------------
+const char * bgp_msg_writer_strerror(int error)
+{
+  switch (error) {
+  case BGP_MSG_WRITER_SUCCESS:
+    return "success";
+  case BGP_MSG_WRITER_ERROR_OPEN:
+    return "could not open file";
+  case BGP_MSG_WRITER_ERROR_FORMAT:
+    return "invalid file format";
+  case BGP_MSG_WRITER_ERROR_READ:
+    return "could not read file";
+  case BGP_MSG_WRITER_ERROR_WRITE:
+    return "could not write file";
+  }
+  return "unknown error";
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// TEXT FORMAT
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _mw_text_header ]------------------------------------------
+static void _mw_text_header(gds_stream_t * stream,
+			    bgp_msg_writer_kind_t kind, time_t created)
+{
+  if (kind != BGP_MSG_WRITER_MONITOR)
+    return;
+  stream_printf(stream, "# BGP message trace\n");
+  stream_printf(stream, "# generated by C-BGP on %s", ctime(&created));
+  stream_printf(stream, "# <dest-ip>|BGP4|<event-time>|<type>|"
+		"<peer-ip>|<peer-as>|<prefix>|...\n");
+}
+
+// -----[ _mw_text_write ]-------------------------------------------
+/**
+ * The monitor lines are prefixed with the destination's IP address
+ * and the time. This is not MRTD format but required to identify the
+ * destination of the messages. The sender of the recorded messages
+ * is not shown.
+ */
+static void _mw_text_write(gds_stream_t * stream,
+			   bgp_msg_writer_kind_t kind, double time,
+			   net_addr_t from, net_addr_t to, bgp_msg_t * msg)
+{
+  if (kind == BGP_MSG_WRITER_MONITOR) {
+    ip_address_dump(stream, to);
+    stream_printf(stream, "|BGP4|%.2f", time);
+    bgp_msg_dump_from(stream, &from, msg);
+    stream_printf(stream, "\n");
+  } else {
+    bgp_msg_dump_from(stream, NULL, msg);
+    stream_printf(stream, "\n");
+    stream_flush(stream);
+  }
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// BINARY FORMAT
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _mw_put8 ]-------------------------------------------------
+static inline uint8_t * _mw_put8(uint8_t * ptr, uint8_t value)
+{
+  *(ptr++)= value;
+  return ptr;
+}
+
+// -----[ _mw_put16 ]------------------------------------------------
+static inline uint8_t * _mw_put16(uint8_t * ptr, uint16_t value)
+{
+  *(ptr++)= (uint8_t) (value >> 8);
+  *(ptr++)= (uint8_t) value;
+  return ptr;
+}
+
+// -----[ _mw_put32 ]------------------------------------------------
+static inline uint8_t * _mw_put32(uint8_t * ptr, uint32_t value)
+{
+  ptr= _mw_put16(ptr, (uint16_t) (value >> 16));
+  return _mw_put16(ptr, (uint16_t) value);
+}
+
+// -----[ _mw_put64 ]------------------------------------------------
+static inline uint8_t * _mw_put64(uint8_t * ptr, uint64_t value)
+{
+  ptr= _mw_put32(ptr, (uint32_t) (value >> 32));
+  return _mw_put32(ptr, (uint32_t) value);
+}
+
+// -----[ _mw_flush ]------------------------------------------------
+static void _mw_flush(bgp_msg_writer_t * writer)
+{
+  if ((writer->len > 0) &&
+      (fwrite(writer->buffer, 1, writer->len, writer->file) != writer->len))
+    writer->error= BGP_MSG_WRITER_ERROR_WRITE;
+  writer->len= 0;
+}
+
+// -----[ _mw_reserve ]----------------------------------------------
+/**
+ * Reserve space for a record at the end of the buffer. The buffer is
+ * written to the file first if there is not enough space left.
+ */
+static uint8_t * _mw_reserve(bgp_msg_writer_t * writer, size_t len)
+{
+  uint8_t * ptr;
+
+  if (writer->len + len > writer->size) {
+    _mw_flush(writer);
+    if (len > writer->size) {
+      writer->size= len;
+      writer->buffer= (uint8_t *) REALLOC(writer->buffer, writer->size);
+    }
+  }
+  ptr= writer->buffer + writer->len;
+  writer->len+= len;
+  return ptr;
+}
+
+// -----[ _mw_update_size ]------------------------------------------
+static size_t _mw_update_size(bgp_route_t * route)
+{
+  bgp_attr_t * attr= route->attr;
+  bgp_path_seg_t * seg;
+  size_t size= 5 + 4 + 1 + 4 + 4 + 1 + 1;
+  unsigned int index;
+
+  for (index= 0; index < path_num_segments(attr->path_ref); index++) {
+    seg= (bgp_path_seg_t *) attr->path_ref->data[index];
+    size+= 2 + seg->length * 2;
+  }
+  if (attr->comms != NULL)
+    size+= 1 + attr->comms->num * 4;
+  if (attr->originator != NULL)
+    size+= 4;
+  if (attr->cluster_list != NULL)
+    size+= 2 + cluster_list_length(attr->cluster_list) * 4;
+  return size;
+}
+
+// -----[ _mw_put_update ]-------------------------------------------
+static uint8_t * _mw_put_update(uint8_t * ptr, bgp_route_t * route)
+{
+  bgp_attr_t * attr= route->attr;
+  bgp_path_seg_t * seg;
+  unsigned int index, index2;
+  uint8_t flags= 0;
+
+  ptr= _mw_put32(ptr, route->prefix.network);
+  ptr= _mw_put8(ptr, route->prefix.mask);
+  ptr= _mw_put32(ptr, attr->next_hop);
+  ptr= _mw_put8(ptr, attr->origin);
+  ptr= _mw_put32(ptr, attr->local_pref);
+  ptr= _mw_put32(ptr, attr->med);
+
+  if (attr->comms != NULL)
+    flags|= MSG_RECORD_COMMS;
+  if (attr->originator != NULL)
+    flags|= MSG_RECORD_ORIGINATOR;
+  if (attr->cluster_list != NULL)
+    flags|= MSG_RECORD_CLUSTER;
+  ptr= _mw_put8(ptr, flags);
+
+  ptr= _mw_put8(ptr, path_num_segments(attr->path_ref));
+  for (index= 0; index < path_num_segments(attr->path_ref); index++) {
+    seg= (bgp_path_seg_t *) attr->path_ref->data[index];
+    ptr= _mw_put8(ptr, seg->type);
+    ptr= _mw_put8(ptr, seg->length);
+    for (index2= 0; index2 < seg->length; index2++)
+      ptr= _mw_put16(ptr, seg->asns[index2]);
+  }
+
+  if (attr->comms != NULL) {
+    ptr= _mw_put8(ptr, attr->comms->num);
+    for (index= 0; index < attr->comms->num; index++)
+      ptr= _mw_put32(ptr, attr->comms->values[index]);
+  }
+  if (attr->originator != NULL)
+    ptr= _mw_put32(ptr, *attr->originator);
+  if (attr->cluster_list != NULL) {
+    ptr= _mw_put16(ptr, cluster_list_length(attr->cluster_list));
+    for (index= 0; index < cluster_list_length(attr->cluster_list); index++)
+      ptr= _mw_put32(ptr, attr->cluster_list->data[index]);
+  }
+  return ptr;
+}
+
+// -----[ _mw_binary_write ]-----------------------------------------
+static void _mw_binary_write(bgp_msg_writer_t * writer, double time,
+			     net_addr_t from, net_addr_t to, asn_t to_asn,
+			     bgp_msg_t * msg)
+{
+  size_t size= MSG_RECORD_HEADER_SIZE;
+  uint8_t * ptr;
+  uint64_t time_bits;
+
+  switch (msg->type) {
+  case BGP_MSG_TYPE_UPDATE:
+    size+= _mw_update_size(((bgp_msg_update_t *) msg)->route);
+    break;
+  case BGP_MSG_TYPE_WITHDRAW:
+    size+= 5;
+    break;
+  case BGP_MSG_TYPE_OPEN:
+    size+= 4;
+    break;
+  default:
+    break;
+  }
+
+  ptr= _mw_reserve(writer, size);
+  memcpy(&time_bits, &time, sizeof(time_bits));
+  ptr= _mw_put32(ptr, size-4);
+  ptr= _mw_put8(ptr, msg->type);
+  ptr= _mw_put64(ptr, time_bits);
+  ptr= _mw_put32(ptr, from);
+  ptr= _mw_put32(ptr, to);
+  ptr= _mw_put16(ptr, to_asn);
+  ptr= _mw_put16(ptr, msg->peer_asn);
+
+  switch (msg->type) {
+  case BGP_MSG_TYPE_UPDATE:
+    ptr= _mw_put_update(ptr, ((bgp_msg_update_t *) msg)->route);
+    break;
+  case BGP_MSG_TYPE_WITHDRAW:
+    ptr= _mw_put32(ptr, ((bgp_msg_withdraw_t *) msg)->prefix.network);
+    ptr= _mw_put8(ptr, ((bgp_msg_withdraw_t *) msg)->prefix.mask);
+    break;
+  case BGP_MSG_TYPE_OPEN:
+    ptr= _mw_put32(ptr, ((bgp_msg_open_t *) msg)->router_id);
+    break;
+  default:
+    break;
+  }
+  assert(ptr == writer->buffer + writer->len);
+}
+
+// -----[ _mw_get8 ]-------------------------------------------------
+static inline uint8_t _mw_get8(_mw_reader_t * reader)
+{
+  if (reader->pos + 1 > reader->len) {
+    reader->error= BGP_MSG_WRITER_ERROR_FORMAT;
+    return 0;
+  }
+  return reader->data[reader->pos++];
+}
+
+// -----[ _mw_get16 ]------------------------------------------------
+static inline uint16_t _mw_get16(_mw_reader_t * reader)
+{
+  uint16_t value= _mw_get8(reader);
+  return (value << 8) | _mw_get8(reader);
+}
+
+// -----[ _mw_get32 ]------------------------------------------------
+static inline uint32_t _mw_get32(_mw_reader_t * reader)
+{
+  uint32_t value= _mw_get16(reader);
+  return (value << 16) | _mw_get16(reader);
+}
+
+// -----[ _mw_get64 ]------------------------------------------------
+static inline uint64_t _mw_get64(_mw_reader_t * reader)
+{
+  uint64_t value= _mw_get32(reader);
+  return (value << 32) | _mw_get32(reader);
+}
+
+// -----[ _mw_get_update ]-------------------------------------------
+static bgp_route_t * _mw_get_update(_mw_reader_t * reader)
+{
+  bgp_route_t * route;
+  bgp_path_t * path;
+  bgp_path_seg_t * seg;
+  bgp_comms_t * comms;
+  ip_pfx_t prefix;
+  net_addr_t next_hop;
+  bgp_origin_t origin;
+  unsigned int index, index2, num;
+  uint8_t flags, seg_type, seg_len;
+
+  prefix.network= _mw_get32(reader);
+  prefix.mask= _mw_get8(reader);
+  next_hop= _mw_get32(reader);
+  origin= _mw_get8(reader);
+  route= route_create(prefix, NULL, next_hop, origin);
+  route_localpref_set(route, _mw_get32(reader));
+  route_med_set(route, _mw_get32(reader));
+  flags= _mw_get8(reader);
+
+  path= path_create();
+  num= _mw_get8(reader);
+  for (index= 0; index < num; index++) {
+    seg_type= _mw_get8(reader);
+    seg_len= _mw_get8(reader);
+    seg= path_segment_create(seg_type, seg_len);
+    for (index2= 0; index2 < seg_len; index2++)
+      seg->asns[index2]= _mw_get16(reader);
+    path_add_segment(path, seg);
+  }
+  route_set_path(route, path);
+
+  if (flags & MSG_RECORD_COMMS) {
+    comms= comms_create();
+    num= _mw_get8(reader);
+    for (index= 0; index < num; index++)
+      comms_add(&comms, _mw_get32(reader));
+    route_set_comm(route, comms);
+  }
+  if (flags & MSG_RECORD_ORIGINATOR)
+    route_originator_set(route, _mw_get32(reader));
+  if (flags & MSG_RECORD_CLUSTER) {
+    route_cluster_list_set(route);
+    num= _mw_get16(reader);
+    for (index= 0; index < num; index++)
+      route_cluster_list_append(route, _mw_get32(reader));
+  }
+  return route;
+}
+
+// -----[ _mw_decode_record ]----------------------------------------
+static int _mw_decode_record(_mw_reader_t * reader, gds_stream_t * stream,
+			     bgp_msg_writer_kind_t kind)
+{
+  bgp_msg_t * msg= NULL;
+  bgp_route_t * route= NULL;
+  uint8_t type;
+  uint64_t time_bits;
+  double time;
+  net_addr_t from, to;
+  uint16_t peer_asn;
+  ip_pfx_t prefix;
+
+  type= _mw_get8(reader);
+  time_bits= _mw_get64(reader);
+  memcpy(&time, &time_bits, sizeof(time));
+  from= _mw_get32(reader);
+  to= _mw_get32(reader);
+  _mw_get16(reader); // ASN of the recipient
+  peer_asn= _mw_get16(reader);
+
+  switch (type) {
+  case BGP_MSG_TYPE_UPDATE:
+    route= _mw_get_update(reader);
+    msg= bgp_msg_update_create(peer_asn, route);
+    break;
+  case BGP_MSG_TYPE_WITHDRAW:
+    prefix.network= _mw_get32(reader);
+    prefix.mask= _mw_get8(reader);
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+    msg= bgp_msg_withdraw_create(peer_asn, prefix, NULL);
+#else
+    msg= bgp_msg_withdraw_create(peer_asn, prefix);
+#endif
+    break;
+  case BGP_MSG_TYPE_OPEN:
+    msg= bgp_msg_open_create(peer_asn, _mw_get32(reader));
+    break;
+  case BGP_MSG_TYPE_CLOSE:
+    msg= bgp_msg_close_create(peer_asn);
+    break;
+  default:
+    return BGP_MSG_WRITER_ERROR_FORMAT;
+  }
+
+  if ((reader->error == BGP_MSG_WRITER_SUCCESS) &&
+      (reader->pos == reader->len))
+    _mw_text_write(stream, kind, time, from, to, msg);
+  else
+    reader->error= BGP_MSG_WRITER_ERROR_FORMAT;
+
+  bgp_msg_destroy(&msg);
+  if (route != NULL)
+    route_destroy(&route);
+  return reader->error;
+}
+
+// -----[ bgp_msg_writer_decode ]------------------------------------
+int bgp_msg_writer_decode(const char * filename, gds_stream_t * stream)
+{
+  uint8_t header[MSG_WRITER_HEADER_SIZE];
+  uint8_t * buffer= NULL;
+  size_t size= 0, len;
+  _mw_reader_t reader;
+  bgp_msg_writer_kind_t kind;
+  int result= BGP_MSG_WRITER_SUCCESS;
+  FILE * file;
+
+  file= fopen(filename, "rb");
+  if (file == NULL)
+    return BGP_MSG_WRITER_ERROR_OPEN;
+
+  // File header
+  reader.data= header;
+  reader.len= MSG_WRITER_HEADER_SIZE;
+  reader.pos= 4;
+  reader.error= BGP_MSG_WRITER_SUCCESS;
+  if ((fread(header, 1, MSG_WRITER_HEADER_SIZE, file) !=
+       MSG_WRITER_HEADER_SIZE) ||
+      memcmp(header, MSG_WRITER_MAGIC, 4) ||
+      (_mw_get8(&reader) != MSG_WRITER_VERSION)) {
+    fclose(file);
+    return BGP_MSG_WRITER_ERROR_FORMAT;
+  }
+  kind= _mw_get8(&reader);
+  _mw_get16(&reader);
+  _mw_text_header(stream, kind, (time_t) _mw_get64(&reader));
+
+  // Records
+  while (fread(header, 1, 4, file) == 4) {
+    reader.data= header;
+    reader.len= 4;
+    reader.pos= 0;
+    len= _mw_get32(&reader);
+    if (len > size) {
+      size= len;
+      buffer= (uint8_t *) REALLOC(buffer, size);
+    }
+    if (fread(buffer, 1, len, file) != len) {
+      result= BGP_MSG_WRITER_ERROR_READ;
+      break;
+    }
+    reader.data= buffer;
+    reader.len= len;
+    reader.pos= 0;
+    result= _mw_decode_record(&reader, stream, kind);
+    if (result != BGP_MSG_WRITER_SUCCESS)
+      break;
+  }
+  if ((result == BGP_MSG_WRITER_SUCCESS) && !feof(file))
+    result= BGP_MSG_WRITER_ERROR_READ;
+
+  if (buffer != NULL)
+    FREE(buffer);
+  fclose(file);
+  return result;
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// WRITER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ bgp_msg_writer_create ]------------------------------------
+bgp_msg_writer_t * bgp_msg_writer_create(const char * filename,
+					 bgp_msg_format_t format,
+					 bgp_msg_writer_kind_t kind)
+{
+  bgp_msg_writer_t * writer;
+  uint8_t header[MSG_WRITER_HEADER_SIZE], * ptr;
+  gds_stream_t * stream= NULL;
+  FILE * file= NULL;
+#ifdef HAVE_BGPDUMP
+  mrtd_bgp4mp_t * mrt= NULL;
+#endif
+  time_t created= time(NULL);
+
+  switch (format) {
+  case BGP_MSG_FORMAT_TEXT:
+    stream= stream_create_file((char *) filename);
+    if (stream == NULL)
+      return NULL;
+    stream_set_level(stream, STREAM_LEVEL_EVERYTHING);
+    _mw_text_header(stream, kind, created);
+    break;
+  case BGP_MSG_FORMAT_BINARY:
+    file= fopen(filename, "wb");
+    if (file == NULL)
+      return NULL;
+    memcpy(header, MSG_WRITER_MAGIC, 4);
+    ptr= _mw_put8(header+4, MSG_WRITER_VERSION);
+    ptr= _mw_put8(ptr, kind);
+    ptr= _mw_put16(ptr, 0);
+    _mw_put64(ptr, (uint64_t) created);
+    if (fwrite(header, 1, MSG_WRITER_HEADER_SIZE, file) !=
+	MSG_WRITER_HEADER_SIZE) {
+      fclose(file);
+      return NULL;
+    }
+    break;
+  case BGP_MSG_FORMAT_MRT:
+#ifdef HAVE_BGPDUMP
+    mrt= mrtd_bgp4mp_open(filename);
+    if (mrt == NULL)
+      return NULL;
+    break;
+#else
+    return NULL;
+#endif
+  default:
+    return NULL;
+  }
+
+  writer= (bgp_msg_writer_t *) MALLOC(sizeof(bgp_msg_writer_t));
+  writer->format= format;
+  writer->kind= kind;
+  writer->stream= stream;
+  writer->file= file;
+  writer->buffer= NULL;
+  writer->len= 0;
+  writer->size= 0;
+  if (file != NULL) {
+    writer->size= MSG_WRITER_BUFFER_SIZE;
+    writer->buffer= (uint8_t *) MALLOC(writer->size);
+  }
+#ifdef HAVE_BGPDUMP
+  writer->mrt= mrt;
+#endif
+  writer->error= BGP_MSG_WRITER_SUCCESS;
+  return writer;
+}
+
+// -----[ bgp_msg_writer_destroy ]-----------------------------------
+void bgp_msg_writer_destroy(bgp_msg_writer_t ** writer_ref)
+{
+  bgp_msg_writer_t * writer= *writer_ref;
+
+  if (writer == NULL)
+    return;
+  if (writer->stream != NULL)
+    stream_destroy(&writer->stream);
+  if (writer->file != NULL) {
+    _mw_flush(writer);
+    fclose(writer->file);
+    FREE(writer->buffer);
+  }
+#ifdef HAVE_BGPDUMP
+  if (writer->mrt != NULL)
+    mrtd_bgp4mp_close(&writer->mrt);
+#endif
+  FREE(writer);
+  *writer_ref= NULL;
+}
+
+// -----[ bgp_msg_writer_write ]-------------------------------------
+void bgp_msg_writer_write(bgp_msg_writer_t * writer, double time,
+			  net_addr_t from, net_addr_t to, asn_t to_asn,
+			  bgp_msg_t * msg)
+{
+  switch (writer->format) {
+  case BGP_MSG_FORMAT_TEXT:
+    _mw_text_write(writer->stream, writer->kind, time, from, to, msg);
+    break;
+  case BGP_MSG_FORMAT_BINARY:
+    _mw_binary_write(writer, time, from, to, to_asn, msg);
+    break;
+  case BGP_MSG_FORMAT_MRT:
+#ifdef HAVE_BGPDUMP
+    if (mrtd_bgp4mp_write(writer->mrt, (uint32_t) time, from,
+			  msg->peer_asn, to, to_asn, msg) != MRTD_SUCCESS)
+      writer->error= BGP_MSG_WRITER_ERROR_WRITE;
+#endif
+    break;
+  default:
+    abort();
+  }
+}
@@ -0,0 +1,142 @@
+// ==================================================================
+// @(#)msg_writer.h
+//
+// Buffered writers for the BGP message monitor and peer records.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+
+/**
+ * \file
+ * Provide writers for the BGP messages tapped by the message monitor
+ * (see bgp_msg_monitor_open()) and by the peer records (see
+ * bgp_peer_set_record_writer()).
+ *
+ * Three output formats are supported:
+ * \li text: one line per message, as produced by bgp_msg_dump().
+ * \li binary: compact records accumulated in a memory buffer that is
+ *   written to the file when full. The file can be converted to the
+ *   text format offline with bgp_msg_writer_decode().
+ * \li mrt: MRT BGP4MP_MESSAGE_AS4 records (only available when C-BGP
+ *   is built with libbgpdump). MRT timestamps have a resolution of
+ *   one second.
+ */
+
+#ifndef __BGP_MSG_WRITER_H__
+#define __BGP_MSG_WRITER_H__
+
+#include <libgds/stream.h>
+
+#include <bgp/types.h>
+
+// -----[ bgp_msg_format_t ]-----------------------------------------
+typedef enum {
+  BGP_MSG_FORMAT_TEXT,
+  BGP_MSG_FORMAT_BINARY,
+  BGP_MSG_FORMAT_MRT,
+  BGP_MSG_FORMAT_MAX,
+} bgp_msg_format_t;
+
+// -----[ bgp_msg_writer_kind_t ]------------------------------------
+typedef enum {
+  /** Message monitor: the text lines are prefixed with the
+      destination and the time. */
+  BGP_MSG_WRITER_MONITOR,
+  /** Peer record: the text lines only contain the message. */
+  BGP_MSG_WRITER_RECORD,
+} bgp_msg_writer_kind_t;
+
+// -----[ bgp_msg_writer_error_t ]-----------------------------------
+typedef enum {
+  BGP_MSG_WRITER_SUCCESS      = 0,
+  BGP_MSG_WRITER_ERROR_OPEN   = -1,
+  BGP_MSG_WRITER_ERROR_FORMAT = -2,
+  BGP_MSG_WRITER_ERROR_READ   = -3,
+  BGP_MSG_WRITER_ERROR_WRITE  = -4,
+} bgp_msg_writer_error_t;
+
+typedef struct bgp_msg_writer_t bgp_msg_writer_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ bgp_msg_writer_create ]----------------------------------
+  /**
+   * Create a message writer.
+   *
+   * \param filename is the output file.
+   * \param format   is the output format.
+   * \param kind     tells how text lines are formatted.
+   * \retval the writer, or NULL if the file could not be created or
+   *   the format is not supported.
+   */
+  bgp_msg_writer_t * bgp_msg_writer_create(const char * filename,
+					   bgp_msg_format_t format,
+					   bgp_msg_writer_kind_t kind);
+
+  // -----[ bgp_msg_writer_destroy ]---------------------------------
+  /**
+   * Write the buffered messages, close the file and destroy the
+   * writer.
+   */
+  void bgp_msg_writer_destroy(bgp_msg_writer_t ** writer_ref);
+
+  // -----[ bgp_msg_writer_write ]-----------------------------------
+  /**
+   * Append a message.
+   *
+   * \param writer   is the writer.
+   * \param time     is the simulation time.
+   * \param from     is the identifier of the sender.
+   * \param to       is the address of the recipient.
+   * \param to_asn   is the ASN of the recipient.
+   * \param msg      is the message.
+   */
+  void bgp_msg_writer_write(bgp_msg_writer_t * writer, double time,
+			    net_addr_t from, net_addr_t to, asn_t to_asn,
+			    bgp_msg_t * msg);
+
+  // -----[ bgp_msg_writer_decode ]----------------------------------
+  /**
+   * Convert a file written in binary format to the text format.
+   *
+   * \param filename is the binary file.
+   * \param stream   is the output stream.
+   * \retval BGP_MSG_WRITER_SUCCESS in case of success,
+   *   or < 0 in case of error.
+   */
+  int bgp_msg_writer_decode(const char * filename, gds_stream_t * stream);
+
+  // -----[ bgp_msg_writer_strerror ]--------------------------------
+  const char * bgp_msg_writer_strerror(int error);
+
+  // -----[ bgp_msg_format_from_str ]--------------------------------
+  int bgp_msg_format_from_str(const char * str, bgp_msg_format_t * format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_MSG_WRITER_H__ */
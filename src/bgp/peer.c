@@ -46,11 +46,14 @@
 #include <bgp/attr/ecomm.h>
 #include <bgp/filter/filter.h>
 #include <bgp/message.h>
+#include <bgp/msg_writer.h>
 #include <bgp/peer.h>
 #include <bgp/qos.h>
 #include <bgp/rib.h>
 #include <bgp/route.h>
 
+#include <sim/simulator.h>
+
 char * SESSION_STATES[SESSION_STATE_MAX]= {
   "IDLE",
   "OPENWAIT",
@@ -94,7 +97,7 @@ bgp_peer_t * bgp_peer_create(uint16_t asn, net_addr_t addr,
   peer->next_hop= NET_ADDR_ANY;
   peer->src_addr= NET_ADDR_ANY;
 
-  peer->pRecordStream= NULL;
+  peer->record_writer= NULL;
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   peer->uWaltonLimit = 1;
   bgp_router_walton_peer_set(peer, 1);
@@ -121,6 +124,9 @@ void bgp_peer_destroy(bgp_peer_t ** ppeer)
     rib_destroy(&(*ppeer)->adj_rib[RIB_IN]);
     rib_destroy(&(*ppeer)->adj_rib[RIB_OUT]);
 
+    /* Write the recorded messages that are still buffered */
+    bgp_msg_writer_destroy(&(*ppeer)->record_writer);
+
     FREE(*ppeer);
     *ppeer= NULL;
   }
@@ -573,7 +579,7 @@ static int _bgp_peer_disable_adjribin(uint32_t uKey, uint8_t uKeyLen,
       route_dump(gdsdebug, route);
       stream_printf(gdsdebug, "\n");
     }
-    bgp_router_decision_process(peer->router, peer, route->prefix);
+    bgp_router_decision_process(peer->router, route->prefix);
 
   }
 
@@ -592,7 +598,7 @@ static int _bgp_peer_enable_adjribin(uint32_t uKey, uint8_t uKeyLen,
 
   //route_flag_set(route, ROUTE_FLAG_ELIGIBLE, 0);
 
-  bgp_router_decision_process(peer->router, peer, route->prefix);
+  bgp_router_decision_process(peer->router, route->prefix);
 
   return 0;
 }
@@ -641,7 +647,10 @@ static inline void _bgp_peer_rescan_adjribin(bgp_peer_t * peer, int iClear)
 
 // -----[ bgp_peer_set_filter ]----------------------------------------
 /**
- * Change a filter of this peer. The previous filter is destroyed.
+ * Change a filter of this peer. The peer takes ownership of one
+ * reference to the new filter and the reference to the previous
+ * filter is released. To share a filter between several peers, pass
+ * a new reference to each of them (see filter_add_ref()).
  */
 void bgp_peer_set_filter(bgp_peer_t * peer, bgp_filter_dir_t dir,
 			 bgp_filter_t * filter)
@@ -925,7 +934,7 @@ static inline void _bgp_peer_process_update(bgp_peer_t * peer,
   
   // Run decision process for this route
   if (need_DP_run)
-    bgp_router_decision_process(peer->router, peer, prefix);
+    bgp_router_decision_process(peer->router, prefix);
 }
 
 // -----[ _bgp_peer_process_withdraw ]--------------------------------
@@ -956,8 +965,7 @@ static inline void _bgp_peer_process_withdraw(bgp_peer_t * peer,
 
   // Run decision process in case this route is the best route
   // towards this prefix
-  bgp_router_decision_process(peer->router, peer,
-			      msg->prefix);
+  bgp_router_decision_process(peer->router, msg->prefix);
   
   STREAM_DEBUG_ENABLED(STREAM_LEVEL_DEBUG) {
     stream_printf(gdsdebug, "\tremove: ");
@@ -1062,24 +1070,26 @@ int bgp_peer_handle_message(bgp_peer_t * peer, bgp_msg_t * msg)
 /**
  * Send a BGP message to the given peer. If activated, this function
  * will tap BGP messages and record them to a file (see
- * 'pRecordStream').
+ * 'record_writer') and to the message monitor.
  *
  * Note: if the peer is virtual, the message will be discarded and the
  * function will return an error.
  */
 static inline int _bgp_peer_send(bgp_peer_t * peer, bgp_msg_t * msg)
 {
+  net_node_t * node= peer->router->node;
+
   msg->seq_num= peer->send_seq_num++;
   
   // Record BGP messages (optional)
-  if (peer->pRecordStream != NULL) {
-    bgp_msg_dump(peer->pRecordStream, NULL, msg);
-    stream_printf(peer->pRecordStream, "\n");
-    stream_flush(peer->pRecordStream);
-  }
+  if (peer->record_writer != NULL)
+    bgp_msg_writer_write(peer->record_writer,
+			 sim_get_time(network_get_simulator(node->network)),
+			 node->rid, peer->addr, peer->asn, msg);
 
   // Send the message
   if (!bgp_peer_flag_get(peer, PEER_FLAG_VIRTUAL)) {
+    bgp_msg_monitor_write(msg, node, peer->addr, peer->asn);
     return bgp_msg_send(peer->router->node,
 			peer->src_addr,
 			peer->addr, msg);
@@ -1104,7 +1114,7 @@ static inline int _bgp_peer_send(bgp_peer_t * peer, bgp_msg_t * msg)
 int bgp_peer_send_enabled(bgp_peer_t * peer)
 {
   return (!bgp_peer_flag_get(peer, PEER_FLAG_VIRTUAL) ||
-	  (peer->pRecordStream != NULL));
+	  (peer->record_writer != NULL));
 }
 
 /////////////////////////////////////////////////////////////////////
@@ -1280,19 +1290,17 @@ void bgp_peer_dump_filters(gds_stream_t * stream, bgp_peer_t * peer,
   filter_dump(stream, peer->filter[dir]);
 }
 
-// -----[ bgp_peer_set_record_stream ]-------------------------------
+// -----[ bgp_peer_set_record_writer ]-------------------------------
 /**
- * Set a stream for recording the messages sent to this neighbor. If
- * the given stream is NULL, the recording will be stopped.
+ * Set a writer for recording the messages sent to this neighbor. If
+ * the given writer is NULL, the recording will be stopped. The
+ * previous writer is destroyed (its buffered messages are written).
  */
-int bgp_peer_set_record_stream(bgp_peer_t * peer, gds_stream_t * stream)
+int bgp_peer_set_record_writer(bgp_peer_t * peer,
+			       bgp_msg_writer_t * writer)
 {
-  if (peer->pRecordStream != NULL) {
-    stream_destroy(&(peer->pRecordStream));
-    peer->pRecordStream= NULL;
-  }
-  if (stream != NULL)
-    peer->pRecordStream= stream;
+  bgp_msg_writer_destroy(&peer->record_writer);
+  peer->record_writer= writer;
   return 0;
 }
 
@@ -1398,7 +1406,7 @@ static void _bgp_peer_process_update_walton(bgp_peer_t * peer,
   
   // Run decision process for this route
   if (iNeedDecisionProcess)
-    bgp_router_decision_process(peer->router, peer, prefix);
+    bgp_router_decision_process(peer->router, prefix);
 }
 
 // -----[ _bgp_peer_process_withdraw_walton ]------------------------
@@ -1437,8 +1445,7 @@ static void _bgp_peer_process_walton_withdraw(bgp_peer_t * peer,
 
   // Run decision process in case this route is the best route
   // towards this prefix
-  bgp_router_decision_process(peer->router, peer,
-			      msg->prefix);
+  bgp_router_decision_process(peer->router, msg->prefix);
   
   STREAM_DEBUG_ENABLED(STREAM_LEVEL_DEBUG) {
     stream_printf(gdsdebug, "\tremove: ");
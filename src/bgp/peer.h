@@ -31,6 +31,7 @@
 
 #include <libgds/stream.h>
 
+#include <bgp/msg_writer.h>
 #include <bgp/types.h>
 
 extern char * SESSION_STATES[SESSION_STATE_MAX];
@@ -136,9 +137,9 @@ extern "C" {
   // ----- bgp_peer_dump_filters ---------------------------------
   void bgp_peer_dump_filters(gds_stream_t * stream, bgp_peer_t * peer,
 			     bgp_filter_dir_t dir);
-  // -----[ bgp_peer_set_record_stream ]-----------------------------
-  int bgp_peer_set_record_stream(bgp_peer_t * peer,
-				 gds_stream_t * stream);
+  // -----[ bgp_peer_set_record_writer ]-----------------------------
+  int bgp_peer_set_record_writer(bgp_peer_t * peer,
+				 bgp_msg_writer_t * writer);
   // -----[ bgp_peer_send_enabled ]----------------------------------
   int bgp_peer_send_enabled(bgp_peer_t * peer);
 
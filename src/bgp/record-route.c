@@ -28,8 +28,12 @@
 # include <config.h>
 #endif
 
+#include <libgds/array.h>
+#include <libgds/memory.h>
 #include <libgds/stream.h>
+#include <libgds/trie.h>
 
+#include <net/network.h>
 #include <net/node.h>
 #include <net/prefix.h>
 #include <net/protocol.h>
@@ -120,6 +124,7 @@ void bgp_dump_recorded_route(gds_stream_t * stream, bgp_router_t * router,
   stream_printf(stream, "\t");
   switch (result) {
   case AS_RECORD_ROUTE_SUCCESS: stream_printf(stream, "SUCCESS"); break;
+  case AS_RECORD_ROUTE_LOOP: stream_printf(stream, "LOOP"); break;
   case AS_RECORD_ROUTE_TOO_LONG: stream_printf(stream, "TOO_LONG"); break;
   case AS_RECORD_ROUTE_UNREACH: stream_printf(stream, "UNREACHABLE"); break;
   default:
@@ -131,3 +136,217 @@ void bgp_dump_recorded_route(gds_stream_t * stream, bgp_router_t * router,
 
   stream_flush(stream);
 }
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// MEMOIZED RECORD-ROUTE
+//
+/////////////////////////////////////////////////////////////////////
+
+#define _RR_STATE_ACTIVE 1
+#define _RR_STATE_DONE   2
+
+// -----[ _rr_hop_t ]------------------------------------------------
+/**
+ * Resolution of one router: does it have a route, which router is
+ * next, and how the trace that starts at this router ends.
+ */
+typedef struct _rr_hop_t {
+  bgp_router_t     * router;
+  uint8_t            state;
+  /** Has a route towards the prefix (its ASN is recorded). */
+  uint8_t            has_route;
+  /** Result of the trace that starts at this router. */
+  int                result;
+  /** Number of routers on that trace (each one counted once). */
+  unsigned int       length;
+  /** Next router (NULL if the trace ends here). */
+  struct _rr_hop_t * next;
+} _rr_hop_t;
+
+struct bgp_rr_batch_t {
+  ip_pfx_t     prefix;
+  uint8_t      options;
+  /** Resolved routers, indexed by router-ID. */
+  gds_trie_t * hops;
+};
+
+// -----[ _rr_hop_destroy ]------------------------------------------
+static void _rr_hop_destroy(void * data)
+{
+  FREE(data);
+}
+
+// -----[ bgp_rr_batch_create ]--------------------------------------
+bgp_rr_batch_t * bgp_rr_batch_create(ip_pfx_t prefix, uint8_t options)
+{
+  bgp_rr_batch_t * batch= (bgp_rr_batch_t *) MALLOC(sizeof(bgp_rr_batch_t));
+  batch->prefix= prefix;
+  batch->options= options;
+  batch->hops= trie_create(_rr_hop_destroy);
+  return batch;
+}
+
+// -----[ bgp_rr_batch_destroy ]-------------------------------------
+void bgp_rr_batch_destroy(bgp_rr_batch_t ** batch_ref)
+{
+  bgp_rr_batch_t * batch= *batch_ref;
+
+  if (batch != NULL) {
+    trie_destroy(&batch->hops);
+    FREE(batch);
+    *batch_ref= NULL;
+  }
+}
+
+// -----[ _rr_hop_get ]----------------------------------------------
+static inline _rr_hop_t * _rr_hop_get(bgp_rr_batch_t * batch,
+				      bgp_router_t * router)
+{
+  _rr_hop_t * hop= (_rr_hop_t *) trie_find_exact(batch->hops,
+						 router->node->rid, 32);
+  if (hop == NULL) {
+    hop= (_rr_hop_t *) MALLOC(sizeof(_rr_hop_t));
+    hop->router= router;
+    hop->state= 0;
+    hop->has_route= 0;
+    hop->result= AS_RECORD_ROUTE_UNREACH;
+    hop->length= 1;
+    hop->next= NULL;
+    trie_insert(batch->hops, router->node->rid, 32, hop, 0);
+  }
+  return hop;
+}
+
+// -----[ _rr_hop_step ]---------------------------------------------
+/**
+ * Look up the route of a router and find the next router. Returns
+ * the next router, or NULL if the trace ends at this router (the
+ * hop's result is then set).
+ */
+static bgp_router_t * _rr_hop_step(bgp_rr_batch_t * batch, _rr_hop_t * hop)
+{
+  bgp_router_t * router= hop->router;
+  bgp_route_t * route;
+  net_node_t * node;
+  net_protocol_t * protocol;
+
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  route= rib_find_one_best(router->loc_rib, batch->prefix);
+#else
+  if (batch->options & AS_RECORD_ROUTE_OPT_EXACT_MATCH)
+    route= rib_find_exact(router->loc_rib, batch->prefix);
+  else
+    route= rib_find_best(router->loc_rib, batch->prefix);
+#endif
+  if (route == NULL)
+    return NULL;
+  hop->has_route= 1;
+
+  if (node_has_address(router->node, route->attr->next_hop)) {
+    hop->result= AS_RECORD_ROUTE_SUCCESS;
+    return NULL;
+  }
+
+  // Next-hop is not a node or does not run BGP: black hole
+  node= network_find_node(router->node->network, route->attr->next_hop);
+  if (node == NULL)
+    return NULL;
+  protocol= protocols_get(node->protocols, NET_PROTOCOL_BGP);
+  if (protocol == NULL)
+    return NULL;
+  return (bgp_router_t *) protocol->handler;
+}
+
+// -----[ _rr_resolve ]----------------------------------------------
+/**
+ * Resolve the routers along the trace that starts at a router, up
+ * to the first router already resolved. A router met twice on the
+ * way closes a loop: all the routers of the trace then end in a
+ * loop.
+ */
+static void _rr_resolve(bgp_rr_batch_t * batch, _rr_hop_t * hop)
+{
+  ptr_array_t * chain= ptr_array_create_ref(0);
+  bgp_router_t * next_router;
+  _rr_hop_t * next= NULL;
+  _rr_hop_t * cur;
+  unsigned int index, loop_start, loop_length;
+
+  while (1) {
+    hop->state= _RR_STATE_ACTIVE;
+    ptr_array_append(chain, hop);
+    next_router= _rr_hop_step(batch, hop);
+    if (next_router == NULL) {
+      next= NULL;
+      break;
+    }
+    next= _rr_hop_get(batch, next_router);
+    hop->next= next;
+    if (next->state != 0)
+      break;
+    hop= next;
+  }
+
+  // Loop: the routers from the repeated one to the end of the chain
+  index= ptr_array_length(chain);
+  if ((next != NULL) && (next->state == _RR_STATE_ACTIVE)) {
+    for (loop_start= 0; chain->data[loop_start] != next; loop_start++);
+    loop_length= index-loop_start;
+    for (; index > loop_start; index--) {
+      cur= (_rr_hop_t *) chain->data[index-1];
+      cur->result= AS_RECORD_ROUTE_LOOP;
+      cur->length= loop_length;
+      cur->state= _RR_STATE_DONE;
+    }
+  }
+
+  // Unwind the chain, each router inherits the result of its
+  // successor
+  for (; index > 0; index--) {
+    cur= (_rr_hop_t *) chain->data[index-1];
+    if (cur->next != NULL) {
+      cur->result= cur->next->result;
+      cur->length= cur->next->length+1;
+    }
+    cur->state= _RR_STATE_DONE;
+  }
+
+  ptr_array_destroy(&chain);
+}
+
+// -----[ bgp_rr_batch_record ]--------------------------------------
+/**
+ * The AS-path is rebuilt by following the resolved routers, exactly
+ * as bgp_record_route() would have recorded it.
+ */
+int bgp_rr_batch_record(bgp_rr_batch_t * batch, bgp_router_t * router,
+			bgp_path_t ** path_ref)
+{
+  _rr_hop_t * hop= _rr_hop_get(batch, router);
+  bgp_path_t * path= path_create();
+  bgp_router_t * prev_router= NULL;
+  unsigned int index;
+  int result;
+
+  if (hop->state != _RR_STATE_DONE)
+    _rr_resolve(batch, hop);
+  result= hop->result;
+
+  for (index= hop->length; (index > 0) && hop->has_route; index--) {
+    if ((prev_router == NULL) ||
+	((batch->options & AS_RECORD_ROUTE_OPT_PRESERVE_DUPS) ||
+	 (prev_router->asn != hop->router->asn))) {
+      if (path_append(&path, hop->router->asn) < 0) {
+	result= AS_RECORD_ROUTE_TOO_LONG;
+	break;
+      }
+    }
+    prev_router= hop->router;
+    hop= hop->next;
+  }
+
+  *path_ref= path;
+  return result;
+}
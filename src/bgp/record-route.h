@@ -44,6 +44,14 @@
 /** Perform exact match instead of best-match (i.e. longest-match) */
 #define AS_RECORD_ROUTE_OPT_EXACT_MATCH   0x02
 
+// -----[ bgp_rr_batch_t ]-------------------------------------------
+/**
+ * Memoized record-route towards a single prefix. Each router met
+ * while tracing is resolved once, then its downstream path is
+ * reused by all the routers whose trace goes through it.
+ */
+typedef struct bgp_rr_batch_t bgp_rr_batch_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -69,6 +77,35 @@ extern "C" {
 			       ip_pfx_t prefix, bgp_path_t * path,
 			       int result);
 
+  // -----[ bgp_rr_batch_create ]-----------------------------------
+  /**
+   * Create a memoized record-route towards a prefix.
+   *
+   * The routers' Loc-RIBs must not change while the batch is in
+   * use.
+   *
+   * @param prefix  is the destination prefix.
+   * @param options is a set of options (see bgp_record_route()).
+   */
+  bgp_rr_batch_t * bgp_rr_batch_create(ip_pfx_t prefix, uint8_t options);
+
+  // -----[ bgp_rr_batch_destroy ]----------------------------------
+  void bgp_rr_batch_destroy(bgp_rr_batch_t ** batch_ref);
+
+  // -----[ bgp_rr_batch_record ]-----------------------------------
+  /**
+   * Record the AS-path from one BGP router. The result is the same
+   * as that of bgp_record_route(), except that forwarding loops are
+   * detected and reported with AS_RECORD_ROUTE_LOOP. The path then
+   * contains the routers' ASNs up to the first repeated router.
+   *
+   * @param batch    is the memoized record-route.
+   * @param router   is the source router.
+   * @param path_ref is the resulting AS-level trace.
+   */
+  int bgp_rr_batch_record(bgp_rr_batch_t * batch, bgp_router_t * router,
+			  bgp_path_t ** path_ref);
+
 #ifdef __cplusplus
 }
 #endif
@@ -38,6 +38,7 @@
 #include <bgp/rib.h>
 #include <bgp/route.h>
 #include <bgp/routes_list.h>
+#include <util/mem_stats.h>
 
 // -----[ _rib_route_destroy ]---------------------------------------
 static void _rib_route_destroy(void ** item_ref)
@@ -85,9 +86,23 @@ bgp_rib_t * rib_create(uint8_t options)
   return (bgp_rib_t *) trie_create(destroy);
 }
 
+// -----[ _rib_count_entry ]-----------------------------------------
+static int _rib_count_entry(trie_key_t key, trie_key_len_t key_len,
+			    void * item, void * ctx)
+{
+  (*((unsigned int *) ctx))++;
+  return 0;
+}
+
 // ----- rib_destroy ------------------------------------------------
 void rib_destroy(bgp_rib_t ** rib_ref)
 {
+  unsigned int num_entries= 0;
+
+  if (*rib_ref != NULL) {
+    trie_for_each(*rib_ref, _rib_count_entry, &num_entries);
+    mem_stats_free_n(MEM_TAG_RIB, MEM_STATS_RIB_ENTRY_SIZE, num_entries);
+  }
   trie_destroy(rib_ref);
 }
 
@@ -196,6 +211,7 @@ int _rib_insert_new_route(bgp_rib_t * rib, bgp_route_t * route)
   //TODO: Verify that the option is good!
   routes= routes_list_create(0);
   routes_list_append(routes, route);
+  mem_stats_alloc(MEM_TAG_RIB, MEM_STATS_RIB_ENTRY_SIZE);
   return trie_insert(rib, route->prefix.network,
 		     route->prefix.mask, routes, 0);
 }
@@ -254,6 +270,37 @@ int _rib_remove_route(bgp_routes_t * routes, net_addr_t next_hop)
 }
 #endif
 
+#if !defined __EXPERIMENTAL_WALTON__
+// -----[ _rib_insert ]----------------------------------------------
+/**
+ * Insert or replace a route. Only the insertion of a new entry is
+ * accounted in the memory statistics. The route is first inserted
+ * without replacement: this fails only if the prefix is already in
+ * the RIB, in which case the existing route is replaced.
+ */
+static inline int _rib_insert(bgp_rib_t * rib, bgp_route_t * route)
+{
+  int result= trie_insert(rib, route->prefix.network,
+			  route->prefix.mask, route, 0);
+  if (result == TRIE_SUCCESS) {
+    mem_stats_alloc(MEM_TAG_RIB, MEM_STATS_RIB_ENTRY_SIZE);
+    return result;
+  }
+  return trie_insert(rib, route->prefix.network,
+		     route->prefix.mask, route,
+		     TRIE_INSERT_OR_REPLACE);
+}
+#endif
+
+// -----[ _rib_remove ]----------------------------------------------
+static inline int _rib_remove(bgp_rib_t * rib, ip_pfx_t prefix)
+{
+  int result= trie_remove(rib, prefix.network, prefix.mask);
+  if (result == TRIE_SUCCESS)
+    mem_stats_free(MEM_TAG_RIB, MEM_STATS_RIB_ENTRY_SIZE);
+  return result;
+}
+
 // ----- rib_add_route ----------------------------------------------
 /**
  * Add a new route to the RIB
@@ -274,10 +321,7 @@ int rib_add_route(bgp_rib_t * rib, bgp_route_t * route)
     return _rib_replace_route(rib, routes, route);
   }
 #else
-  int result= trie_insert(rib, route->prefix.network,
-			  route->prefix.mask, route,
-			  TRIE_INSERT_OR_REPLACE);
-  return (result==TRIE_SUCCESS?0:-1);
+  return (_rib_insert(rib, route)==TRIE_SUCCESS?0:-1);
 #endif
 }
 
@@ -297,9 +341,7 @@ int rib_replace_route(bgp_rib_t * rib, bgp_route_t * route)
     return _rib_replace_route(rib, routes, route);
   }
 #else
-  return trie_insert(rib, route->prefix.network,
-		     route->prefix.mask, route,
-		     TRIE_INSERT_OR_REPLACE);
+  return _rib_insert(rib, route);
 #endif
 }
 
@@ -323,19 +365,15 @@ int rib_remove_route(bgp_rib_t * rib, ip_pfx_t prefix)
     if (next_hop != NULL) {
       _rib_remove_route(routes, *next_hop);
       if (routes_list_get_num(routes) == 0) {
-        return trie_remove(rib, prefix.network,
-			   prefix.mask);
+        return _rib_remove(rib, prefix);
       }
     } else {
-      return trie_remove(rib, prefix.network,
-			 prefix.mask);
+      return _rib_remove(rib, prefix);
     }
   }
   return 0;
 #else
-  return trie_remove(rib,
-		     prefix.network,
-		     prefix.mask);
+  return _rib_remove(rib, prefix);
 #endif
 }
 
@@ -0,0 +1,713 @@
+// ==================================================================
+// @(#)rib_export.c
+//
+// Machine-readable export of BGP RIBs (JSON lines and CSV).
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgds/enumerator.h>
+#include <libgds/hash.h>
+#include <libgds/memory.h>
+
+#include <net/network.h>
+#include <net/node.h>
+#include <net/protocol.h>
+#include <bgp/as.h>
+#include <bgp/attr/comm.h>
+#include <bgp/attr/origin.h>
+#include <bgp/attr/path.h>
+#include <bgp/attr/path_segment.h>
+#include <bgp/peer.h>
+#include <bgp/peer-list.h>
+#include <bgp/rib.h>
+#include <bgp/rib_export.h>
+#include <bgp/route.h>
+#include <bgp/routes_list.h>
+
+#ifdef HAVE_BGPDUMP
+# include <external/cfile_tools.h>
+typedef CFWFILE * _rx_file_t;
+# define RX_FILE_OPEN(N) cfw_open(N)
+# define RX_FILE_WRITE(F,B,L) cfw_write(B, 1, L, F)
+# define RX_FILE_CLOSE(F) cfw_close(F)
+#else
+typedef FILE * _rx_file_t;
+# define RX_FILE_OPEN(N) fopen(N, "w")
+# define RX_FILE_WRITE(F,B,L) fwrite(B, 1, L, F)
+# define RX_FILE_CLOSE(F) fclose(F)
+#endif /* HAVE_BGPDUMP */
+
+#define RX_BUFFER_SIZE 65536
+#define RX_CACHE_SIZE  25000
+/** Largest field written without going through the cache (an IP
+    prefix, a 32-bits integer or a keyword). */
+#define RX_FIELD_SIZE  32
+
+static const char * const FORMAT_NAMES[BGP_RIB_EXPORT_MAX]= {
+  "jsonl",
+  "csv",
+};
+
+static const char CSV_HEADER[]=
+  "router,prefix,peer,peer_asn,best,next_hop,local_pref,med,origin,"
+  "as_path,communities\n";
+
+static const char DIGITS[200]=
+  "0001020304050607080910111213141516171819"
+  "2021222324252627282930313233343536373839"
+  "4041424344454647484950515253545556575859"
+  "6061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// -----[ _rx_cache_entry_t ]----------------------------------------
+/**
+ * Text of an interned AS-Path or Communities attribute, keyed on the
+ * attribute.
+ */
+typedef struct {
+  const void * ref;
+  size_t       len;
+  char         data[];
+} _rx_cache_entry_t;
+
+// -----[ bgp_rib_export_t ]-----------------------------------------
+struct bgp_rib_export_t {
+  bgp_rib_export_format_t   format;
+  /** Output: file if not NULL, stream otherwise. */
+  _rx_file_t                file;
+  gds_stream_t            * stream;
+  char                    * buffer;
+  size_t                    len;
+  gds_hash_set_t          * cache;
+  /** Text of the address of the last exported router. */
+  bgp_router_t            * router;
+  char                      router_str[RX_FIELD_SIZE];
+  size_t                    router_len;
+  int                       error;
+};
+
+// -----[ bgp_rib_export_format_from_str ]---------------------------
+int bgp_rib_export_format_from_str(const char * str,
+				   bgp_rib_export_format_t * format)
+{
+  bgp_rib_export_format_t index;
+
+  for (index= 0; index < BGP_RIB_EXPORT_MAX; index++)
+    if (!strcmp(str, FORMAT_NAMES[index])) {
+      *format= index;
+      return 0;
+    }
+  return -1;
+}
+
+// -----[ bgp_rib_export_strerror ]----------------------------------
+const char * bgp_rib_export_strerror(int error)
+{
+  switch (error) {
+  case BGP_RIB_EXPORT_SUCCESS:
+    return "success";
+  case BGP_RIB_EXPORT_ERROR_OPEN:
+    return "could not open file";
+  case BGP_RIB_EXPORT_ERROR_WRITE:
+    return "could not write file";
+  }
+  return "unknown error";
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// OUTPUT BUFFER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _rx_flush ]------------------------------------------------
+static void _rx_flush(bgp_rib_export_t * exporter)
+{
+  if (exporter->len == 0)
+    return;
+  if (exporter->file != NULL) {
+    if (RX_FILE_WRITE(exporter->file, exporter->buffer, exporter->len) !=
+	exporter->len)
+      exporter->error= BGP_RIB_EXPORT_ERROR_WRITE;
+  } else {
+    stream_printf(exporter->stream, "%.*s", (int) exporter->len,
+		  exporter->buffer);
+  }
+  exporter->len= 0;
+}
+
+// -----[ _rx_reserve ]----------------------------------------------
+/**
+ * Make room for len bytes (len <= RX_BUFFER_SIZE) at the end of the
+ * buffer and return a pointer to this room.
+ */
+static inline char * _rx_reserve(bgp_rib_export_t * exporter, size_t len)
+{
+  if (exporter->len + len > RX_BUFFER_SIZE)
+    _rx_flush(exporter);
+  return exporter->buffer + exporter->len;
+}
+
+// -----[ _rx_write ]------------------------------------------------
+static inline void _rx_write(bgp_rib_export_t * exporter,
+			     const char * data, size_t len)
+{
+  if (len > RX_BUFFER_SIZE) {
+    _rx_flush(exporter);
+    if (exporter->file != NULL) {
+      if (RX_FILE_WRITE(exporter->file, data, len) != len)
+	exporter->error= BGP_RIB_EXPORT_ERROR_WRITE;
+    } else {
+      stream_printf(exporter->stream, "%.*s", (int) len, data);
+    }
+    return;
+  }
+  memcpy(_rx_reserve(exporter, len), data, len);
+  exporter->len+= len;
+}
+
+// -----[ _rx_char ]-------------------------------------------------
+static inline void _rx_char(bgp_rib_export_t * exporter, char c)
+{
+  *_rx_reserve(exporter, 1)= c;
+  exporter->len++;
+}
+
+// -----[ _rx_str ]--------------------------------------------------
+#define _rx_str(E,S) _rx_write(E, S, sizeof(S)-1)
+
+/////////////////////////////////////////////////////////////////////
+//
+// FIELD FORMATTERS
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _rx_fmt_u32 ]----------------------------------------------
+/**
+ * Write the decimal representation of an unsigned integer, two
+ * digits at a time. Return the number of characters written.
+ */
+static inline size_t _rx_fmt_u32(char * dst, uint32_t value)
+{
+  char tmp[10];
+  char * ptr= tmp + sizeof(tmp);
+  unsigned int index;
+  size_t len;
+
+  while (value >= 100) {
+    index= (value % 100) * 2;
+    value/= 100;
+    *(--ptr)= DIGITS[index+1];
+    *(--ptr)= DIGITS[index];
+  }
+  if (value >= 10) {
+    *(--ptr)= DIGITS[value*2+1];
+    *(--ptr)= DIGITS[value*2];
+  } else {
+    *(--ptr)= '0' + value;
+  }
+  len= tmp + sizeof(tmp) - ptr;
+  memcpy(dst, ptr, len);
+  return len;
+}
+
+// -----[ _rx_fmt_addr ]---------------------------------------------
+static inline size_t _rx_fmt_addr(char * dst, net_addr_t addr)
+{
+  char * ptr= dst;
+
+  ptr+= _rx_fmt_u32(ptr, (addr >> 24) & 255);
+  *(ptr++)= '.';
+  ptr+= _rx_fmt_u32(ptr, (addr >> 16) & 255);
+  *(ptr++)= '.';
+  ptr+= _rx_fmt_u32(ptr, (addr >> 8) & 255);
+  *(ptr++)= '.';
+  ptr+= _rx_fmt_u32(ptr, addr & 255);
+  return ptr - dst;
+}
+
+// -----[ _rx_u32 ]--------------------------------------------------
+static inline void _rx_u32(bgp_rib_export_t * exporter, uint32_t value)
+{
+  exporter->len+= _rx_fmt_u32(_rx_reserve(exporter, RX_FIELD_SIZE), value);
+}
+
+// -----[ _rx_addr ]-------------------------------------------------
+/** Write an IP address, quoted in JSON. */
+static inline void _rx_addr(bgp_rib_export_t * exporter, net_addr_t addr)
+{
+  char * ptr= _rx_reserve(exporter, RX_FIELD_SIZE);
+  char * start= ptr;
+
+  if (exporter->format == BGP_RIB_EXPORT_JSONL)
+    *(ptr++)= '"';
+  ptr+= _rx_fmt_addr(ptr, addr);
+  if (exporter->format == BGP_RIB_EXPORT_JSONL)
+    *(ptr++)= '"';
+  exporter->len+= ptr - start;
+}
+
+// -----[ _rx_prefix ]-----------------------------------------------
+static inline void _rx_prefix(bgp_rib_export_t * exporter, ip_pfx_t prefix)
+{
+  char * ptr= _rx_reserve(exporter, RX_FIELD_SIZE);
+  char * start= ptr;
+
+  if (exporter->format == BGP_RIB_EXPORT_JSONL)
+    *(ptr++)= '"';
+  ptr+= _rx_fmt_addr(ptr, prefix.network);
+  *(ptr++)= '/';
+  ptr+= _rx_fmt_u32(ptr, prefix.mask);
+  if (exporter->format == BGP_RIB_EXPORT_JSONL)
+    *(ptr++)= '"';
+  exporter->len+= ptr - start;
+}
+
+// -----[ _rx_null ]-------------------------------------------------
+static inline void _rx_null(bgp_rib_export_t * exporter)
+{
+  if (exporter->format == BGP_RIB_EXPORT_JSONL)
+    _rx_str(exporter, "null");
+}
+
+// -----[ _rx_sep ]--------------------------------------------------
+/** Write the separator and the name of the next field. */
+#define _rx_sep(E,NAME)				\
+  do {						\
+    if ((E)->format == BGP_RIB_EXPORT_JSONL)	\
+      _rx_str(E, ",\"" NAME "\":");		\
+    else					\
+      _rx_char(E, ',');				\
+  } while (0)
+
+/////////////////////////////////////////////////////////////////////
+//
+// ATTRIBUTE CACHE
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _rx_cache_compute ]----------------------------------------
+static uint32_t _rx_cache_compute(const void * item,
+				  unsigned int hash_size)
+{
+  const _rx_cache_entry_t * entry= (const _rx_cache_entry_t *) item;
+  return (uint32_t) (((unsigned long) entry->ref) >> 3) % hash_size;
+}
+
+// -----[ _rx_cache_compare ]----------------------------------------
+static int _rx_cache_compare(const void * item1, const void * item2,
+			     unsigned int elt_size)
+{
+  const _rx_cache_entry_t * entry1= (const _rx_cache_entry_t *) item1;
+  const _rx_cache_entry_t * entry2= (const _rx_cache_entry_t *) item2;
+
+  if (entry1->ref < entry2->ref)
+    return -1;
+  else if (entry1->ref > entry2->ref)
+    return 1;
+  return 0;
+}
+
+// -----[ _rx_cache_destroy ]----------------------------------------
+static void _rx_cache_destroy(void * item)
+{
+  FREE(item);
+}
+
+// -----[ _rx_cache_search ]-----------------------------------------
+static inline _rx_cache_entry_t *
+_rx_cache_search(bgp_rib_export_t * exporter, const void * ref)
+{
+  _rx_cache_entry_t key= { .ref= ref, .len= 0 };
+  return (_rx_cache_entry_t *) hash_set_search(exporter->cache, &key);
+}
+
+// -----[ _rx_cache_path ]-------------------------------------------
+/**
+ * Format an AS-Path as path_dump() does: segments from the neighbor
+ * to the origin, AS-SETs between braces. C-BGP stores the segments
+ * and the ASNs of each segment in reverse order.
+ */
+static _rx_cache_entry_t * _rx_cache_path(bgp_rib_export_t * exporter,
+					  bgp_path_t * path)
+{
+  _rx_cache_entry_t * entry;
+  bgp_path_seg_t * seg;
+  unsigned int num_segs, index, asn_index;
+  size_t size= 0;
+  char * ptr;
+
+  num_segs= path_num_segments(path);
+  for (index= 0; index < num_segs; index++) {
+    seg= (bgp_path_seg_t *) path->data[index];
+    size+= seg->length * 11 + 3;
+  }
+  entry= (_rx_cache_entry_t *) MALLOC(sizeof(_rx_cache_entry_t) + size);
+  entry->ref= path;
+  ptr= entry->data;
+  for (index= num_segs; index > 0; index--) {
+    seg= (bgp_path_seg_t *) path->data[index-1];
+    if (index < num_segs)
+      *(ptr++)= ' ';
+    if (seg->type == AS_PATH_SEGMENT_SET)
+      *(ptr++)= '{';
+    for (asn_index= seg->length; asn_index > 0; asn_index--) {
+      if (asn_index < seg->length)
+	*(ptr++)= ' ';
+      ptr+= _rx_fmt_u32(ptr, seg->asns[asn_index-1]);
+    }
+    if (seg->type == AS_PATH_SEGMENT_SET)
+      *(ptr++)= '}';
+  }
+  entry->len= ptr - entry->data;
+  hash_set_add(exporter->cache, entry);
+  return entry;
+}
+
+// -----[ _rx_cache_comms ]------------------------------------------
+/** Format Communities as "<asn>:<value>", separated by spaces. */
+static _rx_cache_entry_t * _rx_cache_comms(bgp_rib_export_t * exporter,
+					   bgp_comms_t * comms)
+{
+  _rx_cache_entry_t * entry;
+  unsigned int index;
+  char * ptr;
+
+  entry= (_rx_cache_entry_t *) MALLOC(sizeof(_rx_cache_entry_t) +
+				      comms->num * 12);
+  entry->ref= comms;
+  ptr= entry->data;
+  for (index= 0; index < comms->num; index++) {
+    if (index > 0)
+      *(ptr++)= ' ';
+    ptr+= _rx_fmt_u32(ptr, comms->values[index] >> 16);
+    *(ptr++)= ':';
+    ptr+= _rx_fmt_u32(ptr, comms->values[index] & 0xFFFF);
+  }
+  entry->len= ptr - entry->data;
+  hash_set_add(exporter->cache, entry);
+  return entry;
+}
+
+// -----[ _rx_cached ]-----------------------------------------------
+/** Write the (quoted in JSON) text of a cache entry. */
+static inline void _rx_cached(bgp_rib_export_t * exporter,
+			      _rx_cache_entry_t * entry)
+{
+  if (exporter->format == BGP_RIB_EXPORT_JSONL)
+    _rx_char(exporter, '"');
+  _rx_write(exporter, entry->data, entry->len);
+  if (exporter->format == BGP_RIB_EXPORT_JSONL)
+    _rx_char(exporter, '"');
+}
+
+// -----[ _rx_path ]-------------------------------------------------
+static inline void _rx_path(bgp_rib_export_t * exporter, bgp_path_t * path)
+{
+  _rx_cache_entry_t * entry;
+
+  if ((path == NULL) || (path_num_segments(path) == 0)) {
+    if (exporter->format == BGP_RIB_EXPORT_JSONL)
+      _rx_str(exporter, "\"\"");
+    return;
+  }
+  entry= _rx_cache_search(exporter, path);
+  if (entry == NULL)
+    entry= _rx_cache_path(exporter, path);
+  _rx_cached(exporter, entry);
+}
+
+// -----[ _rx_comms ]------------------------------------------------
+static inline void _rx_comms(bgp_rib_export_t * exporter,
+			     bgp_comms_t * comms)
+{
+  _rx_cache_entry_t * entry;
+
+  if ((comms == NULL) || (comms->num == 0)) {
+    if (exporter->format == BGP_RIB_EXPORT_JSONL)
+      _rx_str(exporter, "\"\"");
+    return;
+  }
+  entry= _rx_cache_search(exporter, comms);
+  if (entry == NULL)
+    entry= _rx_cache_comms(exporter, comms);
+  _rx_cached(exporter, entry);
+}
+
+/////////////////////////////////////////////////////////////////////
+//
+// EXPORT WRITER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ bgp_rib_export_open ]--------------------------------------
+bgp_rib_export_t * bgp_rib_export_open(const char * filename,
+				       gds_stream_t * stream,
+				       bgp_rib_export_format_t format)
+{
+  bgp_rib_export_t * exporter;
+  _rx_file_t file= NULL;
+
+  if (filename != NULL) {
+    file= RX_FILE_OPEN(filename);
+    if (file == NULL)
+      return NULL;
+  }
+
+  exporter= (bgp_rib_export_t *) MALLOC(sizeof(bgp_rib_export_t));
+  exporter->format= format;
+  exporter->file= file;
+  exporter->stream= stream;
+  exporter->buffer= (char *) MALLOC(RX_BUFFER_SIZE);
+  exporter->len= 0;
+  exporter->cache= hash_set_create(RX_CACHE_SIZE, 0, _rx_cache_compare,
+				 _rx_cache_destroy, _rx_cache_compute);
+  exporter->router= NULL;
+  exporter->router_len= 0;
+  exporter->error= BGP_RIB_EXPORT_SUCCESS;
+
+  if (format == BGP_RIB_EXPORT_CSV)
+    _rx_str(exporter, CSV_HEADER);
+  return exporter;
+}
+
+// -----[ bgp_rib_export_close ]-------------------------------------
+int bgp_rib_export_close(bgp_rib_export_t ** export_ref)
+{
+  bgp_rib_export_t * exporter= *export_ref;
+  int result;
+
+  if (exporter == NULL)
+    return BGP_RIB_EXPORT_SUCCESS;
+
+  _rx_flush(exporter);
+  result= exporter->error;
+  if (exporter->file != NULL) {
+    if ((RX_FILE_CLOSE(exporter->file) != 0) &&
+	(result == BGP_RIB_EXPORT_SUCCESS))
+      result= BGP_RIB_EXPORT_ERROR_WRITE;
+  } else {
+    stream_flush(exporter->stream);
+  }
+  hash_set_destroy(&exporter->cache);
+  FREE(exporter->buffer);
+  FREE(exporter);
+  *export_ref= NULL;
+  return result;
+}
+
+// -----[ bgp_rib_export_route ]-------------------------------------
+void bgp_rib_export_route(bgp_rib_export_t * exporter,
+			  bgp_router_t * router, bgp_route_t * route)
+{
+  int json= (exporter->format == BGP_RIB_EXPORT_JSONL);
+  int best= route_flag_get(route, ROUTE_FLAG_BEST);
+
+  // The address of the router is the same for all its routes
+  if (exporter->router != router) {
+    exporter->router= router;
+    exporter->router_len= 0;
+    if (json)
+      exporter->router_str[exporter->router_len++]= '"';
+    exporter->router_len+= _rx_fmt_addr(exporter->router_str +
+				      exporter->router_len,
+				      router->node->rid);
+    if (json)
+      exporter->router_str[exporter->router_len++]= '"';
+  }
+
+  if (json)
+    _rx_str(exporter, "{\"router\":");
+  _rx_write(exporter, exporter->router_str, exporter->router_len);
+
+  _rx_sep(exporter, "prefix");
+  _rx_prefix(exporter, route->prefix);
+
+  _rx_sep(exporter, "peer");
+  if (route->peer != NULL)
+    _rx_addr(exporter, route->peer->addr);
+  else
+    _rx_null(exporter);
+
+  _rx_sep(exporter, "peer_asn");
+  if (route->peer != NULL)
+    _rx_u32(exporter, route->peer->asn);
+  else
+    _rx_null(exporter);
+
+  _rx_sep(exporter, "best");
+  if (json) {
+    if (best)
+      _rx_str(exporter, "true");
+    else
+      _rx_str(exporter, "false");
+  } else {
+    _rx_char(exporter, best?'1':'0');
+  }
+
+  _rx_sep(exporter, "next_hop");
+  _rx_addr(exporter, route->attr->next_hop);
+
+  _rx_sep(exporter, "local_pref");
+  _rx_u32(exporter, route->attr->local_pref);
+
+  _rx_sep(exporter, "med");
+  if (route->attr->med != ROUTE_MED_MISSING)
+    _rx_u32(exporter, route->attr->med);
+  else
+    _rx_null(exporter);
+
+  _rx_sep(exporter, "origin");
+  if (json)
+    _rx_char(exporter, '"');
+  switch (route->attr->origin) {
+  case BGP_ORIGIN_IGP: _rx_str(exporter, "IGP"); break;
+  case BGP_ORIGIN_EGP: _rx_str(exporter, "EGP"); break;
+  default:
+    _rx_str(exporter, "INCOMPLETE");
+  }
+  if (json)
+    _rx_char(exporter, '"');
+
+  _rx_sep(exporter, "as_path");
+  _rx_path(exporter, route->attr->path_ref);
+
+  _rx_sep(exporter, "communities");
+  _rx_comms(exporter, route->attr->comms);
+
+  if (json)
+    _rx_str(exporter, "}\n");
+  else
+    _rx_char(exporter, '\n');
+}
+
+// -----[ _rx_ctx_t ]------------------------------------------------
+typedef struct {
+  bgp_rib_export_t * exporter;
+  bgp_router_t     * router;
+} _rx_ctx_t;
+
+// -----[ _rx_for_each_route ]---------------------------------------
+static int _rx_for_each_route(uint32_t key, uint8_t key_len,
+			      void * item, void * context)
+{
+  _rx_ctx_t * ctx= (_rx_ctx_t *) context;
+
+  bgp_rib_export_route(ctx->exporter, ctx->router, (bgp_route_t *) item);
+  return ctx->exporter->error;
+}
+
+// -----[ _rx_rib ]--------------------------------------------------
+/**
+ * Export the routes of a RIB selected by a prefix (see
+ * bgp_rib_export_rib()).
+ */
+static void _rx_rib(bgp_rib_export_t * exporter, bgp_router_t * router,
+		    bgp_rib_t * rib, ip_pfx_t prefix)
+{
+  _rx_ctx_t ctx= { .exporter= exporter, .router= router };
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  bgp_route_ts * routes;
+  uint16_t index;
+#else
+  bgp_route_t * route;
+#endif
+
+  // All prefixes
+  if (prefix.mask == 0) {
+    rib_for_each(rib, _rx_for_each_route, &ctx);
+    return;
+  }
+
+  // Single address (best match) or single prefix (exact match)
+#if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
+  if (prefix.mask >= 32)
+    routes= rib_find_best(rib, prefix);
+  else
+    routes= rib_find_exact(rib, prefix);
+  if (routes != NULL)
+    for (index= 0; index < routes_list_get_num(routes); index++)
+      bgp_rib_export_route(exporter, router,
+			   routes_list_get_at(routes, index));
+#else
+  if (prefix.mask >= 32)
+    route= rib_find_best(rib, prefix);
+  else
+    route= rib_find_exact(rib, prefix);
+  if (route != NULL)
+    bgp_rib_export_route(exporter, router, route);
+#endif
+}
+
+// -----[ bgp_rib_export_rib ]---------------------------------------
+void bgp_rib_export_rib(bgp_rib_export_t * exporter, bgp_router_t * router,
+			ip_pfx_t prefix)
+{
+  _rx_rib(exporter, router, router->loc_rib, prefix);
+}
+
+// -----[ bgp_rib_export_adj_rib ]-----------------------------------
+void bgp_rib_export_adj_rib(bgp_rib_export_t * exporter,
+			    bgp_router_t * router, bgp_peer_t * peer,
+			    ip_pfx_t prefix, bgp_rib_dir_t dir)
+{
+  unsigned int index;
+
+  if (peer != NULL) {
+    _rx_rib(exporter, router, peer->adj_rib[dir], prefix);
+    return;
+  }
+  for (index= 0; index < bgp_peers_size(router->peers); index++)
+    _rx_rib(exporter, router, bgp_peers_at(router->peers, index)->adj_rib[dir],
+	    prefix);
+}
+
+// -----[ bgp_rib_export_network ]-----------------------------------
+void bgp_rib_export_network(bgp_rib_export_t * exporter,
+			    network_t * network, ip_pfx_t prefix)
+{
+  gds_enum_t * nodes;
+  net_node_t * node;
+  net_protocol_t * protocol;
+
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    protocol= node_get_protocol(node, NET_PROTOCOL_BGP);
+    if (protocol == NULL)
+      continue;
+    bgp_rib_export_rib(exporter, (bgp_router_t *) protocol->handler, prefix);
+  }
+  enum_destroy(&nodes);
+}
@@ -0,0 +1,150 @@
+// ==================================================================
+// @(#)rib_export.h
+//
+// Machine-readable export of BGP RIBs (JSON lines and CSV).
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+
+/**
+ * \file
+ * Provide a writer that exports the routes of BGP RIBs in a
+ * machine-readable format, for offline analysis.
+ *
+ * Two output formats are supported:
+ * \li jsonl: one JSON object per line.
+ * \li csv: a header line followed by one comma-separated line per
+ *   route.
+ *
+ * Each route has the following fields: router, prefix, peer,
+ * peer_asn, best, next_hop, local_pref, med, origin, as_path and
+ * communities. The peer and peer_asn fields are empty (null) for
+ * locally originated routes, the med field is empty (null) when the
+ * MED is missing.
+ *
+ * The lines are formatted in a memory buffer that is written when
+ * full. The text of an AS-Path or of a Communities attribute is
+ * formatted once and re-used for all the routes that share the same
+ * interned attribute.
+ */
+
+#ifndef __BGP_RIB_EXPORT_H__
+#define __BGP_RIB_EXPORT_H__
+
+#include <libgds/stream.h>
+
+#include <net/prefix.h>
+#include <bgp/types.h>
+
+// -----[ bgp_rib_export_format_t ]----------------------------------
+typedef enum {
+  BGP_RIB_EXPORT_JSONL,
+  BGP_RIB_EXPORT_CSV,
+  BGP_RIB_EXPORT_MAX,
+} bgp_rib_export_format_t;
+
+// -----[ bgp_rib_export_error_t ]-----------------------------------
+typedef enum {
+  BGP_RIB_EXPORT_SUCCESS     = 0,
+  BGP_RIB_EXPORT_ERROR_OPEN  = -1,
+  BGP_RIB_EXPORT_ERROR_WRITE = -2,
+} bgp_rib_export_error_t;
+
+typedef struct bgp_rib_export_t bgp_rib_export_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ bgp_rib_export_open ]------------------------------------
+  /**
+   * Create an export writer.
+   *
+   * \param filename is the output file, or NULL to write to the
+   *   stream. When C-BGP is built with libbgpdump, the output is
+   *   compressed if the file name ends with ".gz" or ".bz2".
+   * \param stream   is the output stream used if filename is NULL.
+   * \param format   is the output format.
+   * \retval the writer, or NULL if the file could not be created.
+   */
+  bgp_rib_export_t * bgp_rib_export_open(const char * filename,
+					 gds_stream_t * stream,
+					 bgp_rib_export_format_t format);
+
+  // -----[ bgp_rib_export_close ]-----------------------------------
+  /**
+   * Write the buffered lines, close the file and destroy the writer.
+   *
+   * \retval BGP_RIB_EXPORT_SUCCESS in case of success,
+   *   or BGP_RIB_EXPORT_ERROR_WRITE if a write failed.
+   */
+  int bgp_rib_export_close(bgp_rib_export_t ** export_ref);
+
+  // -----[ bgp_rib_export_route ]-----------------------------------
+  /**
+   * Export a single route of a router.
+   */
+  void bgp_rib_export_route(bgp_rib_export_t * exporter,
+			    bgp_router_t * router, bgp_route_t * route);
+
+  // -----[ bgp_rib_export_rib ]-------------------------------------
+  /**
+   * Export the Loc-RIB of a router.
+   *
+   * \param prefix selects a specific prefix (prefix length < 32),
+   *   the longest prefix matching an address (prefix length >= 32),
+   *   or all prefixes (prefix length == 0).
+   */
+  void bgp_rib_export_rib(bgp_rib_export_t * exporter, bgp_router_t * router,
+			  ip_pfx_t prefix);
+
+  // -----[ bgp_rib_export_adj_rib ]---------------------------------
+  /**
+   * Export the Adj-RIB-In or Adj-RIB-Out of one peer (or of all the
+   * peers if peer is NULL) of a router. The prefix selects the
+   * routes as in bgp_rib_export_rib().
+   */
+  void bgp_rib_export_adj_rib(bgp_rib_export_t * exporter,
+			      bgp_router_t * router, bgp_peer_t * peer,
+			      ip_pfx_t prefix, bgp_rib_dir_t dir);
+
+  // -----[ bgp_rib_export_network ]---------------------------------
+  /**
+   * Export the Loc-RIBs of all the BGP routers of a network.
+   */
+  void bgp_rib_export_network(bgp_rib_export_t * exporter,
+			      network_t * network, ip_pfx_t prefix);
+
+  // -----[ bgp_rib_export_strerror ]--------------------------------
+  const char * bgp_rib_export_strerror(int error);
+
+  // -----[ bgp_rib_export_format_from_str ]-------------------------
+  int bgp_rib_export_format_from_str(const char * str,
+				     bgp_rib_export_format_t * format);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __BGP_RIB_EXPORT_H__ */
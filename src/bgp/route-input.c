@@ -40,6 +40,7 @@
 static char * INPUT_TYPE_STR[BGP_ROUTES_INPUT_MAX]=
 {
   "mrt-ascii",
+  "mrt-ascii-legacy",
 #ifdef HAVE_BGPDUMP
   "mrt-binary",
 #endif /* HAVE_BGPDUMP */
@@ -68,6 +69,8 @@ int bgp_routes_load(const char * filename, bgp_input_type_t format,
   switch (format) {
   case BGP_ROUTES_INPUT_MRT_ASC:
     return mrtd_ascii_load(filename, handler, ctx);
+  case BGP_ROUTES_INPUT_MRT_ASC_LEGACY:
+    return mrtd_ascii_load_legacy(filename, handler, ctx);
 #ifdef HAVE_BGPDUMP
   case BGP_ROUTES_INPUT_MRT_BIN:
     return mrtd_binary_load(filename, handler, ctx);
@@ -33,6 +33,7 @@
 // ----- BGP Routes Input Formats -----
 typedef enum {
   BGP_ROUTES_INPUT_MRT_ASC,
+  BGP_ROUTES_INPUT_MRT_ASC_LEGACY,
 #ifdef HAVE_BGPDUMP
   BGP_ROUTES_INPUT_MRT_BIN,
 #endif /* HAVE_BGPDUMP */
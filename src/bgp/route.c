@@ -41,13 +41,14 @@
 #include <bgp/attr/origin.h>
 #include <bgp/qos.h>
 #include <bgp/route.h>
+#include <util/mem_stats.h>
 #include <util/str_format.h>
 
-typedef struct _options_t {
+struct route_options_t {
   uint8_t   show_mode;
   char    * show_format;
-} _options_t;
-static _options_t _default_options= {
+};
+static route_options_t _default_options= {
   .show_mode  = BGP_ROUTES_OUTPUT_CISCO,
   .show_format= NULL,
 };
@@ -86,6 +87,7 @@ static inline bgp_route_t *
 _route_create2(ip_pfx_t prefix, bgp_peer_t * peer, bgp_attr_t * attr)
 {
   bgp_route_t * route= (bgp_route_t *) MALLOC(sizeof(bgp_route_t));
+  mem_stats_alloc(MEM_TAG_ROUTE, sizeof(bgp_route_t));
   route->prefix= prefix;
   route->peer= peer;
   route->attr= attr;
@@ -116,6 +118,9 @@ bgp_route_t * route_create_nlri(bgp_nlri_t nlri, bgp_peer_t * peer,
   size_t route_size= sizeof(bgp_route_t) + nlri_size - sizeof(bgp_nlri_t);
 
   route= (bgp_route_t *) MALLOC(route_size);
+  // Accounted as a regular route, since route_destroy() does not
+  // know the size of the NLRI.
+  mem_stats_alloc(MEM_TAG_ROUTE, sizeof(bgp_route_t));
   route->peer= peer;
   //route->attr= attr;
   route->flags= 0;
@@ -153,6 +158,7 @@ void route_destroy(bgp_route_t ** route_ref)
     bgp_attr_destroy(&(*route_ref)->attr);
 
     FREE(*route_ref);
+    mem_stats_free(MEM_TAG_ROUTE, sizeof(bgp_route_t));
     *route_ref= NULL;
   }
 }
@@ -1002,3 +1008,36 @@ void _bgp_route_destroy()
 {
   str_destroy(&_default_options.show_format);
 }
+
+// -----[ _route_options_create ]------------------------------------
+route_options_t * _route_options_create()
+{
+  route_options_t * options=
+    (route_options_t *) MALLOC(sizeof(route_options_t));
+  options->show_mode= BGP_ROUTES_OUTPUT_CISCO;
+  options->show_format= NULL;
+  return options;
+}
+
+// -----[ _route_options_destroy ]-----------------------------------
+void _route_options_destroy(route_options_t ** options_ref)
+{
+  if (*options_ref != NULL) {
+    str_destroy(&(*options_ref)->show_format);
+    FREE(*options_ref);
+    *options_ref= NULL;
+  }
+}
+
+// -----[ _route_options_swap ]--------------------------------------
+/**
+ * Exchange the current "show" mode with the given one (used to
+ * switch between simulation contexts).
+ */
+void _route_options_swap(route_options_t * options)
+{
+  route_options_t tmp= _default_options;
+
+  _default_options= *options;
+  *options= tmp;
+}
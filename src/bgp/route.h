@@ -92,6 +92,9 @@
 #define ROUTE_SHOW_MRT    1
 #define ROUTE_SHOW_CUSTOM 2
 
+// -----[ route_options_t ]------------------------------------------
+/** Route "show" mode (see "bgp options show-mode"). */
+typedef struct route_options_t route_options_t;
 
 #ifdef __cplusplus
 extern "C" {
@@ -223,6 +226,12 @@ extern "C" {
   
   // -----[ _bgp_route_destroy ]-------------------------------------
   void _bgp_route_destroy();
+  // -----[ _route_options_create ]----------------------------------
+  route_options_t * _route_options_create();
+  // -----[ _route_options_destroy ]---------------------------------
+  void _route_options_destroy(route_options_t ** options_ref);
+  // -----[ _route_options_swap ]------------------------------------
+  void _route_options_swap(route_options_t * options);
 
   
 #ifdef __cplusplus
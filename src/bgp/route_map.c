@@ -152,3 +152,12 @@ void _route_maps_destroy()
 {
   hash_set_destroy(&_route_maps);
 }
+
+// -----[ _route_maps_swap ]-----------------------------------------
+void _route_maps_swap(gds_hash_set_t ** route_maps_ref)
+{
+  gds_hash_set_t * route_maps= _route_maps;
+
+  _route_maps= *route_maps_ref;
+  *route_maps_ref= route_maps;
+}
@@ -28,6 +28,8 @@
 #ifndef __BGP_ROUTE_MAP_H__
 #define __BGP_ROUTE_MAP_H__
 
+#include <libgds/hash.h>
+
 #include <bgp/filter/types.h>
 
 typedef struct {
@@ -57,6 +59,8 @@ extern "C" {
   void _route_maps_init();
   // -----[ _route_maps_destroy ]------------------------------------
   void _route_maps_destroy();
+  // -----[ _route_maps_swap ]---------------------------------------
+  void _route_maps_swap(gds_hash_set_t ** route_maps_ref);
 
 #ifdef __cplusplus
 }
@@ -115,6 +115,8 @@ typedef struct bgp_router_t {
   net_node_t          * node;
   /** Reference to BGP domain (AS). */
   struct bgp_domain_t * domain;
+  /** Number of runs of the decision process (one per prefix). */
+  unsigned int          num_dp_runs;
 
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   /** This is a list of neighbors sorted on the walton limit number
@@ -172,8 +174,8 @@ typedef struct bgp_peer_t {
   unsigned int          recv_seq_num;
   /** Last error of the session. */
   int                   last_error;
-  /** Optionnal stream for recording sent/received BGP messages. */
-  gds_stream_t        * pRecordStream;
+  /** Optionnal writer for recording the sent BGP messages. */
+  struct bgp_msg_writer_t * record_writer;
 
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   uint16_t uWaltonLimit;
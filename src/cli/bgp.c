@@ -42,10 +42,12 @@
 #include <bgp/filter/predicate_parser.h>
 #include <bgp/message.h>
 #include <bgp/mrtd.h>
+#include <bgp/msg_writer.h>
 #include <bgp/peer.h>
 #include <bgp/peer-list.h>
 #include <bgp/qos.h>
 #include <bgp/record-route.h>
+#include <bgp/rib_export.h>
 #include <bgp/route.h>
 #include <bgp/route_map.h>
 #include <bgp/tie_breaks.h>
@@ -65,6 +67,7 @@
 #include <libgds/memory.h>
 #include <libgds/str_util.h>
 #include <net/error.h>
+#include <net/network.h>
 #include <net/node.h>
 #include <net/prefix.h>
 #include <net/util.h>
@@ -430,15 +433,60 @@ int cli_bgp_options_localpref(cli_ctx_t * ctx, cli_cmd_t * cmd)
 /**
  * context: {}
  * tokens: {output-file|"-"}
+ * options: {--format=text|binary|mrt}
  */
 int cli_bgp_options_msgmonitor(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
   const char * arg= cli_get_arg_value(cmd, 0);
+  const char * opt= cli_get_opt_value(cmd, "format");
+  bgp_msg_format_t format= BGP_MSG_FORMAT_TEXT;
 
   if (strcmp(arg, "-") == 0) {
     bgp_msg_monitor_close();
-  } else {
-    bgp_msg_monitor_open(arg);
+    return CLI_SUCCESS;
+  }
+
+  if ((opt != NULL) && (bgp_msg_format_from_str(opt, &format) != 0)) {
+    cli_set_user_error(cli_get(), "invalid output format \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if (bgp_msg_monitor_open(arg, format) != 0) {
+    cli_set_user_error(cli_get(), "could not open \"%s\" for writing", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_bgp_msg_decode ]---------------------------------------
+/**
+ * Convert a message trace written in binary format (see "bgp options
+ * msg-monitor" and "bgp router peer record") to the text format.
+ *
+ * context: {}
+ * tokens: {file}
+ * options: {--output=FILE}
+ */
+static int cli_bgp_msg_decode(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * filename= cli_get_arg_value(cmd, 0);
+  gds_stream_t * stream= gdsout;
+  const char * output= cli_get_opt_value(cmd, "output");
+  int result;
+
+  if (output != NULL) {
+    stream= stream_create_file(output);
+    if (stream == NULL) {
+      cli_set_user_error(cli_get(), "could not create \"%s\"", output);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+  result= bgp_msg_writer_decode(filename, stream);
+  if (stream != gdsout)
+    stream_destroy(&stream);
+  if (result != BGP_MSG_WRITER_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not decode \"%s\" (%s)",
+		       filename, bgp_msg_writer_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
   }
   return CLI_SUCCESS;
 }
@@ -561,7 +609,7 @@ int cli_bgp_router_debug_dp(cli_ctx_t * ctx, cli_cmd_t * cmd)
  *
  * context: {router}
  * tokens: {file}
- * options: {--autoconf,--format,--force,--summary}
+ * options: {--autoconf,--bulk,--format,--force,--summary}
  */
 static int cli_bgp_router_load_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -584,6 +632,10 @@ static int cli_bgp_router_load_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
   if (cli_has_opt_value(cmd, "autoconf"))
     options|= BGP_ROUTER_LOAD_OPTIONS_AUTOCONF;
 
+  // Get option --bulk ?
+  if (cli_has_opt_value(cmd, "bulk"))
+    options|= BGP_ROUTER_LOAD_OPTIONS_BULK;
+
   // Get option --force ?
   if (cli_has_opt_value(cmd, "force"))
     options|= BGP_ROUTER_LOAD_OPTIONS_FORCE;
@@ -602,6 +654,114 @@ static int cli_bgp_router_load_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+#ifdef HAVE_BGPDUMP
+// -----[ _opt_save_format ]-----------------------------------------
+/**
+ * Check the optional output format of the save commands. Only the
+ * binary MRT format (TABLE_DUMP_V2) is supported.
+ */
+static int _opt_save_format(cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_opt_value(cmd, "format");
+  bgp_input_type_t format;
+
+  if (arg == NULL)
+    return 0;
+  if ((bgp_routes_str2format(arg, &format) != 0) ||
+      (format != BGP_ROUTES_INPUT_MRT_BIN)) {
+    cli_set_user_error(cli_get(), "invalid output format \"%s\"", arg);
+    return -1;
+  }
+  return 0;
+}
+
+// ----- cli_bgp_router_save_rib ------------------------------------
+/**
+ * This function saves the Loc-RIB of the given BGP instance into a
+ * binary MRT file (TABLE_DUMP_V2). The file is compressed if its
+ * name ends with ".gz" or ".bz2".
+ *
+ * context: {router}
+ * tokens: {file}
+ * options: {--format}
+ */
+static int cli_bgp_router_save_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  bgp_router_t * router= _router_from_context(ctx);
+  const char * filename= cli_get_arg_value(cmd, 0);
+  int result;
+
+  if (_opt_save_format(cmd))
+    return CLI_ERROR_COMMAND_FAILED;
+
+  result= mrtd_binary_save_rib(router, filename);
+  if (result != MRTD_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not save \"%s\" (%s)",
+		       filename, mrtd_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
+// ----- cli_bgp_router_save_adjrib ---------------------------------
+/**
+ * This function saves the Adj-RIB-In or Adj-RIB-Out of one peer (or
+ * of all peers) of the given BGP instance into a binary MRT file
+ * (TABLE_DUMP_V2).
+ *
+ * context: {router}
+ * tokens: {in|out, peer|*, file}
+ * options: {--format}
+ */
+static int cli_bgp_router_save_adjrib(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  bgp_router_t * router= _router_from_context(ctx);
+  const char * filename= cli_get_arg_value(cmd, 2);
+  const char * arg;
+  net_addr_t peer_addr;
+  bgp_peer_t * peer;
+  bgp_rib_dir_t dir;
+  int result;
+
+  // Get the adjrib direction: in|out
+  arg= cli_get_arg_value(cmd, 0);
+  if (!strcmp(arg, "in")) {
+    dir= RIB_IN;
+  } else if (!strcmp(arg, "out")) {
+    dir= RIB_OUT;
+  } else {
+    cli_set_user_error(cli_get(), "invalid adj-rib side \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  // Get the peer|*
+  arg= cli_get_arg_value(cmd, 1);
+  if (!strcmp(arg, "*")) {
+    peer= NULL;
+  } else if (!str2addr_id(arg, &peer_addr)) {
+    peer= bgp_router_find_peer(router, peer_addr);
+    if (peer == NULL) {
+      cli_set_user_error(cli_get(), "unknown peer \"%s\"", arg);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  } else {
+    cli_set_user_error(cli_get(), "invalid peer address \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  if (_opt_save_format(cmd))
+    return CLI_ERROR_COMMAND_FAILED;
+
+  result= mrtd_binary_save_adj_rib(router, peer, dir, filename);
+  if (result != MRTD_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not save \"%s\" (%s)",
+		       filename, mrtd_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+#endif /* HAVE_BGPDUMP */
+
 // ----- cli_bgp_router_set_tiebreak --------------------------------
 /**
  * This function changes the tie-breaking rule of the given BGP
@@ -704,6 +864,74 @@ static inline void _opt_output_release(gds_stream_t ** stream_ref) {
   }
 }
 
+// -----[ _arg_rib_prefix ]------------------------------------------
+/**
+ * Convert a prefix|address|* argument to the prefix selector of the
+ * RIB exports: the prefix length is 0 for '*' and 32 for an address.
+ */
+static int _arg_rib_prefix(const char * arg, ip_pfx_t * prefix)
+{
+  if (!strcmp(arg, "*")) {
+    prefix->network= 0;
+    prefix->mask= 0;
+  } else if (!str2prefix(arg, prefix)) {
+  } else if (!str2address(arg, &prefix->network)) {
+    prefix->mask= 32;
+  } else {
+    cli_set_user_error(cli_get(), "invalid prefix|address|* \"%s\"", arg);
+    return -1;
+  }
+  return 0;
+}
+
+// -----[ _opt_export_open ]-----------------------------------------
+/**
+ * Open a machine-readable export if option --format is present (or
+ * if a default format is given). The routes are written to the file
+ * of option --output or to the standard output. The exporter is
+ * NULL if no export is requested.
+ */
+static int _opt_export_open(const cli_cmd_t * cmd,
+			    const char * default_format,
+			    bgp_rib_export_t ** exporter_ref)
+{
+  const char * arg= default_format;
+  const char * output= NULL;
+  bgp_rib_export_format_t format;
+
+  *exporter_ref= NULL;
+  if (cli_has_opt_value(cmd, "format"))
+    arg= cli_get_opt_value(cmd, "format");
+  if (arg == NULL)
+    return 0;
+  if (bgp_rib_export_format_from_str(arg, &format)) {
+    cli_set_user_error(cli_get(), "invalid output format \"%s\"", arg);
+    return -1;
+  }
+
+  if (cli_has_opt_value(cmd, "output"))
+    output= cli_get_opt_value(cmd, "output");
+  *exporter_ref= bgp_rib_export_open(output, gdsout, format);
+  if (*exporter_ref == NULL) {
+    cli_set_user_error(cli_get(), "could not create \"%s\"", output);
+    return -1;
+  }
+  return 0;
+}
+
+// -----[ _opt_export_close ]----------------------------------------
+static int _opt_export_close(bgp_rib_export_t ** exporter_ref)
+{
+  int result= bgp_rib_export_close(exporter_ref);
+
+  if (result != BGP_RIB_EXPORT_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not export routes (%s)",
+		       bgp_rib_export_strerror(result));
+    return -1;
+  }
+  return 0;
+}
+
 // ----- cli_bgp_router_show_rib ------------------------------------
 /**
  * This function shows the list of routes in the given BGP instance's
@@ -714,9 +942,12 @@ static inline void _opt_output_release(gds_stream_t ** stream_ref) {
  *   - a prefix, meaning show only the route towards this exact prefix
  *   - an asterisk ('*'), meaning show everything
  *
+ * With option --format=jsonl|csv, the routes are written in a
+ * machine-readable format (see bgp_rib_export_open()).
+ *
  * context: {router}
  * tokens: {prefix|address|*}
- * options: {--output=filename}
+ * options: {--format=jsonl|csv, --output=filename}
  */
 int cli_bgp_router_show_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -724,6 +955,17 @@ int cli_bgp_router_show_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
   const char * arg= cli_get_arg_value(cmd, 0);
   ip_pfx_t prefix;
   gds_stream_t * stream;
+  bgp_rib_export_t * exporter;
+
+  if (cli_has_opt_value(cmd, "format")) {
+    if (_arg_rib_prefix(arg, &prefix) ||
+	_opt_export_open(cmd, NULL, &exporter))
+      return CLI_ERROR_COMMAND_FAILED;
+    bgp_rib_export_rib(exporter, router, prefix);
+    if (_opt_export_close(&exporter))
+      return CLI_ERROR_COMMAND_FAILED;
+    return CLI_SUCCESS;
+  }
   
   if (_opt_output_init(cmd, &stream))
     return CLI_ERROR_COMMAND_FAILED;
@@ -761,9 +1003,12 @@ int cli_bgp_router_show_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
  *   - a prefix, meaning show only the route towards this exact prefix
  *   - an asterisk ('*'), meaning show everything
  *
+ * With option --format=jsonl|csv, the routes are written in a
+ * machine-readable format (see bgp_rib_export_open()).
+ *
  * context: {router}
  * tokens: {in|out, addr, prefix|address|*}
- * options: {--output=filename}
+ * options: {--format=jsonl|csv, --output=filename}
  */
 static int cli_bgp_router_show_adjrib(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -774,6 +1019,7 @@ static int cli_bgp_router_show_adjrib(cli_ctx_t * ctx, cli_cmd_t * cmd)
   ip_pfx_t prefix;
   bgp_rib_dir_t dir;
   gds_stream_t * stream;
+  bgp_rib_export_t * exporter;
 
   // Get the adjrib direction: in|out
   arg= cli_get_arg_value(cmd, 0);
@@ -813,6 +1059,15 @@ static int cli_bgp_router_show_adjrib(cli_ctx_t * ctx, cli_cmd_t * cmd)
     return CLI_ERROR_COMMAND_FAILED;
   }
 
+  if (cli_has_opt_value(cmd, "format")) {
+    if (_opt_export_open(cmd, NULL, &exporter))
+      return CLI_ERROR_COMMAND_FAILED;
+    bgp_rib_export_adj_rib(exporter, router, peer, prefix, dir);
+    if (_opt_export_close(&exporter))
+      return CLI_ERROR_COMMAND_FAILED;
+    return CLI_SUCCESS;
+  }
+
     if (_opt_output_init(cmd, &stream))
     return CLI_ERROR_COMMAND_FAILED;
   
@@ -1339,6 +1594,61 @@ int cli_bgp_show_routers(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+#ifdef HAVE_BGPDUMP
+// ----- cli_bgp_save_rib -------------------------------------------
+/**
+ * Save the Loc-RIBs of all the BGP routers into a single binary MRT
+ * file (TABLE_DUMP_V2). Each router appears as a peer in the peer
+ * index table, as if a route collector was peering with all the
+ * routers.
+ *
+ * context: {}
+ * tokens:  {file}
+ * options: {--format}
+ */
+static int cli_bgp_save_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * filename= cli_get_arg_value(cmd, 0);
+  int result;
+
+  if (_opt_save_format(cmd))
+    return CLI_ERROR_COMMAND_FAILED;
+
+  result= mrtd_binary_save_network(network_get_default(), filename);
+  if (result != MRTD_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not save \"%s\" (%s)",
+		       filename, mrtd_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+#endif /* HAVE_BGPDUMP */
+
+// -----[ cli_bgp_show_rib ]-----------------------------------------
+/**
+ * Export the Loc-RIBs of all the BGP routers in a machine-readable
+ * format (JSON lines by default). Each line holds the address of
+ * the router the route belongs to.
+ *
+ * context: {}
+ * tokens:  {prefix|address|*}
+ * options: {--format=jsonl|csv, --output=filename}
+ */
+static int cli_bgp_show_rib(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  bgp_rib_export_t * exporter;
+  ip_pfx_t prefix;
+
+  if (_arg_rib_prefix(arg, &prefix) ||
+      _opt_export_open(cmd, "jsonl", &exporter))
+    return CLI_ERROR_COMMAND_FAILED;
+  bgp_rib_export_network(exporter, network_get_default(), prefix);
+  if (_opt_export_close(&exporter))
+    return CLI_ERROR_COMMAND_FAILED;
+  return CLI_SUCCESS;
+}
+
 // ----- cli_bgp_show_sessions --------------------------------------
 /**
  * Show the list of sessions.
@@ -1538,6 +1848,7 @@ static void _register_bgp_options(cli_cmd_t * parent)
   cli_add_arg(cmd, cli_arg("local-pref", NULL));
   cmd= cli_add_cmd(group, cli_cmd("msg-monitor", cli_bgp_options_msgmonitor));
   cli_add_arg(cmd, cli_arg("output-file", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("show-mode", cli_bgp_options_showmode));
   cli_add_arg(cmd, cli_arg("cisco|mrt|custom", NULL));
 
@@ -1563,11 +1874,30 @@ static void _register_bgp_router_load(cli_cmd_t * parent)
   cmd= cli_add_cmd(group, cli_cmd("rib", cli_bgp_router_load_rib));
   cli_add_arg(cmd, cli_arg_file("file", NULL));
   cli_add_opt(cmd, cli_opt("autoconf", NULL));
+  cli_add_opt(cmd, cli_opt("bulk", NULL));
   cli_add_opt(cmd, cli_opt("force", NULL));
   cli_add_opt(cmd, cli_opt("format=", NULL));
   cli_add_opt(cmd, cli_opt("summary", NULL));
 }
 
+#ifdef HAVE_BGPDUMP
+// ----- _register_bgp_router_save -------------------------------
+static void _register_bgp_router_save(cli_cmd_t * parent)
+{
+  cli_cmd_t * group, * cmd;
+
+  group= cli_add_cmd(parent, cli_cmd_group("save"));
+  cmd= cli_add_cmd(group, cli_cmd("adj-rib", cli_bgp_router_save_adjrib));
+  cli_add_arg(cmd, cli_arg("in|out", NULL));
+  cli_add_arg(cmd, cli_arg2("peer", NULL, cli_enum_bgp_peers_addr));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("rib", cli_bgp_router_save_rib));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
+}
+#endif /* HAVE_BGPDUMP */
+
 // ----- _register_bgp_router_set --------------------------------
 static void _register_bgp_router_set(cli_cmd_t * parent)
 {
@@ -1591,9 +1921,11 @@ static void _register_bgp_router_show(cli_cmd_t * parent)
   cli_add_arg(cmd, cli_arg("in|out", NULL));
   cli_add_arg(cmd, cli_arg2("peer", NULL, cli_enum_bgp_peers_addr));
   cli_add_arg(cmd, cli_arg("prefix|address|*", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
   cli_add_opt(cmd, cli_opt("output=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("rib", cli_bgp_router_show_rib));
   cli_add_arg(cmd, cli_arg("prefix|address|*", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
   cli_add_opt(cmd, cli_opt("output=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("route-info",
 				  cli_bgp_router_show_routeinfo));
@@ -1617,6 +1949,9 @@ static void _register_bgp_router(cli_cmd_t * parent)
   _register_bgp_router_del(group);
   cli_register_bgp_router_peer(group);
   _register_bgp_router_load(group);
+#ifdef HAVE_BGPDUMP
+  _register_bgp_router_save(group);
+#endif /* HAVE_BGPDUMP */
   _register_bgp_router_set(group);
   _register_bgp_router_show(group);
   cmd= cli_add_cmd(group, cli_cmd("record-route", cli_bgp_router_recordroute));
@@ -1631,12 +1966,29 @@ static void _register_bgp_router(cli_cmd_t * parent)
   cmd= cli_add_cmd(group, cli_cmd("stop", cli_bgp_router_stop));
 }
 
+#ifdef HAVE_BGPDUMP
+// ----- _register_bgp_save --------------------------------------
+static void _register_bgp_save(cli_cmd_t * parent)
+{
+  cli_cmd_t * group, * cmd;
+
+  group= cli_add_cmd(parent, cli_cmd_group("save"));
+  cmd= cli_add_cmd(group, cli_cmd("rib", cli_bgp_save_rib));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
+}
+#endif /* HAVE_BGPDUMP */
+
 // ----- _register_bgp_show --------------------------------------
 static void _register_bgp_show(cli_cmd_t * parent)
 {
   cli_cmd_t * group, * cmd;
   
   group= cli_add_cmd(parent, cli_cmd_group("show"));
+  cmd= cli_add_cmd(group, cli_cmd("rib", cli_bgp_show_rib));
+  cli_add_arg(cmd, cli_arg("prefix|address|*", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("route-maps", cli_bgp_show_route_maps));
   cmd= cli_add_cmd(group, cli_cmd("routers", cli_bgp_show_routers));
   cli_add_arg(cmd, cli_arg("prefix|*", NULL));
@@ -1647,7 +1999,7 @@ static void _register_bgp_show(cli_cmd_t * parent)
 // -----[ cli_register_bgp ]-----------------------------------------
 void cli_register_bgp(cli_cmd_t * parent)
 {
-  cli_cmd_t * group;
+  cli_cmd_t * group, * cmd;
 
   group= cli_add_cmd(parent, cli_cmd_group("bgp"));
   _register_bgp_route_map(group);
@@ -1657,7 +2009,13 @@ void cli_register_bgp(cli_cmd_t * parent)
   _register_bgp_options(group);
   cli_register_bgp_topology(group);
   _register_bgp_router(group);
+#ifdef HAVE_BGPDUMP
+  _register_bgp_save(group);
+#endif /* HAVE_BGPDUMP */
   _register_bgp_show(group);
   cli_add_cmd(group, cli_cmd("clear-rib", cli_bgp_clearrib));
   cli_add_cmd(group, cli_cmd("clear-adj-rib", cli_bgp_clearadjrib));
+  cmd= cli_add_cmd(group, cli_cmd("msg-decode", cli_bgp_msg_decode));
+  cli_add_arg(cmd, cli_arg("file", NULL));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
 }
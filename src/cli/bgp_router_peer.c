@@ -33,11 +33,13 @@
 
 #include <libgds/cli_ctx.h>
 #include <libgds/cli_params.h>
+#include <libgds/str_util.h>
 
 #include <bgp/aslevel/as-level.h>
 #include <bgp/filter/filter.h>
 #include <bgp/filter/parser.h>
 #include <bgp/mrtd.h>
+#include <bgp/msg_writer.h>
 #include <bgp/peer.h>
 #include <bgp/as.h>
 #include <cli/bgp_filter.h>
@@ -102,12 +104,23 @@ static int cli_ctx_create_peer_filter(cli_ctx_t * ctx, cli_cmd_t * cmd,
     return CLI_ERROR_CTX_CREATE;
   }
 
+  // The filter might be shared with other peers: get a private
+  // instance before it is modified.
+  filter_unshare((bgp_filter_t **) *item_ref);
+
   return CLI_SUCCESS;
 }
 
 // -----[ cli_ctx_destroy_peer_filter ]------------------------------
+/**
+ * When the filter context is left, the filter is replaced by its
+ * canonical instance, so that peers with equal filters share them.
+ */
 static void cli_ctx_destroy_peer_filter(void ** item_ref)
 {
+  bgp_filter_t ** filter_ref= (bgp_filter_t **) *item_ref;
+
+  *filter_ref= filter_intern(*filter_ref);
 }
 
 // -----[ cli_peer_show_info ]---------------------------------------
@@ -182,26 +195,33 @@ static int cli_peer_nexthopself(cli_ctx_t * ctx,
 /**
  * context: {router, peer}
  * tokens: {file|-}
+ * options: {--format=text|binary|mrt}
  */
 static int cli_peer_record(cli_ctx_t * ctx,
 			   cli_cmd_t * cmd)
 {
   bgp_peer_t * peer= _peer_from_context(ctx);
   const char * arg= cli_get_arg_value(cmd, 0);
-  gds_stream_t * stream;
+  const char * opt= cli_get_opt_value(cmd, "format");
+  bgp_msg_format_t format= BGP_MSG_FORMAT_TEXT;
+  bgp_msg_writer_t * writer;
   
   /* Get filename */
   if (strcmp(arg, "-") == 0) {
-    bgp_peer_set_record_stream(peer, NULL);
+    bgp_peer_set_record_writer(peer, NULL);
   } else {
-    stream= stream_create_file(arg);
-    if (stream == NULL) {
+    if ((opt != NULL) && (bgp_msg_format_from_str(opt, &format) != 0)) {
+      cli_set_user_error(cli_get(), "invalid output format \"%s\"", opt);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    writer= bgp_msg_writer_create(arg, format, BGP_MSG_WRITER_RECORD);
+    if (writer == NULL) {
       cli_set_user_error(cli_get(), "could not open \"%s\" for writing", arg);
       return CLI_ERROR_COMMAND_FAILED;
     }
-    if (bgp_peer_set_record_stream(peer, stream) < 0) {
-      stream_destroy(&stream);
-      cli_set_user_error(cli_get(), "could not set the peer record stream");
+    if (bgp_peer_set_record_writer(peer, writer) < 0) {
+      bgp_msg_writer_destroy(&writer);
+      cli_set_user_error(cli_get(), "could not set the peer record writer");
       return CLI_ERROR_COMMAND_FAILED;
     }
   }
@@ -241,6 +261,58 @@ static int cli_peer_recv(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_peer_replay ]------------------------------------------
+/**
+ * Replay the BGP4MP UPDATE messages of a binary MRT file through a
+ * virtual peer. The messages are delivered while the simulation
+ * runs (see mrtd_binary_replay()).
+ *
+ * context: {router, peer}
+ * tokens: {mrt-file}
+ * options: {--speedup=K, --src=ADDR, --summary}
+ */
+#ifdef HAVE_BGPDUMP
+static int cli_peer_replay(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  bgp_peer_t * peer= _peer_from_context(ctx);
+  const char * filename= cli_get_arg_value(cmd, 0);
+  const char * arg;
+  net_addr_t src_addr= IP_ADDR_ANY;
+  double speedup= 1;
+  uint8_t options= 0;
+  int result;
+
+  /* Check that the peer is virtual */
+  if (!bgp_peer_flag_get(peer, PEER_FLAG_VIRTUAL)) {
+    cli_set_user_error(cli_get(), "only virtual peers can do that");
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  arg= cli_get_opt_value(cmd, "speedup");
+  if ((arg != NULL) && (str_as_double(arg, &speedup) || (speedup <= 0))) {
+    cli_set_user_error(cli_get(), "invalid speedup \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  arg= cli_get_opt_value(cmd, "src");
+  if ((arg != NULL) && str2address(arg, &src_addr)) {
+    cli_set_user_error(cli_get(), "invalid source address \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  if (cli_has_opt_value(cmd, "summary"))
+    options|= MRTD_REPLAY_OPTIONS_SUMMARY;
+
+  result= mrtd_binary_replay(peer, filename, src_addr, speedup, options);
+  if (result != MRTD_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not replay \"%s\" (%s)",
+		       filename, mrtd_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+#endif /* HAVE_BGPDUMP */
+
 // -----[ cli_peer_walton_limit ]------------------------------------
 /**
  * context: {router, peer}
@@ -477,12 +549,20 @@ void cli_register_bgp_router_peer(cli_cmd_t * parent)
 #endif /* __EXPERIMENTAL__ */
   cmd= cli_add_cmd(group, cli_cmd("record", cli_peer_record));
   cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
 #if defined __EXPERIMENTAL__ && defined __EXPERIMENTAL_WALTON__
   cmd= cli_add_cmd(group, cli_cmd("walton-limit", cli_peer_walton_limit));
   cli_add_arg(cmd, cli_arg("announce-limit", NULL));
 #endif /* __EXPERIMENTAL__ && __EXPERIMENTAL_WALTON__ */
   cmd= cli_add_cmd(group, cli_cmd("recv", cli_peer_recv));
   cli_add_arg(cmd, cli_arg("mrt-record", NULL));
+#ifdef HAVE_BGPDUMP
+  cmd= cli_add_cmd(group, cli_cmd("replay", cli_peer_replay));
+  cli_add_arg(cmd, cli_arg_file("mrt-file", NULL));
+  cli_add_opt(cmd, cli_opt("speedup=", NULL));
+  cli_add_opt(cmd, cli_opt("src=", NULL));
+  cli_add_opt(cmd, cli_opt("summary", NULL));
+#endif /* HAVE_BGPDUMP */
   cmd= cli_add_cmd(group, cli_cmd("reset", cli_peer_reset));
   cmd= cli_add_cmd(group, cli_cmd("rr-client", cli_peer_rrclient));
   cmd= cli_add_cmd(group, cli_cmd("soft-restart", cli_peer_softrestart));
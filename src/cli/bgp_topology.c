@@ -37,6 +37,7 @@
 #include <bgp/record-route.h>
 #include <bgp/aslevel/as-level.h>
 #include <bgp/aslevel/filter.h>
+#include <bgp/aslevel/solver.h>
 #include <bgp/aslevel/stat.h>
 #include <cli/common.h>
 #include <net/util.h>
@@ -301,10 +302,47 @@ static int cli_bgp_topology_install(cli_ctx_t * ctx, cli_cmd_t * cmd)
 /**
  * context: {}
  * tokens: {}
+ * options: {--solver, --per-prefix, --output=FILE, --discard}
+ *
+ * With --solver, the routes are directly computed and installed in
+ * the routers (no BGP message is exchanged). The network is then
+ * converged without running the simulator.
+ *
+ * With --per-prefix, the sessions are established and each prefix
+ * is propagated and converged (the simulator is run) separately.
+ * The routes towards each prefix are recorded in FILE (--output)
+ * and, with --discard, the prefix is then removed from the routers.
  */
 static int cli_bgp_topology_run(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
-  int result= aslevel_topo_run();
+  as_level_topo_t * topo;
+  gds_stream_t * stream= NULL;
+  const char * arg;
+  uint8_t options= 0;
+  int result;
+
+  if (cli_has_opt_value(cmd, "solver")) {
+    topo= aslevel_get_topo();
+    if (topo == NULL)
+      result= ASLEVEL_ERROR_NO_TOPOLOGY;
+    else
+      result= aslevel_solver_run(topo);
+  } else if (cli_has_opt_value(cmd, "per-prefix")) {
+    arg= cli_get_opt_value(cmd, "output");
+    if (arg != NULL) {
+      stream= stream_create_file(arg);
+      if (stream == NULL) {
+	cli_set_user_error(cli_get(), "unable to create \"%s\"", arg);
+	return CLI_ERROR_COMMAND_FAILED;
+      }
+    }
+    if (cli_has_opt_value(cmd, "discard"))
+      options|= ASLEVEL_RUN_DISCARD;
+    result= aslevel_topo_run_per_prefix(stream, options);
+    if (stream != NULL)
+      stream_destroy(&stream);
+  } else
+    result= aslevel_topo_run();
 
   if (result != ASLEVEL_SUCCESS) {
     cli_set_user_error(cli_get(), "could not run topology (%s)",
@@ -314,6 +352,50 @@ static int cli_bgp_topology_run(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_bgp_topology_solver_check ]----------------------------
+/**
+ * context: {}
+ * tokens : {}
+ * options: {--output=FILE, --verbose}
+ *
+ * Compare the routes computed by the solver with the content of the
+ * Loc-RIBs (typically after 'bgp topology run' and 'sim run').
+ */
+static int cli_bgp_topology_solver_check(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  gds_stream_t * stream= gdsout;
+  as_level_topo_t * topo= aslevel_get_topo();
+  const char * arg;
+  int result;
+
+  if (topo == NULL) {
+    cli_set_user_error(cli_get(), "no topology loaded");
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  arg= cli_get_opt_value(cmd, "output");
+  if (arg != NULL) {
+    stream= stream_create_file(arg);
+    if (stream == NULL) {
+      cli_set_user_error(cli_get(), "unable to create \"%s\"", arg);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
+  result= aslevel_solver_check(topo, stream,
+			       cli_has_opt_value(cmd, "verbose"));
+
+  if (stream != gdsout)
+    stream_destroy(&stream);
+
+  if (result != ASLEVEL_SUCCESS) {
+    cli_set_user_error(cli_get(), "check failed (%s)",
+		       aslevel_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
 // -----[ cli_bgp_topology_dump ]------------------------------------
 /**
  * context: {}
@@ -436,4 +518,12 @@ void cli_register_bgp_topology(cli_cmd_t * parent)
   cli_add_arg(cmd, cli_arg("<output>", NULL));
   */
   cmd= cli_add_cmd(group, cli_cmd("run", cli_bgp_topology_run));
+  cli_add_opt(cmd, cli_opt("solver", NULL));
+  cli_add_opt(cmd, cli_opt("per-prefix", NULL));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
+  cli_add_opt(cmd, cli_opt("discard", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("solver-check",
+				  cli_bgp_topology_solver_check));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
+  cli_add_opt(cmd, cli_opt("verbose", NULL));
 }
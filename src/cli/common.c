@@ -57,9 +57,11 @@
 #include <cli/bgp.h>
 #include <cli/common.h>
 #include <cli/net.h>
+#include <cli/script.h>
 #include <cli/sim.h>
 #include <ui/output.h>
 #include <ui/rl.h>
+#include <util/mem_stats.h>
 
 #if defined(HAVE_SETRLIMIT) || defined(HAVE_GETRLIMIT)
 # include <sys/resource.h>
@@ -512,6 +514,33 @@ int cli_show_mrt(cli_ctx_t * ctx, cli_cmd_t * cmd)
 #endif
 }
 
+// -----[ cli_show_mem ]---------------------------------------------
+/**
+ * Show the memory held by each subsystem (routes, attributes,
+ * AS-Paths, Communities, RIBs, FIBs, SPT vertices, events and
+ * messages).
+ *
+ * options: {--peak, --format=text|json}
+ */
+int cli_show_mem(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_opt_value(cmd, "format");
+  mem_stats_format_t format= MEM_STATS_FORMAT_TEXT;
+
+  if (arg != NULL) {
+    if (!strcmp(arg, "json"))
+      format= MEM_STATS_FORMAT_JSON;
+    else if (strcmp(arg, "text")) {
+      cli_set_user_error(cli_get(), "invalid format \"%s\"", arg);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
+  mem_stats_dump(gdsout, format, cli_has_opt_value(cmd, "peak"));
+  stream_flush(gdsout);
+  return CLI_SUCCESS;
+}
+
 // ----- cli_show_mem_limit -----------------------------------------
 int cli_show_mem_limit(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
@@ -721,7 +750,10 @@ static int cli_include(cli_ctx_t * ctx, cli_cmd_t * cmd)
 
   cli_get_error_details(cli_get(), &cli_error);
   line_number= cli_error.line_number;
-  result= cli_execute_stream(_main_cli, file);
+  if (cli_script_is_compiled(file))
+    result= cli_script_load(_main_cli, file);
+  else
+    result= cli_execute_stream(_main_cli, file);
   if (result != CLI_SUCCESS) {
     cli_get_error_details(cli_get(), &cli_error);
     cli_set_user_error(cli_get(), "in file \"%s\", line %d (%s)",
@@ -836,6 +868,9 @@ static void _register_show(cli_cmd_t * parent)
   cmd= cli_add_cmd(group, cli_cmd("mrt", cli_show_mrt));
   cli_add_arg(cmd, cli_arg_file("file", NULL));
   cli_add_arg(cmd, cli_arg("predicate", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("mem", cli_show_mem));
+  cli_add_opt(cmd, cli_opt("format=", NULL));
+  cli_add_opt(cmd, cli_opt("peak", NULL));
   cmd= cli_add_cmd(group, cli_cmd("mem-limit", cli_show_mem_limit));
   cmd= cli_add_cmd(group, cli_cmd("path-hash-content",
 				  cli_show_path_hash_content));
@@ -909,7 +944,7 @@ static void _register_chdir(cli_cmd_t * parent)
 }
 
 // -----[ _cli_on_error ]--------------------------------------------
-static int _cli_on_error(cli_t * cli, int result)
+int _cli_on_error(cli_t * cli, int result)
 {
   cli_dump_error(gdserr, cli);
   return (iOptionExitOnError?result:CLI_SUCCESS);
@@ -977,3 +1012,12 @@ void _cli_common_destroy()
 {
   cli_destroy(&_main_cli);
 }
+
+// -----[ _cli_common_swap ]-----------------------------------------
+void _cli_common_swap(cli_t ** cli_ref)
+{
+  cli_t * cli= _main_cli;
+
+  _main_cli= *cli_ref;
+  *cli_ref= cli;
+}
@@ -59,6 +59,10 @@ extern "C" {
   void _cli_common_init();
   // ----- _cli_destroy ---------------------------------------------
   void _cli_common_destroy();
+  // -----[ _cli_common_swap ]---------------------------------------
+  void _cli_common_swap(cli_t ** cli_ref);
+  // -----[ _cli_on_error ]------------------------------------------
+  int _cli_on_error(cli_t * cli, int result);
 
   // -----[ cli_set_param ]------------------------------------------
   void cli_set_param(const char * param, const char * value);
@@ -30,6 +30,7 @@
 
 #include <assert.h>
 #include <errno.h>
+#include <stdio.h>
 #include <string.h>
 
 #include <libgds/cli_ctx.h>
@@ -46,10 +47,13 @@
 #include <cli/net_ospf.h>
 #include <net/error.h>
 #include <net/export.h>
+#include <net/failure.h>
+#include <net/icmp.h>
 #include <net/netflow.h>
 #include <net/node.h>
 #include <net/ntf.h>
 #include <net/prefix.h>
+#include <net/state.h>
 #include <net/subnet.h>
 #include <net/igp.h>
 #include <net/igp_domain.h>
@@ -58,6 +62,7 @@
 #include <net/ospf_rt.h>
 #include <net/tm.h>
 #include <net/util.h>
+#include <net/verify.h>
 #include <ui/rl.h>
 
 #include <bgp/aslevel/types.h>
@@ -263,6 +268,15 @@ int cli_net_add_link(cli_ctx_t * ctx, cli_cmd_t * cmd)
     return CLI_ERROR_COMMAND_FAILED;
   }  
 
+  if (depth > 1) {
+    result= net_iface_set_depth(iface, depth, dir);
+    if (result != ESUCCESS) {
+      cli_set_user_error(cli_get(), "could not set link depth (%s)",
+			 network_strerror(result));
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
   return CLI_SUCCESS;
 }
 
@@ -286,6 +300,7 @@ int cli_net_add_linkptp(cli_ctx_t * ctx, cli_cmd_t * cmd)
   net_iface_t * iface;
   net_link_delay_t delay= 0;
   net_link_load_t capacity= 0;
+  uint8_t depth= 1;
 
   // Get source node
   if (str2node(arg_src, &src_node)) {
@@ -311,6 +326,15 @@ int cli_net_add_linkptp(cli_ctx_t * ctx, cli_cmd_t * cmd)
     return CLI_ERROR_COMMAND_FAILED;
   }
 
+  // Get optional link depth
+  opt= cli_get_opt_value(cmd, "depth");
+  if (opt != NULL) {
+    if (str2depth(opt, &depth)) {
+      cli_set_user_error(cli_get(), "invalid link depth \"%s\"", opt);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
   // Get optional link capacity
   opt= cli_get_opt_value(cmd, "bw");
   if (opt != NULL) {
@@ -347,6 +371,15 @@ int cli_net_add_linkptp(cli_ctx_t * ctx, cli_cmd_t * cmd)
     return CLI_ERROR_COMMAND_FAILED;
   }
 
+  if (depth > 1) {
+    result= net_iface_set_depth(iface, depth, BIDIR);
+    if (result != ESUCCESS) {
+      cli_set_user_error(cli_get(), "could not set link depth (%s)",
+			 network_strerror(result));
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
   return CLI_SUCCESS;
 }
 
@@ -433,6 +466,44 @@ int cli_net_export(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_net_save_state ]---------------------------------------
+/**
+ * context: {}
+ * tokens: {file}
+ */
+int cli_net_save_state(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * filename= cli_get_arg_value(cmd, 0);
+  net_error_t result;
+
+  result= net_state_save(network_get_default(), filename);
+  if (result != ESUCCESS) {
+    cli_set_user_error(cli_get(), "could not save state to \"%s\" (%s)",
+		       filename, network_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_net_load_state ]---------------------------------------
+/**
+ * context: {}
+ * tokens: {file}
+ */
+int cli_net_load_state(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * filename= cli_get_arg_value(cmd, 0);
+  net_error_t result;
+
+  result= net_state_load(network_get_default(), filename);
+  if (result != ESUCCESS) {
+    cli_set_user_error(cli_get(), "could not load state from \"%s\" (%s)",
+		       filename, network_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
 // ----- cli_net_ntf_load -------------------------------------------
 /**
  * context: {}
@@ -531,7 +602,7 @@ int cli_net_link_igpweight(cli_ctx_t * ctx, cli_cmd_t * cmd)
   // Get optional TOS
   opt= cli_get_opt_value(cmd, "tos");
   if (opt != NULL)
-    if (!str2tos(opt, &tos)) {
+    if (str2tos(opt, &tos)) {
       cli_set_user_error(cli_get(), "invalid TOS \"%s\"", opt);
       return CLI_ERROR_COMMAND_FAILED;
     }
@@ -765,6 +836,55 @@ int cli_net_traffic_load(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ cli_net_traffic_convert ]----------------------------------
+/**
+ * context: {}
+ * tokens : {file, bin-file}
+ */
+int cli_net_traffic_convert(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  const char * bin_arg= cli_get_arg_value(cmd, 1);
+  int result;
+
+  result= net_tm_convert(arg, bin_arg);
+  if (result != NET_TM_SUCCESS) {
+    cli_set_user_error(cli_get(),
+		       "could not convert traffic matrix \"%s\" (%s)",
+		       arg, (net_tm_strerror(result) != NULL) ?
+		       net_tm_strerror(result) : "parse error");
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_net_traffic_load_binary ]------------------------------
+/**
+ * context: {}
+ * tokens : {bin-file}
+ * options: {--summary}
+ */
+int cli_net_traffic_load_binary(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  flow_stats_t stats;
+  int result;
+
+  flow_stats_init(&stats);
+  result= net_tm_load_binary(network_get_default(), arg, &stats);
+  if (result != NET_TM_SUCCESS) {
+    cli_set_user_error(cli_get(), "could not load traffic matrix \"%s\" (%s)",
+		       arg, net_tm_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  // Get option "--summary" ?
+  if (cli_has_opt_value(cmd, "summary"))
+    flow_stats_dump(gdsout, &stats);
+
+  return CLI_SUCCESS;
+}
+
 // ----- cli_net_traffic_save ---------------------------------------
 /**
  * context: {}
@@ -794,6 +914,191 @@ int cli_net_traffic_save(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ _net_record_route_file ]-----------------------------------
+/**
+ * Trace the routes listed in a file. Each line contains a source
+ * address and a destination (address or prefix). Empty lines and
+ * lines starting with '#' are ignored.
+ */
+static int _net_record_route_file(const char * filename,
+				  uint8_t ttl, net_tos_t tos,
+				  ip_opt_t * opts)
+{
+  FILE * file;
+  char line[256], src_str[64], dst_str[64];
+  unsigned int line_number= 0;
+  net_addr_t src_addr;
+  net_node_t * node;
+  ip_dest_t dest;
+  ip_opt_t * line_opts;
+  int result= CLI_SUCCESS;
+
+  file= fopen(filename, "r");
+  if (file == NULL) {
+    cli_set_user_error(cli_get(), "unable to open file \"%s\"", filename);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  while (fgets(line, sizeof(line), file) != NULL) {
+    line_number++;
+    if (sscanf(line, "%63s %63s", src_str, dst_str) != 2) {
+      if ((sscanf(line, "%63s", src_str) != 1) || (src_str[0] == '#'))
+	continue;
+      cli_set_user_error(cli_get(), "syntax error (line %u)", line_number);
+      result= CLI_ERROR_COMMAND_FAILED;
+      break;
+    }
+    if (src_str[0] == '#')
+      continue;
+
+    if (str2address(src_str, &src_addr) ||
+	((node= network_find_node(network_get_default(), src_addr))
+	 == NULL)) {
+      cli_set_user_error(cli_get(), "invalid source \"%s\" (line %u)",
+			 src_str, line_number);
+      result= CLI_ERROR_COMMAND_FAILED;
+      break;
+    }
+    if (ip_string_to_dest(dst_str, &dest) ||
+	((dest.type != NET_DEST_ADDRESS) &&
+	 (dest.type != NET_DEST_PREFIX))) {
+      cli_set_user_error(cli_get(), "invalid destination \"%s\" (line %u)",
+			 dst_str, line_number);
+      result= CLI_ERROR_COMMAND_FAILED;
+      break;
+    }
+
+    line_opts= ip_options_copy(opts, 0);
+    if (dest.type == NET_DEST_PREFIX)
+      ip_options_alt_dest(line_opts, dest.prefix);
+    icmp_record_route(gdsout, node, IP_ADDR_ANY, dest, ttl, tos, line_opts);
+    ip_options_destroy(&line_opts);
+  }
+
+  fclose(file);
+  return result;
+}
+
+// -----[ cli_net_record_route ]-------------------------------------
+/**
+ * Trace the routes between a batch of source/destination pairs. The
+ * argument is either a file (see _net_record_route_file()) or '*',
+ * meaning the routes between all pairs of nodes (towards their
+ * identifier address).
+ *
+ * Each trace follows the routing tables directly from node to node
+ * (see icmp_walk_send()). No simulator event is scheduled. The
+ * output format is the same as that of "net node X record-route".
+ *
+ * context: {}
+ * tokens : {file|*}
+ * options: see cli_net_recordroute_opts()
+ */
+int cli_net_record_route(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  net_tos_t tos= 0;
+  uint8_t ttl= 255;
+  ip_opt_t * opts;
+  int result= CLI_SUCCESS;
+
+  opts= ip_options_create();
+  if (cli_net_recordroute_opts(cmd, opts, &ttl, &tos) != CLI_SUCCESS) {
+    ip_options_destroy(&opts);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  if (!strcmp(arg, "*"))
+    icmp_record_route_all_pairs(gdsout, network_get_default(),
+				ttl, tos, opts);
+  else
+    result= _net_record_route_file(arg, ttl, tos, opts);
+
+  ip_options_destroy(&opts);
+  return result;
+}
+
+// -----[ cli_net_failure_sweep ]------------------------------------
+/**
+ * Report the impact of each single link or node failure.
+ *
+ * context: {}
+ * tokens : {links|nodes}
+ * options: [--output=FILE]
+ */
+int cli_net_failure_sweep(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  const char * arg= cli_get_arg_value(cmd, 0);
+  gds_stream_t * stream= gdsout;
+  uint8_t type;
+  int result;
+
+  if (!strcmp(arg, "links"))
+    type= NET_FAILURE_LINKS;
+  else if (!strcmp(arg, "nodes"))
+    type= NET_FAILURE_NODES;
+  else {
+    cli_set_user_error(cli_get(), "invalid failure type \"%s\"", arg);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  arg= cli_get_opt_value(cmd, "output");
+  if (arg != NULL) {
+    stream= stream_create_file(arg);
+    if (stream == NULL) {
+      cli_set_user_error(cli_get(), "unable to create \"%s\"", arg);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
+  result= network_failure_sweep(stream, network_get_default(), type);
+
+  if (stream != gdsout)
+    stream_destroy(&stream);
+
+  if (result != ESUCCESS) {
+    cli_set_user_error(cli_get(), "failure sweep failed (%s)",
+		       network_strerror(result));
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_net_verify ]-------------------------------------------
+/**
+ * Verify the forwarding state of the whole network (forwarding
+ * loops, black holes and ECMP inconsistencies).
+ *
+ * context: {}
+ * tokens : {}
+ * options: [--output=FILE]
+ *          [--summary]
+ */
+int cli_net_verify(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  gds_stream_t * stream= gdsout;
+  net_verify_stats_t stats;
+  const char * arg;
+
+  arg= cli_get_opt_value(cmd, "output");
+  if (arg != NULL) {
+    stream= stream_create_file(arg);
+    if (stream == NULL) {
+      cli_set_user_error(cli_get(), "unable to create \"%s\"", arg);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+  }
+
+  network_verify(stream, network_get_default(), &stats);
+
+  if (cli_has_opt_value(cmd, "summary"))
+    net_verify_stats_dump(gdsout, &stats);
+
+  if (stream != gdsout)
+    stream_destroy(&stream);
+  return CLI_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -841,6 +1146,27 @@ static void _register_net_export(cli_cmd_t * parent)
   cli_add_opt(cmd, cli_opt("output=", NULL));
 }
 
+// -----[ _register_net_state ]--------------------------------------
+static void _register_net_state(cli_cmd_t * parent)
+{
+  cli_cmd_t * cmd;
+
+  cmd= cli_add_cmd(parent, cli_cmd("load-state", cli_net_load_state));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cmd= cli_add_cmd(parent, cli_cmd("save-state", cli_net_save_state));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+}
+
+// -----[ _register_net_failure_sweep ]------------------------------
+static void _register_net_failure_sweep(cli_cmd_t * parent)
+{
+  cli_cmd_t * cmd;
+
+  cmd= cli_add_cmd(parent, cli_cmd("failure-sweep", cli_net_failure_sweep));
+  cli_add_arg(cmd, cli_arg("links|nodes", NULL));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
+}
+
 // -----[ _register_net_link_show ]----------------------------------
 static void cli_register_net_link_show(cli_cmd_t * parent)
 {
@@ -863,7 +1189,7 @@ static void _register_net_link(cli_cmd_t * parent)
   cmd= cli_add_cmd(group, cli_cmd("igp-weight", cli_net_link_igpweight));
   cli_add_arg(cmd, cli_arg("weight", NULL));
   cli_add_opt(cmd, cli_opt("bidir", NULL));
-  cli_add_opt(cmd, cli_opt("tos", NULL));
+  cli_add_opt(cmd, cli_opt("tos=", NULL));
   cli_register_net_link_show(group);
 }
 
@@ -906,6 +1232,16 @@ static void _register_net_subnet(cli_cmd_t * parent)
   _register_net_subnet_show(group);
 }
 
+// -----[ _register_net_record_route ]-------------------------------
+static void _register_net_record_route(cli_cmd_t * parent)
+{
+  cli_cmd_t * cmd;
+
+  cmd= cli_add_cmd(parent, cli_cmd("record-route", cli_net_record_route));
+  cli_add_arg(cmd, cli_arg_file("file|*", NULL));
+  cli_net_recordroute_register_opts(cmd);
+}
+
 // -----[ _register_net_show ]---------------------------------------
 static void _register_net_show(cli_cmd_t * parent)
 {
@@ -923,15 +1259,30 @@ static void _register_net_traffic(cli_cmd_t * parent)
   cli_cmd_t * group, * cmd;
 
   group= cli_add_cmd(parent, cli_cmd_group("traffic"));
+  cmd= cli_add_cmd(group, cli_cmd("convert", cli_net_traffic_convert));
+  cli_add_arg(cmd, cli_arg_file("file", NULL));
+  cli_add_arg(cmd, cli_arg_file("bin-file", NULL));
   cmd= cli_add_cmd(group, cli_cmd("load", cli_net_traffic_load));
   cli_add_arg(cmd, cli_arg_file("file", NULL));
   cli_add_opt(cmd, cli_opt("src=", NULL));
   cli_add_opt(cmd, cli_opt("dst=", NULL));
   cli_add_opt(cmd, cli_opt("summary", NULL));
+  cmd= cli_add_cmd(group, cli_cmd("load-binary",
+				  cli_net_traffic_load_binary));
+  cli_add_arg(cmd, cli_arg_file("bin-file", NULL));
+  cli_add_opt(cmd, cli_opt("summary", NULL));
   cmd= cli_add_cmd(group, cli_cmd("save", cli_net_traffic_save));
   cli_add_arg(cmd, cli_arg_file("file", NULL));
 }
 
+// -----[ _register_net_verify ]-------------------------------------
+static void _register_net_verify(cli_cmd_t * parent)
+{
+  cli_cmd_t * cmd= cli_add_cmd(parent, cli_cmd("verify", cli_net_verify));
+  cli_add_opt(cmd, cli_opt("output=", NULL));
+  cli_add_opt(cmd, cli_opt("summary", NULL));
+}
+
 // -----[ cli_register_net ]-----------------------------------------
 void cli_register_net(cli_cmd_t * parent)
 {
@@ -939,13 +1290,17 @@ void cli_register_net(cli_cmd_t * parent)
   _register_net_add(group);
   cli_register_net_domain(group);
   _register_net_export(group);
+  _register_net_failure_sweep(group);
   _register_net_link(group);
   _register_net_links(group);
   _register_net_ntf(group);
   cli_register_net_node(group);
+  _register_net_record_route(group);
   _register_net_subnet(group);
   _register_net_show(group);
+  _register_net_state(group);
   _register_net_traffic(group);
+  _register_net_verify(group);
 //#ifdef OSPF_SUPPORT
 //  cli_register_net_ospf(group);
 //#endif
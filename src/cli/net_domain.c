@@ -164,12 +164,26 @@ static int cli_net_domain_show_nodes(cli_ctx_t * ctx, cli_cmd_t * cmd)
 /**
  * context: {domain}
  * tokens: {}
+ * options: [--keep-spt] [--tos=all]
  */
 static int cli_net_domain_compute(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
   igp_domain_t * domain= _igp_domain_from_context(ctx);
   int keep_spt= cli_has_opt_value(cmd, "keep-spt");
-  if (igp_domain_compute(domain, keep_spt) != CLI_SUCCESS) {
+  const char * opt= cli_get_opt_value(cmd, "tos");
+  int result;
+
+  // Compute all the TOS planes at once ?
+  if (opt != NULL) {
+    if (strcmp(opt, "all")) {
+      cli_set_user_error(cli_get(), "invalid TOS \"%s\" (expected all)", opt);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    result= igp_domain_compute_multi(domain, keep_spt);
+  } else
+    result= igp_domain_compute(domain, keep_spt);
+
+  if (result != CLI_SUCCESS) {
     cli_set_user_error(cli_get(), "IGP routes computation failed.\n");
     return CLI_ERROR_COMMAND_FAILED;
   }
@@ -228,6 +242,7 @@ void cli_register_net_domain(cli_cmd_t * parent)
   cli_add_arg(group, cli_arg("id", NULL));
   cmd= cli_cmd("compute", cli_net_domain_compute);
   cli_add_opt(cmd, cli_opt("keep-spt", NULL));
+  cli_add_opt(cmd, cli_opt("tos=", NULL));
   cli_add_cmd(group, cmd);
   /*cli_add_cmd(group, cli_cmd("links-igp-weight",
     cli_net_domain_links_igp_weight));*/
@@ -41,6 +41,7 @@
 #include <cli/net_node_iface.h>
 #include <net/error.h>
 #include <net/icmp.h>
+#include <net/igp.h>
 #include <net/igp_domain.h>
 #include <net/net_types.h>
 #include <net/netflow.h>
@@ -217,10 +218,10 @@ static int cli_net_node_ping(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
-// ----- cli_net_node_recordroute -----------------------------------
+// -----[ cli_net_recordroute_opts ]---------------------------------
 /**
- * context: {node}
- * tokens : {prefix|address|*}
+ * Parse the options of the record-route commands.
+ *
  * options: [--capacity]
  *          [--check-loop]
  *          [--deflection]
@@ -232,18 +233,11 @@ static int cli_net_node_ping(cli_ctx_t * ctx, cli_cmd_t * cmd)
  *          [--tunnel]
  *          [--weight]
  */
-static int cli_net_node_recordroute(cli_ctx_t * ctx, cli_cmd_t * cmd)
+int cli_net_recordroute_opts(cli_cmd_t * cmd, ip_opt_t * opts,
+			     uint8_t * ttl, net_tos_t * tos)
 {
-  net_node_t * node= _node_from_context(ctx);
-  const char * arg= cli_get_arg_value(cmd, 0);
   const char * opt;
-  ip_dest_t dest;
-  net_tos_t tos= 0;
-  ip_opt_t * opts;
   net_link_load_t load= 0;
-  uint8_t ttl= 255;
-
-  opts= ip_options_create();
 
   // Optional capacity ?
   if (cli_has_opt_value(cmd, "capacity"))
@@ -268,7 +262,7 @@ static int cli_net_node_recordroute(cli_ctx_t * ctx, cli_cmd_t * cmd)
   // TTL value provided ?
   opt= cli_get_opt_value(cmd, "ttl");
   if (opt != NULL) {
-    if (str2ttl(opt, &ttl)) {
+    if (str2ttl(opt, ttl)) {
       cli_set_user_error(cli_get(), "invalid TTL \"%s\"", opt);
       return CLI_ERROR_COMMAND_FAILED;
     }
@@ -291,7 +285,7 @@ static int cli_net_node_recordroute(cli_ctx_t * ctx, cli_cmd_t * cmd)
   // Perform record-route in particular plane (based on TOS) ?
   opt= cli_get_opt_value(cmd, "tos");
   if (opt != NULL)
-    if (str2tos(opt, &tos)) {
+    if (str2tos(opt, tos)) {
       cli_set_user_error(cli_get(), "invalid TOS \"%s\"", opt);
       return CLI_ERROR_COMMAND_FAILED;
     }
@@ -300,22 +294,62 @@ static int cli_net_node_recordroute(cli_ctx_t * ctx, cli_cmd_t * cmd)
   if (cli_has_opt_value(cmd, "weight"))
     ip_options_set(opts, IP_OPT_WEIGHT);
 
+  return CLI_SUCCESS;
+}
+
+// -----[ cli_net_recordroute_register_opts ]------------------------
+void cli_net_recordroute_register_opts(cli_cmd_t * cmd)
+{
+  cli_add_opt(cmd, cli_opt("capacity", NULL));
+  cli_add_opt(cmd, cli_opt("check-loop", NULL));
+  cli_add_opt(cmd, cli_opt("deflection", NULL));
+  cli_add_opt(cmd, cli_opt("delay", NULL));
+  cli_add_opt(cmd, cli_opt("ecmp", NULL));
+  cli_add_opt(cmd, cli_opt("load=", NULL));
+  cli_add_opt(cmd, cli_opt("ttl=", NULL));
+  cli_add_opt(cmd, cli_opt("tos=", NULL));
+  cli_add_opt(cmd, cli_opt("tunnel", NULL));
+  cli_add_opt(cmd, cli_opt("weight", NULL));
+}
+
+// ----- cli_net_node_recordroute -----------------------------------
+/**
+ * context: {node}
+ * tokens : {prefix|address|*}
+ * options: see cli_net_recordroute_opts()
+ */
+static int cli_net_node_recordroute(cli_ctx_t * ctx, cli_cmd_t * cmd)
+{
+  net_node_t * node= _node_from_context(ctx);
+  const char * arg= cli_get_arg_value(cmd, 0);
+  ip_dest_t dest;
+  net_tos_t tos= 0;
+  ip_opt_t * opts;
+  uint8_t ttl= 255;
+
   // Get destination address
-    if (ip_string_to_dest(arg, &dest)) {
+  if (ip_string_to_dest(arg, &dest)) {
     cli_set_user_error(cli_get(), "invalid prefix|address|* \"%s\"", arg);
     return CLI_ERROR_COMMAND_FAILED;
   }
 
-    // Check that the destination type is adress/prefix
+  // Check that the destination type is adress/prefix
   if ((dest.type != NET_DEST_ADDRESS) &&
       (dest.type != NET_DEST_PREFIX)) {
     cli_set_user_error(cli_get(), "can not use such destination");
     return CLI_ERROR_COMMAND_FAILED;
   }
 
+  opts= ip_options_create();
+  if (cli_net_recordroute_opts(cmd, opts, &ttl, &tos) != CLI_SUCCESS) {
+    ip_options_destroy(&opts);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
   if (dest.type == NET_DEST_PREFIX)
     ip_options_alt_dest(opts, dest.prefix);
   icmp_record_route(gdsout, node, IP_ADDR_ANY, dest, ttl, tos, opts);
+  ip_options_destroy(&opts);
 
   return CLI_SUCCESS;
 }
@@ -498,17 +532,51 @@ static int cli_net_node_show_links(cli_ctx_t * ctx, cli_cmd_t * cmd)
   return CLI_SUCCESS;
 }
 
+// -----[ _node_opt_tos ]---------------------------------------------
+/**
+ * Get the value of the optional "tos" option. The routes and SPT of
+ * a TOS other than 0 are only available after a multi-topology
+ * computation ("net domain X compute --tos=all").
+ */
+static int _node_opt_tos(cli_cmd_t * cmd, net_node_t * node,
+			 net_tos_t * tos)
+{
+  const char * opt= cli_get_opt_value(cmd, "tos");
+
+  *tos= 0;
+  if (opt == NULL)
+    return CLI_SUCCESS;
+  if (str2tos(opt, tos)) {
+    cli_set_user_error(cli_get(), "invalid TOS \"%s\"", opt);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  if ((*tos > 0) &&
+      ((node->igp_planes == NULL) || (*tos >= node->igp_planes->depth))) {
+    cli_set_user_error(cli_get(), "no routes computed for TOS %u", *tos);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+  return CLI_SUCCESS;
+}
+
 // -----[ cli_net_node_show_spt ]------------------------------------
 /**
  * context: {node}
  * tokens : {}
+ * options: [--output=FILE] [--tos=TOS]
  */
 static int cli_net_node_show_spt(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
   net_node_t * node= _node_from_context(ctx);
   gds_stream_t * stream= gdsout;
+  spt_t * spt= node->spt;
+  net_tos_t tos;
 
-  if (node->spt == NULL) {
+  if (_node_opt_tos(cmd, node, &tos) != CLI_SUCCESS)
+    return CLI_ERROR_COMMAND_FAILED;
+  if (tos > 0)
+    spt= node->igp_planes->spts[tos];
+
+  if (spt == NULL) {
     cli_set_user_error(cli_get(), "no SPT stored for this node");
     return CLI_ERROR_CMD_FAILED;
   }
@@ -521,7 +589,7 @@ static int cli_net_node_show_spt(cli_ctx_t * ctx, cli_cmd_t * cmd)
     }
   }
 
-  spt_to_graphviz(stream, node->spt);
+  spt_to_graphviz(stream, spt);
 
   if (stream != gdsout) {
     stream_destroy(&stream);
@@ -533,12 +601,14 @@ static int cli_net_node_show_spt(cli_ctx_t * ctx, cli_cmd_t * cmd)
 /**
  * context: {node}
  * tokens: {prefix|address|*}
+ * options: [--tos=TOS]
  */
 static int cli_net_node_show_rt(cli_ctx_t * ctx, cli_cmd_t * cmd)
 {
   net_node_t * node= _node_from_context(ctx);
   const char * arg= cli_get_arg_value(cmd, 0);
   ip_dest_t dest;
+  net_tos_t tos;
 
   // Get the prefix/address/*
   if (ip_string_to_dest(arg, &dest)) {
@@ -546,6 +616,14 @@ static int cli_net_node_show_rt(cli_ctx_t * ctx, cli_cmd_t * cmd)
     return CLI_ERROR_COMMAND_FAILED;
   }
 
+  // Dump the IGP routes of another plane ?
+  if (_node_opt_tos(cmd, node, &tos) != CLI_SUCCESS)
+    return CLI_ERROR_COMMAND_FAILED;
+  if (tos > 0) {
+    rt_dump(gdsout, node->igp_planes->rts[tos], dest);
+    return CLI_SUCCESS;
+  }
+
 #ifndef OSPF_SUPPORT
   // Dump routing table
   node_rt_dump(gdsout, node, dest);
@@ -688,9 +766,11 @@ static void _register_net_node_show(cli_cmd_t * parent)
   cmd= cli_add_cmd(group, cli_cmd("links", cli_net_node_show_links));
   cmd= cli_cmd("spt", cli_net_node_show_spt);
   cli_add_opt(cmd, cli_opt("output=", NULL));
+  cli_add_opt(cmd, cli_opt("tos=", NULL));
   cmd= cli_add_cmd(group, cmd);
   cmd= cli_add_cmd(group, cli_cmd("rt", cli_net_node_show_rt));
   cli_add_arg(cmd, cli_arg("prefix|address|*", NULL));
+  cli_add_opt(cmd, cli_opt("tos=", NULL));
 }
 
 // -----[ _register_net_node_route ]---------------------------------
@@ -746,16 +826,7 @@ void cli_register_net_node(cli_cmd_t * parent)
   cli_add_opt(cmd, cli_opt("ttl=", NULL));
   cmd= cli_add_cmd(group, cli_cmd("record-route", cli_net_node_recordroute));
   cli_add_arg(cmd, cli_arg("address|prefix", NULL));
-  cli_add_opt(cmd, cli_opt("capacity", NULL));
-  cli_add_opt(cmd, cli_opt("check-loop", NULL));
-  cli_add_opt(cmd, cli_opt("deflection", NULL));
-  cli_add_opt(cmd, cli_opt("delay", NULL));
-  cli_add_opt(cmd, cli_opt("ecmp", NULL));
-  cli_add_opt(cmd, cli_opt("load=", NULL));
-  cli_add_opt(cmd, cli_opt("ttl=", NULL));
-  cli_add_opt(cmd, cli_opt("tos=", NULL));
-  cli_add_opt(cmd, cli_opt("tunnel", NULL));
-  cli_add_opt(cmd, cli_opt("weight", NULL));
+  cli_net_recordroute_register_opts(cmd);
   cmd= cli_add_cmd(group, cli_cmd("traceroute", cli_net_node_traceroute));
   cli_add_arg(cmd, cli_arg2("addr", NULL, cli_enum_net_nodes_addr_id));
 
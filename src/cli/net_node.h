@@ -29,12 +29,20 @@
 
 #include <libgds/cli.h>
 
+#include <net/icmp_options.h>
+#include <net/net_types.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
   // -----[ cli_register_net_node ]----------------------------------
   void cli_register_net_node(cli_cmd_t * parent);
+  // -----[ cli_net_recordroute_opts ]-------------------------------
+  int cli_net_recordroute_opts(cli_cmd_t * cmd, ip_opt_t * opts,
+			       uint8_t * ttl, net_tos_t * tos);
+  // -----[ cli_net_recordroute_register_opts ]----------------------
+  void cli_net_recordroute_register_opts(cli_cmd_t * cmd);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,781 @@
+// ==================================================================
+// @(#)script.c
+//
+// Compiled (binary) CLI scripts.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgds/cli.h>
+#include <libgds/memory.h>
+#include <libgds/stream.h>
+
+#include <cli/common.h>
+#include <cli/script.h>
+#include <net/error.h>
+#include <net/iface.h>
+#include <net/igp_domain.h>
+#include <net/link.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <net/protocol.h>
+#include <net/util.h>
+#include <bgp/as.h>
+#include <ui/output.h>
+
+/** Maximum length of a line in a CLI script. */
+#define CLI_SCRIPT_MAX_LINE   4096
+/** Maximum number of tokens in a compiled command. */
+#define CLI_SCRIPT_MAX_TOKENS 16
+
+// -----[ cli_script_op_t ]------------------------------------------
+typedef enum {
+  /** Text line, executed by the CLI. */
+  CLI_SCRIPT_OP_LINE,
+  /** net add node <addr> [--no-loopback] */
+  CLI_SCRIPT_OP_NET_ADD_NODE,
+  /** net add link <src> <dst> [--bw=] [--delay=] [--depth=] */
+  CLI_SCRIPT_OP_NET_ADD_LINK,
+  /** net node <addr> domain <id> */
+  CLI_SCRIPT_OP_NET_NODE_DOMAIN,
+  /** net link <src> <dst> igp-weight [--bidir] [--tos=] <weight> */
+  CLI_SCRIPT_OP_NET_LINK_IGP_WEIGHT,
+  /** bgp add router <asn> <addr> */
+  CLI_SCRIPT_OP_BGP_ADD_ROUTER,
+  /** bgp router <addr> add peer <asn> <addr> */
+  CLI_SCRIPT_OP_BGP_ROUTER_ADD_PEER,
+  CLI_SCRIPT_OP_MAX,
+} cli_script_op_t;
+
+#define CLI_SCRIPT_FLAG_NO_LOOPBACK 0x01
+#define CLI_SCRIPT_FLAG_BIDIR       0x02
+
+// -----[ _cli_script_rec_t ]----------------------------------------
+/**
+ * Compiled command. The meaning of the addresses and values depends
+ * on the operation (see _ops).
+ */
+typedef struct {
+  uint8_t      op;
+  uint8_t      flags;
+  uint32_t     line;
+  net_addr_t   addrs[2];
+  uint32_t     values[3];
+  char       * text;
+} _cli_script_rec_t;
+
+// -----[ _ops ]-----------------------------------------------------
+/** Number of addresses and values stored for each operation. */
+static struct {
+  uint8_t num_addrs;
+  uint8_t num_values;
+} _ops[CLI_SCRIPT_OP_MAX]= {
+  { 0, 0 }, // line
+  { 1, 0 }, // net add node: node
+  { 2, 3 }, // net add link: src, dst / delay, capacity, depth
+  { 1, 1 }, // net node domain: node / domain
+  { 2, 2 }, // net link igp-weight: src, dst / weight, tos
+  { 1, 1 }, // bgp add router: node / asn
+  { 2, 1 }, // bgp router add peer: router, peer / asn
+};
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// COMPILER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _cli_script_split ]----------------------------------------
+/**
+ * Split a command into its arguments and its options (tokens that
+ * start with "--"). Return -1 if there are too many tokens.
+ */
+static inline int _cli_script_split(char * line,
+				    char ** args, unsigned int * num_args,
+				    char ** opts, unsigned int * num_opts)
+{
+  char * saveptr= NULL;
+  char * token;
+
+  *num_args= 0;
+  *num_opts= 0;
+  for (token= strtok_r(line, " \t\r\n", &saveptr); token != NULL;
+       token= strtok_r(NULL, " \t\r\n", &saveptr)) {
+    if (!strncmp(token, "--", 2)) {
+      if (*num_opts >= CLI_SCRIPT_MAX_TOKENS)
+	return -1;
+      opts[(*num_opts)++]= token+2;
+    } else {
+      if (*num_args >= CLI_SCRIPT_MAX_TOKENS)
+	return -1;
+      args[(*num_args)++]= token;
+    }
+  }
+  return 0;
+}
+
+// -----[ _cli_script_opt ]------------------------------------------
+/**
+ * Return the value of an option "--name=value" (or "" for an option
+ * without value), or NULL if the option is not present.
+ */
+static inline const char * _cli_script_opt(char ** opts,
+					   unsigned int num_opts,
+					   const char * name)
+{
+  size_t len= strlen(name);
+  unsigned int index;
+
+  for (index= 0; index < num_opts; index++) {
+    if (strncmp(opts[index], name, len))
+      continue;
+    if (opts[index][len] == '=')
+      return opts[index]+len+1;
+    if (opts[index][len] == '\0')
+      return opts[index]+len;
+  }
+  return NULL;
+}
+
+// -----[ _cli_script_check_opts ]-----------------------------------
+/**
+ * Check that all the options are in the given list (a NULL
+ * terminated array of option names).
+ */
+static inline int _cli_script_check_opts(char ** opts,
+					 unsigned int num_opts,
+					 const char ** names)
+{
+  unsigned int index;
+  const char ** name;
+  size_t len;
+
+  for (index= 0; index < num_opts; index++) {
+    for (name= names; *name != NULL; name++) {
+      len= strlen(*name);
+      if (!strncmp(opts[index], *name, len) &&
+	  ((opts[index][len] == '=') || (opts[index][len] == '\0')))
+	break;
+    }
+    if (*name == NULL)
+      return -1;
+  }
+  return 0;
+}
+
+// -----[ _cli_script_compile_line ]---------------------------------
+/**
+ * Try to compile a line of the script. Return 0 if the line could
+ * be compiled into the record, or -1 if it must be kept as text.
+ *
+ * The line is only compiled if all its arguments are valid. Invalid
+ * commands are kept as text so that their error is reported by the
+ * CLI, exactly as in the original script.
+ */
+static int _cli_script_compile_line(const char * line,
+				    _cli_script_rec_t * rec)
+{
+  static const char * add_link_opts[]= { "bw", "delay", "depth", NULL };
+  static const char * igp_weight_opts[]= { "bidir", "tos", NULL };
+  static const char * add_node_opts[]= { "no-loopback", NULL };
+  static const char * no_opts[]= { NULL };
+  char buf[CLI_SCRIPT_MAX_LINE];
+  char * args[CLI_SCRIPT_MAX_TOKENS];
+  char * opts[CLI_SCRIPT_MAX_TOKENS];
+  unsigned int num_args, num_opts;
+  const char * opt;
+  net_link_delay_t delay= 0;
+  net_link_load_t capacity= 0;
+  uint8_t depth= 1;
+  net_tos_t tos= 0;
+  igp_weight_t weight;
+  unsigned int id;
+  asn_t asn;
+
+  // Lines in a sub-context (indented), and lines that rely on
+  // quoting or parameters are left to the CLI
+  if ((*line == ' ') || (*line == '\t') ||
+      (strpbrk(line, "\"'$\\#{}") != NULL))
+    return -1;
+
+  strcpy(buf, line);
+  if (_cli_script_split(buf, args, &num_args, opts, &num_opts) < 0)
+    return -1;
+  if (num_args < 3)
+    return -1;
+
+  memset(rec, 0, sizeof(*rec));
+
+  if (!strcmp(args[0], "net")) {
+
+    if ((num_args == 4) && !strcmp(args[1], "add") &&
+	!strcmp(args[2], "node")) {
+      if (_cli_script_check_opts(opts, num_opts, add_node_opts) ||
+	  str2address(args[3], &rec->addrs[0]))
+	return -1;
+      rec->op= CLI_SCRIPT_OP_NET_ADD_NODE;
+      if (_cli_script_opt(opts, num_opts, "no-loopback") != NULL)
+	rec->flags|= CLI_SCRIPT_FLAG_NO_LOOPBACK;
+      return 0;
+    }
+
+    if ((num_args == 5) && !strcmp(args[1], "add") &&
+	!strcmp(args[2], "link")) {
+      if (_cli_script_check_opts(opts, num_opts, add_link_opts) ||
+	  str2address(args[3], &rec->addrs[0]) ||
+	  str2address(args[4], &rec->addrs[1]))
+	return -1;
+      if ((((opt= _cli_script_opt(opts, num_opts, "bw")) != NULL) &&
+	   str2capacity(opt, &capacity)) ||
+	  (((opt= _cli_script_opt(opts, num_opts, "delay")) != NULL) &&
+	   str2delay(opt, &delay)) ||
+	  (((opt= _cli_script_opt(opts, num_opts, "depth")) != NULL) &&
+	   str2depth(opt, &depth)))
+	return -1;
+      rec->op= CLI_SCRIPT_OP_NET_ADD_LINK;
+      rec->values[0]= delay;
+      rec->values[1]= capacity;
+      rec->values[2]= depth;
+      return 0;
+    }
+
+    if ((num_args == 5) && !strcmp(args[1], "node") &&
+	!strcmp(args[3], "domain")) {
+      if (_cli_script_check_opts(opts, num_opts, no_opts) ||
+	  str2address(args[2], &rec->addrs[0]) ||
+	  str2domain_id(args[4], &id))
+	return -1;
+      rec->op= CLI_SCRIPT_OP_NET_NODE_DOMAIN;
+      rec->values[0]= id;
+      return 0;
+    }
+
+    if ((num_args == 6) && !strcmp(args[1], "link") &&
+	!strcmp(args[4], "igp-weight")) {
+      if (_cli_script_check_opts(opts, num_opts, igp_weight_opts) ||
+	  str2address(args[2], &rec->addrs[0]) ||
+	  str2address(args[3], &rec->addrs[1]) ||
+	  str2weight(args[5], &weight))
+	return -1;
+      if (((opt= _cli_script_opt(opts, num_opts, "tos")) != NULL) &&
+	  str2tos(opt, &tos))
+	return -1;
+      rec->op= CLI_SCRIPT_OP_NET_LINK_IGP_WEIGHT;
+      if (_cli_script_opt(opts, num_opts, "bidir") != NULL)
+	rec->flags|= CLI_SCRIPT_FLAG_BIDIR;
+      rec->values[0]= weight;
+      rec->values[1]= tos;
+      return 0;
+    }
+
+  } else if (!strcmp(args[0], "bgp")) {
+
+    if (num_opts > 0)
+      return -1;
+
+    if ((num_args == 5) && !strcmp(args[1], "add") &&
+	!strcmp(args[2], "router")) {
+      if (str2asn(args[3], &asn) ||
+	  str2address(args[4], &rec->addrs[0]))
+	return -1;
+      rec->op= CLI_SCRIPT_OP_BGP_ADD_ROUTER;
+      rec->values[0]= asn;
+      return 0;
+    }
+
+    if ((num_args == 7) && !strcmp(args[1], "router") &&
+	!strcmp(args[3], "add") && !strcmp(args[4], "peer")) {
+      if (str2address(args[2], &rec->addrs[0]) ||
+	  str2asn(args[5], &asn) ||
+	  str2address(args[6], &rec->addrs[1]))
+	return -1;
+      rec->op= CLI_SCRIPT_OP_BGP_ROUTER_ADD_PEER;
+      rec->values[0]= asn;
+      return 0;
+    }
+
+  }
+  return -1;
+}
+
+// -----[ _cli_script_write ]----------------------------------------
+static inline int _cli_script_write(FILE * stream, const void * data,
+				    size_t size)
+{
+  return (fwrite(data, size, 1, stream) == 1)?0:-1;
+}
+
+// -----[ _cli_script_write_rec ]------------------------------------
+static int _cli_script_write_rec(FILE * stream, _cli_script_rec_t * rec)
+{
+  uint32_t len;
+
+  if (_cli_script_write(stream, &rec->op, sizeof(rec->op)) ||
+      _cli_script_write(stream, &rec->flags, sizeof(rec->flags)) ||
+      _cli_script_write(stream, &rec->line, sizeof(rec->line)) ||
+      _cli_script_write(stream, rec->addrs,
+			_ops[rec->op].num_addrs*sizeof(net_addr_t)) ||
+      _cli_script_write(stream, rec->values,
+			_ops[rec->op].num_values*sizeof(uint32_t)))
+    return -1;
+  if (rec->op == CLI_SCRIPT_OP_LINE) {
+    len= strlen(rec->text);
+    if (_cli_script_write(stream, &len, sizeof(len)) ||
+	_cli_script_write(stream, rec->text, len))
+      return -1;
+  }
+  return 0;
+}
+
+// -----[ cli_script_compile ]---------------------------------------
+int cli_script_compile(FILE * src, FILE * dst)
+{
+  char line[CLI_SCRIPT_MAX_LINE];
+  uint32_t version= CLI_SCRIPT_VERSION;
+  _cli_script_rec_t rec;
+  uint32_t line_number= 0;
+  size_t len;
+  char * ptr;
+
+  if (_cli_script_write(dst, CLI_SCRIPT_MAGIC, strlen(CLI_SCRIPT_MAGIC)) ||
+      _cli_script_write(dst, &version, sizeof(version)))
+    return -1;
+
+  while (fgets(line, sizeof(line), src) != NULL) {
+    line_number++;
+    len= strlen(line);
+    if ((len > 0) && (line[len-1] != '\n') && !feof(src)) {
+      stream_printf(gdserr, "Error: line %u is too long\n", line_number);
+      return -1;
+    }
+    while ((len > 0) && ((line[len-1] == '\n') || (line[len-1] == '\r')))
+      line[--len]= '\0';
+
+    // Skip empty lines and comments
+    for (ptr= line; (*ptr == ' ') || (*ptr == '\t'); ptr++);
+    if ((*ptr == '\0') || (*ptr == '#'))
+      continue;
+
+    if (_cli_script_compile_line(line, &rec) < 0) {
+      memset(&rec, 0, sizeof(rec));
+      rec.op= CLI_SCRIPT_OP_LINE;
+      rec.text= line;
+    }
+    rec.line= line_number;
+    if (_cli_script_write_rec(dst, &rec) < 0)
+      return -1;
+  }
+  return 0;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// LOADER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _cli_script_load_ctx_t ]-----------------------------------
+/**
+ * Handles of the node and router used by the previous record,
+ * re-used when consecutive records refer to the same address. They
+ * are forgotten after each text line since a CLI command could
+ * remove them.
+ */
+typedef struct {
+  net_addr_t     node_addr;
+  net_node_t   * node;
+  net_addr_t     router_addr;
+  bgp_router_t * router;
+} _cli_script_load_ctx_t;
+
+static unsigned int _load_depth= 0;
+static uint32_t     _load_line= 0;
+
+// -----[ _cli_script_on_error ]-------------------------------------
+/**
+ * Report an error with the line number of the failing command in
+ * the original script.
+ */
+static int _cli_script_on_error(cli_t * cli, int result)
+{
+  cli->error.line_number= _load_line;
+  return _cli_on_error(cli, result);
+}
+
+// -----[ _cli_script_node ]-----------------------------------------
+static inline net_node_t * _cli_script_node(_cli_script_load_ctx_t * ctx,
+					    net_addr_t addr)
+{
+  if ((ctx->node == NULL) || (ctx->node_addr != addr)) {
+    ctx->node= network_find_node(network_get_default(), addr);
+    ctx->node_addr= addr;
+  }
+  return ctx->node;
+}
+
+// -----[ _cli_script_router ]---------------------------------------
+static inline bgp_router_t *
+_cli_script_router(_cli_script_load_ctx_t * ctx, net_addr_t addr)
+{
+  net_node_t * node;
+  net_protocol_t * protocol;
+
+  if ((ctx->router == NULL) || (ctx->router_addr != addr)) {
+    ctx->router= NULL;
+    node= _cli_script_node(ctx, addr);
+    if (node == NULL)
+      return NULL;
+    protocol= protocols_get(node->protocols, NET_PROTOCOL_BGP);
+    if (protocol == NULL)
+      return NULL;
+    ctx->router= (bgp_router_t *) protocol->handler;
+    ctx->router_addr= addr;
+  }
+  return ctx->router;
+}
+
+// -----[ _cli_script_rec_to_string ]--------------------------------
+/**
+ * Rebuild the text of a compiled command.
+ */
+static void _cli_script_rec_to_string(_cli_script_rec_t * rec,
+				      char * buf, size_t size)
+{
+  char addr1[16], addr2[16];
+
+  ip_address_to_string(rec->addrs[0], addr1, sizeof(addr1));
+  ip_address_to_string(rec->addrs[1], addr2, sizeof(addr2));
+  switch (rec->op) {
+  case CLI_SCRIPT_OP_NET_ADD_NODE:
+    snprintf(buf, size, "net add node %s%s", addr1,
+	     (rec->flags & CLI_SCRIPT_FLAG_NO_LOOPBACK)?" --no-loopback":"");
+    break;
+  case CLI_SCRIPT_OP_NET_ADD_LINK:
+    snprintf(buf, size, "net add link %s %s --delay=%u --bw=%u --depth=%u",
+	     addr1, addr2, rec->values[0], rec->values[1], rec->values[2]);
+    break;
+  case CLI_SCRIPT_OP_NET_NODE_DOMAIN:
+    snprintf(buf, size, "net node %s domain %u", addr1, rec->values[0]);
+    break;
+  case CLI_SCRIPT_OP_NET_LINK_IGP_WEIGHT:
+    snprintf(buf, size, "net link %s %s igp-weight%s --tos=%u %u",
+	     addr1, addr2,
+	     (rec->flags & CLI_SCRIPT_FLAG_BIDIR)?" --bidir":"",
+	     rec->values[1], rec->values[0]);
+    break;
+  case CLI_SCRIPT_OP_BGP_ADD_ROUTER:
+    snprintf(buf, size, "bgp add router %u %s", rec->values[0], addr1);
+    break;
+  case CLI_SCRIPT_OP_BGP_ROUTER_ADD_PEER:
+    snprintf(buf, size, "bgp router %s add peer %u %s",
+	     addr1, rec->values[0], addr2);
+    break;
+  default:
+    abort();
+  }
+}
+
+// -----[ _cli_script_exec_rec ]-------------------------------------
+/**
+ * Execute a compiled command. The error messages are those of the
+ * corresponding CLI commands.
+ */
+static int _cli_script_exec_rec(cli_t * cli, _cli_script_load_ctx_t * ctx,
+				_cli_script_rec_t * rec)
+{
+  char addr1[16], addr2[16];
+  net_node_t * node, * dst_node;
+  bgp_router_t * router;
+  net_iface_t * iface;
+  igp_domain_t * domain;
+  ip_pfx_t prefix;
+  int result;
+
+  ip_address_to_string(rec->addrs[0], addr1, sizeof(addr1));
+  ip_address_to_string(rec->addrs[1], addr2, sizeof(addr2));
+
+  switch (rec->op) {
+
+  case CLI_SCRIPT_OP_NET_ADD_NODE:
+    result= node_create(rec->addrs[0], &node,
+			(rec->flags & CLI_SCRIPT_FLAG_NO_LOOPBACK)?
+			0:NODE_OPTIONS_LOOPBACK);
+    if (result == ESUCCESS) {
+      result= network_add_node(network_get_default(), node);
+      if (result != ESUCCESS)
+	node_destroy(&node);
+    }
+    if (result != ESUCCESS) {
+      cli_set_user_error(cli, "could not add node (%s)",
+			 network_strerror(result));
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    ctx->node_addr= rec->addrs[0];
+    ctx->node= node;
+    break;
+
+  case CLI_SCRIPT_OP_NET_ADD_LINK:
+    if ((node= _cli_script_node(ctx, rec->addrs[0])) == NULL) {
+      cli_set_user_error(cli, "could not find node \"%s\"", addr1);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    dst_node= network_find_node(network_get_default(), rec->addrs[1]);
+    if (dst_node == NULL) {
+      cli_set_user_error(cli, "tail-end \"%s\" does not exist.", addr2);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    result= net_link_create_rtr(node, dst_node, BIDIR, &iface);
+    if (result != ESUCCESS) {
+      cli_set_user_error(cli, "could not add link %s -> %s (%s)",
+			 addr1, addr2, network_strerror(result));
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    result= net_link_set_phys_attr(iface, rec->values[0], rec->values[1],
+				   BIDIR);
+    if (result != ESUCCESS) {
+      cli_set_user_error(cli, "could not set physical attributes (%s)",
+			 network_strerror(result));
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    if (rec->values[2] > 1) {
+      result= net_iface_set_depth(iface, rec->values[2], BIDIR);
+      if (result != ESUCCESS) {
+	cli_set_user_error(cli, "could not set link depth (%s)",
+			   network_strerror(result));
+	return CLI_ERROR_COMMAND_FAILED;
+      }
+    }
+    break;
+
+  case CLI_SCRIPT_OP_NET_NODE_DOMAIN:
+    if ((node= _cli_script_node(ctx, rec->addrs[0])) == NULL) {
+      cli_set_user_error(cli, "unable to find node \"%s\"", addr1);
+      return CLI_ERROR_CTX_CREATE;
+    }
+    domain= network_find_igp_domain(network_get_default(), rec->values[0]);
+    if (domain == NULL) {
+      cli_set_user_error(cli, "unknown domain \"%u\"", rec->values[0]);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    if (igp_domain_contains_router(domain, node)) {
+      cli_set_user_error(cli, "could not add to domain \"%u\"",
+			 rec->values[0]);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    igp_domain_add_router(domain, node);
+    break;
+
+  case CLI_SCRIPT_OP_NET_LINK_IGP_WEIGHT:
+    if ((node= _cli_script_node(ctx, rec->addrs[0])) == NULL) {
+      cli_set_user_error(cli, "unable to find node \"%s\"", addr1);
+      return CLI_ERROR_CTX_CREATE;
+    }
+    prefix.network= rec->addrs[1];
+    prefix.mask= 32;
+    iface= node_find_iface(node, prefix);
+    if (iface == NULL) {
+      cli_set_user_error(cli, "unable to find link %s -> %s", addr1, addr2);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    if ((rec->flags & CLI_SCRIPT_FLAG_BIDIR) &&
+	(iface->type != NET_IFACE_RTR)) {
+      cli_set_user_error(cli, ": --bidir only works with ptp links");
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    result= net_iface_set_metric(iface, rec->values[1], rec->values[0],
+				 (rec->flags & CLI_SCRIPT_FLAG_BIDIR)?1:0);
+    if (result != ESUCCESS) {
+      cli_set_user_error(cli, "cannot set metric (%s)",
+			 network_strerror(result));
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    break;
+
+  case CLI_SCRIPT_OP_BGP_ADD_ROUTER:
+    if ((node= _cli_script_node(ctx, rec->addrs[0])) == NULL) {
+      cli_set_user_error(cli, "invalid node address \"%s\"", addr1);
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    result= bgp_add_router(rec->values[0], node, NULL);
+    if (result != ESUCCESS) {
+      cli_set_user_error(cli, "could not add BGP router (%s)",
+			 network_strerror(result));
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    break;
+
+  case CLI_SCRIPT_OP_BGP_ROUTER_ADD_PEER:
+    if (_cli_script_node(ctx, rec->addrs[0]) == NULL) {
+      cli_set_user_error(cli, "invalid node id \"%s\"", addr1);
+      return CLI_ERROR_CTX_CREATE;
+    }
+    if ((router= _cli_script_router(ctx, rec->addrs[0])) == NULL) {
+      cli_set_user_error(cli, "BGP is not supported on node \"%s\"", addr1);
+      return CLI_ERROR_CTX_CREATE;
+    }
+    if (bgp_router_add_peer(router, rec->values[0], rec->addrs[1],
+			    NULL) != 0) {
+      cli_set_user_error(cli, "peer already exists");
+      return CLI_ERROR_COMMAND_FAILED;
+    }
+    break;
+
+  default:
+    abort();
+  }
+  return CLI_SUCCESS;
+}
+
+// -----[ _cli_script_read ]-----------------------------------------
+static inline int _cli_script_read(FILE * stream, void * data, size_t size)
+{
+  if (size == 0)
+    return 0;
+  return (fread(data, size, 1, stream) == 1)?0:-1;
+}
+
+// -----[ _cli_script_read_rec ]-------------------------------------
+/**
+ * Read the next record.
+ *
+ * Return value:
+ *    1  if a record was read
+ *    0  at the end of the stream
+ *   -1  if the stream is corrupted
+ */
+static int _cli_script_read_rec(FILE * stream, _cli_script_rec_t * rec,
+				char * text, size_t text_size)
+{
+  uint32_t len;
+
+  if (_cli_script_read(stream, &rec->op, sizeof(rec->op)) < 0)
+    return feof(stream)?0:-1;
+  if ((rec->op >= CLI_SCRIPT_OP_MAX) ||
+      _cli_script_read(stream, &rec->flags, sizeof(rec->flags)) ||
+      _cli_script_read(stream, &rec->line, sizeof(rec->line)) ||
+      _cli_script_read(stream, rec->addrs,
+		       _ops[rec->op].num_addrs*sizeof(net_addr_t)) ||
+      _cli_script_read(stream, rec->values,
+		       _ops[rec->op].num_values*sizeof(uint32_t)))
+    return -1;
+  if (rec->op == CLI_SCRIPT_OP_LINE) {
+    if (_cli_script_read(stream, &len, sizeof(len)) ||
+	(len >= text_size) ||
+	_cli_script_read(stream, text, len))
+      return -1;
+    text[len]= '\0';
+    rec->text= text;
+  }
+  return 1;
+}
+
+// -----[ cli_script_is_compiled ]-----------------------------------
+int cli_script_is_compiled(FILE * stream)
+{
+  char magic[sizeof(CLI_SCRIPT_MAGIC)-1];
+  int compiled;
+
+  compiled= ((fread(magic, sizeof(magic), 1, stream) == 1) &&
+	     !memcmp(magic, CLI_SCRIPT_MAGIC, sizeof(magic)));
+  rewind(stream);
+  return compiled;
+}
+
+// -----[ cli_script_load ]------------------------------------------
+int cli_script_load(cli_t * cli, FILE * stream)
+{
+  char magic[sizeof(CLI_SCRIPT_MAGIC)-1];
+  char text[CLI_SCRIPT_MAX_LINE];
+  _cli_script_load_ctx_t ctx;
+  _cli_script_rec_t rec;
+  uint32_t prev_line= _load_line;
+  uint32_t version;
+  cli_cmd_t * cmd;
+  int result= CLI_SUCCESS;
+  int status;
+
+  if (_cli_script_read(stream, magic, sizeof(magic)) ||
+      memcmp(magic, CLI_SCRIPT_MAGIC, sizeof(magic)) ||
+      _cli_script_read(stream, &version, sizeof(version)) ||
+      (version != CLI_SCRIPT_VERSION)) {
+    cli_set_user_error(cli, "invalid compiled script (version/byte order)");
+    cli->error.error= CLI_ERROR_COMMAND_FAILED;
+    cli->error.line_number= 0;
+    cli_dump_error(gdserr, cli);
+    return CLI_ERROR_COMMAND_FAILED;
+  }
+
+  if (_load_depth++ == 0)
+    cli_set_on_error(cli, _cli_script_on_error);
+
+  memset(&ctx, 0, sizeof(ctx));
+  while ((status= _cli_script_read_rec(stream, &rec,
+				       text, sizeof(text))) > 0) {
+    _load_line= rec.line;
+
+    // Compiled commands are relative to the root context. In a
+    // sub-context, their text is handed to the CLI.
+    if (rec.op != CLI_SCRIPT_OP_LINE) {
+      cli_get_cmd_context(cli, &cmd, NULL);
+      if (cmd != cli_get_root_cmd(cli)) {
+	_cli_script_rec_to_string(&rec, text, sizeof(text));
+	rec.op= CLI_SCRIPT_OP_LINE;
+	rec.text= text;
+      }
+    }
+
+    if (rec.op == CLI_SCRIPT_OP_LINE) {
+      result= cli_execute_line(cli, rec.text);
+      memset(&ctx, 0, sizeof(ctx));
+    } else {
+      result= _cli_script_exec_rec(cli, &ctx, &rec);
+      if (result != CLI_SUCCESS) {
+	cli->error.error= result;
+	result= _cli_script_on_error(cli, result);
+      }
+    }
+    if (result != CLI_SUCCESS)
+      break;
+  }
+  if (status < 0) {
+    cli_set_user_error(cli, "corrupted compiled script");
+    cli->error.error= CLI_ERROR_COMMAND_FAILED;
+    _cli_script_on_error(cli, CLI_ERROR_COMMAND_FAILED);
+    result= CLI_ERROR_COMMAND_FAILED;
+  }
+
+  if (--_load_depth == 0)
+    cli_set_on_error(cli, _cli_on_error);
+  _load_line= prev_line;
+  return result;
+}
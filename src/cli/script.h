@@ -0,0 +1,103 @@
+// ==================================================================
+// @(#)script.h
+//
+// Compiled (binary) CLI scripts.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+/**
+ * \file
+ * Provide a compiler that turns a CLI script into a compact binary
+ * command stream, and the matching loader.
+ *
+ * The commands that dominate large generated configurations
+ * ("net add node", "net add link", "net node X domain",
+ * "net link X Y igp-weight", "bgp add router" and
+ * "bgp router X add peer") are parsed once, at compile time, into
+ * records that hold their arguments in binary form. Loading such a
+ * record calls the network / BGP functions directly, without going
+ * through the CLI tokenizer and command tree, and re-uses the node
+ * and router of the previous record when they are the same. All the
+ * other lines are stored as text and executed by the CLI.
+ *
+ * Each record holds the line number of the command in the original
+ * script, which is used to report errors.
+ *
+ * The records are stored in native byte order. A compiled script
+ * can only be loaded on a host with the same byte order.
+ */
+
+#ifndef __CLI_SCRIPT_H__
+#define __CLI_SCRIPT_H__
+
+#include <stdio.h>
+
+#include <libgds/cli.h>
+
+/** Magic number at the beginning of a compiled script. */
+#define CLI_SCRIPT_MAGIC   "CBGP-CBC"
+/** Version of the compiled script format. */
+#define CLI_SCRIPT_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ cli_script_compile ]-------------------------------------
+  /**
+   * Compile a CLI script.
+   *
+   * \param src    is the stream of the CLI script.
+   * \param dst    is the stream of the compiled script.
+   * \retval 0 in case of success,
+   *   or < 0 in case of error (write failure).
+   */
+  int cli_script_compile(FILE * src, FILE * dst);
+
+  // -----[ cli_script_is_compiled ]---------------------------------
+  /**
+   * Tell if a stream contains a compiled script. The stream is
+   * rewound to its beginning.
+   */
+  int cli_script_is_compiled(FILE * stream);
+
+  // -----[ cli_script_load ]----------------------------------------
+  /**
+   * Execute a compiled script.
+   *
+   * Errors are reported as for a CLI script, with the line number
+   * of the failing command in the original script.
+   *
+   * \param cli    is the CLI the text lines are executed with.
+   * \param stream is the stream of the compiled script.
+   * \retval CLI_SUCCESS in case of success,
+   *   or the CLI error code of the failing command.
+   */
+  int cli_script_load(cli_t * cli, FILE * stream);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __CLI_SCRIPT_H__ */
@@ -478,7 +478,7 @@ int process_mrtd_table_dump_v2_peer_index_table(struct mstream *s,BGPDUMP_ENTRY
 	    read_asn(s, &t->entries[i].peer_as, 2);
 	  
 	}
-	return 0;
+	return 1;
 }
 
 
@@ -507,6 +507,12 @@ int process_mrtd_table_dump_v2_ipv4_unicast(struct mstream *s, BGPDUMP_ENTRY *en
 		e = &prefixdata->entries[i];
 
 		mstream_getw(s, &e->peer_index);
+		if((table_dump_v2_peer_index_table == NULL) ||
+		   (e->peer_index >= table_dump_v2_peer_index_table->peer_count)) {
+		    syslog(LOG_ERR, "process_mrtd_table_dump_v2_ipv4_unicast: invalid peer index %d", e->peer_index);
+		    prefixdata->entry_count = i;
+		    return 0;
+		}
 		e->peer = &table_dump_v2_peer_index_table->entries[e->peer_index];
 		mstream_getl(s, &e->originated_time);
 
@@ -64,7 +64,7 @@ Original Author: Dan Ardelean (dan@ripe.net)
 
 struct mstream {
     u_char	*start;
-    u_int16_t	position;
+    u_int32_t	position;
     u_int32_t	len;
 };
 
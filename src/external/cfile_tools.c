@@ -55,6 +55,10 @@ const char * cfr_extensions[CFR_NUM_FORMATS] = {
 };
 
 
+// Size of the input buffers. Large buffers reduce the number of
+// read system calls (and zlib refills) on multi-GB dumps.
+#define CFR_BUFFER_SIZE (1 << 20)
+
 // Prototypes of non API functions (don't use these from outside this file)
 const char * _cfr_compressor_strerror(int format, int err);
 const char * _bz2_strerror(int err);
@@ -124,6 +128,7 @@ CFRFILE *cfr_open(const char *path) {
 	free(retval);
         return(NULL);
       }
+      setvbuf(in, NULL, _IOFBF, CFR_BUFFER_SIZE);
       retval->data1 = in;
       return(retval);
     }
@@ -143,6 +148,7 @@ CFRFILE *cfr_open(const char *path) {
         free(retval);
         return(NULL);
       }
+      setvbuf(in, NULL, _IOFBF, CFR_BUFFER_SIZE);
       retval->data1 = in;
       
       // bzip2ify file
@@ -169,6 +175,9 @@ CFRFILE *cfr_open(const char *path) {
 		free(retval);
 		return (NULL);
     	}
+#if defined(ZLIB_VERNUM) && (ZLIB_VERNUM >= 0x1240)
+	gzbuffer((gzFile) f, CFR_BUFFER_SIZE);
+#endif
         retval->data2 = f;
 	return (retval);
    }
@@ -523,6 +532,193 @@ const char * cfr_compressor_str(CFRFILE *stream) {
 }
 
 
+CFWFILE *cfw_open(const char *path) {
+  /*******************************/
+  // Analog to 'fopen'. Opens a file for writing. The output is
+  // compressed when the file name ends with the extension of a
+  // supported compressor.
+  // Note: Returns NULL in case of error.
+
+  int format, ext_len, name_len;
+  CFWFILE * retval = NULL;
+
+  if (path == NULL) return(NULL);
+
+  // determine file format
+  name_len = strlen(path);
+  format = 2;  // skip specials 0, 1 
+  while (format < CFR_NUM_FORMATS) {
+    ext_len = strlen(cfr_extensions[format]);
+    if ((name_len >= ext_len) &&
+	(strncmp(cfr_extensions[format],
+		 path+(name_len-ext_len),
+		 ext_len) == 0)
+        ) break;
+    format ++;
+  }
+  if (format >= CFR_NUM_FORMATS) 
+	format = 1;  // uncompressed 
+
+  retval = (CFWFILE *) calloc(1,sizeof(CFWFILE));
+  retval->format = format;
+
+  switch (format) {
+  case 1:  // uncompressed
+    { 
+      FILE * out;
+      out = fopen(path,"w");
+      if (out == NULL) { 
+	free(retval);
+        return(NULL);
+      }
+      setvbuf(out, NULL, _IOFBF, CFR_BUFFER_SIZE);
+      retval->data1 = out;
+      return(retval);
+    }
+    break;
+#ifndef DONT_HAVE_BZ2
+  case 2:  // bzip2
+    { 
+      int bzerror;
+      BZFILE * bzout;
+      FILE * out;
+      
+      out = fopen(path,"w");
+      if (out == NULL) { 
+        free(retval);
+        return(NULL);
+      }
+      setvbuf(out, NULL, _IOFBF, CFR_BUFFER_SIZE);
+      retval->data1 = out;
+      
+      bzout = BZ2_bzWriteOpen( &bzerror, out, 9, 0, 0); 
+      if (bzerror != BZ_OK) {
+        errno = bzerror;
+        BZ2_bzWriteClose( &bzerror, bzout, 1, NULL, NULL);
+        fclose(out);
+	free(retval);
+        return(NULL);
+      }
+      retval->data2 = bzout;
+      return(retval);
+    }
+    break;
+#endif
+#ifndef DONT_HAVE_GZ
+  case 3:  // gzip
+    { 
+      gzFile f;
+      f = gzopen(path, "wb");
+      if (f == NULL) {
+	free(retval);
+	return (NULL);
+      }
+#if defined(ZLIB_VERNUM) && (ZLIB_VERNUM >= 0x1240)
+      gzbuffer(f, CFR_BUFFER_SIZE);
+#endif
+      retval->data2 = f;
+      return (retval);
+    }
+    break;
+#endif
+  default:  // this is an internal error, no diag yet.
+    fprintf(stderr,"illegal format '%d' in cfw_open!\n", format);
+    exit(1);
+  }
+  return NULL;
+}
+
+
+
+int cfw_close(CFWFILE *stream) {
+  /**************************/
+  // Analog to 'fclose'. Flushes the compressor and frees the
+  // handle, even in case of error.
+  
+  int retval = -1;
+  if (stream == NULL) return(-1);
+
+  switch (stream->format) {
+  case 1:  // uncompressed
+    retval = fclose((FILE *)(stream->data1));
+    break;
+#ifndef DONT_HAVE_BZ2
+  case 2: // bzip2
+    { 
+      int bzerror = BZ_OK;
+      BZ2_bzWriteClose( &bzerror, (BZFILE *) (stream->data2), 0, NULL, NULL);
+      retval = fclose((FILE *)(stream->data1));
+      if (bzerror != BZ_OK)
+        retval = -1;
+    }
+    break;
+#endif
+#ifndef DONT_HAVE_GZ
+  case 3:  // gzip
+    retval = (gzclose((gzFile) stream->data2) == Z_OK)?0:-1;
+    break;
+#endif
+  default:  // this is an internal error, no diag yet.
+    fprintf(stderr,"illegal format '%d' in cfw_close!\n",stream->format);
+    exit(1);
+  }
+  free(stream);
+  return(retval);
+}
+
+
+
+size_t cfw_write(const void *ptr, size_t size, size_t nmemb,
+		 CFWFILE *stream) {
+  /**************************/
+  // Analog to fwrite. Returns the number of items written.
+
+  size_t bytes;
+
+  if (stream == NULL) return(0);
+  if ((size == 0) || (nmemb == 0)) return(0);
+  if (stream->error1 || stream->error2) return(0);
+  bytes = size * nmemb;
+
+  switch (stream->format) {
+  case 1:  // uncompressed
+    {
+      size_t written = fwrite(ptr, size, nmemb, (FILE *)(stream->data1));
+      if (written != nmemb)
+        stream->error1 = errno;
+      return(written);
+    }
+    break;
+#ifndef DONT_HAVE_BZ2
+  case 2: // bzip2
+    {
+      int bzerror;
+      BZ2_bzWrite( &bzerror, (BZFILE *) (stream->data2), (void *) ptr, bytes);
+      if (bzerror != BZ_OK) {
+        stream->error2 = bzerror;
+        return(0);
+      }
+      return(nmemb);
+    }
+    break;
+#endif
+#ifndef DONT_HAVE_GZ
+  case 3:  // gzip
+    if (gzwrite((gzFile) stream->data2, ptr, bytes) != (int) bytes) {
+      stream->error2 = -1;
+      return(0);
+    }
+    return(nmemb);
+    break;
+#endif
+  default:  // this is an internal error, no diag yet.
+    fprintf(stderr,"illegal format '%d' in cfw_write!\n",stream->format);
+    exit(1);
+  }
+  return(0);
+}
+
+
 // Utility functions for compressor errors. 
 // * Not part of the API, do not call directly as they may change! *
 
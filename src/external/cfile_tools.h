@@ -15,6 +15,7 @@
 
   Function prefixes are: 
      cfr_ = compressed file read   
+     cfw_ = compressed file write
 
   Supported:
   Reading: 
@@ -23,6 +24,11 @@
   - no compression
   - bzip2  
   - gzip
+  Writing:
+  - type recognition from file name extension 
+  - no compression
+  - bzip2  
+  - gzip
 
   $Revision: 1.1 $ $Date: 2008-01-25 11:27:33 $
 */
@@ -60,6 +66,9 @@ typedef struct _CFRFILE {
                       // further reading returns error and not eof.
 } CFRFILE;
 
+// Files opened for writing use the same handle
+typedef CFRFILE CFWFILE;
+
 // Formats
 
 #ifndef DONT_HAVE_BZ2
@@ -84,6 +93,11 @@ int          cfr_error(CFRFILE *stream);
 char       * cfr_strerror(CFRFILE *stream);
 const char * cfr_compressor_str(CFRFILE *stream);
 
+CFWFILE    * cfw_open(const char *path);
+int          cfw_close(CFWFILE *stream);
+size_t       cfw_write(const void *ptr, size_t size, size_t nmemb,
+		       CFWFILE *stream);
+
 #ifndef DONT_HAVE_BZ2
 const char * _bz2_strerror(int err);
 #endif
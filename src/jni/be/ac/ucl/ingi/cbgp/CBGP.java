@@ -28,6 +28,7 @@
 
 package be.ac.ucl.ingi.cbgp; 
 
+import java.nio.ByteBuffer;
 import java.util.Vector;
 
 import be.ac.ucl.ingi.cbgp.bgp.Domain;
@@ -340,6 +341,31 @@ public class CBGP {
     public native Vector<Interface> netGetLinks()
     	throws CBGPException;
 
+    // -----[ netGetLinkLoadsBuffer ]--------------------------------
+    /**
+     * Writes the capacity and load of all the links of the network
+     * into a direct ByteBuffer (see ByteBuffer.allocateDirect), in
+     * the native byte order. Each record is 20 bytes long and laid
+     * out as follows:
+     * <pre>
+     *   offset  size  field
+     *        0     4  node address
+     *        4     4  interface address
+     *        8     1  interface mask
+     *        9     1  interface type
+     *       10     1  enabled (0 or 1)
+     *       11     1  reserved
+     *       12     4  capacity
+     *       16     4  load
+     * </pre>
+     *
+     * @param buffer the destination buffer
+     * @return the number of bytes written, or the opposite of the
+     *         required buffer size if the buffer is too small
+     */
+    public native synchronized int netGetLinkLoadsBuffer(ByteBuffer buffer)
+    	throws CBGPException;
+
     
     ////////////////////////////////////////////////////////////////
     //
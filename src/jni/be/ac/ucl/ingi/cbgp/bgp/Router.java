@@ -26,6 +26,7 @@
 
 package be.ac.ucl.ingi.cbgp.bgp; 
 
+import java.nio.ByteBuffer;
 import java.util.Vector;
 
 import be.ac.ucl.ingi.cbgp.CBGP;
@@ -150,6 +151,49 @@ public class Router extends ProxyObject {
 		boolean in)
 		throws CBGPException, InvalidDestinationException;
 
+    // -----[ getRIBBuffer ]-----------------------------------------
+    /**
+     * Writes the content of the Loc-RIB into a direct ByteBuffer
+     * (see ByteBuffer.allocateDirect). This avoids the creation of
+     * a Route object per route for large RIBs.
+     *
+     * The records are written from the start of the buffer, in the
+     * native byte order (see ByteOrder.nativeOrder). Each record is
+     * laid out as follows:
+     * <pre>
+     *   offset  size  field
+     *        0     4  prefix network
+     *        4     1  prefix mask
+     *        5     1  origin (0:IGP, 1:EGP, 2:INCOMPLETE)
+     *        6     2  flags (best, feasible, ...)
+     *        8     4  next-hop
+     *       12     4  peer address (0 for a local route)
+     *       16     4  local-pref
+     *       20     4  med
+     *       24     2  path length (N)
+     *       26     2  number of communities (M)
+     *       28   4*N  AS-path, from the neighbor AS to the origin AS
+     *   28+4*N   4*M  communities
+     * </pre>
+     *
+     * @param buffer the destination buffer
+     * @return the number of bytes written, or the opposite of the
+     *         required buffer size if the buffer is too small (in
+     *         which case the buffer content is incomplete)
+     */
+    public native int getRIBBuffer(ByteBuffer buffer)
+		throws CBGPException;
+
+    // -----[ getAdjRIBBuffer ]--------------------------------------
+    /**
+     * Writes the content of the Adj-RIB-In (or Adj-RIB-Out) of a
+     * peer into a direct ByteBuffer. The records have the same
+     * layout as those of getRIBBuffer.
+     */
+    public native int getAdjRIBBuffer(String peer, boolean in,
+		ByteBuffer buffer)
+		throws CBGPException;
+
     // -----[ loadRib ]----------------------------------------------
     public native void loadRib(String fileName, boolean force, String type)
 		throws CBGPException;
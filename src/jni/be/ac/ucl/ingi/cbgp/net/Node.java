@@ -26,6 +26,7 @@
 
 package be.ac.ucl.ingi.cbgp.net; 
 
+import java.nio.ByteBuffer;
 import java.util.Vector;
 
 import be.ac.ucl.ingi.cbgp.CBGP;
@@ -211,6 +212,30 @@ public class Node extends Element {
     public native synchronized Vector<IPRoute> getRT(String sPrefix)
 		throws CBGPException;
 
+    // -----[ getRTBuffer ]------------------------------------------
+    /**
+     * Writes the content of the routing table of this node into a
+     * direct ByteBuffer (see ByteBuffer.allocateDirect), one record
+     * per next-hop, in the native byte order. Each record is 20
+     * bytes long and laid out as follows:
+     * <pre>
+     *   offset  size  field
+     *        0     4  prefix network
+     *        4     1  prefix mask
+     *        5     1  route type (see IPRoute)
+     *        6     2  reserved
+     *        8     4  metric
+     *       12     4  gateway
+     *       16     4  outgoing interface address
+     * </pre>
+     *
+     * @param buffer the destination buffer
+     * @return the number of bytes written, or the opposite of the
+     *         required buffer size if the buffer is too small
+     */
+    public native synchronized int getRTBuffer(ByteBuffer buffer)
+		throws CBGPException;
+
     // -----[ addRoute ]---------------------------------------------
     /**
      * Add a static route to this node.
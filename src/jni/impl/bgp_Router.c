@@ -39,6 +39,7 @@
 #include <jni/impl/net_Node.h>
 
 #include <bgp/as.h>
+#include <bgp/attr/path.h>
 #include <bgp/rib.h>
 #include <bgp/route.h>
 #include <bgp/route-input.h>
@@ -459,6 +460,118 @@ JNIEXPORT jobject JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Router_getAdjRIB
   return_jni_unlock(jEnv, joVector);
 }
 
+// -----[ _cbgp_jni_put_rib_route ]----------------------------------
+/**
+ * Append a BGP route to a bulk transfer buffer. The record layout
+ * is documented in bgp.Router.getRIBBuffer().
+ */
+static int _cbgp_jni_put_rib_route(uint32_t uKey, uint8_t uKeyLen,
+				   void * pItem, void * pContext)
+{
+  jni_buffer_t * buffer= (jni_buffer_t *) pContext;
+  bgp_route_t * route= (bgp_route_t *) pItem;
+  bgp_comms_t * comms= route->attr->comms;
+  unsigned int num_comms= ((comms != NULL)?comms->num:0);
+  unsigned int index;
+  int path_len= path_to_array(route->attr->path_ref, NULL, 0);
+
+  jni_buffer_put_u32(buffer, route->prefix.network);
+  jni_buffer_put_u8(buffer, route->prefix.mask);
+  jni_buffer_put_u8(buffer, route->attr->origin);
+  jni_buffer_put_u16(buffer, route->flags);
+  jni_buffer_put_u32(buffer, route->attr->next_hop);
+  jni_buffer_put_u32(buffer, ((route->peer != NULL)?route->peer->addr:0));
+  jni_buffer_put_u32(buffer, route->attr->local_pref);
+  jni_buffer_put_u32(buffer, route->attr->med);
+  jni_buffer_put_u16(buffer, path_len);
+  jni_buffer_put_u16(buffer, num_comms);
+
+  // The AS-Path is flattened in place when it fits
+  if (buffer->offset + (jlong) (path_len * sizeof(uint32_t)) <=
+      buffer->capacity)
+    path_to_array(route->attr->path_ref,
+		  (uint32_t *) (buffer->data + buffer->offset), path_len);
+  buffer->offset+= (jlong) (path_len * sizeof(uint32_t));
+
+  for (index= 0; index < num_comms; index++)
+    jni_buffer_put_u32(buffer, comms->values[index]);
+  return 0;
+}
+
+// -----[ getRIBBuffer ]---------------------------------------------
+/*
+ * Class:     be_ac_ucl_ingi_cbgp_bgp_Router
+ * Method:    getRIBBuffer
+ * Signature: (Ljava/nio/ByteBuffer;)I
+ *
+ * This function writes the content of the router's RIB into a
+ * direct ByteBuffer, without creating a Java object per route.
+ */
+JNIEXPORT jint JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Router_getRIBBuffer
+  (JNIEnv * jEnv, jobject joRouter, jobject joBuffer)
+{
+  bgp_router_t * router;
+  jni_buffer_t buffer;
+
+  jni_lock(jEnv);
+
+  /* Get the router instance */
+  router= (bgp_router_t *) jni_proxy_lookup(jEnv, joRouter);
+  if (router == NULL)
+    return_jni_unlock(jEnv, 0);
+
+  if (jni_buffer_init(jEnv, joBuffer, &buffer) < 0)
+    return_jni_unlock(jEnv, 0);
+
+  rib_for_each(router->loc_rib, _cbgp_jni_put_rib_route, &buffer);
+
+  return_jni_unlock(jEnv, jni_buffer_result(jEnv, &buffer));
+}
+
+// -----[ getAdjRIBBuffer ]------------------------------------------
+/*
+ * Class:     be_ac_ucl_ingi_cbgp_bgp_Router
+ * Method:    getAdjRIBBuffer
+ * Signature: (Ljava/lang/String;ZLjava/nio/ByteBuffer;)I
+ *
+ * This function writes the content of the Adj-RIB-In (or
+ * Adj-RIB-Out) of a peer into a direct ByteBuffer. The records have
+ * the same layout as those of getRIBBuffer().
+ */
+JNIEXPORT jint JNICALL Java_be_ac_ucl_ingi_cbgp_bgp_Router_getAdjRIBBuffer
+  (JNIEnv * jEnv, jobject joRouter, jstring jsPeerAddr, jboolean bIn,
+   jobject joBuffer)
+{
+  bgp_router_t * router;
+  net_addr_t tPeerAddr;
+  bgp_peer_t * peer;
+  jni_buffer_t buffer;
+
+  jni_lock(jEnv);
+
+  /* Get the router instance */
+  router= (bgp_router_t *) jni_proxy_lookup(jEnv, joRouter);
+  if (router == NULL)
+    return_jni_unlock(jEnv, 0);
+
+  /* Convert the peer address */
+  if (jni_check_null(jEnv, jsPeerAddr) ||
+      (ip_jstring_to_address(jEnv, jsPeerAddr, &tPeerAddr) != 0))
+    return_jni_unlock(jEnv, 0);
+  if ((peer= bgp_router_find_peer(router, tPeerAddr)) == NULL) {
+    throw_CBGPException(jEnv, "unknown peer");
+    return_jni_unlock(jEnv, 0);
+  }
+
+  if (jni_buffer_init(jEnv, joBuffer, &buffer) < 0)
+    return_jni_unlock(jEnv, 0);
+
+  rib_for_each(peer->adj_rib[(bIn==JNI_TRUE)?RIB_IN:RIB_OUT],
+	       _cbgp_jni_put_rib_route, &buffer);
+
+  return_jni_unlock(jEnv, jni_buffer_result(jEnv, &buffer));
+}
+
 // -----[ _get_networks ]--------------------------------------------
 static int _get_networks(const void * item, const void * ctx)
 {
@@ -667,6 +667,63 @@ JNIEXPORT jobject JNICALL Java_be_ac_ucl_ingi_cbgp_net_Node_getRT
   return_jni_unlock(jEnv, joVector);
 }
 
+// -----[ _cbgp_jni_put_rt_route ]-----------------------------------
+/**
+ * Append a route to a bulk transfer buffer, one record per
+ * next-hop. The record layout is documented in
+ * net.Node.getRTBuffer().
+ */
+static int _cbgp_jni_put_rt_route(uint32_t key, uint8_t key_len,
+				  void * pItem, void * pContext)
+{
+  jni_buffer_t * buffer= (jni_buffer_t *) pContext;
+  rt_info_t * rtinfo= (rt_info_t *) pItem;
+  const rt_entry_t * entry;
+  unsigned int index;
+
+  for (index= 0; index < rt_entries_size(rtinfo->entries); index++) {
+    entry= rt_entries_get_at(rtinfo->entries, index);
+    jni_buffer_put_u32(buffer, rtinfo->prefix.network);
+    jni_buffer_put_u8(buffer, rtinfo->prefix.mask);
+    jni_buffer_put_u8(buffer, rtinfo->type);
+    jni_buffer_put_u16(buffer, 0);
+    jni_buffer_put_u32(buffer, rtinfo->metric);
+    jni_buffer_put_u32(buffer, entry->gateway);
+    jni_buffer_put_u32(buffer, ((entry->oif != NULL)?entry->oif->addr:0));
+  }
+  return 0;
+}
+
+// -----[ getRTBuffer ]----------------------------------------------
+/*
+ * Class:     be_ac_ucl_ingi_cbgp_net_Node
+ * Method:    getRTBuffer
+ * Signature: (Ljava/nio/ByteBuffer;)I
+ *
+ * This function writes the content of the node's routing table into
+ * a direct ByteBuffer, without creating a Java object per route.
+ */
+JNIEXPORT jint JNICALL Java_be_ac_ucl_ingi_cbgp_net_Node_getRTBuffer
+  (JNIEnv * jEnv, jobject joNode, jobject joBuffer)
+{
+  net_node_t * node;
+  jni_buffer_t buffer;
+
+  jni_lock(jEnv);
+
+  /* Get the node */
+  node= (net_node_t*) jni_proxy_lookup(jEnv, joNode);
+  if (node == NULL)
+    return_jni_unlock(jEnv, 0);
+
+  if (jni_buffer_init(jEnv, joBuffer, &buffer) < 0)
+    return_jni_unlock(jEnv, 0);
+
+  rt_for_each(node->rt, _cbgp_jni_put_rt_route, &buffer);
+
+  return_jni_unlock(jEnv, jni_buffer_result(jEnv, &buffer));
+}
+
 // -----[ hasProtocol ]----------------------------------------------
 /*
  * Class:     be_ac_ucl_ingi_cbgp_net_Node
@@ -65,6 +65,7 @@
 #include <jni/impl/net_Subnet.h>
 
 #include <net/error.h>
+#include <net/iface.h>
 #include <net/igp.h>
 #include <net/link-list.h>
 #include <net/network.h>
@@ -1160,6 +1161,55 @@ JNIEXPORT jobject JNICALL Java_be_ac_ucl_ingi_cbgp_CBGP_netGetLinks
 }
 
 
+// -----[ netGetLinkLoadsBuffer ]------------------------------------
+/*
+ * Class:     be_ac_ucl_ingi_cbgp_CBGP
+ * Method:    netGetLinkLoadsBuffer
+ * Signature: (Ljava/nio/ByteBuffer;)I
+ *
+ * This function writes the capacity and load of all the interfaces
+ * of the network into a direct ByteBuffer, without creating a Java
+ * object per interface. The loopback and virtual interfaces are
+ * skipped, as in netGetLinks().
+ */
+JNIEXPORT jint JNICALL Java_be_ac_ucl_ingi_cbgp_CBGP_netGetLinkLoadsBuffer
+  (JNIEnv * env, jobject joCBGP, jobject joBuffer)
+{
+  gds_enum_t * nodes;
+  net_node_t * node;
+  net_iface_t * iface;
+  unsigned int index;
+  jni_buffer_t buffer;
+
+  jni_lock(env);
+
+  if (jni_buffer_init(env, joBuffer, &buffer) < 0)
+    return_jni_unlock(env, 0);
+
+  nodes= trie_get_enum(network_get_default()->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    for (index= 0; index < net_ifaces_size(node->ifaces); index++) {
+      iface= node->ifaces->data[index];
+      if ((iface->type == NET_IFACE_LOOPBACK) ||
+	  (iface->type == NET_IFACE_VIRTUAL))
+	continue;
+      jni_buffer_put_u32(&buffer, node->rid);
+      jni_buffer_put_u32(&buffer, iface->addr);
+      jni_buffer_put_u8(&buffer, iface->mask);
+      jni_buffer_put_u8(&buffer, iface->type);
+      jni_buffer_put_u8(&buffer, net_iface_is_enabled(iface));
+      jni_buffer_put_u8(&buffer, 0);
+      jni_buffer_put_u32(&buffer, net_iface_get_capacity(iface));
+      jni_buffer_put_u32(&buffer, net_iface_get_load(iface));
+    }
+  }
+  enum_destroy(&nodes);
+
+  return_jni_unlock(env, jni_buffer_result(env, &buffer));
+}
+
+
 /////////////////////////////////////////////////////////////////////
 //
 // CBGP STATIC METHODS
@@ -48,6 +48,8 @@ jobject get_Global_CBGP();
 //#define DEBUG_PROXIES
 
 #define JNI_PROXY_HASH_SIZE 1000
+/** Average number of proxies per bucket before the tables grow. */
+#define JNI_PROXY_HASH_LOAD 4
 
 #define CLASS_ProxyObject "be/ac/ucl/ingi/cbgp/ProxyObject"
 #define METHOD_ProxyObject_getCBGP "()Lbe/ac/ucl/ingi/cbgp/CBGP;"
@@ -56,6 +58,9 @@ static gds_hash_set_t * _c2java_map= NULL;
 static gds_hash_set_t * _java2c_map= NULL;
 static unsigned long    _next_id   = 0;
 static JNIEnv         * jCurrentEnv= NULL;
+static unsigned int     _proxies_size= JNI_PROXY_HASH_SIZE;
+static unsigned int     _proxies_count= 0;
+static int              _proxies_rehashing= 0;
 
 // -----[ _proxy_t ]-----
 typedef struct {
@@ -204,6 +209,10 @@ static void _jni_proxy_c2j_destroy(void * item)
 {
   _proxy_t * proxy= (_proxy_t *) item;
 
+  // The proxy is only moved to a larger table (see _jni_proxies_grow)
+  if (_proxies_rehashing)
+    return;
+
 #if defined(DEBUG_PROXIES)
   fprintf(stderr, "debug: invalidate ");
   _jni_proxy_dump(proxy);
@@ -219,6 +228,9 @@ static void _jni_proxy_j2c_destroy(void * item)
 {
   _proxy_t * proxy= (_proxy_t *) item;
 
+  if (_proxies_rehashing)
+    return;
+
 #if defined(DEBUG_PROXIES)
   fprintf(stderr, "debug: destroy ");
   _jni_proxy_dump(proxy);
@@ -246,6 +258,69 @@ static uint32_t _jni_proxy_j2c_compute(const void * item,
   return proxy->id % hash_size;
 }
 
+// -----[ _jni_proxies_rehash ]--------------------------------------
+static int _jni_proxies_rehash(void * item, void * ctx)
+{
+  gds_hash_set_t * hash= (gds_hash_set_t *) ctx;
+
+  if (hash_set_add(hash, item) != item)
+    return -1;
+  return 0;
+}
+
+// -----[ _jni_proxies_grow ]----------------------------------------
+/**
+ * This function doubles the number of buckets of the C->Java and
+ * Java->C mappings when the average number of proxies per bucket
+ * exceeds JNI_PROXY_HASH_LOAD. The hash sets have a fixed number of
+ * buckets, hence the proxies are moved to new, larger hash sets.
+ * Large topologies create a proxy for each node, link and router
+ * that is returned to Java, and the lookups would otherwise
+ * degenerate to a linear search in long buckets.
+ */
+static void _jni_proxies_grow()
+{
+  gds_hash_set_t * c2java_map= NULL;
+  gds_hash_set_t * java2c_map;
+
+  if (_proxies_count <= _proxies_size * JNI_PROXY_HASH_LOAD)
+    return;
+
+  _proxies_size*= 2;
+
+#ifdef DEBUG_PROXIES
+  fprintf(stderr, "debug: proxy tables grow to %u buckets\n",
+	  _proxies_size);
+#endif /* DEBUG_PROXIES */
+
+  if (_c2java_map != NULL) {
+    c2java_map= hash_set_create(_proxies_size,
+				0,
+				_jni_proxy_c2j_cmp,
+				_jni_proxy_c2j_destroy,
+				_jni_proxy_c2j_compute);
+    if (hash_set_for_each(_c2java_map, _jni_proxies_rehash, c2java_map))
+      abort();
+  }
+  java2c_map= hash_set_create(_proxies_size,
+			      0,
+			      _jni_proxy_j2c_cmp,
+			      _jni_proxy_j2c_destroy,
+			      _jni_proxy_j2c_compute);
+  if (hash_set_for_each(_java2c_map, _jni_proxies_rehash, java2c_map))
+    abort();
+
+  // Destroy the old hash sets without releasing the proxies
+  _proxies_rehashing= 1;
+  if (_c2java_map != NULL)
+    hash_set_destroy(&_c2java_map);
+  hash_set_destroy(&_java2c_map);
+  _proxies_rehashing= 0;
+
+  _c2java_map= c2java_map;
+  _java2c_map= java2c_map;
+}
+
 // -----[ jni_proxy_add ]--------------------------------------------
 void jni_proxy_add(JNIEnv * env, jobject jobj, void * cobj)
 {
@@ -270,6 +345,8 @@ void jni_proxy_add(JNIEnv * env, jobject jobj, void * cobj)
     fprintf(stderr, "\n");
     abort();
   }
+  _proxies_count++;
+  _jni_proxies_grow();
 
 #ifdef DEBUG_PROXIES
   fprintf(stderr, "debug: proxy added\n");
@@ -308,6 +385,7 @@ void jni_proxy_remove(JNIEnv * env, jobject jobj)
     hash_set_remove(_c2java_map, proxy);
   hash_set_remove(_java2c_map, proxy);
   jCurrentEnv= NULL;
+  _proxies_count--;
 
 #ifdef DEBUG_PROXIES
   fprintf(stderr, "debug: proxy removed\n");
@@ -464,14 +542,14 @@ void _jni_proxies_init()
    * removed.
    */
   if (_c2java_map == NULL) {
-    _c2java_map= hash_set_create(JNI_PROXY_HASH_SIZE,
+    _c2java_map= hash_set_create(_proxies_size,
 			      0,
 			      _jni_proxy_c2j_cmp,
 			      _jni_proxy_c2j_destroy,
 			      _jni_proxy_c2j_compute);
   }
   if (_java2c_map == NULL) {
-    _java2c_map= hash_set_create(JNI_PROXY_HASH_SIZE,
+    _java2c_map= hash_set_create(_proxies_size,
 			      0,
 			      _jni_proxy_j2c_cmp,
 			      _jni_proxy_j2c_destroy,
@@ -504,6 +582,8 @@ void _jni_proxies_destroy(JNIEnv * env)
   hash_set_destroy(&_c2java_map);
   hash_set_destroy(&_java2c_map);
   jCurrentEnv= NULL;
+  _proxies_size= JNI_PROXY_HASH_SIZE;
+  _proxies_count= 0;
 }
 
 
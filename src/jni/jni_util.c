@@ -45,6 +45,7 @@
 #include <net/node.h>
 #include <net/util.h>
 #include <jni.h>
+#include <string.h>
 
 #define CLASS_AbstractConsoleEventListener \
   "be/ac/ucl/ingi/cbgp/AbstractConsoleEventListener"
@@ -768,3 +769,77 @@ jstring cbgp_jni_net_error_str(JNIEnv * jEnv, int iErrorCode)
 }
 
 
+/////////////////////////////////////////////////////////////////////
+//
+// BULK TRANSFER BUFFERS
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ jni_buffer_init ]------------------------------------------
+/**
+ * Prepare a writer for the given direct ByteBuffer. The records are
+ * always written from the start of the buffer, whatever its
+ * position.
+ *
+ * Return value:
+ *   0   in case of success
+ *  -1   in case of failure (an exception has been thrown)
+ */
+int jni_buffer_init(JNIEnv * jEnv, jobject joBuffer,
+		    jni_buffer_t * buffer)
+{
+  if (jni_check_null(jEnv, joBuffer))
+    return -1;
+
+  buffer->data= (uint8_t *) (*jEnv)->GetDirectBufferAddress(jEnv, joBuffer);
+  buffer->capacity= (*jEnv)->GetDirectBufferCapacity(jEnv, joBuffer);
+  buffer->offset= 0;
+  if ((buffer->data == NULL) || (buffer->capacity < 0)) {
+    throw_CBGPException(jEnv, "buffer must be a direct ByteBuffer");
+    return -1;
+  }
+  return 0;
+}
+
+// -----[ _jni_buffer_put ]------------------------------------------
+static inline void _jni_buffer_put(jni_buffer_t * buffer,
+				   const void * value, size_t size)
+{
+  if (buffer->offset + (jlong) size <= buffer->capacity)
+    memcpy(buffer->data + buffer->offset, value, size);
+  buffer->offset+= (jlong) size;
+}
+
+// -----[ jni_buffer_put_u8 ]----------------------------------------
+void jni_buffer_put_u8(jni_buffer_t * buffer, uint8_t value)
+{
+  _jni_buffer_put(buffer, &value, sizeof(value));
+}
+
+// -----[ jni_buffer_put_u16 ]---------------------------------------
+void jni_buffer_put_u16(jni_buffer_t * buffer, uint16_t value)
+{
+  _jni_buffer_put(buffer, &value, sizeof(value));
+}
+
+// -----[ jni_buffer_put_u32 ]---------------------------------------
+void jni_buffer_put_u32(jni_buffer_t * buffer, uint32_t value)
+{
+  _jni_buffer_put(buffer, &value, sizeof(value));
+}
+
+// -----[ jni_buffer_result ]----------------------------------------
+/**
+ * Return the number of bytes written in the buffer. If the buffer
+ * was too small, return the opposite of the required size.
+ */
+jint jni_buffer_result(JNIEnv * jEnv, jni_buffer_t * buffer)
+{
+  if (buffer->offset > INT32_MAX) {
+    throw_CBGPException(jEnv, "snapshot too large for a ByteBuffer");
+    return 0;
+  }
+  if (buffer->offset > buffer->capacity)
+    return (jint) -buffer->offset;
+  return (jint) buffer->offset;
+}
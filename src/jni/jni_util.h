@@ -51,6 +51,20 @@ typedef struct {
   JNIEnv  * jEnv;
 } jni_ctx_t;
 
+// -----[ jni_buffer_t ]---------------------------------------------
+/**
+ * Writer for the bulk transfer methods (getRIBBuffer, getRTBuffer,
+ * ...). The records are written in native byte order into a direct
+ * ByteBuffer allocated by the Java side. When the buffer is too
+ * small, the writer keeps counting the required size without
+ * writing, so that the caller can retry with a larger buffer.
+ */
+typedef struct {
+  uint8_t * data;
+  jlong     capacity;
+  jlong     offset;
+} jni_buffer_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -104,6 +118,18 @@ extern "C" {
   // -----[ cbgp_jni_bgp_domain_from_int ]---------------------------
   bgp_domain_t * cbgp_jni_bgp_domain_from_int(JNIEnv * env, jint iNumber);
 
+  // -----[ jni_buffer_init ]----------------------------------------
+  int jni_buffer_init(JNIEnv * jEnv, jobject joBuffer,
+		      jni_buffer_t * buffer);
+  // -----[ jni_buffer_put_u8 ]--------------------------------------
+  void jni_buffer_put_u8(jni_buffer_t * buffer, uint8_t value);
+  // -----[ jni_buffer_put_u16 ]-------------------------------------
+  void jni_buffer_put_u16(jni_buffer_t * buffer, uint16_t value);
+  // -----[ jni_buffer_put_u32 ]-------------------------------------
+  void jni_buffer_put_u32(jni_buffer_t * buffer, uint32_t value);
+  // -----[ jni_buffer_result ]--------------------------------------
+  jint jni_buffer_result(JNIEnv * jEnv, jni_buffer_t * buffer);
+
   // -----[ cbgp_jni_net_error_str ]---------------------------------
   jstring cbgp_jni_net_error_str(JNIEnv * jEnv, int error);
 
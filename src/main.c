@@ -51,10 +51,12 @@
 #define CBGP_MODE_SCRIPT      2
 #define CBGP_MODE_EXECUTE     3
 #define CBGP_MODE_OSPF        4
+#define CBGP_MODE_COMPILE     5
 
 // -----[ global options ]-----
 uint8_t mode   = CBGP_MODE_DEFAULT;
 char * arg_mode= NULL;
+char * arg_output= NULL;
 
 // -----[ simulation_cli_help ]--------------------------------------
 /**
@@ -69,6 +71,9 @@ void simulation_cli_help()
   printf("  -l LOGFILE     output log to LOGFILE instead of stderr.\n");
   printf("  -c SCRIPT      load and execute SCRIPT file.\n");
   printf("                 (without this option, commands are taken from stdin)\n");
+  printf("  -C SCRIPT      compile SCRIPT file into a binary command stream\n");
+  printf("                 that can be loaded faster with -c.\n");
+  printf("  -O FILE        output of -C (default is SCRIPT.cbc)\n");
   printf("  -e COMMAND     execute the given command\n");
   printf("  -D param=value defines a parameter\n");
 
@@ -105,6 +110,7 @@ void _main_done() __attribute((destructor));
 void _main_done()
 {
   str_destroy(&arg_mode);
+  str_destroy(&arg_output);
   libcbgp_done();
 }
 
@@ -127,11 +133,14 @@ int main(int argc, char ** argv) {
   libcbgp_init(argc, argv);
 
   // Process command-line options
-  while ((result= getopt(argc, argv, "mc:D:e:hil:ot:")) != -1) {
+  while ((result= getopt(argc, argv, "mc:C:D:e:hil:oO:t:")) != -1) {
     switch (result) {
     case 'c':
       simulation_set_mode(CBGP_MODE_SCRIPT, optarg);
       break;
+    case 'C':
+      simulation_set_mode(CBGP_MODE_COMPILE, optarg);
+      break;
     case 'D':
       tokenizer= tokenizer_create("=", NULL, NULL);
       assert(tokenizer_run(tokenizer, optarg) == TOKENIZER_SUCCESS);
@@ -156,6 +165,10 @@ int main(int argc, char ** argv) {
       simulation_set_mode(CBGP_MODE_OSPF, NULL);
       break;
 #endif
+    case 'O':
+      str_destroy(&arg_output);
+      arg_output= str_create(optarg);
+      break;
     default:
       simulation_cli_help();
       exit(EXIT_FAILURE);
@@ -183,6 +196,12 @@ int main(int argc, char ** argv) {
     exit_code= (libcbgp_exec_cmd(arg_mode) == 0)?
       EXIT_SUCCESS:EXIT_FAILURE;
     break;
+  case CBGP_MODE_COMPILE:
+    if (arg_output == NULL)
+      arg_output= str_append(str_create(arg_mode), ".cbc");
+    exit_code= (libcbgp_compile_file(arg_mode, arg_output) == 0)?
+      EXIT_SUCCESS:EXIT_FAILURE;
+    break;
 
   case CBGP_MODE_OSPF:
 #ifdef OSPF_SUPPORT
@@ -93,8 +93,12 @@ const char * network_strerror(int error)
     return "link already exists";
   case ENET_LINK_LOOP:
     return "link endpoints are equal";
+  case ENET_LINK_INVALID_TOS:
+    return "TOS larger than link depth";
   case ENET_IGP_DOMAIN_DUPLICATE:
     return "igp domain already exists";
+  case ENET_NODE_UNKNOWN:
+    return "node does not exist";
   case ENET_PROTO_UNKNOWN:
     return "invalid protocol ID";
   case ENET_PROTO_DUPLICATE:
@@ -143,6 +147,14 @@ const char * network_strerror(int error)
     return "network already exists";
   case ENET_NODE_INVALID_ID:
     return "invalid identifier";
+  case ENET_STATE_IO:
+    return "could not access state file";
+  case ENET_STATE_FORMAT:
+    return "invalid state file";
+  case ENET_STATE_VERSION:
+    return "unsupported state file version";
+  case ENET_STATE_NOT_EMPTY:
+    return "network is not empty";
   }
   return NULL;
 }
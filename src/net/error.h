@@ -45,6 +45,7 @@ typedef enum {
   ENET_LINK_DOWN          = -104, /* Link is down (disabled) */
   ENET_LINK_LOOP          = -105, /* Cannot create a link loop */
   ENET_LINK_DUPLICATE     = -106,
+  ENET_LINK_INVALID_TOS   = -107, /* TOS larger than link depth */
 
   ENET_NODE_DUPLICATE     = -200,
   ENET_SUBNET_DUPLICATE   = -201,
@@ -52,6 +53,7 @@ typedef enum {
   ENET_PROTO_DUPLICATE    = -203,
   ENET_IGP_DOMAIN_UNKNOWN = -204,
   ENET_IGP_DOMAIN_DUPLICATE = -205,
+  ENET_NODE_UNKNOWN       = -206, /* Node does not exist */
 
   ENET_IFACE_UNKNOWN      = -300,
   ENET_IFACE_DUPLICATE    = -301,
@@ -89,6 +91,11 @@ typedef enum {
 
   ENET_NODE_INVALID_ID    = -700,
 
+  ENET_STATE_IO           = -800, /* Could not read/write state file */
+  ENET_STATE_FORMAT       = -801, /* Invalid or corrupted state file */
+  ENET_STATE_VERSION      = -802, /* Unsupported state file version */
+  ENET_STATE_NOT_EMPTY    = -803, /* State loaded in non-empty network */
+
   ESIM_TIME_LIMIT         = -1000,
 } net_error_t;
 
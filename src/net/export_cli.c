@@ -314,7 +314,7 @@ static void _net_export_cli_static(gds_stream_t * stream,
   while (enum_has_next(nodes)) {
     node= *((net_node_t **) enum_get_next(nodes));
 
-    rt_info_lists= trie_get_enum(node->rt);
+    rt_info_lists= trie_get_enum(node->rt->trie);
     while (enum_has_next(rt_info_lists)) {
       rt_info_list= *((rt_info_list_t **) enum_get_next(rt_info_lists));
 
@@ -0,0 +1,369 @@
+// ==================================================================
+// @(#)failure.c
+//
+// Single-failure sweep (impact of each link or node failure).
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <string.h>
+
+#include <libgds/array.h>
+#include <libgds/enumerator.h>
+#include <libgds/memory.h>
+#include <libgds/trie.h>
+
+#include <bgp/domain.h>
+#include <bgp/rib.h>
+#include <bgp/types.h>
+#include <net/error.h>
+#include <net/failure.h>
+#include <net/iface.h>
+#include <net/igp_domain.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <net/prefix.h>
+#include <net/protocol.h>
+#include <net/routing.h>
+#include <net/verify.h>
+#include <sim/simulator.h>
+
+// Status of the forwarding between two nodes
+#define _SWEEP_REACHED 0
+#define _SWEEP_UNREACH 1
+#define _SWEEP_LOOP    2
+
+// -----[ _sweep_ctx_t ]---------------------------------------------
+typedef struct {
+  gds_stream_t  * stream;
+  network_t     * network;
+  /** Nodes (ordered by identifier). */
+  net_node_t   ** nodes;
+  unsigned int    num_nodes;
+  /** Status and path of each pair before the failures. */
+  uint8_t       * status;
+  uint32_t      * paths;
+  /** Number of BGP routes of each node before the failures. */
+  unsigned int  * bgp_routes;
+  /** Interfaces disabled by the current failure. */
+  ptr_array_t   * ifaces;
+  /** Node that fails (node failures only). */
+  net_node_t    * failed_node;
+} _sweep_ctx_t;
+
+// -----[ _sweep_trace ]---------------------------------------------
+/**
+ * Follow the forwarding (first routing entry) from a node towards
+ * another one. Returns the status and a hash of the path.
+ */
+static uint8_t _sweep_trace(_sweep_ctx_t * ctx, net_node_t * src,
+			    net_node_t * dst, uint32_t * path)
+{
+  net_node_t * node= src;
+  net_addr_t addr= dst->rid;
+  rt_info_t * rtinfo;
+  const char * reason;
+  unsigned int hops;
+
+  *path= 2166136261u;
+  for (hops= 0; hops <= ctx->num_nodes; hops++) {
+    if (node_has_address(node, addr) != NULL)
+      return _SWEEP_REACHED;
+    if (node->rt == NULL)
+      return _SWEEP_UNREACH;
+    rtinfo= rt_find_best(node->rt, addr, NET_ROUTE_ANY);
+    if (rtinfo == NULL)
+      return _SWEEP_UNREACH;
+    node= net_verify_next_hop(ctx->network, node,
+			      rt_entries_get_at(rtinfo->entries, 0),
+			      addr, NULL, &reason);
+    if (node == NULL)
+      return _SWEEP_UNREACH;
+    *path= (*path ^ node->rid) * 16777619u;
+  }
+  return _SWEEP_LOOP;
+}
+
+// -----[ _sweep_count_route ]---------------------------------------
+static int _sweep_count_route(uint32_t key, uint8_t key_len,
+			      void * item, void * ctx)
+{
+  (*((unsigned int *) ctx))++;
+  return 0;
+}
+
+// -----[ _sweep_bgp_routes ]----------------------------------------
+static unsigned int _sweep_bgp_routes(net_node_t * node)
+{
+  net_protocol_t * protocol= protocols_get(node->protocols,
+					   NET_PROTOCOL_BGP);
+  unsigned int count= 0;
+
+  if (protocol != NULL)
+    rib_for_each(((bgp_router_t *) protocol->handler)->loc_rib,
+		 _sweep_count_route, &count);
+  return count;
+}
+
+// -----[ _sweep_rescan ]--------------------------------------------
+static int _sweep_rescan(bgp_domain_t * domain, void * ctx)
+{
+  bgp_domain_rescan(domain);
+  return 0;
+}
+
+// -----[ _sweep_converge ]------------------------------------------
+/**
+ * Recompute the IGP domains of the nodes whose interfaces changed,
+ * then let BGP converge.
+ */
+static void _sweep_converge(_sweep_ctx_t * ctx)
+{
+  igp_domain_t * domain;
+  net_iface_t * iface;
+  unsigned int index, index2;
+
+  for (index= 0; index < ptr_array_length(ctx->network->domains); index++) {
+    domain= (igp_domain_t *) ctx->network->domains->data[index];
+    for (index2= 0; index2 < ptr_array_length(ctx->ifaces); index2++) {
+      iface= (net_iface_t *) ctx->ifaces->data[index2];
+      if (node_belongs_to_igp_domain(iface->owner, domain->id)) {
+	igp_domain_compute(domain, 0);
+	break;
+      }
+    }
+  }
+  bgp_domains_for_each(_sweep_rescan, NULL);
+  sim_run(network_get_simulator(ctx->network));
+}
+
+// -----[ _sweep_disable ]-------------------------------------------
+static inline void _sweep_disable(_sweep_ctx_t * ctx, net_iface_t * iface)
+{
+  if ((iface == NULL) || !net_iface_is_enabled(iface))
+    return;
+  net_iface_set_enabled(iface, 0);
+  ptr_array_append(ctx->ifaces, iface);
+}
+
+// -----[ _sweep_fail_iface ]----------------------------------------
+/** Disable a link in both directions. */
+static void _sweep_fail_iface(_sweep_ctx_t * ctx, net_iface_t * iface)
+{
+  _sweep_disable(ctx, iface);
+  if (((iface->type == NET_IFACE_RTR) || (iface->type == NET_IFACE_PTP)) &&
+      net_iface_is_connected(iface))
+    _sweep_disable(ctx, iface->dest.iface);
+}
+
+// -----[ _sweep_restore ]-------------------------------------------
+static void _sweep_restore(_sweep_ctx_t * ctx)
+{
+  unsigned int index;
+
+  for (index= 0; index < ptr_array_length(ctx->ifaces); index++)
+    net_iface_set_enabled((net_iface_t *) ctx->ifaces->data[index], 1);
+  _sweep_converge(ctx);
+  ptr_array_destroy(&ctx->ifaces);
+  ctx->ifaces= ptr_array_create_ref(0);
+  ctx->failed_node= NULL;
+}
+
+// -----[ _sweep_report ]--------------------------------------------
+/**
+ * Compare the current state with the state before the failures and
+ * dump the impact of the current failure.
+ */
+static void _sweep_report(_sweep_ctx_t * ctx)
+{
+  unsigned int src, dst, pair= 0, count;
+  unsigned int lost= 0, rerouted= 0, bgp_lost= 0;
+  uint32_t path;
+  uint8_t status;
+
+  for (src= 0; src < ctx->num_nodes; src++) {
+    for (dst= 0; dst < ctx->num_nodes; dst++) {
+      if (src == dst)
+	continue;
+      pair++;
+      if ((ctx->status[pair-1] != _SWEEP_REACHED) ||
+	  (ctx->nodes[src] == ctx->failed_node) ||
+	  (ctx->nodes[dst] == ctx->failed_node))
+	continue;
+      status= _sweep_trace(ctx, ctx->nodes[src], ctx->nodes[dst], &path);
+      if (status != _SWEEP_REACHED)
+	lost++;
+      else if (path != ctx->paths[pair-1])
+	rerouted++;
+    }
+    if (ctx->nodes[src] == ctx->failed_node)
+      continue;
+    count= _sweep_bgp_routes(ctx->nodes[src]);
+    if (count < ctx->bgp_routes[src])
+      bgp_lost+= ctx->bgp_routes[src]-count;
+  }
+  stream_printf(ctx->stream, "\t%u\t%u\t%u\n", lost, rerouted, bgp_lost);
+}
+
+// -----[ _sweep_init ]----------------------------------------------
+static void _sweep_init(_sweep_ctx_t * ctx, gds_stream_t * stream,
+			network_t * network)
+{
+  gds_enum_t * nodes;
+  unsigned int index, src, dst, pair;
+
+  ctx->stream= stream;
+  ctx->network= network;
+  ctx->num_nodes= 0;
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    enum_get_next(nodes);
+    ctx->num_nodes++;
+  }
+  enum_destroy(&nodes);
+
+  ctx->nodes= (net_node_t **) MALLOC(sizeof(net_node_t *)*
+				     (ctx->num_nodes+1));
+  index= 0;
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes))
+    ctx->nodes[index++]= *((net_node_t **) enum_get_next(nodes));
+  enum_destroy(&nodes);
+
+  // State before the failures
+  ctx->status= (uint8_t *) MALLOC(sizeof(uint8_t)*
+				  (ctx->num_nodes*ctx->num_nodes+1));
+  ctx->paths= (uint32_t *) MALLOC(sizeof(uint32_t)*
+				  (ctx->num_nodes*ctx->num_nodes+1));
+  ctx->bgp_routes= (unsigned int *) MALLOC(sizeof(unsigned int)*
+					   (ctx->num_nodes+1));
+  pair= 0;
+  for (src= 0; src < ctx->num_nodes; src++) {
+    for (dst= 0; dst < ctx->num_nodes; dst++) {
+      if (src == dst)
+	continue;
+      ctx->status[pair]= _sweep_trace(ctx, ctx->nodes[src], ctx->nodes[dst],
+				      &ctx->paths[pair]);
+      pair++;
+    }
+    ctx->bgp_routes[src]= _sweep_bgp_routes(ctx->nodes[src]);
+  }
+
+  ctx->ifaces= ptr_array_create_ref(0);
+  ctx->failed_node= NULL;
+}
+
+// -----[ _sweep_destroy ]-------------------------------------------
+static void _sweep_destroy(_sweep_ctx_t * ctx)
+{
+  FREE(ctx->nodes);
+  FREE(ctx->status);
+  FREE(ctx->paths);
+  FREE(ctx->bgp_routes);
+  ptr_array_destroy(&ctx->ifaces);
+}
+
+// -----[ _sweep_links ]---------------------------------------------
+/**
+ * Each point-to-point link is failed once (from the node with the
+ * lowest identifier). Each subnet attachment is failed separately.
+ */
+static void _sweep_links(_sweep_ctx_t * ctx)
+{
+  net_node_t * node;
+  net_iface_t * iface;
+  unsigned int index, index2;
+
+  for (index= 0; index < ctx->num_nodes; index++) {
+    node= ctx->nodes[index];
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if (!net_iface_is_connected(iface) || !net_iface_is_enabled(iface))
+	continue;
+      switch (iface->type) {
+      case NET_IFACE_RTR:
+      case NET_IFACE_PTP:
+	if (iface->dest.iface->owner->rid < node->rid)
+	  continue;
+	node_dump_id(ctx->stream, node);
+	stream_printf(ctx->stream, "\t");
+	node_dump_id(ctx->stream, iface->dest.iface->owner);
+	break;
+      case NET_IFACE_PTMP:
+	node_dump_id(ctx->stream, node);
+	stream_printf(ctx->stream, "\t");
+	ip_prefix_dump(ctx->stream, net_iface_dst_prefix(iface));
+	break;
+      default:
+	continue;
+      }
+      _sweep_fail_iface(ctx, iface);
+      _sweep_converge(ctx);
+      _sweep_report(ctx);
+      _sweep_restore(ctx);
+    }
+  }
+}
+
+// -----[ _sweep_nodes ]---------------------------------------------
+static void _sweep_nodes(_sweep_ctx_t * ctx)
+{
+  net_node_t * node;
+  net_iface_t * iface;
+  unsigned int index, index2;
+
+  for (index= 0; index < ctx->num_nodes; index++) {
+    node= ctx->nodes[index];
+    node_dump_id(ctx->stream, node);
+    ctx->failed_node= node;
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if (iface->type != NET_IFACE_LOOPBACK)
+	_sweep_fail_iface(ctx, iface);
+    }
+    _sweep_converge(ctx);
+    _sweep_report(ctx);
+    _sweep_restore(ctx);
+  }
+}
+
+// -----[ network_failure_sweep ]------------------------------------
+int network_failure_sweep(gds_stream_t * stream, network_t * network,
+			  uint8_t type)
+{
+  _sweep_ctx_t ctx;
+
+  _sweep_init(&ctx, stream, network);
+  if (type == NET_FAILURE_NODES)
+    _sweep_nodes(&ctx);
+  else
+    _sweep_links(&ctx);
+  _sweep_destroy(&ctx);
+  stream_flush(stream);
+  return ESUCCESS;
+}
@@ -0,0 +1,91 @@
+// ==================================================================
+// @(#)failure.h
+//
+// Single-failure sweep (impact of each link or node failure).
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+/**
+ * \file
+ * Provide a sweep over all the single failures of a network (one
+ * link or one node at a time).
+ *
+ * For each failure, the failed interfaces are disabled, the IGP
+ * domains of the nodes concerned are recomputed, the BGP routers
+ * rescan their RIBs and the simulation is run until convergence.
+ * The forwarding state is then compared with the state before the
+ * failure, and the failure is reverted in the same way.
+ *
+ * The impact of each failure is reported on a single line:
+ *
+ *   <failure> <lost> <rerouted> <bgp-lost>
+ *
+ * where
+ * \li <failure> is the link (both nodes, or the node and the
+ *   subnet) or the node that fails,
+ * \li <lost> is the number of (node, node) pairs that are no
+ *   longer reachable,
+ * \li <rerouted> is the number of pairs whose path changed,
+ * \li <bgp-lost> is the number of BGP routes lost by the routers.
+ *
+ * The pairs that involve a failed node are not taken into account.
+ */
+
+#ifndef __NET_FAILURE_H__
+#define __NET_FAILURE_H__
+
+#include <libgds/stream.h>
+
+#include <net/net_types.h>
+
+/** Fail the links (point-to-point links and subnet attachments). */
+#define NET_FAILURE_LINKS 0
+/** Fail the nodes. */
+#define NET_FAILURE_NODES 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ network_failure_sweep ]----------------------------------
+  /**
+   * Report the impact of each single failure.
+   *
+   * The network must have converged before the sweep.
+   *
+   * \param stream  is the output stream.
+   * \param network is the network.
+   * \param type    is the type of failures (NET_FAILURE_LINKS or
+   *   NET_FAILURE_NODES).
+   * \retval ESUCCESS in case of success,
+   *   or a negative error code otherwise.
+   */
+  int network_failure_sweep(gds_stream_t * stream, network_t * network,
+			    uint8_t type);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_FAILURE_H__ */
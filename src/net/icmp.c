@@ -35,11 +35,14 @@
 
 #include <net/error.h>
 #include <net/icmp.h>
+#include <net/iface.h>
+#include <net/ipip.h>
 #include <net/node.h>
 #include <net/prefix.h>
 #include <net/protocol.h>
 #include <net/network.h>
 #include <net/net_types.h>
+#include <net/subnet.h>
 
 //#define ICMP_DEBUG
 
@@ -66,6 +69,44 @@ static struct {
   .received= 0,
 };
 
+/**
+ * Local simulator used to schedule the messages exchanged by the
+ * ping and traceroute functions. It is created once and reused, as
+ * each probe runs it until its queue is empty. Record-route does not
+ * need it (see icmp_walk_send()).
+ */
+static simulator_t * _icmp_sim= NULL;
+
+// -----[ icmp_sim_get ]---------------------------------------------
+/**
+ * Get a local simulator to send probes. The shared simulator is
+ * returned unless it is already running (nested probes), in which
+ * case a private simulator is created.
+ */
+simulator_t * icmp_sim_get()
+{
+  if (_icmp_sim == NULL)
+    _icmp_sim= sim_create(SCHEDULER_STATIC);
+  if (sim_is_running(_icmp_sim))
+    return sim_create(SCHEDULER_STATIC);
+  return _icmp_sim;
+}
+
+// -----[ icmp_sim_release ]-----------------------------------------
+/**
+ * Release a local simulator obtained with icmp_sim_get().
+ */
+void icmp_sim_release(simulator_t ** sim_ref)
+{
+  if (*sim_ref != _icmp_sim) {
+    sim_destroy(sim_ref);
+    return;
+  }
+  if (sim_get_num_events(*sim_ref) > 0)
+    sim_clear(*sim_ref);
+  *sim_ref= NULL;
+}
+
 // -----[ icmp_perror ]----------------------------------------------
 /**
  * Report comprehensive ICMP error description.
@@ -278,7 +319,7 @@ net_error_t icmp_ping_send_recv(net_node_t * node, net_addr_t src_addr,
   simulator_t * sim= NULL;
   net_error_t error;
 
-  sim= sim_create(SCHEDULER_STATIC);
+  sim= icmp_sim_get();
 
   _rcvd_ctx.received= 0;
   error= icmp_send_echo_request(node, src_addr, dst_addr, ttl, sim);
@@ -312,7 +353,7 @@ net_error_t icmp_ping_send_recv(net_node_t * node, net_addr_t src_addr,
     }
   }
 
-  sim_destroy(&sim);
+  icmp_sim_release(&sim);
   return error;
 }
 
@@ -432,6 +473,269 @@ net_error_t icmp_trace_route(gds_stream_t * stream,
   return error;
 }
 
+// -----[ _icmp_walk_t ]---------------------------------------------
+/**
+ * Position of a probe during a direct forwarding walk. The message
+ * is either sent by the node (iif is NULL) or received by the node
+ * through the interface iif.
+ */
+typedef struct {
+  net_node_t         * node;
+  net_iface_t        * iif;
+  net_msg_t          * msg;
+  const rt_entries_t * rtentries;
+} _icmp_walk_t;
+
+// -----[ _icmp_walk_drop ]------------------------------------------
+static inline net_error_t _icmp_walk_drop(_icmp_walk_t * walk,
+					  net_error_t error)
+{
+  ip_opt_hook_msg_error(walk->msg, error);
+  message_destroy(&walk->msg);
+  return error;
+}
+
+// -----[ _icmp_walk_deliver ]---------------------------------------
+/**
+ * Deliver the message locally (see _node_ip_input()). A message
+ * addressed to another local interface is received again through
+ * that interface, which decapsulates it if it is a tunnel.
+ */
+static net_error_t _icmp_walk_deliver(_icmp_walk_t * walk,
+				      net_iface_t * lif)
+{
+  net_protocol_t * proto;
+  net_msg_t * inner_msg;
+  net_error_t error;
+
+  if (walk->iif != lif) {
+    if (ipip_iface_is_tunnel(lif)) {
+      inner_msg= ipip_decap(lif, walk->msg);
+      if (inner_msg == NULL) {
+	message_destroy(&walk->msg);
+	return EUNEXPECTED;
+      }
+      walk->msg= inner_msg;
+    }
+    walk->iif= lif;
+    return ESUCCESS;
+  }
+
+  error= ip_opt_hook_msg_rcvd(walk->node, lif, walk->msg);
+  if (error != ESUCCESS) {
+    message_destroy(&walk->msg);
+    return error;
+  }
+
+  proto= node_get_protocol(walk->node, walk->msg->protocol);
+  if (proto == NULL)
+    return _icmp_walk_drop(walk, ENET_PROTO_UNREACH);
+
+  error= protocol_recv(proto, walk->msg, NULL);
+  walk->msg->payload= NULL;
+  message_destroy(&walk->msg);
+  return error;
+}
+
+// -----[ _icmp_walk_output ]----------------------------------------
+/**
+ * Forward the message through the first routing entry and move to
+ * the node attached to the outgoing interface (see _node_ip_output()
+ * and the interface send functions). The other entries are pushed
+ * as ECMP branches by the IP options.
+ *
+ * As in _node_ip_output(), a message lost on a link that is down is
+ * not reported to the caller.
+ */
+static net_error_t _icmp_walk_output(_icmp_walk_t * walk,
+				     const rt_entries_t * rtentries)
+{
+  const rt_entry_t * rtentry= rt_entries_get_at(rtentries, 0);
+  net_msg_t * msg= walk->msg;
+  net_addr_t dst= msg->dst_addr;
+  net_addr_t l2_addr;
+  net_iface_t * oif, * dst_iface;
+  net_msg_t * outer_msg;
+  net_error_t error;
+  int reached= 0;
+
+  error= ip_opt_hook_msg_ecmp(walk->node, msg, &rtentries);
+  if (error != ESUCCESS)
+    return _icmp_walk_drop(walk, error);
+
+  // Recursive lookup (BGP next-hop)
+  if (rtentry->oif == NULL) {
+    dst= rtentry->gateway;
+    rtentries= node_rt_lookup(walk->node, dst);
+    if ((rtentries == NULL) ||
+	(rt_entries_get_at(rtentries, 0) == rtentry) ||
+	(rt_entries_get_at(rtentries, 0)->oif == NULL))
+      return _icmp_walk_drop(walk, ENET_HOST_UNREACH);
+    rtentry= rt_entries_get_at(rtentries, 0);
+  }
+
+  oif= rtentry->oif;
+  l2_addr= rtentry->gateway;
+  if (msg->src_addr == NET_ADDR_ANY)
+    msg->src_addr= net_iface_src_address(oif);
+  if ((oif->type == NET_IFACE_PTMP) && (l2_addr == NET_ADDR_ANY))
+    l2_addr= dst;
+
+  error= ip_opt_hook_msg_out(walk->node, oif, msg);
+  if (error != ESUCCESS)
+    return _icmp_walk_drop(walk, error);
+
+  if (!net_iface_is_connected(oif) || !net_iface_is_enabled(oif)) {
+    _icmp_walk_drop(walk, ENET_LINK_DOWN);
+    return ESUCCESS;
+  }
+
+  switch (oif->type) {
+  case NET_IFACE_RTR:
+  case NET_IFACE_PTP:
+    walk->node= oif->dest.iface->owner;
+    walk->iif= oif->dest.iface;
+    return ESUCCESS;
+
+  case NET_IFACE_PTMP:
+    error= ip_opt_hook_msg_subnet(oif->dest.subnet, msg, &reached);
+    if (error != ESUCCESS)
+      return _icmp_walk_drop(walk, error);
+    if (reached) {
+      message_destroy(&walk->msg);
+      return ESUCCESS;
+    }
+    dst_iface= net_subnet_find_link(oif->dest.subnet, l2_addr);
+    if (dst_iface == NULL)
+      return _icmp_walk_drop(walk, ENET_HOST_UNREACH);
+    if (!net_iface_is_enabled(dst_iface)) {
+      _icmp_walk_drop(walk, ENET_LINK_DOWN);
+      return ESUCCESS;
+    }
+    walk->node= dst_iface->owner;
+    walk->iif= dst_iface;
+    return ESUCCESS;
+
+  case NET_IFACE_VIRTUAL:
+    if (ipip_iface_is_tunnel(oif)) {
+      // The tunnel head sends the encapsulated message
+      error= ipip_encap(oif, msg, &outer_msg);
+      if (error != ESUCCESS) {
+	_icmp_walk_drop(walk, error);
+	return ESUCCESS;
+      }
+      walk->msg= outer_msg;
+      walk->iif= NULL;
+      walk->rtentries= NULL;
+      return ESUCCESS;
+    }
+    /* FALLTHROUGH */
+
+  default:
+    _icmp_walk_drop(walk, EUNSUPPORTED);
+    return ESUCCESS;
+  }
+}
+
+// -----[ _icmp_walk_sent ]------------------------------------------
+/**
+ * Process a message sent by a node (see node_send()).
+ */
+static net_error_t _icmp_walk_sent(_icmp_walk_t * walk)
+{
+  const rt_entries_t * rtentries= walk->rtentries;
+  net_iface_t * lif;
+  net_error_t error;
+
+  walk->rtentries= NULL;
+
+  error= ip_opt_hook_msg_sent(walk->node, walk->msg, &rtentries);
+  if (error != ESUCCESS)
+    return _icmp_walk_drop(walk, error);
+
+  if (rtentries == NULL) {
+    lif= node_has_address(walk->node, walk->msg->dst_addr);
+    if (lif != NULL) {
+      if (walk->msg->src_addr == NET_ADDR_ANY)
+	walk->msg->src_addr= lif->addr;
+      walk->iif= lif;
+      return _icmp_walk_deliver(walk, lif);
+    }
+    rtentries= node_rt_lookup(walk->node, walk->msg->dst_addr);
+    if (rtentries == NULL)
+      return _icmp_walk_drop(walk, ENET_HOST_UNREACH);
+  }
+
+  return _icmp_walk_output(walk, rtentries);
+}
+
+// -----[ _icmp_walk_recv ]------------------------------------------
+/**
+ * Process a message received by a node (see node_recv_msg()).
+ */
+static net_error_t _icmp_walk_recv(_icmp_walk_t * walk)
+{
+  const rt_entries_t * rtentries= NULL;
+  net_iface_t * lif;
+  net_error_t error;
+
+  error= ip_opt_hook_msg_in(walk->node, walk->iif, walk->msg, &rtentries);
+  if (error != ESUCCESS) {
+    message_destroy(&walk->msg);
+    return error;
+  }
+
+  if (rtentries == NULL) {
+    lif= node_has_address(walk->node, walk->msg->dst_addr);
+    if (lif != NULL)
+      return _icmp_walk_deliver(walk, lif);
+  }
+
+  if (walk->msg->ttl <= 1)
+    return _icmp_walk_drop(walk, ENET_TIME_EXCEEDED);
+  walk->msg->ttl--;
+
+  if (rtentries == NULL) {
+    rtentries= node_rt_lookup(walk->node, walk->msg->dst_addr);
+    if (rtentries == NULL)
+      return _icmp_walk_drop(walk, ENET_HOST_UNREACH);
+  }
+
+  return _icmp_walk_output(walk, rtentries);
+}
+
+// -----[ icmp_walk_send ]-------------------------------------------
+/**
+ * Forward a probe hop by hop, directly from the routing tables of
+ * the nodes, instead of scheduling its transmission on each link.
+ * The IP options hooks are called at the same points as in the
+ * forwarding functions, so that the traces are identical. No ICMP
+ * error is sent back to the source.
+ *
+ * The returned error is that of the source node, as with
+ * node_send().
+ */
+net_error_t icmp_walk_send(net_node_t * node, net_msg_t * msg,
+			   const rt_entries_t * rtentries)
+{
+  _icmp_walk_t walk= {
+    .node= node,
+    .iif= NULL,
+    .msg= msg,
+    .rtentries= rtentries,
+  };
+  net_error_t error;
+
+  error= _icmp_walk_sent(&walk);
+  while (walk.msg != NULL) {
+    if (walk.iif == NULL)
+      _icmp_walk_sent(&walk);
+    else
+      _icmp_walk_recv(&walk);
+  }
+  return error;
+}
+
 // -----[ icmp_trace_send ]------------------------------------------
 /**
  * How to handle the IP options ?
@@ -546,6 +850,53 @@ int icmp_record_route(gds_stream_t * stream,
   return ESUCCESS;
 }
 
+// -----[ icmp_record_route_all_pairs ]------------------------------
+int icmp_record_route_all_pairs(gds_stream_t * stream,
+				network_t * network,
+				uint8_t ttl, net_tos_t tos,
+				ip_opt_t * opts)
+{
+  gds_enum_t * srcs, * dsts;
+  net_node_t * src, * dst;
+  ip_dest_t dest;
+
+  dest.type= NET_DEST_ADDRESS;
+  srcs= trie_get_enum(network->nodes);
+  while (enum_has_next(srcs)) {
+    src= *((net_node_t **) enum_get_next(srcs));
+    dsts= trie_get_enum(network->nodes);
+    while (enum_has_next(dsts)) {
+      dst= *((net_node_t **) enum_get_next(dsts));
+      if (dst == src)
+	continue;
+      dest.addr= dst->rid;
+      icmp_record_route(stream, src, IP_ADDR_ANY, dest, ttl, tos, opts);
+    }
+    enum_destroy(&dsts);
+  }
+  enum_destroy(&srcs);
+  return ESUCCESS;
+}
+
+// -----[ _icmp_destroy ]--------------------------------------------
+void _icmp_destroy()
+{
+  sim_destroy(&_icmp_sim);
+}
+
+// -----[ _icmp_swap ]-----------------------------------------------
+/**
+ * Exchange the local simulator with the given one (used to switch
+ * between simulation contexts).
+ */
+void _icmp_swap(simulator_t ** sim_ref)
+{
+  simulator_t * sim= _icmp_sim;
+
+  _icmp_sim= *sim_ref;
+  *sim_ref= sim;
+}
+
 
 const net_protocol_def_t PROTOCOL_ICMP= {
   .name= "icmp",
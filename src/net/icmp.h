@@ -99,6 +99,20 @@ extern "C" {
   // -----[ icmp_ping_send_recv ]------------------------------------
   int icmp_ping_send_recv(net_node_t * node, net_addr_t src_addr,
 			  net_addr_t dst_addr, uint8_t ttl);
+  // -----[ icmp_walk_send ]-----------------------------------------
+  /**
+   * Forward a message without the simulator, by following the
+   * routing tables, tunnels and subnets from the given node. The
+   * message is destroyed.
+   *
+   * \param node      is the source node.
+   * \param msg       is the message.
+   * \param rtentries is the routing entries to use at the source
+   *   (NULL for a normal lookup).
+   * \retval the error reported by the source node.
+   */
+  net_error_t icmp_walk_send(net_node_t * node, net_msg_t * msg,
+			     const rt_entries_t * rtentries);
   // -----[ icmp_trace_send ]----------------------------------------
   array_t * icmp_trace_send(net_node_t * node, net_addr_t dst_addr,
 			    uint8_t max_ttl, ip_opt_t * opts);
@@ -198,7 +212,28 @@ extern "C" {
 			net_node_t * node, net_addr_t src_addr,
 			ip_dest_t dest, uint8_t ttl,
 			net_tos_t tos, ip_opt_t * opts);
-  
+
+  // -----[ icmp_record_route_all_pairs ]----------------------------
+  /**
+   * Trace the route from each node of the network towards the
+   * identifier (address) of each other node. The output format is
+   * the same as that of \c icmp_record_route.
+   */
+  int icmp_record_route_all_pairs(gds_stream_t * stream,
+				  network_t * network,
+				  uint8_t ttl, net_tos_t tos,
+				  ip_opt_t * opts);
+
+  // -----[ icmp_sim_get ]-------------------------------------------
+  simulator_t * icmp_sim_get();
+  // -----[ icmp_sim_release ]---------------------------------------
+  void icmp_sim_release(simulator_t ** sim_ref);
+
+  // -----[ _icmp_destroy ]------------------------------------------
+  void _icmp_destroy();
+  // -----[ _icmp_swap ]---------------------------------------------
+  void _icmp_swap(simulator_t ** sim_ref);
+
 #ifdef __cplusplus
 }
 #endif
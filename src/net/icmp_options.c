@@ -651,7 +651,6 @@ static void _array_trace_destroy(void * item, const void * ctx)
 array_t * ip_opt_ecmp_run(ip_opt_t * opts, net_msg_t * init_msg,
 			  net_node_t * node)
 {
-  simulator_t * sim;
   net_msg_t * msg;
   ip_trace_t ** trace_ptr;
   _ecmp_ctx_t * ctx;
@@ -677,15 +676,11 @@ array_t * ip_opt_ecmp_run(ip_opt_t * opts, net_msg_t * init_msg,
     opts= msg->opts;
     ip_options_add_ref(opts);
 
-    sim= sim_create(SCHEDULER_STATIC);
-    net_error_t error= node_send(ctx->node, ctx->msg, ctx->rtentries, sim);
+    net_error_t error= icmp_walk_send(ctx->node, ctx->msg, ctx->rtentries);
     if (error != ESUCCESS) {
       (*trace_ptr)->status= error;
       ___ip_opt_debug("could not send (%s)\n", network_strerror(error));
-    } else {
-      sim_run(sim);
     }
-    sim_destroy(&sim);
     rt_entries_destroy(&ctx->rtentries);
     FREE(ctx);
 
@@ -410,19 +410,18 @@ void net_iface_set_enabled(net_iface_t * iface, int enabled)
 
 // -----[ net_iface_get_metric ]-------------------------------------
 /**
- * To-do: if (tTOS > depth) => return IGP_MAX_WEIGHT
+ * Return IGP_MAX_WEIGHT if the interface has no weight for the
+ * requested TOS.
  */
 igp_weight_t net_iface_get_metric(net_iface_t * iface, net_tos_t tos)
 {
-  if (iface->weights == NULL)
+  if ((iface->weights == NULL) ||
+      (tos >= net_igp_weights_depth(iface->weights)))
     return IGP_MAX_WEIGHT;
   return iface->weights->data[tos];
 }
 
 // -----[ net_iface_set_metric ]-------------------------------------
-/**
- * To-do: return error if (weights == NULL) or if (depth <= tTOS)
- */
 int net_iface_set_metric(net_iface_t * iface, net_tos_t tos,
 			 igp_weight_t weight, net_iface_dir_t dir)
 {
@@ -430,7 +429,8 @@ int net_iface_set_metric(net_iface_t * iface, net_tos_t tos,
   net_iface_t * rev_iface;
 
   assert(iface->weights != NULL);
-  assert(tos < net_igp_weights_depth(iface->weights));
+  if (tos >= net_igp_weights_depth(iface->weights))
+    return ENET_LINK_INVALID_TOS;
 
   if (dir == BIDIR) {
     error= _net_iface_get_reverse(iface, &rev_iface);
@@ -445,6 +445,42 @@ int net_iface_set_metric(net_iface_t * iface, net_tos_t tos,
   return ESUCCESS;
 }
 
+// -----[ net_iface_set_depth ]--------------------------------------
+/**
+ * Change the number of IGP weights (TOS) of an interface. The
+ * existing weights are kept. The new ones are initialized with the
+ * TOS 0 weight.
+ */
+net_error_t net_iface_set_depth(net_iface_t * iface, net_tos_t depth,
+				net_iface_dir_t dir)
+{
+  net_error_t error;
+  net_iface_t * rev_iface;
+  igp_weights_t * weights;
+  unsigned int index;
+
+  assert(iface->weights != NULL);
+  if ((depth == 0) || (depth > NET_LINK_MAX_DEPTH))
+    return ENET_LINK_INVALID_TOS;
+
+  if (dir == BIDIR) {
+    error= _net_iface_get_reverse(iface, &rev_iface);
+    if (error != ESUCCESS)
+      return error;
+    error= net_iface_set_depth(rev_iface, depth, UNIDIR);
+    if (error != ESUCCESS)
+      return error;
+  }
+
+  weights= net_igp_weights_create(depth, iface->weights->data[0]);
+  for (index= 0; (index < depth) &&
+	 (index < net_igp_weights_depth(iface->weights)); index++)
+    weights->data[index]= iface->weights->data[index];
+  net_igp_weights_destroy(&iface->weights);
+  iface->weights= weights;
+  return ESUCCESS;
+}
+
 // -----[ net_iface_get_delay ]--------------------------------------
 net_link_delay_t net_iface_get_delay(net_iface_t * iface)
 {
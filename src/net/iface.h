@@ -140,6 +140,13 @@ extern "C" {
    */
   int net_iface_set_metric(net_iface_t * iface, net_tos_t tos,
 			   igp_weight_t weight, net_iface_dir_t eDir);
+
+  // -----[ net_iface_set_depth ]------------------------------------
+  /**
+   * Set the number of IGP weights (TOS) of a network interface.
+   */
+  net_error_t net_iface_set_depth(net_iface_t * iface, net_tos_t depth,
+				  net_iface_dir_t dir);
   
   // -----[ net_iface_is_enabled ]-----------------------------------
   /**
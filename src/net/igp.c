@@ -48,6 +48,7 @@
 #include <net/node.h>
 #include <net/routing.h>
 #include <net/subnet.h>
+#include <util/mem_stats.h>
 #include <util/str_format.h>
 
 //#define IGP_DEBUG
@@ -433,6 +434,260 @@ net_error_t spt_bfs(net_node_t * root, igp_domain_t * domain,
   return ESUCCESS;
 }
 
+/////////////////////////////////////////////////////////////////////
+//
+// MULTI-TOPOLOGY SPT COMPUTATION
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _mspt_vertex_t ]-------------------------------------------
+/**
+ * Element visited by the multi-topology BFS. The weights of the
+ * element in all the planes are stored in a single vector, which
+ * is compared and updated in one pass for each traversed link. A
+ * plane where the element has not been reached yet has a weight
+ * equal to IGP_MAX_WEIGHT and no SPT vertex.
+ */
+typedef struct {
+  igp_weight_t   weights[NET_LINK_MAX_DEPTH];
+  spt_vertex_t * vertices[NET_LINK_MAX_DEPTH];
+  net_elem_t     elem;
+} _mspt_vertex_t;
+
+// -----[ _mspt_context_t ]------------------------------------------
+typedef struct {
+  net_iface_t    * iif;     // incoming interface (reaching the node)
+  _mspt_vertex_t * vertex;
+  uint16_t         planes;  // planes to be relaxed from this vertex
+} _mspt_context_t;
+
+// -----[ _mspt_comp_t ]---------------------------------------------
+typedef struct {
+  net_tos_t          depth;
+  spt_t            * spts[NET_LINK_MAX_DEPTH];
+  gds_radix_tree_t * vertices;
+  gds_fifo_t       * fifo;
+  igp_domain_t     * domain;
+} _mspt_comp_t;
+
+// -----[ _mspt_vertex_destroy ]-------------------------------------
+static void _mspt_vertex_destroy(void ** item)
+{
+  FREE(*item);
+  mem_stats_free(MEM_TAG_SPT, sizeof(_mspt_vertex_t));
+}
+
+// -----[ _mspt_get_vertex ]-----------------------------------------
+static inline _mspt_vertex_t * _mspt_get_vertex(_mspt_comp_t * comp,
+						net_elem_t elem)
+{
+  ip_pfx_t prefix= net_elem_prefix(&elem);
+  _mspt_vertex_t * vertex;
+  net_tos_t tos;
+
+  ip_prefix_mask(&prefix);
+  vertex= (_mspt_vertex_t *) radix_tree_get_exact(comp->vertices,
+						  prefix.network,
+						  prefix.mask);
+  if (vertex == NULL) {
+    vertex= (_mspt_vertex_t *) MALLOC(sizeof(_mspt_vertex_t));
+    mem_stats_alloc(MEM_TAG_SPT, sizeof(_mspt_vertex_t));
+    vertex->elem= elem;
+    for (tos= 0; tos < NET_LINK_MAX_DEPTH; tos++) {
+      vertex->weights[tos]= IGP_MAX_WEIGHT;
+      vertex->vertices[tos]= NULL;
+    }
+    assert(radix_tree_add(comp->vertices, prefix.network, prefix.mask,
+			  vertex) >= 0);
+  }
+  return vertex;
+}
+
+// -----[ _mspt_push ]-----------------------------------------------
+static inline void _mspt_push(_mspt_comp_t * comp,
+			      net_iface_t * iif,
+			      _mspt_vertex_t * vertex,
+			      uint16_t planes)
+{
+  _mspt_context_t * ctx;
+
+  ___igp_debug("  * push dst:%e\n", &vertex->elem);
+
+  ctx= (_mspt_context_t *) MALLOC(sizeof(_mspt_context_t));
+  ctx->iif= iif;
+  ctx->vertex= vertex;
+  ctx->planes= planes;
+  assert(fifo_push(comp->fifo, ctx) == 0);
+}
+
+// -----[ _mspt_link_traverse ]--------------------------------------
+/**
+ * Same as _link_traverse(), for all the planes at once. The filters
+ * that do not depend on the weights are applied once. The weight of
+ * the link is then added in each plane and the SPT of each plane is
+ * updated following the same rules as in _spt_update_node(). The
+ * next element is pushed once, with the set of planes where it has
+ * been created or improved.
+ */
+static inline void _mspt_link_traverse(_mspt_comp_t * comp,
+				       _mspt_context_t * context,
+				       net_iface_t * link)
+{
+  _mspt_vertex_t * vertex= context->vertex;
+  _mspt_vertex_t * next_vertex= NULL;
+  net_elem_t next_elem= { .type=NODE };
+  igp_weight_t weights[NET_LINK_MAX_DEPTH];
+  igp_weight_t weight;
+  spt_vertex_t * spt_vertex;
+  uint16_t planes= 0;
+  net_tos_t tos;
+
+  // Get the end-side of the link
+  if (!_link_get_next_elem(&vertex->elem, link, &next_elem))
+    return;
+
+  // Filter: stop if tail-end is outside of domain
+  if ((next_elem.type == NODE) &&
+      !igp_domain_contains_router(comp->domain, next_elem.node))
+    return;
+
+  // Filter: cannot go back through incoming interface
+  if ((context->iif != NULL) && (context->iif->dest.iface == link))
+    return;
+
+  // Filter: cannot traverse a link that is disabled or disconnected
+  if (!net_iface_is_enabled(link) ||
+      !net_iface_is_connected(link))
+    return;
+
+  // Compute weight to reach destination through this link in each
+  // plane (max-metric if the link cannot be traversed)
+  for (tos= 0; tos < comp->depth; tos++) {
+    weights[tos]= IGP_MAX_WEIGHT;
+    if (!(context->planes & (1 << tos)))
+      continue;
+    weight= 0;
+    if (vertex->elem.type != LINK) {
+      weight= net_iface_get_metric(link, tos);
+      if ((weight == 0) || (weight == IGP_MAX_WEIGHT))
+	continue;
+    }
+    if (vertex->elem.type == SUBNET)
+      weights[tos]= vertex->weights[tos];
+    else
+      weights[tos]= net_igp_add_weights(vertex->weights[tos], weight);
+  }
+
+  // Update the SPT of each plane
+  for (tos= 0; tos < comp->depth; tos++) {
+    if (weights[tos] == IGP_MAX_WEIGHT)
+      continue;
+    if (next_vertex == NULL)
+      next_vertex= _mspt_get_vertex(comp, next_elem);
+
+    if (weights[tos] < next_vertex->weights[tos]) {
+      spt_vertex= next_vertex->vertices[tos];
+      if (spt_vertex == NULL) {
+	spt_vertex= spt_vertex_create(next_elem, weights[tos]);
+	spt_set_vertex(comp->spts[tos], spt_vertex);
+	next_vertex->vertices[tos]= spt_vertex;
+      } else {
+	spt_vertex->weight= weights[tos];
+	spt_vertex_clear_preds(spt_vertex);
+      }
+      spt_vertex_add_pred(spt_vertex, vertex->vertices[tos]);
+      next_vertex->weights[tos]= weights[tos];
+      planes|= (1 << tos);
+    } else if (weights[tos] == next_vertex->weights[tos]) {
+      spt_vertex_add_pred(next_vertex->vertices[tos],
+			  vertex->vertices[tos]);
+    }
+  }
+
+  ___igp_debug("  traverse link:%l\n", link);
+
+  if (planes != 0)
+    _mspt_push(comp, link, next_vertex, planes);
+}
+
+// -----[ spt_bfs_multi ]--------------------------------------------
+net_error_t spt_bfs_multi(net_node_t * root, igp_domain_t * domain,
+			  net_tos_t depth, spt_t ** spts)
+{
+  _mspt_comp_t comp;
+  _mspt_context_t * context;
+  _mspt_vertex_t * vertex;
+  net_ifaces_t * ifaces;
+  net_iface_t * link;
+  unsigned int index;
+  net_tos_t tos;
+
+  if ((depth == 0) || (depth > NET_LINK_MAX_DEPTH))
+    return EUNEXPECTED;
+
+  comp.depth= depth;
+  comp.domain= domain;
+  comp.fifo= fifo_create(100000, NULL);
+  comp.vertices= radix_tree_create(32, _mspt_vertex_destroy);
+
+  // Start with root node (src node), in all the planes
+  vertex= (_mspt_vertex_t *) MALLOC(sizeof(_mspt_vertex_t));
+  mem_stats_alloc(MEM_TAG_SPT, sizeof(_mspt_vertex_t));
+  vertex->elem.type= NODE;
+  vertex->elem.node= root;
+  for (tos= 0; tos < NET_LINK_MAX_DEPTH; tos++) {
+    vertex->weights[tos]= IGP_MAX_WEIGHT;
+    vertex->vertices[tos]= NULL;
+  }
+  for (tos= 0; tos < depth; tos++) {
+    comp.spts[tos]= spt_create(root);
+    vertex->weights[tos]= 0;
+    vertex->vertices[tos]= comp.spts[tos]->root;
+  }
+  assert(radix_tree_add(comp.vertices, root->rid, 32, vertex) >= 0);
+  ___igp_debug("START root:%e\n", &vertex->elem);
+  _mspt_push(&comp, NULL, vertex, (1 << depth) - 1);
+
+  // Breadth-First Search
+  while (fifo_depth(comp.fifo) > 0) {
+    context= (_mspt_context_t *) fifo_pop(comp.fifo);
+    vertex= context->vertex;
+
+    ___igp_debug("VISIT src:%e\n", &vertex->elem);
+
+    ifaces= NULL;
+    link= NULL;
+    switch (vertex->elem.type) {
+    case NODE:
+      ifaces= vertex->elem.node->ifaces;
+      break;
+    case SUBNET:
+      if (!subnet_is_transit(vertex->elem.subnet))
+	break;
+      ifaces= vertex->elem.subnet->ifaces;
+      break;
+    case LINK:
+      link= vertex->elem.link->dest.iface;
+      break;
+    default: abort();
+    }
+
+    if (link != NULL) {
+      _mspt_link_traverse(&comp, context, link);
+    } else if (ifaces != NULL) {
+      for (index= 0; index < net_ifaces_size(ifaces); index++)
+	_mspt_link_traverse(&comp, context, net_ifaces_at(ifaces, index));
+    }
+    FREE(context);
+  }
+  fifo_destroy(&comp.fifo);
+  radix_tree_destroy(&comp.vertices);
+
+  for (tos= 0; tos < depth; tos++)
+    spts[tos]= comp.spts[tos];
+  return ESUCCESS;
+}
+
 typedef gds_radix_tree_t fib_t;
 
 typedef struct _fib_comp_t {
@@ -484,7 +739,8 @@ static inline void _spt_install_fib_entry(fib_t * fib, ip_pfx_t prefix,
 static inline
 net_error_t _spt_install_fib(fib_t * fib,
 			     spt_vertex_t * vertex,
-			     rt_entry_t * rtentry)
+			     rt_entry_t * rtentry,
+			     net_tos_t tos)
 {
   unsigned int index;
   net_iface_t * iface;
@@ -499,8 +755,13 @@ net_error_t _spt_install_fib(fib_t * fib,
       if ((iface->type != NET_IFACE_LOOPBACK) &&
 	  (iface->type != NET_IFACE_VIRTUAL))
 	continue;
+      // A loopback without weight for this TOS uses its TOS 0 weight
       weight= vertex->weight;
-      weight= net_igp_add_weights(weight, net_iface_get_metric(iface, 0));
+      if ((iface->weights != NULL) &&
+	  (tos < net_igp_weights_depth(iface->weights)))
+	weight= net_igp_add_weights(weight, net_iface_get_metric(iface, tos));
+      else
+	weight= net_igp_add_weights(weight, net_iface_get_metric(iface, 0));
       _spt_install_fib_entry(fib, net_iface_dst_prefix(iface),
 			     weight, rt_entry_add_ref(rtentry));
     }
@@ -519,7 +780,8 @@ net_error_t _spt_install_fib(fib_t * fib,
 // -----[ _spt_compute_fib ]-----------------------------------------
 static inline
 net_error_t _spt_compute_fib(net_node_t * node,
-			     spt_t * spt, fib_t ** fib_ref)
+			     spt_t * spt, net_tos_t tos,
+			     fib_t ** fib_ref)
 {
   spt_vertex_t * vertex, * succ;
   gds_stack_t * stack= stack_create(10000);
@@ -558,7 +820,7 @@ net_error_t _spt_compute_fib(net_node_t * node,
 
       ___igp_debug("spt_compute_fib %v %r\n", succ, new_rtentry);
 
-      _spt_install_fib(fib, succ, new_rtentry);
+      _spt_install_fib(fib, succ, new_rtentry, tos);
       
       _fib_comp_push(stack, succ, new_rtentry);
     }
@@ -596,6 +858,7 @@ int igp_compute_domain(igp_domain_t * domain, int keep_spt)
 
     if (node->spt != NULL)
       spt_destroy(&node->spt);
+    igp_planes_destroy(&node->igp_planes);
     
     // Remove all IGP routes from node
     node_rt_del_route(node, NULL, NULL, NULL, NET_ROUTE_IGP);
@@ -606,7 +869,7 @@ int igp_compute_domain(igp_domain_t * domain, int keep_spt)
       continue;
 
     // Compute the FIB based on the SPT
-    result= _spt_compute_fib(node, node->spt, &fib);
+    result= _spt_compute_fib(node, node->spt, 0, &fib);
     if (result != ESUCCESS)
       continue;
     
@@ -622,3 +885,121 @@ int igp_compute_domain(igp_domain_t * domain, int keep_spt)
   enum_destroy(&routers);
   return result;
 }
+
+// -----[ _igp_compute_rt_for_each ]---------------------------------
+static int _igp_compute_rt_for_each(uint32_t key, uint8_t key_len,
+				    void * item, void * ctx)
+{
+  net_rt_t * rt= (net_rt_t *) ctx;
+  rt_info_t * rtinfo= (rt_info_t *) item;
+  ip_pfx_t prefix= { .network= key, .mask= key_len };
+
+  return rt_add_route(rt, prefix, rtinfo);
+}
+
+// -----[ _igp_domain_depth ]----------------------------------------
+/**
+ * Return the largest number of IGP weights (TOS) found on the links
+ * of the domain's routers.
+ */
+static net_tos_t _igp_domain_depth(igp_domain_t * domain)
+{
+  gds_enum_t * routers= trie_get_enum(domain->routers);
+  net_node_t * node;
+  net_iface_t * iface;
+  unsigned int index;
+  net_tos_t depth= 1;
+
+  while (enum_has_next(routers)) {
+    node= *((net_node_t **) enum_get_next(routers));
+    for (index= 0; index < net_ifaces_size(node->ifaces); index++) {
+      iface= net_ifaces_at(node->ifaces, index);
+      if ((iface->weights != NULL) &&
+	  (net_igp_weights_depth(iface->weights) > depth))
+	depth= net_igp_weights_depth(iface->weights);
+    }
+  }
+  enum_destroy(&routers);
+  return depth;
+}
+
+// -----[ igp_compute_domain_multi ]---------------------------------
+int igp_compute_domain_multi(igp_domain_t * domain, int keep_spt)
+{
+  gds_enum_t * routers= trie_get_enum(domain->routers);
+  net_tos_t depth= _igp_domain_depth(domain);
+  spt_t * spts[NET_LINK_MAX_DEPTH];
+  igp_planes_t * planes;
+  net_node_t * node;
+  fib_t * fib= NULL;
+  int result= ESUCCESS;
+  net_tos_t tos;
+
+  while (enum_has_next(routers) && (result == ESUCCESS)) {
+    node= *((net_node_t **) enum_get_next(routers));
+
+    if (node->spt != NULL)
+      spt_destroy(&node->spt);
+    igp_planes_destroy(&node->igp_planes);
+    
+    // Remove all IGP routes from node
+    node_rt_del_route(node, NULL, NULL, NULL, NET_ROUTE_IGP);
+
+    // Compute the SPTs of all the planes in one traversal
+    result= spt_bfs_multi(node, domain, depth, spts);
+    if (result != ESUCCESS)
+      continue;
+
+    planes= (igp_planes_t *) MALLOC(sizeof(igp_planes_t));
+    planes->depth= depth;
+    for (tos= 0; tos < NET_LINK_MAX_DEPTH; tos++) {
+      planes->spts[tos]= NULL;
+      planes->rts[tos]= NULL;
+    }
+    node->igp_planes= planes;
+    node->spt= spts[0];
+
+    for (tos= 0; (tos < depth) && (result == ESUCCESS); tos++) {
+      result= _spt_compute_fib(node, spts[tos], tos, &fib);
+      if (result != ESUCCESS)
+	break;
+
+      // TOS 0 routes are installed in the node's routing table, the
+      // routes of the other planes are stored aside
+      if (tos == 0) {
+	result= radix_tree_for_each(fib, _igp_compute_prefix_for_each,
+				    node);
+      } else {
+	planes->rts[tos]= rt_create();
+	result= radix_tree_for_each(fib, _igp_compute_rt_for_each,
+				    planes->rts[tos]);
+	planes->spts[tos]= spts[tos];
+      }
+      radix_tree_destroy(&fib);
+    }
+
+    if (!keep_spt) {
+      spt_destroy(&node->spt);
+      for (tos= 1; tos < depth; tos++)
+	spt_destroy(&planes->spts[tos]);
+    }
+  }
+  enum_destroy(&routers);
+  return result;
+}
+
+// -----[ igp_planes_destroy ]---------------------------------------
+void igp_planes_destroy(igp_planes_t ** planes_ref)
+{
+  igp_planes_t * planes= *planes_ref;
+  net_tos_t tos;
+
+  if (planes != NULL) {
+    for (tos= 0; tos < NET_LINK_MAX_DEPTH; tos++) {
+      spt_destroy(&planes->spts[tos]);
+      rt_destroy(&planes->rts[tos]);
+    }
+    FREE(planes);
+    *planes_ref= NULL;
+  }
+}
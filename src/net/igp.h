@@ -40,10 +40,26 @@
 #define __NET_IGP_H__
 
 #include <net/igp_domain.h>
+#include <net/link.h>
 #include <net/network.h>
 #include <net/prefix.h>
 #include <net/spt.h>
 
+// -----[ igp_planes_t ]---------------------------------------------
+/**
+ * Results of a multi-topology computation for the TOS other than
+ * 0. The TOS 0 routes and SPT are stored in the node's routing
+ * table and SPT, as for a single-topology computation.
+ */
+typedef struct igp_planes_t {
+  /** Number of planes (TOS) computed. */
+  net_tos_t   depth;
+  /** SPT of each plane (only kept if requested, NULL for TOS 0). */
+  spt_t     * spts[NET_LINK_MAX_DEPTH];
+  /** IGP routes of each plane (NULL for TOS 0). */
+  net_rt_t  * rts[NET_LINK_MAX_DEPTH];
+} igp_planes_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -77,6 +93,47 @@ extern "C" {
   net_error_t spt_bfs(net_node_t * src_node, igp_domain_t * domain,
 		      spt_t ** spt_ref);
 
+  // -----[ spt_bfs_multi ]------------------------------------------
+  /**
+   * Compute the SPTs of several TOS (planes) in a single traversal
+   * of the IGP domain. Each visited element keeps a vector with its
+   * weight in every plane. The SPT of each plane is identical to
+   * the SPT computed by spt_bfs() with the weights of that TOS.
+   *
+   * A link that has no weight for a TOS cannot be traversed in that
+   * plane.
+   *
+   * \param src_node is the node at the root of the SPTs.
+   * \param domain   is the target IGP domain.
+   * \param depth    is the number of planes (TOS 0 to depth-1).
+   * \param spts     is an array of depth SPTs to be computed.
+   * \retval ESUCCESS in case of success, a negative error code
+   *         otherwize.
+   */
+  net_error_t spt_bfs_multi(net_node_t * src_node, igp_domain_t * domain,
+			    net_tos_t depth, spt_t ** spts);
+
+  // -----[ igp_compute_domain_multi ]-------------------------------
+  /**
+   * Compute the routes of all the TOS (planes) for each router
+   * within an IGP domain. The number of planes is the largest
+   * number of IGP weights found on the domain's links.
+   *
+   * The TOS 0 routes are installed in the routing table of each
+   * router. The routes of the other planes are stored in the
+   * router's igp_planes (they are not used for forwarding).
+   *
+   * \param domain   is the target IGP domain.
+   * \param keep_spt tells whether or not the computed SPTs must be
+   *                 kept.
+   * \retval ESUCCESS in case of success, a negative error code
+   *         otherwize.
+   */
+  int igp_compute_domain_multi(igp_domain_t * domain, int keep_spt);
+
+  // -----[ igp_planes_destroy ]-------------------------------------
+  void igp_planes_destroy(igp_planes_t ** planes_ref);
+
 
 #ifdef __cplusplus
 }
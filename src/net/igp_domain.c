@@ -153,6 +153,20 @@ int igp_domain_compute(igp_domain_t * domain, int keep_spt)
   }
 }
 
+// -----[ igp_domain_compute_multi ]---------------------------------
+int igp_domain_compute_multi(igp_domain_t * domain, int keep_spt)
+{
+  switch (domain->type) {
+  case IGP_DOMAIN_IGP:
+    return igp_compute_domain_multi(domain, keep_spt);
+  case IGP_DOMAIN_OSPF:
+    return -1;
+  default:
+    cbgp_fatal("invalid IGP domain type (%d)", domain->type);
+    abort();
+  }
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -128,6 +128,16 @@ extern "C" {
    */
   int igp_domain_compute(igp_domain_t * domain, int keep_spt);
 
+  // -----[ igp_domain_compute_multi ]-------------------------------
+  /**
+   * Compute the routes of all the TOS within an IGP domain, in a
+   * single traversal per router (see igp_compute_domain_multi()).
+   * Only supported by the IGP model.
+   *
+   * \retval 0 on success, -1 on error.
+   */
+  int igp_domain_compute_multi(igp_domain_t * domain, int keep_spt);
+
   
   ///////////////////////////////////////////////////////////////////
   // LIST OF IGP DOMAINS
@@ -119,20 +119,18 @@ static void _ipip_msg_destroy(void ** payload_ref)
   message_destroy(&msg);
 }
 
-// -----[ ipip_iface_send ]------------------------------------------
+// -----[ ipip_encap ]-----------------------------------------------
 /**
- * This is the tunnel interface send function.
+ * Encapsulate a message into an IP-in-IP message addressed to the
+ * tunnel end-point.
  */
-static int _ipip_iface_send(net_iface_t * self,
-			    net_addr_t next_hop,
-			    net_msg_t * msg)
+net_error_t ipip_encap(net_iface_t * tunnel, net_msg_t * msg,
+		       net_msg_t ** outer_msg_ref)
 {
-  ipip_data_t * ctx= (ipip_data_t *) self->user_data;
+  ipip_data_t * ctx= (ipip_data_t *) tunnel->user_data;
   net_addr_t src_addr= ctx->src_addr;
   net_msg_t * outer_msg;
 
-  ___ipip_debug("_ipip_iface_send msg=%m\n", msg);
-
   if (ctx->oif != NULL) {
     // Default IP encap source address = outgoing interface's address.
     if (src_addr == NET_ADDR_ANY)
@@ -141,51 +139,93 @@ static int _ipip_iface_send(net_iface_t * self,
     //TO BE WRITTEN: return node_ip_output(); ...
     return EUNSUPPORTED;
 
-  } else {
+  }
 
-    outer_msg= message_create(src_addr, self->dest.end_point,
-			      NET_PROTOCOL_IPIP, 255, msg,
-			      _ipip_msg_destroy);
+  outer_msg= message_create(src_addr, tunnel->dest.end_point,
+			    NET_PROTOCOL_IPIP, 255, msg,
+			    _ipip_msg_destroy);
 
-    ip_opt_hook_msg_encap(self->owner, outer_msg, msg);
+  ip_opt_hook_msg_encap(tunnel->owner, outer_msg, msg);
 
-    node_send(self->owner, outer_msg, NULL, NULL);
-    return ESUCCESS;
-  }
+  *outer_msg_ref= outer_msg;
+  return ESUCCESS;
 }
 
-// -----[ ipip_iface_recv ]------------------------------------------
+// -----[ ipip_decap ]-----------------------------------------------
 /**
- * This is the tunnel interface receive function.
- *
- * Note: this function is responsible for destroying the received
- *       message. This is a bit different from a protocol handler,
- *       but is exactly the same behavior as an interface.
+ * Decapsulate an IP-in-IP message received on a tunnel interface.
+ * The outer message is destroyed and the inner message is returned
+ * (NULL if the message is not an IP-in-IP message).
  */
-static int _ipip_iface_recv(net_iface_t * self, net_msg_t * msg)
+net_msg_t * ipip_decap(net_iface_t * tunnel, net_msg_t * msg)
 {
   net_msg_t * outer_msg;
   net_msg_t * inner_msg;
 
-  ___ipip_debug("_ipip_iface_recv msg=%m\n", msg);
-
   if (msg->protocol != NET_PROTOCOL_IPIP) {
     /* Discard packet silently ? should log */
     stream_printf(gdserr, "non-IPIP packet received on tunnel interface\n");
-    return -1;
+    return NULL;
   }
 
   outer_msg= msg;
   inner_msg= (net_msg_t *) outer_msg->payload;
 
-  ip_opt_hook_msg_decap(self->owner, outer_msg, inner_msg);
+  ip_opt_hook_msg_decap(tunnel->owner, outer_msg, inner_msg);
 
   outer_msg->payload= NULL;
   message_destroy(&outer_msg);
+  return inner_msg;
+}
+
+// -----[ ipip_iface_send ]------------------------------------------
+/**
+ * This is the tunnel interface send function.
+ */
+static int _ipip_iface_send(net_iface_t * self,
+			    net_addr_t next_hop,
+			    net_msg_t * msg)
+{
+  net_msg_t * outer_msg;
+  net_error_t error;
+
+  ___ipip_debug("_ipip_iface_send msg=%m\n", msg);
+
+  error= ipip_encap(self, msg, &outer_msg);
+  if (error != ESUCCESS)
+    return error;
+
+  node_send(self->owner, outer_msg, NULL, NULL);
+  return ESUCCESS;
+}
+
+// -----[ ipip_iface_recv ]------------------------------------------
+/**
+ * This is the tunnel interface receive function.
+ *
+ * Note: this function is responsible for destroying the received
+ *       message. This is a bit different from a protocol handler,
+ *       but is exactly the same behavior as an interface.
+ */
+static int _ipip_iface_recv(net_iface_t * self, net_msg_t * msg)
+{
+  net_msg_t * inner_msg;
+
+  ___ipip_debug("_ipip_iface_recv msg=%m\n", msg);
+
+  inner_msg= ipip_decap(self, msg);
+  if (inner_msg == NULL)
+    return -1;
 
   return node_recv_msg(self->owner, self, inner_msg);
 }
 
+// -----[ ipip_iface_is_tunnel ]-------------------------------------
+int ipip_iface_is_tunnel(net_iface_t * iface)
+{
+  return (iface->ops.send == _ipip_iface_send);
+}
+
 // -----[ ipip_link_create ]-----------------------------------------
 /**
  * Create a tunnel interface.
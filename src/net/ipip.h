@@ -42,6 +42,16 @@ extern "C" {
   int ipip_link_create(net_node_t * node, net_addr_t end_point,
 		       net_addr_t addr, net_iface_t * oif,
 		       net_addr_t src_addr, net_iface_t ** ppLink);
+  // -----[ ipip_encap ]---------------------------------------------
+  net_error_t ipip_encap(net_iface_t * tunnel, net_msg_t * msg,
+			 net_msg_t ** outer_msg_ref);
+  // -----[ ipip_decap ]---------------------------------------------
+  net_msg_t * ipip_decap(net_iface_t * tunnel, net_msg_t * msg);
+  // -----[ ipip_iface_is_tunnel ]-----------------------------------
+  /**
+   * Test if an interface is the entry point of an IP-in-IP tunnel.
+   */
+  int ipip_iface_is_tunnel(net_iface_t * iface);
 
 #ifdef __cplusplus
 }
@@ -40,7 +40,7 @@ igp_weights_t * net_igp_weights_create(net_tos_t depth,
 {
   unsigned int index;
   igp_weights_t * weights;
-  assert((depth > 0) && (depth < NET_LINK_MAX_DEPTH));
+  assert((depth > 0) && (depth <= NET_LINK_MAX_DEPTH));
   weights= (igp_weights_t *) uint32_array_create(depth);
   for (index= 0; index < depth; index++)
     weights->data[index]= dflt;
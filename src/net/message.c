@@ -34,6 +34,7 @@
 #include <net/icmp_options.h>
 #include <net/message.h>
 #include <net/protocol.h>
+#include <util/mem_stats.h>
 
 //#define NET_MSG_DEBUG
 
@@ -51,6 +52,7 @@ net_msg_t * message_create(net_addr_t src_addr, net_addr_t dst_addr,
 			   void * payload, FPayLoadDestroy destroy)
 {
   net_msg_t * msg= (net_msg_t *) MALLOC(sizeof(net_msg_t));
+  mem_stats_alloc(MEM_TAG_MSG, sizeof(net_msg_t));
   msg->src_addr= src_addr;
   msg->dst_addr= dst_addr;
   msg->protocol= proto;
@@ -76,6 +78,7 @@ void message_destroy(net_msg_t ** msg_ref)
     if (msg->opts != NULL)
       ip_options_destroy(&msg->opts);
     FREE(msg);
+    mem_stats_free(MEM_TAG_MSG, sizeof(net_msg_t));
     *msg_ref= NULL;
   }
   __debug("message_destroy::END");
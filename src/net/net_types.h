@@ -63,6 +63,7 @@ typedef uint32_t net_link_load_t;
 
 // -----[ Forward declarations ]-------------------------------------
 struct spt_t;
+struct igp_planes_t;
 
 // -----[ coord_t ]--------------------------------------------------
 /** Definition of geographical coordinates. */
@@ -291,6 +292,8 @@ typedef struct {
 #endif
 
   struct spt_t    * spt;
+  /** Routes of the other TOS (multi-topology computation). */
+  struct igp_planes_t * igp_planes;
 } net_node_t;
 
 
@@ -836,6 +836,17 @@ void network_destroy(network_t ** network_ref)
   }
 }
 
+// -----[ network_clear ]--------------------------------------------
+void network_clear(network_t * network)
+{
+  igp_domains_destroy(&network->domains);
+  trie_destroy(&network->nodes);
+  subnets_destroy(&network->subnets);
+  network->domains= igp_domains_create();
+  network->nodes= trie_create(network_nodes_destroy);
+  network->subnets= subnets_create();
+}
+
 // -----[ network_get_default ]--------------------------------------
 /**
  * Get the default network.
@@ -993,3 +1004,15 @@ void _network_done()
     network_destroy(&_default_network);
 }
 
+// -----[ _network_swap ]--------------------------------------------
+void _network_swap(network_t ** network_ref, simulator_t ** sim_ref)
+{
+  network_t * network= _default_network;
+  simulator_t * sim= _thread_sim;
+
+  _default_network= *network_ref;
+  _thread_sim= *sim_ref;
+  *network_ref= network;
+  *sim_ref= sim;
+}
+
@@ -165,6 +165,16 @@ extern "C" {
    */
   void network_destroy(network_t ** network_ref);
 
+  // -----[ network_clear ]------------------------------------------
+  /**
+   * Remove and destroy all the nodes, subnets and IGP domains of a
+   * network. The BGP routers hosted by the nodes must have been
+   * removed from their BGP domain beforehand.
+   *
+   * \param network is the network to be cleared.
+   */
+  void network_clear(network_t * network);
+
   // -----[ network_get_default ]------------------------------------
   network_t * network_get_default();
 
@@ -252,6 +262,14 @@ extern "C" {
    */
   void _network_done();
 
+  // -----[ _network_swap ]------------------------------------------
+  /**
+   * Exchange the default network and the current simulator with
+   * the given ones. This function is used by the library to switch
+   * between simulation contexts.
+   */
+  void _network_swap(network_t ** network_ref, simulator_t ** sim_ref);
+
   ///////////////////////////////////////////////////////////////////
   // FUNCTIONS FOR GLOBAL TOPOLOGY MANAGEMENT
   ///////////////////////////////////////////////////////////////////
@@ -33,6 +33,7 @@
 
 #include <net/error.h>
 #include <net/icmp.h>
+#include <net/igp.h>
 #include <net/link.h>
 #include <net/link-list.h>
 #include <net/net_types.h>
@@ -65,6 +66,7 @@ net_error_t node_create(net_addr_t rid, net_node_t ** node_ref,
 				      ARRAY_OPTION_UNIQUE|
 				      ARRAY_OPTION_SORTED);
   node->spt= NULL;
+  node->igp_planes= NULL;
 
   // Activate ICMP protocol
   error= node_register_protocol(node, NET_PROTOCOL_ICMP, node);
@@ -109,6 +111,7 @@ void node_destroy(net_node_t ** node_ref)
     if ((*node_ref)->name)
       str_destroy(&(*node_ref)->name);
     spt_destroy(&((*node_ref)->spt));
+    igp_planes_destroy(&((*node_ref)->igp_planes));
     FREE(*node_ref);
     *node_ref= NULL;
   }
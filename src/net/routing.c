@@ -31,12 +31,15 @@
 #include <assert.h>
 #include <string.h>
 
+#include <libgds/hash.h>
 #include <libgds/stream.h>
 #include <libgds/memory.h>
 #include <net/network.h>
 #include <net/node.h>
 #include <net/routing.h>
+#include <net/rt_lpm.h>
 #include <ui/output.h>
+#include <util/mem_stats.h>
 #include <util/str_format.h>
 
 //#define ROUTING_DEBUG
@@ -98,6 +101,7 @@ static inline void ___routing_debug(const char * format, ...)
 rt_entry_t * rt_entry_create(net_iface_t * oif, net_addr_t gateway)
 {
   rt_entry_t * entry= (rt_entry_t *) MALLOC(sizeof(rt_entry_t));
+  mem_stats_alloc(MEM_TAG_FIB, sizeof(rt_entry_t));
   entry->oif= oif;
   entry->gateway= gateway;
   entry->ref_cnt= 1;
@@ -116,6 +120,7 @@ void rt_entry_destroy(rt_entry_t ** entry_ref)
       return;
     ___routing_debug("rt_entry_destroy %e\n", *entry_ref);
     FREE(*entry_ref);
+    mem_stats_free(MEM_TAG_FIB, sizeof(rt_entry_t));
     *entry_ref= NULL;
   }
 }
@@ -279,6 +284,136 @@ void rt_entries_dump(gds_stream_t * stream, const rt_entries_t * entries)
 }
 
 
+/////////////////////////////////////////////////////////////////////
+// NEXT-HOP GROUPS (shared rt_entries_t)
+/////////////////////////////////////////////////////////////////////
+
+/**
+ * A next-hop group is an interned array of routing table entries
+ * that is shared by all the routes (of any node) with the same set
+ * of next-hops. This is mostly useful for BGP routes: a full table
+ * only refers to a handful of BGP next-hops.
+ */
+typedef struct {
+  rt_entries_t * entries;
+  unsigned int   ref_cnt;
+} _rt_group_t;
+
+static gds_hash_set_t * _rt_groups= NULL;
+static unsigned int     _rt_groups_size= 1024;
+static unsigned int     _rt_groups_count= 0;
+
+// -----[ _rt_groups_compute ]---------------------------------------
+static uint32_t _rt_groups_compute(const void * item,
+				   unsigned int hash_size)
+{
+  const _rt_group_t * group= (const _rt_group_t *) item;
+  const rt_entry_t * entry;
+  unsigned int index;
+  uint32_t key= rt_entries_size(group->entries);
+
+  for (index= 0; index < rt_entries_size(group->entries); index++) {
+    entry= rt_entries_get_at(group->entries, index);
+    key= key * 31 + entry->gateway;
+    key= key * 31 + (uint32_t) (unsigned long) entry->oif;
+  }
+  return key % hash_size;
+}
+
+// -----[ _rt_groups_compare ]---------------------------------------
+static int _rt_groups_compare(const void * item1, const void * item2,
+			      unsigned int elt_size)
+{
+  const _rt_group_t * group1= (const _rt_group_t *) item1;
+  const _rt_group_t * group2= (const _rt_group_t *) item2;
+  const rt_entry_t * entry1, * entry2;
+  unsigned int index;
+
+  if (rt_entries_size(group1->entries) == rt_entries_size(group2->entries)) {
+    for (index= 0; index < rt_entries_size(group1->entries); index++) {
+      entry1= rt_entries_get_at(group1->entries, index);
+      entry2= rt_entries_get_at(group2->entries, index);
+      if ((entry1->gateway != entry2->gateway) ||
+	  (entry1->oif != entry2->oif))
+	break;
+    }
+    if (index == rt_entries_size(group1->entries))
+      return 0;
+  }
+  return (item1 < item2) ? -1 : 1;
+}
+
+// -----[ rt_entries_intern ]----------------------------------------
+/**
+ * Replace an array of entries by the next-hop group with the same
+ * entries. If the group already exists, the given array is destroyed
+ * and a new reference to the group's array is returned. Otherwise,
+ * the array itself becomes the group's array.
+ *
+ * A shared array must not be modified and must be released with
+ * rt_entries_release().
+ */
+rt_entries_t * rt_entries_intern(rt_entries_t * entries)
+{
+  _rt_group_t key= { .entries= entries };
+  _rt_group_t * group;
+
+  if (_rt_groups == NULL)
+    _rt_groups= hash_set_create(_rt_groups_size, 0,
+				_rt_groups_compare, NULL,
+				_rt_groups_compute);
+
+  group= (_rt_group_t *) hash_set_search(_rt_groups, &key);
+  if (group != NULL) {
+    rt_entries_destroy(&entries);
+  } else {
+    group= (_rt_group_t *) MALLOC(sizeof(_rt_group_t));
+    mem_stats_alloc(MEM_TAG_FIB, sizeof(_rt_group_t));
+    group->entries= entries;
+    group->ref_cnt= 0;
+    hash_set_add(_rt_groups, group);
+    _rt_groups_count++;
+  }
+  group->ref_cnt++;
+  return group->entries;
+}
+
+// -----[ rt_entries_release ]---------------------------------------
+/**
+ * Release a reference to a shared array of entries. The next-hop
+ * group is freed along with its last reference.
+ */
+void rt_entries_release(rt_entries_t ** entries_ref)
+{
+  _rt_group_t key= { .entries= *entries_ref };
+  _rt_group_t * group;
+
+  if (*entries_ref == NULL)
+    return;
+
+  group= (_rt_group_t *) hash_set_search(_rt_groups, &key);
+  assert((group != NULL) && (group->entries == *entries_ref));
+  *entries_ref= NULL;
+
+  if (--group->ref_cnt > 0)
+    return;
+  hash_set_remove(_rt_groups, group);
+  _rt_groups_count--;
+  rt_entries_destroy(&group->entries);
+  FREE(group);
+  mem_stats_free(MEM_TAG_FIB, sizeof(_rt_group_t));
+}
+
+// -----[ rt_entries_groups ]----------------------------------------
+/**
+ * Return the number of next-hop groups currently in use.
+ */
+unsigned int rt_entries_groups()
+{
+  return _rt_groups_count;
+}
+
+
 /////////////////////////////////////////////////////////////////////
 //
 // ROUTE (rt_info_t)
@@ -291,19 +426,42 @@ rt_info_t * rt_info_create(ip_pfx_t prefix,
 			   net_route_type_t type)
 {
   rt_info_t * rtinfo= (rt_info_t *) MALLOC(sizeof(rt_info_t));
+  mem_stats_alloc(MEM_TAG_FIB, sizeof(rt_info_t));
   rtinfo->prefix= prefix;
   rtinfo->entries= rt_entries_create();
   rtinfo->metric= metric;
   rtinfo->type= type;
+  rtinfo->shared= 0;
   return rtinfo;
 }
 
+// -----[ _rt_info_release_entries ]---------------------------------
+static inline void _rt_info_release_entries(rt_info_t * rtinfo)
+{
+  if (rtinfo->shared)
+    rt_entries_release(&rtinfo->entries);
+  else
+    rt_entries_destroy(&rtinfo->entries);
+  rtinfo->shared= 0;
+}
+
 // -----[ rt_info_add_entry ]----------------------------------------
 int rt_info_add_entry(rt_info_t * rtinfo,
 		      net_iface_t * oif, net_addr_t gateway)
 {
-  rt_entry_t * entry= rt_entry_create(oif, gateway);
-  int result= rt_entries_add(rtinfo->entries, entry);
+  rt_entry_t * entry;
+  rt_entries_t * entries;
+  int result;
+
+  // Make the entries private before modifying them
+  if (rtinfo->shared) {
+    entries= rt_entries_copy(rtinfo->entries);
+    _rt_info_release_entries(rtinfo);
+    rtinfo->entries= entries;
+  }
+
+  entry= rt_entry_create(oif, gateway);
+  result= rt_entries_add(rtinfo->entries, entry);
   if (result < 0)
     rt_entry_destroy(&entry);
   return result;
@@ -312,17 +470,31 @@ int rt_info_add_entry(rt_info_t * rtinfo,
 // -----[ rt_info_set_entries ]--------------------------------------
 int rt_info_set_entries(rt_info_t * rtinfo, rt_entries_t * entries)
 {
-  rt_entries_destroy(&rtinfo->entries);
+  _rt_info_release_entries(rtinfo);
   rtinfo->entries= entries;
   return ESUCCESS;
 }
 
+// -----[ rt_info_intern ]-------------------------------------------
+/**
+ * Make the route's entries point to the shared next-hop group with
+ * the same entries.
+ */
+void rt_info_intern(rt_info_t * rtinfo)
+{
+  if (rtinfo->shared)
+    return;
+  rtinfo->entries= rt_entries_intern(rtinfo->entries);
+  rtinfo->shared= 1;
+}
+
 // -----[ rt_info_destroy ]------------------------------------------
 void rt_info_destroy(rt_info_t ** rtinfo_ref)
 {
   if (*rtinfo_ref != NULL) {
-    rt_entries_destroy(&(*rtinfo_ref)->entries);
+    _rt_info_release_entries(*rtinfo_ref);
     FREE(*rtinfo_ref);
+    mem_stats_free(MEM_TAG_FIB, sizeof(rt_info_t));
     *rtinfo_ref= NULL;
   }
 }
@@ -494,8 +666,12 @@ static int _net_info_removal_for_each(const void * item,
 {
   net_rt_t * rt= (net_rt_t *) ctx;
   ip_pfx_t * prefix= *(ip_pfx_t **) item;
+  int result;
 
-  return trie_remove(rt, prefix->network, prefix->mask);
+  result= trie_remove(rt->trie, prefix->network, prefix->mask);
+  if (result == 0)
+    rt->num_prefixes--;
+  return result;
 }
 
 // -----[ _net_info_removal ]----------------------------------------
@@ -582,7 +758,13 @@ static void _rt_il_dst(void ** ppItem)
  */
 net_rt_t * rt_create()
 {
-  return (net_rt_t *) trie_create(_rt_il_dst);
+  net_rt_t * rt= (net_rt_t *) MALLOC(sizeof(net_rt_t));
+  rt->trie= trie_create(_rt_il_dst);
+  rt->generation= 0;
+  rt->num_prefixes= 0;
+  rt->lookups= 0;
+  rt->lpm= NULL;
+  return rt;
 }
 
 // ----- rt_destroy -------------------------------------------------
@@ -591,7 +773,42 @@ net_rt_t * rt_create()
  */
 void rt_destroy(net_rt_t ** rt_ref)
 {
-  trie_destroy(rt_ref);
+  if (*rt_ref != NULL) {
+    rt_lpm_destroy(&(*rt_ref)->lpm);
+    trie_destroy(&(*rt_ref)->trie);
+    FREE(*rt_ref);
+    *rt_ref= NULL;
+  }
+}
+
+// -----[ _rt_changed ]----------------------------------------------
+/**
+ * Record a change of the routing table. The compiled lookup
+ * snapshot becomes outdated.
+ */
+static inline void _rt_changed(net_rt_t * rt)
+{
+  rt->generation++;
+  rt->lookups= 0;
+}
+
+// -----[ _rt_lpm_get ]----------------------------------------------
+/**
+ * Return an up-to-date compiled lookup snapshot, or NULL if the
+ * routing table changed too recently. The snapshot is (re)built only
+ * once the number of lookups since the last change is large enough
+ * to amortize the cost of the compilation. This keeps the snapshot
+ * out of the way during the convergence.
+ */
+static inline rt_lpm_t * _rt_lpm_get(net_rt_t * rt)
+{
+  if ((rt->lpm != NULL) && (rt->lpm->generation == rt->generation))
+    return rt->lpm;
+  if (++rt->lookups < RT_LPM_MIN_LOOKUPS + (rt->num_prefixes >> 2))
+    return NULL;
+  rt_lpm_destroy(&rt->lpm);
+  rt->lpm= rt_lpm_build(rt);
+  return rt->lpm;
 }
 
 // -----[ rt_find_best ]---------------------------------------------
@@ -611,10 +828,18 @@ rt_info_t * rt_find_best(net_rt_t * rt, net_addr_t addr,
   rt_infos_t * list;
   int index;
   rt_info_t * rtinfo;
+  rt_lpm_t * lpm;
+
+  /* Use the compiled snapshot if any route type is ok */
+  if (type == NET_ROUTE_ANY) {
+    lpm= _rt_lpm_get(rt);
+    if (lpm != NULL)
+      return rt_lpm_lookup(lpm, addr);
+  }
 
   /* First, retrieve the list of routes that best match the given
      prefix */
-  list= (rt_infos_t *) trie_find_best(rt, addr, 32);
+  list= (rt_infos_t *) trie_find_best(rt->trie, addr, 32);
 
   /* Then, select the first returned route that matches the given
      route-type (if requested) */
@@ -653,7 +878,7 @@ rt_info_t * rt_find_exact(net_rt_t * rt, ip_pfx_t prefix,
   /* First, retrieve the list of routes that exactly match the given
      prefix */
   list= (rt_infos_t *)
-    trie_find_exact(rt, prefix.network, prefix.mask);
+    trie_find_exact(rt->trie, prefix.network, prefix.mask);
 
   /* Then, select the first returned route that matches the given
      route-type (if requested) */
@@ -684,7 +909,7 @@ int rt_add_route(net_rt_t * rt, ip_pfx_t prefix,
 {
   rt_infos_t * list;
 
-  list= (rt_infos_t *) trie_find_exact(rt,
+  list= (rt_infos_t *) trie_find_exact(rt->trie,
 					   prefix.network,
 					   prefix.mask);
 
@@ -693,13 +918,16 @@ int rt_add_route(net_rt_t * rt, ip_pfx_t prefix,
 
     list= _rt_info_list_create();
     assert(_rt_info_list_add(list, rtinfo) == ESUCCESS);
-    trie_insert(rt, prefix.network, prefix.mask, list, 0);
+    trie_insert(rt->trie, prefix.network, prefix.mask, list, 0);
+    rt->num_prefixes++;
 
   } else {
 
-    return _rt_info_list_add(list, rtinfo);
+    if (_rt_info_list_add(list, rtinfo) != ESUCCESS)
+      return ENET_RT_DUPLICATE;
 
   }
+  _rt_changed(rt);
   return ESUCCESS;
 }
 
@@ -744,7 +972,7 @@ net_error_t rt_del_routes(net_rt_t * rt, rt_filter_t * filter)
   if (filter->prefix != NULL) {
 
     /* Get the list of routes towards the given prefix */
-    list= (rt_infos_t *) trie_find_exact(rt,
+    list= (rt_infos_t *) trie_find_exact(rt->trie,
 					     filter->prefix->network,
 					     filter->prefix->mask);
     error= _rt_del_for_each(filter->prefix->network,
@@ -755,12 +983,13 @@ net_error_t rt_del_routes(net_rt_t * rt, rt_filter_t * filter)
 
     /* Remove all the routes that match the given attributes, whatever
        the prefix is */
-    error= trie_for_each(rt, _rt_del_for_each, filter);
+    error= trie_for_each(rt->trie, _rt_del_for_each, filter);
 
   }
 
   // Post-processing, remove empty rtinfo lists
   _net_info_removal(filter, rt);
+  _rt_changed(rt);
 
   return error;
 }
@@ -830,7 +1059,7 @@ int rt_for_each(net_rt_t * rt, FRadixTreeForEach fForEach,
   for_each_ctx.fForEach= fForEach;
   for_each_ctx.ctx= ctx;
 
-  return trie_for_each(rt, _rt_for_each_function, &for_each_ctx);
+  return trie_for_each(rt->trie, _rt_for_each_function, &for_each_ctx);
 }
 
 
@@ -926,7 +1155,7 @@ void rt_dump(gds_stream_t * stream, net_rt_t * rt, ip_dest_t dest)
   switch (dest.type) {
 
   case NET_DEST_ANY:
-    trie_for_each(rt, _rt_dump_for_each, stream);
+    trie_for_each(rt->trie, _rt_dump_for_each, stream);
     break;
 
   case NET_DEST_ADDRESS:
@@ -950,3 +1179,12 @@ void rt_dump(gds_stream_t * stream, net_rt_t * rt, ip_dest_t dest)
   }
 }
 
+// -----[ _routing_destroy ]-----------------------------------------
+/**
+ * Free the table of next-hop groups. The groups are released along
+ * with the routes that use them.
+ */
+void _routing_destroy()
+{
+  hash_set_destroy(&_rt_groups);
+}
@@ -85,6 +85,8 @@ typedef struct {
   rt_entries_t   * entries;
   /** How the route was learned (routing protocol). */
   net_route_type_t type;
+  /** Tells if the entries are a shared next-hop group. */
+  uint8_t          shared;
 } rt_info_t;
 
 
@@ -129,6 +131,18 @@ extern "C" {
   void rt_entries_dump(gds_stream_t * stream, const rt_entries_t * entries);
 
 
+  ///////////////////////////////////////////////////////////////////
+  // NEXT-HOP GROUPS (shared rt_entries_t)
+  ///////////////////////////////////////////////////////////////////
+
+  // -----[ rt_entries_intern ]--------------------------------------
+  rt_entries_t * rt_entries_intern(rt_entries_t * entries);
+  // -----[ rt_entries_release ]-------------------------------------
+  void rt_entries_release(rt_entries_t ** entries_ref);
+  // -----[ rt_entries_groups ]--------------------------------------
+  unsigned int rt_entries_groups();
+
+
   ///////////////////////////////////////////////////////////////////
   // ROUTE (rt_info_t)
   ///////////////////////////////////////////////////////////////////
@@ -143,6 +157,8 @@ extern "C" {
 			net_iface_t * oif, net_addr_t gateway);
   // -----[ rt_info_set_entries ]--------------------------------------
   int rt_info_set_entries(rt_info_t * rtinfo, rt_entries_t * entries);
+  // -----[ rt_info_intern ]----------------------------------------
+  void rt_info_intern(rt_info_t * rtinfo);
   // -----[ rt_info_dump ]-------------------------------------------
   void rt_info_dump(gds_stream_t * stream, const rt_info_t * rtinfo);
 
@@ -178,6 +194,9 @@ extern "C" {
   // ----- rt_for_each ----------------------------------------------
   int rt_for_each(net_rt_t * rt, FRadixTreeForEach for_each,
 		  void * ctx);
+
+  // -----[ _routing_destroy ]---------------------------------------
+  void _routing_destroy();
   
 #ifdef __cplusplus
 }
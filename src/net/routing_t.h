@@ -43,6 +43,27 @@
 
 typedef uint8_t net_route_type_t;
 
-typedef gds_trie_t net_rt_t;
+struct rt_lpm_t;
+
+/**
+ * Definition of a routing table.
+ *
+ * The routes are stored in a trie of route-info lists. A read-only
+ * snapshot of the longest-match lookups (see rt_lpm.h) is compiled
+ * when the table does not change for a while. The generation number
+ * is increased each time the table is modified.
+ */
+typedef struct {
+  /** Trie of route-info lists (one per prefix). */
+  gds_trie_t      * trie;
+  /** Generation number (increased on each change). */
+  unsigned int      generation;
+  /** Number of prefixes. */
+  unsigned int      num_prefixes;
+  /** Number of lookups since the last change. */
+  unsigned int      lookups;
+  /** Compiled lookup snapshot (can be NULL or outdated). */
+  struct rt_lpm_t * lpm;
+} net_rt_t;
 
 #endif /* __NET_ROUTING_T_H__ */
@@ -0,0 +1,221 @@
+// ==================================================================
+// @(#)rt_lpm.c
+//
+// Compiled (read-only) longest-match lookup structure.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include <libgds/memory.h>
+
+#include <net/rt_lpm.h>
+
+// -----[ _lpm_pfx_t ]-----------------------------------------------
+typedef struct {
+  uint32_t    start;
+  uint32_t    end;
+  uint8_t     mask;
+  rt_info_t * info;
+} _lpm_pfx_t;
+
+// -----[ _lpm_ctx_t ]-----------------------------------------------
+typedef struct {
+  _lpm_pfx_t   * pfxs;
+  unsigned int   num_pfxs;
+} _lpm_ctx_t;
+
+// -----[ _lpm_collect ]---------------------------------------------
+static int _lpm_collect(uint32_t key, uint8_t key_len,
+			void * item, void * ctx)
+{
+  _lpm_ctx_t * lpm_ctx= (_lpm_ctx_t *) ctx;
+  rt_infos_t * list= (rt_infos_t *) item;
+  _lpm_pfx_t * pfx= &lpm_ctx->pfxs[lpm_ctx->num_pfxs++];
+  uint32_t mask= (key_len == 0) ? 0 : (0xFFFFFFFFu << (32-key_len));
+
+  pfx->start= key & mask;
+  pfx->end= pfx->start | ~mask;
+  pfx->mask= key_len;
+  pfx->info= (rt_info_t *) list->data[0];
+  return 0;
+}
+
+// -----[ _lpm_count ]-----------------------------------------------
+static int _lpm_count(uint32_t key, uint8_t key_len,
+		      void * item, void * ctx)
+{
+  (*((unsigned int *) ctx))++;
+  return 0;
+}
+
+// -----[ _lpm_pfx_cmp ]---------------------------------------------
+/**
+ * Sort by start address, then shortest prefix first (the enclosing
+ * prefixes come before the prefixes they contain).
+ */
+static int _lpm_pfx_cmp(const void * item1, const void * item2)
+{
+  const _lpm_pfx_t * pfx1= (const _lpm_pfx_t *) item1;
+  const _lpm_pfx_t * pfx2= (const _lpm_pfx_t *) item2;
+
+  if (pfx1->start != pfx2->start)
+    return (pfx1->start < pfx2->start) ? -1 : 1;
+  if (pfx1->mask != pfx2->mask)
+    return (pfx1->mask < pfx2->mask) ? -1 : 1;
+  return 0;
+}
+
+// -----[ _lpm_emit ]------------------------------------------------
+/**
+ * Append the range [from, to] to the snapshot. Adjacent ranges that
+ * lead to the same route are merged.
+ */
+static inline void _lpm_emit(rt_lpm_t * lpm, uint64_t from, uint64_t to,
+			     rt_info_t * info)
+{
+  if (from > to)
+    return;
+  if ((lpm->num_ranges > 0) && (lpm->infos[lpm->num_ranges-1] == info))
+    return;
+  lpm->starts[lpm->num_ranges]= (net_addr_t) from;
+  lpm->infos[lpm->num_ranges]= info;
+  lpm->num_ranges++;
+}
+
+// -----[ _lpm_build_index ]-----------------------------------------
+static void _lpm_build_index(rt_lpm_t * lpm)
+{
+  unsigned int hi, index= 0;
+
+  lpm->index= (uint32_t *) MALLOC(sizeof(uint32_t)*65537);
+  for (hi= 0; hi < 65536; hi++) {
+    while ((index+1 < lpm->num_ranges) &&
+	   (lpm->starts[index+1] <= (hi << 16)))
+      index++;
+    lpm->index[hi]= index;
+  }
+  lpm->index[65536]= lpm->num_ranges-1;
+}
+
+// -----[ rt_lpm_build ]---------------------------------------------
+/**
+ * The prefixes are sorted and swept with a stack of the enclosing
+ * prefixes. Each address range is associated with the route of the
+ * innermost prefix that covers it.
+ */
+rt_lpm_t * rt_lpm_build(net_rt_t * rt)
+{
+  rt_lpm_t * lpm= (rt_lpm_t *) MALLOC(sizeof(rt_lpm_t));
+  _lpm_pfx_t * stack[33];
+  unsigned int index, depth= 0;
+  _lpm_ctx_t ctx;
+  uint64_t cur= 0;
+  _lpm_pfx_t * pfx;
+
+  ctx.num_pfxs= 0;
+  trie_for_each(rt->trie, _lpm_count, &ctx.num_pfxs);
+  ctx.pfxs= (_lpm_pfx_t *) MALLOC(sizeof(_lpm_pfx_t)*(ctx.num_pfxs+1));
+  index= ctx.num_pfxs;
+  ctx.num_pfxs= 0;
+  trie_for_each(rt->trie, _lpm_collect, &ctx);
+  assert(ctx.num_pfxs == index);
+  qsort(ctx.pfxs, ctx.num_pfxs, sizeof(_lpm_pfx_t), _lpm_pfx_cmp);
+
+  // At most 2 ranges per prefix, plus the leading range
+  lpm->generation= rt->generation;
+  lpm->num_ranges= 0;
+  lpm->starts= (net_addr_t *)
+    MALLOC(sizeof(net_addr_t)*(2*ctx.num_pfxs+1));
+  lpm->infos= (rt_info_t **)
+    MALLOC(sizeof(rt_info_t *)*(2*ctx.num_pfxs+1));
+  lpm->index= NULL;
+
+  for (index= 0; index < ctx.num_pfxs; index++) {
+    pfx= &ctx.pfxs[index];
+    // Close the enclosing prefixes that end before this one
+    while ((depth > 0) && (stack[depth-1]->end < pfx->start)) {
+      _lpm_emit(lpm, cur, stack[depth-1]->end, stack[depth-1]->info);
+      cur= (uint64_t) stack[depth-1]->end + 1;
+      depth--;
+    }
+    _lpm_emit(lpm, cur, (uint64_t) pfx->start - 1,
+	      (depth > 0) ? stack[depth-1]->info : NULL);
+    cur= pfx->start;
+    stack[depth++]= pfx;
+  }
+  while (depth > 0) {
+    _lpm_emit(lpm, cur, stack[depth-1]->end, stack[depth-1]->info);
+    cur= (uint64_t) stack[depth-1]->end + 1;
+    depth--;
+  }
+  _lpm_emit(lpm, cur, 0xFFFFFFFFu, NULL);
+
+  FREE(ctx.pfxs);
+
+  if (lpm->num_ranges >= RT_LPM_INDEX_MIN)
+    _lpm_build_index(lpm);
+  return lpm;
+}
+
+// -----[ rt_lpm_destroy ]-------------------------------------------
+void rt_lpm_destroy(rt_lpm_t ** lpm_ref)
+{
+  rt_lpm_t * lpm= *lpm_ref;
+
+  if (lpm != NULL) {
+    FREE(lpm->starts);
+    FREE(lpm->infos);
+    if (lpm->index != NULL)
+      FREE(lpm->index);
+    FREE(lpm);
+    *lpm_ref= NULL;
+  }
+}
+
+// -----[ rt_lpm_lookup ]--------------------------------------------
+rt_info_t * rt_lpm_lookup(const rt_lpm_t * lpm, net_addr_t addr)
+{
+  unsigned int low= 0, high= lpm->num_ranges-1, middle;
+
+  if (lpm->index != NULL) {
+    low= lpm->index[addr >> 16];
+    high= lpm->index[(addr >> 16)+1];
+  }
+
+  // Find the last range that starts at or before the address
+  while (low < high) {
+    middle= (low + high + 1) / 2;
+    if (lpm->starts[middle] <= addr)
+      low= middle;
+    else
+      high= middle-1;
+  }
+  return lpm->infos[low];
+}
@@ -0,0 +1,97 @@
+// ==================================================================
+// @(#)rt_lpm.h
+//
+// Compiled (read-only) longest-match lookup structure.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+/**
+ * \file
+ * Provide a compact, read-only snapshot of a routing table that
+ * answers longest-match lookups (any route type).
+ *
+ * The prefixes of the routing table are flattened into a sorted
+ * array of disjoint address ranges, each one associated with the
+ * preferred route of its longest matching prefix. A lookup is a
+ * binary search in this array. For large tables, a first-level
+ * index on the 16 most significant bits of the address narrows the
+ * search to the ranges of a /16.
+ *
+ * The snapshot refers to the route-infos stored in the routing
+ * table. It is only valid as long as the table's generation number
+ * does not change.
+ */
+
+#ifndef __NET_RT_LPM_H__
+#define __NET_RT_LPM_H__
+
+#include <net/routing.h>
+
+/** Minimum number of ranges for the first-level index to be built. */
+#define RT_LPM_INDEX_MIN 4096
+/** Minimum number of lookups without change before compiling. */
+#define RT_LPM_MIN_LOOKUPS 64
+
+// -----[ rt_lpm_t ]-------------------------------------------------
+typedef struct rt_lpm_t {
+  /** Generation of the routing table when compiled. */
+  unsigned int   generation;
+  /** Number of ranges. */
+  unsigned int   num_ranges;
+  /** First address of each range (sorted). */
+  net_addr_t   * starts;
+  /** Route-info of each range (NULL if no route). */
+  rt_info_t   ** infos;
+  /** First-level index (65537 entries, or NULL). */
+  uint32_t     * index;
+} rt_lpm_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ rt_lpm_build ]-------------------------------------------
+  /**
+   * Compile the routing table into a lookup snapshot.
+   *
+   * \param rt is the routing table.
+   * \retval the compiled snapshot.
+   */
+  rt_lpm_t * rt_lpm_build(net_rt_t * rt);
+
+  // -----[ rt_lpm_destroy ]-----------------------------------------
+  void rt_lpm_destroy(rt_lpm_t ** lpm_ref);
+
+  // -----[ rt_lpm_lookup ]------------------------------------------
+  /**
+   * Return the preferred route of the longest prefix that matches
+   * an address, or NULL if there is none.
+   */
+  rt_info_t * rt_lpm_lookup(const rt_lpm_t * lpm, net_addr_t addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_RT_LPM_H__ */
@@ -36,6 +36,7 @@
 
 #include <net/net_types.h>
 #include <net/routing.h>
+#include <util/mem_stats.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -68,6 +69,7 @@ static inline spt_vertex_t * spt_vertex_create(net_elem_t elem,
 {
   spt_vertex_t * vertex=
     (spt_vertex_t *) MALLOC(sizeof(spt_vertex_t));
+  mem_stats_alloc(MEM_TAG_SPT, sizeof(spt_vertex_t));
   vertex->weight= weight;
   vertex->elem= elem;
   vertex->preds= spt_vertices_create(0);
@@ -85,6 +87,7 @@ static inline void _spt_vertex_destroy(void ** item)
   spt_vertices_destroy(&vertex->preds);
   spt_vertices_destroy(&vertex->succs);
   FREE(vertex);
+  mem_stats_free(MEM_TAG_SPT, sizeof(spt_vertex_t));
 }
 
 // -----[ spt_vertex_add_pred ]--------------------------------------
@@ -0,0 +1,1455 @@
+// ==================================================================
+// @(#)state.c
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif /* HAVE_CONFIG_H */
+
+#include <stdio.h>
+#include <string.h>
+
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#if defined(_POSIX_MAPPED_FILES) && (_POSIX_MAPPED_FILES > 0)
+# include <sys/mman.h>
+# define NET_STATE_USE_MMAP
+#endif
+
+#include <libgds/array.h>
+#include <libgds/enumerator.h>
+#include <libgds/memory.h>
+
+#include <net/error.h>
+#include <net/iface.h>
+#include <net/igp_domain.h>
+#include <net/link.h>
+#include <net/link-list.h>
+#include <net/link_attr.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <net/routing.h>
+#include <net/state.h>
+#include <net/subnet.h>
+#include <bgp/as.h>
+#include <bgp/attr/comm.h>
+#include <bgp/attr/comm_hash.h>
+#include <bgp/attr/ecomm.h>
+#include <bgp/attr/path.h>
+#include <bgp/attr/path_hash.h>
+#include <bgp/attr/path_segment.h>
+#include <bgp/domain.h>
+#include <bgp/peer.h>
+#include <bgp/peer-list.h>
+#include <bgp/rib.h>
+#include <bgp/route.h>
+#include <bgp/route_reflector.h>
+#include <bgp/routes_list.h>
+#include <util/mem_stats.h>
+
+#define NET_STATE_MAGIC     "CBGPSTAT"
+#define NET_STATE_MAGIC_LEN 8
+#define NET_STATE_BOM       0x01020304
+
+/** Index used for a missing AS-Path or Communities attribute. */
+#define NET_STATE_NO_INDEX  UINT32_MAX
+
+// -----[ Section tags ]---------------------------------------------
+typedef enum {
+  NET_STATE_SECTION_END    = 0,
+  NET_STATE_SECTION_PATHS  = 1,
+  NET_STATE_SECTION_COMMS  = 2,
+  NET_STATE_SECTION_NODES  = 3,
+  NET_STATE_SECTION_SUBNETS= 4,
+  NET_STATE_SECTION_IFACES = 5,
+  NET_STATE_SECTION_DOMAINS= 6,
+  NET_STATE_SECTION_RT     = 7,
+  NET_STATE_SECTION_BGP    = 8,
+} net_state_section_t;
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// STATE WRITER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _state_writer_t ]------------------------------------------
+typedef struct {
+  FILE        * file;
+  int           error;
+  /** AS-Path dictionary (sorted by address). */
+  ptr_array_t * paths;
+  /** Communities dictionary (sorted by address). */
+  ptr_array_t * comms;
+} _state_writer_t;
+
+// -----[ _state_section_t ]-----------------------------------------
+typedef struct {
+  long         count_offset;
+  long         size_offset;
+  long         start;
+  uint32_t     count;
+} _state_section_t;
+
+// -----[ _wr ]------------------------------------------------------
+static inline void _wr(_state_writer_t * w, const void * data,
+		       size_t size)
+{
+  if (w->error != ESUCCESS)
+    return;
+  if ((size > 0) && (fwrite(data, size, 1, w->file) != 1))
+    w->error= ENET_STATE_IO;
+}
+
+// -----[ _wr_u8 ]---------------------------------------------------
+static inline void _wr_u8(_state_writer_t * w, uint8_t value)
+{
+  _wr(w, &value, sizeof(value));
+}
+
+// -----[ _wr_u16 ]--------------------------------------------------
+static inline void _wr_u16(_state_writer_t * w, uint16_t value)
+{
+  _wr(w, &value, sizeof(value));
+}
+
+// -----[ _wr_u32 ]--------------------------------------------------
+static inline void _wr_u32(_state_writer_t * w, uint32_t value)
+{
+  _wr(w, &value, sizeof(value));
+}
+
+// -----[ _wr_pfx ]--------------------------------------------------
+static inline void _wr_pfx(_state_writer_t * w, ip_pfx_t prefix)
+{
+  _wr_u32(w, prefix.network);
+  _wr_u8(w, prefix.mask);
+}
+
+// -----[ _wr_reserve ]----------------------------------------------
+/**
+ * Reserve room for a 32-bits value that will be patched later. The
+ * function returns the position of the value in the file.
+ */
+static inline long _wr_reserve(_state_writer_t * w)
+{
+  long offset= ftell(w->file);
+  _wr_u32(w, 0);
+  return offset;
+}
+
+// -----[ _wr_patch ]------------------------------------------------
+static inline void _wr_patch(_state_writer_t * w, long offset,
+			     uint32_t value)
+{
+  long current;
+
+  if (w->error != ESUCCESS)
+    return;
+  current= ftell(w->file);
+  if ((fseek(w->file, offset, SEEK_SET) != 0) ||
+      (fwrite(&value, sizeof(value), 1, w->file) != 1) ||
+      (fseek(w->file, current, SEEK_SET) != 0))
+    w->error= ENET_STATE_IO;
+}
+
+// -----[ _wr_section_begin ]----------------------------------------
+static inline void _wr_section_begin(_state_writer_t * w,
+				     _state_section_t * section,
+				     net_state_section_t tag)
+{
+  _wr_u32(w, tag);
+  section->count= 0;
+  section->count_offset= _wr_reserve(w);
+  section->size_offset= _wr_reserve(w);
+  section->start= ftell(w->file);
+}
+
+// -----[ _wr_section_end ]------------------------------------------
+static inline void _wr_section_end(_state_writer_t * w,
+				   _state_section_t * section)
+{
+  _wr_patch(w, section->count_offset, section->count);
+  _wr_patch(w, section->size_offset,
+	    (uint32_t) (ftell(w->file) - section->start));
+}
+
+// -----[ _state_ptr_compare ]---------------------------------------
+static int _state_ptr_compare(const void * item1,
+			      const void * item2,
+			      unsigned int elt_size)
+{
+  const void * ptr1= *((const void **) item1);
+  const void * ptr2= *((const void **) item2);
+
+  if (ptr1 < ptr2)
+    return -1;
+  if (ptr1 > ptr2)
+    return 1;
+  return 0;
+}
+
+// -----[ _state_collect ]-------------------------------------------
+/**
+ * Collect an item of a global repository (path_hash, comm_hash)
+ * into a dictionary.
+ */
+static int _state_collect(void * item, void * ctx)
+{
+  ptr_array_t * dict= (ptr_array_t *) ctx;
+  return (ptr_array_add(dict, &item) < 0)?-1:0;
+}
+
+// -----[ _state_dict_index ]----------------------------------------
+static inline uint32_t _state_dict_index(ptr_array_t * dict,
+					 const void * item)
+{
+  unsigned int index;
+
+  if (item == NULL)
+    return NET_STATE_NO_INDEX;
+  if (ptr_array_sorted_find_index(dict, &item, &index) != 0)
+    return NET_STATE_NO_INDEX;
+  return index;
+}
+
+// -----[ _state_write_paths ]---------------------------------------
+/**
+ * Write the AS-Path dictionary. Each segment is stored as it is
+ * laid out in memory (type, length, ASNs).
+ */
+static void _state_write_paths(_state_writer_t * w)
+{
+  _state_section_t section;
+  unsigned int index, seg_index;
+  bgp_path_t * path;
+  bgp_path_seg_t * seg;
+
+  if (path_hash_for_each(_state_collect, w->paths) != 0) {
+    w->error= EUNEXPECTED;
+    return;
+  }
+
+  _wr_section_begin(w, &section, NET_STATE_SECTION_PATHS);
+  for (index= 0; index < ptr_array_length(w->paths); index++) {
+    path= (bgp_path_t *) w->paths->data[index];
+    _wr_u16(w, (uint16_t) path_num_segments(path));
+    for (seg_index= 0; seg_index < path_num_segments(path); seg_index++) {
+      seg= (bgp_path_seg_t *) path->data[seg_index];
+      _wr(w, seg, sizeof(bgp_path_seg_t) +
+	  seg->length * sizeof(seg->asns[0]));
+    }
+    section.count++;
+  }
+  _wr_section_end(w, &section);
+}
+
+// -----[ _state_write_comms ]---------------------------------------
+static void _state_write_comms(_state_writer_t * w)
+{
+  _state_section_t section;
+  unsigned int index;
+  bgp_comms_t * comms;
+
+  if (comm_hash_for_each(_state_collect, w->comms) != 0) {
+    w->error= EUNEXPECTED;
+    return;
+  }
+
+  _wr_section_begin(w, &section, NET_STATE_SECTION_COMMS);
+  for (index= 0; index < ptr_array_length(w->comms); index++) {
+    comms= (bgp_comms_t *) w->comms->data[index];
+    _wr_u8(w, comms->num);
+    _wr(w, comms->values, comms->num * sizeof(bgp_comm_t));
+    section.count++;
+  }
+  _wr_section_end(w, &section);
+}
+
+// -----[ _state_write_nodes ]---------------------------------------
+static void _state_write_nodes(_state_writer_t * w, network_t * network)
+{
+  _state_section_t section;
+  gds_enum_t * nodes;
+  net_node_t * node;
+  uint16_t name_len;
+
+  _wr_section_begin(w, &section, NET_STATE_SECTION_NODES);
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    _wr_u32(w, node->rid);
+    name_len= (node->name != NULL)?strlen(node->name):0;
+    _wr_u16(w, name_len);
+    _wr(w, node->name, name_len);
+    _wr(w, &node->coord, sizeof(node->coord));
+    section.count++;
+  }
+  enum_destroy(&nodes);
+  _wr_section_end(w, &section);
+}
+
+// -----[ _state_write_subnets ]-------------------------------------
+static void _state_write_subnets(_state_writer_t * w, network_t * network)
+{
+  _state_section_t section;
+  unsigned int index;
+  net_subnet_t * subnet;
+
+  _wr_section_begin(w, &section, NET_STATE_SECTION_SUBNETS);
+  for (index= 0; index < ptr_array_length(network->subnets); index++) {
+    subnet= (net_subnet_t *) network->subnets->data[index];
+    _wr_pfx(w, subnet->prefix);
+    _wr_u8(w, subnet->type);
+    section.count++;
+  }
+  _wr_section_end(w, &section);
+}
+
+// -----[ _state_write_iface ]---------------------------------------
+static void _state_write_iface(_state_writer_t * w, net_iface_t * iface)
+{
+  net_iface_id_t id= net_iface_id(iface);
+  uint8_t depth= net_igp_weights_depth(iface->weights);
+
+  _wr_u32(w, iface->owner->rid);
+  _wr_u8(w, iface->type);
+  _wr_pfx(w, id);
+  _wr_u8(w, iface->flags);
+  _wr_u32(w, iface->phys.delay);
+  _wr_u32(w, iface->phys.capacity);
+  _wr_u32(w, iface->phys.load);
+  _wr_u8(w, depth);
+  _wr(w, iface->weights->data, depth * sizeof(igp_weight_t));
+
+  switch (iface->type) {
+  case NET_IFACE_RTR:
+  case NET_IFACE_PTP:
+    _wr_u8(w, iface->connected);
+    if (iface->connected) {
+      _wr_u32(w, iface->dest.iface->owner->rid);
+      _wr_pfx(w, net_iface_id(iface->dest.iface));
+    }
+    break;
+  case NET_IFACE_PTMP:
+    _wr_pfx(w, iface->dest.subnet->prefix);
+    break;
+  default:
+    break;
+  }
+}
+
+// -----[ _state_write_ifaces ]--------------------------------------
+static void _state_write_ifaces(_state_writer_t * w, network_t * network)
+{
+  _state_section_t section;
+  gds_enum_t * nodes, * ifaces;
+  net_node_t * node;
+  net_iface_t * iface;
+
+  _wr_section_begin(w, &section, NET_STATE_SECTION_IFACES);
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes) && (w->error == ESUCCESS)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    ifaces= net_links_get_enum(node->ifaces);
+    while (enum_has_next(ifaces)) {
+      iface= *((net_iface_t **) enum_get_next(ifaces));
+      if (iface->type == NET_IFACE_VIRTUAL) {
+	w->error= EUNSUPPORTED;
+	break;
+      }
+      _state_write_iface(w, iface);
+      section.count++;
+    }
+    enum_destroy(&ifaces);
+  }
+  enum_destroy(&nodes);
+  _wr_section_end(w, &section);
+}
+
+// -----[ _state_write_domain ]--------------------------------------
+static int _state_write_domain(igp_domain_t * domain, void * ctx)
+{
+  _state_writer_t * w= (_state_writer_t *) ctx;
+  gds_enum_t * routers;
+  net_node_t * router;
+  long count_offset;
+  uint32_t count= 0;
+
+  _wr_u16(w, domain->id);
+  _wr_u8(w, domain->type);
+  count_offset= _wr_reserve(w);
+  routers= trie_get_enum(domain->routers);
+  while (enum_has_next(routers)) {
+    router= *((net_node_t **) enum_get_next(routers));
+    _wr_u32(w, router->rid);
+    count++;
+  }
+  enum_destroy(&routers);
+  _wr_patch(w, count_offset, count);
+  return 0;
+}
+
+// -----[ _state_write_domains ]-------------------------------------
+static void _state_write_domains(_state_writer_t * w, network_t * network)
+{
+  _state_section_t section;
+
+  _wr_section_begin(w, &section, NET_STATE_SECTION_DOMAINS);
+  section.count= ptr_array_length(network->domains);
+  igp_domains_for_each(network->domains, _state_write_domain, w);
+  _wr_section_end(w, &section);
+}
+
+// -----[ _state_write_rt ]------------------------------------------
+/**
+ * Write the routing table of each node. All route types are saved
+ * (static, IGP and BGP).
+ */
+static void _state_write_rt(_state_writer_t * w, network_t * network)
+{
+  _state_section_t section;
+  gds_enum_t * nodes, * rt_info_lists;
+  net_node_t * node;
+  rt_info_list_t * rt_info_list;
+  rt_info_t * rt_info;
+  rt_entry_t * rt_entry;
+  unsigned int index, entry_index;
+  long count_offset;
+  uint32_t count;
+
+  _wr_section_begin(w, &section, NET_STATE_SECTION_RT);
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    _wr_u32(w, node->rid);
+    count_offset= _wr_reserve(w);
+    count= 0;
+
+    rt_info_lists= trie_get_enum(node->rt->trie);
+    while (enum_has_next(rt_info_lists)) {
+      rt_info_list= *((rt_info_list_t **) enum_get_next(rt_info_lists));
+      for (index= 0; index < ptr_array_length(rt_info_list); index++) {
+	rt_info= (rt_info_t *) rt_info_list->data[index];
+	_wr_pfx(w, rt_info->prefix);
+	_wr_u32(w, rt_info->metric);
+	_wr_u8(w, rt_info->type);
+	_wr_u16(w, rt_entries_size(rt_info->entries));
+	for (entry_index= 0; entry_index < rt_entries_size(rt_info->entries);
+	     entry_index++) {
+	  rt_entry= rt_entries_get_at(rt_info->entries, entry_index);
+	  _wr_u8(w, (rt_entry->oif != NULL));
+	  if (rt_entry->oif != NULL)
+	    _wr_pfx(w, net_iface_id(rt_entry->oif));
+	  _wr_u32(w, rt_entry->gateway);
+	}
+	count++;
+      }
+    }
+    enum_destroy(&rt_info_lists);
+
+    _wr_patch(w, count_offset, count);
+    section.count++;
+  }
+  enum_destroy(&nodes);
+  _wr_section_end(w, &section);
+}
+
+// -----[ _state_write_route ]---------------------------------------
+static void _state_write_route(_state_writer_t * w, bgp_route_t * route)
+{
+  bgp_attr_t * attr= route->attr;
+  unsigned int index;
+
+  _wr_pfx(w, route->prefix);
+  _wr_u32(w, (route->peer != NULL)?route->peer->addr:NET_ADDR_ANY);
+  _wr_u16(w, route->flags);
+  _wr_u32(w, attr->next_hop);
+  _wr_u8(w, attr->origin);
+  _wr_u32(w, attr->local_pref);
+  _wr_u32(w, attr->med);
+  _wr_u32(w, _state_dict_index(w->paths, attr->path_ref));
+  _wr_u32(w, _state_dict_index(w->comms, attr->comms));
+
+  _wr_u8(w, (attr->originator != NULL));
+  if (attr->originator != NULL)
+    _wr_u32(w, *attr->originator);
+
+  if (attr->cluster_list != NULL) {
+    _wr_u8(w, cluster_list_length(attr->cluster_list));
+    for (index= 0; index < cluster_list_length(attr->cluster_list); index++)
+      _wr_u32(w, attr->cluster_list->data[index]);
+  } else
+    _wr_u8(w, 0);
+
+  if (attr->ecomms != NULL) {
+    _wr_u8(w, ecomms_length(attr->ecomms));
+    for (index= 0; index < ecomms_length(attr->ecomms); index++)
+      _wr(w, ecomms_get_at(attr->ecomms, index), sizeof(bgp_ecomm_t));
+  } else
+    _wr_u8(w, 0);
+}
+
+// -----[ _state_rib_ctx_t ]-----------------------------------------
+typedef struct {
+  _state_writer_t * writer;
+  uint32_t          count;
+} _state_rib_ctx_t;
+
+// -----[ _state_write_rib_route ]-----------------------------------
+static int _state_write_rib_route(uint32_t key, uint8_t key_len,
+				  void * item, void * ctx)
+{
+  _state_rib_ctx_t * rib_ctx= (_state_rib_ctx_t *) ctx;
+
+  _state_write_route(rib_ctx->writer, (bgp_route_t *) item);
+  rib_ctx->count++;
+  return 0;
+}
+
+// -----[ _state_write_rib ]-----------------------------------------
+static void _state_write_rib(_state_writer_t * w, bgp_rib_t * rib)
+{
+  _state_rib_ctx_t ctx= { .writer= w, .count= 0 };
+  long count_offset= _wr_reserve(w);
+
+  rib_for_each(rib, _state_write_rib_route, &ctx);
+  _wr_patch(w, count_offset, ctx.count);
+}
+
+// -----[ _state_write_peer ]----------------------------------------
+static void _state_write_peer(_state_writer_t * w, bgp_peer_t * peer)
+{
+  _wr_u32(w, peer->addr);
+  _wr_u16(w, peer->asn);
+  _wr_u8(w, peer->flags);
+  _wr_u32(w, peer->router_id);
+  _wr_u8(w, peer->session_state);
+  _wr_u32(w, peer->next_hop);
+  _wr_u32(w, peer->src_addr);
+  _wr_u32(w, peer->send_seq_num);
+  _wr_u32(w, peer->recv_seq_num);
+}
+
+// -----[ _state_write_router ]--------------------------------------
+/**
+ * Write a BGP router: its configuration, its sessions, its
+ * locally originated networks, its Loc-RIB and then the Adj-RIB-In
+ * and Adj-RIB-Out of each session.
+ */
+static void _state_write_router(_state_writer_t * w,
+				bgp_router_t * router)
+{
+  unsigned int index;
+  bgp_peer_t * peer;
+
+  _wr_u32(w, router->node->rid);
+  _wr_u16(w, router->asn);
+  _wr_u32(w, router->rid);
+  _wr_u32(w, router->cluster_id);
+  _wr_u8(w, router->reflector);
+
+  _wr_u32(w, bgp_peers_size(router->peers));
+  for (index= 0; index < bgp_peers_size(router->peers); index++)
+    _state_write_peer(w, bgp_peers_at(router->peers, index));
+
+  _wr_u32(w, bgp_routes_size(router->local_nets));
+  for (index= 0; index < bgp_routes_size(router->local_nets); index++)
+    _state_write_route(w, bgp_routes_at(router->local_nets, index));
+
+  _state_write_rib(w, router->loc_rib);
+  for (index= 0; index < bgp_peers_size(router->peers); index++) {
+    peer= bgp_peers_at(router->peers, index);
+    _state_write_rib(w, peer->adj_rib[RIB_IN]);
+    _state_write_rib(w, peer->adj_rib[RIB_OUT]);
+  }
+}
+
+// -----[ _state_write_bgp ]-----------------------------------------
+static void _state_write_bgp(_state_writer_t * w, network_t * network)
+{
+  _state_section_t section;
+  gds_enum_t * nodes;
+  net_node_t * node;
+  net_protocol_t * protocol;
+
+  _wr_section_begin(w, &section, NET_STATE_SECTION_BGP);
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    protocol= node_get_protocol(node, NET_PROTOCOL_BGP);
+    if (protocol == NULL)
+      continue;
+    _state_write_router(w, (bgp_router_t *) protocol->handler);
+    section.count++;
+  }
+  enum_destroy(&nodes);
+  _wr_section_end(w, &section);
+}
+
+// -----[ net_state_save ]-------------------------------------------
+int net_state_save(network_t * network, const char * filename)
+{
+  _state_writer_t w;
+
+  w.file= fopen(filename, "wb");
+  if (w.file == NULL)
+    return ENET_STATE_IO;
+  w.error= ESUCCESS;
+  w.paths= ptr_array_create(ARRAY_OPTION_SORTED|ARRAY_OPTION_UNIQUE,
+			    _state_ptr_compare, NULL, NULL);
+  w.comms= ptr_array_create(ARRAY_OPTION_SORTED|ARRAY_OPTION_UNIQUE,
+			    _state_ptr_compare, NULL, NULL);
+
+  _wr(&w, NET_STATE_MAGIC, NET_STATE_MAGIC_LEN);
+  _wr_u32(&w, NET_STATE_VERSION);
+  _wr_u32(&w, NET_STATE_BOM);
+
+  // Dictionaries must come first since routes refer to them
+  _state_write_paths(&w);
+  _state_write_comms(&w);
+  _state_write_nodes(&w, network);
+  _state_write_subnets(&w, network);
+  _state_write_ifaces(&w, network);
+  _state_write_domains(&w, network);
+  _state_write_rt(&w, network);
+  _state_write_bgp(&w, network);
+  _wr_u32(&w, NET_STATE_SECTION_END);
+
+  ptr_array_destroy(&w.paths);
+  ptr_array_destroy(&w.comms);
+  if ((fclose(w.file) != 0) && (w.error == ESUCCESS))
+    w.error= ENET_STATE_IO;
+  return w.error;
+}
+
+
+/////////////////////////////////////////////////////////////////////
+//
+// STATE READER
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ _state_reader_t ]------------------------------------------
+typedef struct {
+  const uint8_t * data;
+  size_t          size;
+  size_t          offset;
+  int             error;
+  network_t     * network;
+  /** AS-Path dictionary (interned). */
+  bgp_path_t   ** paths;
+  uint32_t        num_paths;
+  /** Communities dictionary (interned). */
+  bgp_comms_t  ** comms;
+  uint32_t        num_comms;
+} _state_reader_t;
+
+// -----[ _rd ]------------------------------------------------------
+/**
+ * Return a pointer to the next \p size bytes of the state file and
+ * advance the cursor. Return NULL if the file is truncated.
+ */
+static inline const void * _rd(_state_reader_t * r, size_t size)
+{
+  const void * ptr;
+
+  if (r->error != ESUCCESS)
+    return NULL;
+  if (size > r->size - r->offset) {
+    r->error= ENET_STATE_FORMAT;
+    return NULL;
+  }
+  ptr= r->data + r->offset;
+  r->offset+= size;
+  return ptr;
+}
+
+// -----[ _rd_copy ]-------------------------------------------------
+static inline void _rd_copy(_state_reader_t * r, void * data, size_t size)
+{
+  const void * ptr= _rd(r, size);
+  if (ptr != NULL)
+    memcpy(data, ptr, size);
+  else
+    memset(data, 0, size);
+}
+
+// -----[ _rd_u8 ]---------------------------------------------------
+static inline uint8_t _rd_u8(_state_reader_t * r)
+{
+  uint8_t value;
+  _rd_copy(r, &value, sizeof(value));
+  return value;
+}
+
+// -----[ _rd_u16 ]--------------------------------------------------
+static inline uint16_t _rd_u16(_state_reader_t * r)
+{
+  uint16_t value;
+  _rd_copy(r, &value, sizeof(value));
+  return value;
+}
+
+// -----[ _rd_u32 ]--------------------------------------------------
+static inline uint32_t _rd_u32(_state_reader_t * r)
+{
+  uint32_t value;
+  _rd_copy(r, &value, sizeof(value));
+  return value;
+}
+
+// -----[ _rd_pfx ]--------------------------------------------------
+static inline ip_pfx_t _rd_pfx(_state_reader_t * r)
+{
+  ip_pfx_t prefix;
+  prefix.network= _rd_u32(r);
+  prefix.mask= _rd_u8(r);
+  if (prefix.mask > 32)
+    r->error= ENET_STATE_FORMAT;
+  return prefix;
+}
+
+// -----[ _rd_node ]-------------------------------------------------
+static inline net_node_t * _rd_node(_state_reader_t * r)
+{
+  net_addr_t addr= _rd_u32(r);
+  net_node_t * node;
+
+  if (r->error != ESUCCESS)
+    return NULL;
+  node= network_find_node(r->network, addr);
+  if (node == NULL)
+    r->error= ENET_STATE_FORMAT;
+  return node;
+}
+
+// -----[ _state_read_paths ]----------------------------------------
+/**
+ * Read the AS-Path dictionary. Each path is interned in the global
+ * repository. The reference held by the dictionary is released
+ * once the whole state has been loaded.
+ */
+static void _state_read_paths(_state_reader_t * r, uint32_t count)
+{
+  unsigned int index, seg_index;
+  uint16_t num_segs;
+  bgp_path_t * path, * path_ref;
+  bgp_path_seg_t * seg;
+  uint8_t type, length;
+
+  if (r->paths != NULL) {
+    r->error= ENET_STATE_FORMAT;
+    return;
+  }
+  r->paths= (bgp_path_t **) MALLOC(count * sizeof(bgp_path_t *));
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    path= path_create();
+    num_segs= _rd_u16(r);
+    for (seg_index= 0; seg_index < num_segs; seg_index++) {
+      type= _rd_u8(r);
+      length= _rd_u8(r);
+      if (r->error != ESUCCESS)
+	break;
+      seg= path_segment_create(type, length);
+      _rd_copy(r, seg->asns, length * sizeof(seg->asns[0]));
+      path_add_segment(path, seg);
+    }
+    if (r->error != ESUCCESS) {
+      path_destroy(&path);
+      break;
+    }
+    path_ref= path_hash_add(path);
+    if (path_ref != path)
+      path_destroy(&path);
+    r->paths[r->num_paths++]= path_ref;
+  }
+}
+
+// -----[ _state_read_comms ]----------------------------------------
+static void _state_read_comms(_state_reader_t * r, uint32_t count)
+{
+  unsigned int index;
+  bgp_comms_t * comms, * comms_ref;
+  uint8_t num;
+
+  if (r->comms != NULL) {
+    r->error= ENET_STATE_FORMAT;
+    return;
+  }
+  r->comms= (bgp_comms_t **) MALLOC(count * sizeof(bgp_comms_t *));
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    num= _rd_u8(r);
+    if (r->error != ESUCCESS)
+      break;
+    comms= (bgp_comms_t *) MALLOC(sizeof(bgp_comms_t)+
+				  num * sizeof(bgp_comm_t));
+    mem_stats_alloc(MEM_TAG_COMMS, sizeof(bgp_comms_t)+
+		    num * sizeof(bgp_comm_t));
+    comms->num= num;
+    _rd_copy(r, comms->values, num * sizeof(bgp_comm_t));
+    comms_ref= comm_hash_add(comms);
+    if (comms_ref != comms)
+      comms_destroy(&comms);
+    r->comms[r->num_comms++]= comms_ref;
+  }
+}
+
+// -----[ _state_read_nodes ]----------------------------------------
+static void _state_read_nodes(_state_reader_t * r, uint32_t count)
+{
+  unsigned int index;
+  net_addr_t addr;
+  uint16_t name_len;
+  const char * name;
+  char * name_copy;
+  net_node_t * node;
+  int error;
+
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    addr= _rd_u32(r);
+    name_len= _rd_u16(r);
+    name= (const char *) _rd(r, name_len);
+    if (r->error != ESUCCESS)
+      break;
+
+    error= node_create(addr, &node, 0);
+    if (error != ESUCCESS) {
+      r->error= error;
+      break;
+    }
+    error= network_add_node(r->network, node);
+    if (error != ESUCCESS) {
+      node_destroy(&node);
+      r->error= error;
+      break;
+    }
+
+    if (name_len > 0) {
+      name_copy= (char *) MALLOC(name_len+1);
+      memcpy(name_copy, name, name_len);
+      name_copy[name_len]= '\0';
+      node_set_name(node, name_copy);
+      FREE(name_copy);
+    }
+    _rd_copy(r, &node->coord, sizeof(node->coord));
+  }
+}
+
+// -----[ _state_read_subnets ]--------------------------------------
+static void _state_read_subnets(_state_reader_t * r, uint32_t count)
+{
+  unsigned int index;
+  ip_pfx_t prefix;
+  uint8_t type;
+  net_subnet_t * subnet;
+  int error;
+
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    prefix= _rd_pfx(r);
+    type= _rd_u8(r);
+    if (r->error != ESUCCESS)
+      break;
+    if ((prefix.mask >= 32) || (type >= NET_SUBNET_TYPE_MAX)) {
+      r->error= ENET_STATE_FORMAT;
+      break;
+    }
+    subnet= subnet_create(prefix.network, prefix.mask, type);
+    error= network_add_subnet(r->network, subnet);
+    if (error != ESUCCESS) {
+      subnet_destroy(&subnet);
+      r->error= error;
+    }
+  }
+}
+
+// -----[ _state_iface_t ]-------------------------------------------
+/** Interface record, as read from the state file. */
+typedef struct {
+  net_node_t         * node;
+  net_iface_type_t     type;
+  net_iface_id_t       id;
+  uint8_t              flags;
+  net_iface_phys_t     phys;
+  uint8_t              depth;
+  const void         * weights;
+  uint8_t              connected;
+  net_addr_t           dst_addr;
+  net_iface_id_t       dst_id;
+  ip_pfx_t             subnet;
+} _state_iface_t;
+
+// -----[ _rd_iface ]------------------------------------------------
+static inline void _rd_iface(_state_reader_t * r, _state_iface_t * rec)
+{
+  rec->node= _rd_node(r);
+  rec->type= _rd_u8(r);
+  rec->id= _rd_pfx(r);
+  rec->flags= _rd_u8(r);
+  rec->phys.delay= _rd_u32(r);
+  rec->phys.capacity= _rd_u32(r);
+  rec->phys.load= _rd_u32(r);
+  rec->depth= _rd_u8(r);
+  rec->weights= _rd(r, rec->depth * sizeof(igp_weight_t));
+  rec->connected= 0;
+  switch (rec->type) {
+  case NET_IFACE_LOOPBACK:
+    break;
+  case NET_IFACE_RTR:
+  case NET_IFACE_PTP:
+    rec->connected= _rd_u8(r);
+    if (rec->connected) {
+      rec->dst_addr= _rd_u32(r);
+      rec->dst_id= _rd_pfx(r);
+    }
+    break;
+  case NET_IFACE_PTMP:
+    rec->subnet= _rd_pfx(r);
+    break;
+  default:
+    r->error= ENET_STATE_FORMAT;
+  }
+}
+
+// -----[ _state_create_iface ]--------------------------------------
+static inline void _state_create_iface(_state_reader_t * r,
+				       _state_iface_t * rec)
+{
+  net_iface_t * iface;
+  net_subnet_t * subnet;
+  int error;
+
+  if (rec->type == NET_IFACE_PTMP) {
+    subnet= network_find_subnet(r->network, rec->subnet);
+    if (subnet == NULL) {
+      r->error= ENET_STATE_FORMAT;
+      return;
+    }
+    error= net_link_create_ptmp(rec->node, subnet, rec->id.network, &iface);
+  } else {
+    error= net_iface_factory(rec->node, rec->id, rec->type, &iface);
+    if (error == ESUCCESS)
+      error= node_add_iface2(rec->node, iface);
+  }
+  if (error != ESUCCESS) {
+    r->error= error;
+    return;
+  }
+
+  iface->flags= rec->flags;
+  iface->phys= rec->phys;
+  if (rec->depth > 0) {
+    net_igp_weights_destroy(&iface->weights);
+    iface->weights= net_igp_weights_create(rec->depth, 0);
+    memcpy(iface->weights->data, rec->weights,
+	   rec->depth * sizeof(igp_weight_t));
+  }
+}
+
+// -----[ _state_connect_iface ]-------------------------------------
+static inline void _state_connect_iface(_state_reader_t * r,
+					_state_iface_t * rec)
+{
+  net_iface_t * iface, * dst_iface;
+  net_node_t * dst_node;
+  int error;
+
+  if (!rec->connected)
+    return;
+  iface= node_find_iface(rec->node, rec->id);
+  dst_node= network_find_node(r->network, rec->dst_addr);
+  if ((iface == NULL) || (dst_node == NULL)) {
+    r->error= ENET_STATE_FORMAT;
+    return;
+  }
+  dst_iface= node_find_iface(dst_node, rec->dst_id);
+  if (dst_iface == NULL) {
+    r->error= ENET_STATE_FORMAT;
+    return;
+  }
+  error= net_iface_connect_iface(iface, dst_iface);
+  if (error != ESUCCESS)
+    r->error= error;
+}
+
+// -----[ _state_read_ifaces ]---------------------------------------
+/**
+ * Interfaces are read in two passes. The first pass creates all
+ * the interfaces. The second pass connects the RTR/PTP interfaces
+ * since both endpoints must exist.
+ */
+static void _state_read_ifaces(_state_reader_t * r, uint32_t count)
+{
+  size_t start= r->offset;
+  _state_iface_t rec;
+  unsigned int index;
+
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    _rd_iface(r, &rec);
+    if (r->error == ESUCCESS)
+      _state_create_iface(r, &rec);
+  }
+
+  r->offset= start;
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    _rd_iface(r, &rec);
+    if ((r->error == ESUCCESS) && (rec.type != NET_IFACE_PTMP))
+      _state_connect_iface(r, &rec);
+  }
+}
+
+// -----[ _state_read_domains ]--------------------------------------
+static void _state_read_domains(_state_reader_t * r, uint32_t count)
+{
+  unsigned int index, router_index;
+  uint16_t id;
+  uint8_t type;
+  uint32_t num_routers;
+  igp_domain_t * domain;
+  net_node_t * node;
+  int error;
+
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    id= _rd_u16(r);
+    type= _rd_u8(r);
+    num_routers= _rd_u32(r);
+    if (r->error != ESUCCESS)
+      break;
+    if (type >= IGP_DOMAIN_MAX) {
+      r->error= ENET_STATE_FORMAT;
+      break;
+    }
+    domain= igp_domain_create(id, type);
+    error= network_add_igp_domain(r->network, domain);
+    if (error != ESUCCESS) {
+      igp_domain_destroy(&domain);
+      r->error= error;
+      break;
+    }
+    for (router_index= 0; router_index < num_routers; router_index++) {
+      node= _rd_node(r);
+      if (node == NULL)
+	break;
+      igp_domain_add_router(domain, node);
+    }
+  }
+}
+
+// -----[ _state_read_rt ]-------------------------------------------
+static void _state_read_rt(_state_reader_t * r, uint32_t count)
+{
+  unsigned int index, info_index, entry_index;
+  uint32_t num_infos;
+  uint16_t num_entries;
+  net_node_t * node;
+  ip_pfx_t prefix;
+  uint32_t metric;
+  net_route_type_t type;
+  rt_info_t * rt_info;
+  net_iface_t * oif;
+  net_addr_t gateway;
+
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    node= _rd_node(r);
+    num_infos= _rd_u32(r);
+    for (info_index= 0; (info_index < num_infos) &&
+	   (r->error == ESUCCESS); info_index++) {
+      prefix= _rd_pfx(r);
+      metric= _rd_u32(r);
+      type= _rd_u8(r);
+      num_entries= _rd_u16(r);
+      if (r->error != ESUCCESS)
+	break;
+
+      rt_info= rt_info_create(prefix, metric, type);
+      for (entry_index= 0; entry_index < num_entries; entry_index++) {
+	oif= NULL;
+	if (_rd_u8(r)) {
+	  oif= node_find_iface(node, _rd_pfx(r));
+	  if (oif == NULL)
+	    r->error= ENET_STATE_FORMAT;
+	}
+	gateway= _rd_u32(r);
+	if (r->error != ESUCCESS)
+	  break;
+	rt_info_add_entry(rt_info, oif, gateway);
+      }
+      if (type == NET_ROUTE_BGP)
+	rt_info_intern(rt_info);
+
+      if ((r->error != ESUCCESS) ||
+	  (rt_add_route(node->rt, prefix, rt_info) != ESUCCESS)) {
+	rt_info_destroy(&rt_info);
+	if (r->error == ESUCCESS)
+	  r->error= ENET_STATE_FORMAT;
+      }
+    }
+  }
+}
+
+// -----[ _rd_route ]------------------------------------------------
+/**
+ * Read a BGP route. The route's peer is looked up in the sessions of
+ * the given router.
+ */
+static bgp_route_t * _rd_route(_state_reader_t * r,
+			       bgp_router_t * router)
+{
+  bgp_route_t * route;
+  ip_pfx_t prefix;
+  net_addr_t peer_addr, next_hop, originator;
+  bgp_peer_t * peer= NULL;
+  uint16_t flags;
+  uint8_t origin, length;
+  uint32_t local_pref, med, path_index, comm_index;
+  unsigned int index;
+  bgp_ecomm_t ecomm;
+
+  prefix= _rd_pfx(r);
+  peer_addr= _rd_u32(r);
+  flags= _rd_u16(r);
+  next_hop= _rd_u32(r);
+  origin= _rd_u8(r);
+  local_pref= _rd_u32(r);
+  med= _rd_u32(r);
+  path_index= _rd_u32(r);
+  comm_index= _rd_u32(r);
+  if (r->error != ESUCCESS)
+    return NULL;
+
+  if (peer_addr != NET_ADDR_ANY) {
+    peer= bgp_router_find_peer(router, peer_addr);
+    if (peer == NULL)
+      r->error= ENET_STATE_FORMAT;
+  }
+  if ((origin >= BGP_ORIGIN_MAX) ||
+      ((path_index != NET_STATE_NO_INDEX) && (path_index >= r->num_paths)) ||
+      ((comm_index != NET_STATE_NO_INDEX) && (comm_index >= r->num_comms)))
+    r->error= ENET_STATE_FORMAT;
+  if (r->error != ESUCCESS)
+    return NULL;
+
+  route= route_create(prefix, peer, next_hop, origin);
+  route->flags= flags;
+  route_localpref_set(route, local_pref);
+  route_med_set(route, med);
+  if (path_index != NET_STATE_NO_INDEX)
+    route_set_path(route, r->paths[path_index]);
+  if (comm_index != NET_STATE_NO_INDEX)
+    route_set_comm(route, r->comms[comm_index]);
+
+  if (_rd_u8(r)) {
+    originator= _rd_u32(r);
+    route_originator_set(route, originator);
+  }
+  length= _rd_u8(r);
+  for (index= 0; index < length; index++)
+    route_cluster_list_append(route, _rd_u32(r));
+  length= _rd_u8(r);
+  for (index= 0; index < length; index++) {
+    _rd_copy(r, &ecomm, sizeof(ecomm));
+    route_ecomm_append(route, ecomm_val_copy(&ecomm));
+  }
+
+  if (r->error != ESUCCESS)
+    route_destroy(&route);
+  return route;
+}
+
+// -----[ _state_read_rib ]------------------------------------------
+static void _state_read_rib(_state_reader_t * r, bgp_router_t * router,
+			    bgp_rib_t * rib)
+{
+  uint32_t count= _rd_u32(r);
+  unsigned int index;
+  bgp_route_t * route;
+
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    route= _rd_route(r, router);
+    if (route == NULL)
+      break;
+    rib_add_route(rib, route);
+  }
+}
+
+// -----[ _state_read_peer ]-----------------------------------------
+static void _state_read_peer(_state_reader_t * r, bgp_router_t * router)
+{
+  net_addr_t addr= _rd_u32(r);
+  uint16_t asn= _rd_u16(r);
+  bgp_peer_t * peer;
+  int error;
+
+  if (r->error != ESUCCESS)
+    return;
+  error= bgp_router_add_peer(router, asn, addr, &peer);
+  if (error != ESUCCESS) {
+    r->error= error;
+    return;
+  }
+  peer->flags= _rd_u8(r);
+  peer->router_id= _rd_u32(r);
+  peer->session_state= _rd_u8(r);
+  peer->next_hop= _rd_u32(r);
+  peer->src_addr= _rd_u32(r);
+  peer->send_seq_num= _rd_u32(r);
+  peer->recv_seq_num= _rd_u32(r);
+}
+
+// -----[ _state_read_router ]---------------------------------------
+static void _state_read_router(_state_reader_t * r)
+{
+  net_node_t * node= _rd_node(r);
+  uint16_t asn= _rd_u16(r);
+  bgp_router_t * router;
+  bgp_peer_t * peer;
+  uint32_t count;
+  unsigned int index;
+  bgp_route_t * route;
+  int error;
+
+  if (r->error != ESUCCESS)
+    return;
+  error= bgp_add_router(asn, node, &router);
+  if (error != ESUCCESS) {
+    r->error= error;
+    return;
+  }
+  router->rid= _rd_u32(r);
+  router->cluster_id= _rd_u32(r);
+  router->reflector= _rd_u8(r);
+
+  count= _rd_u32(r);
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++)
+    _state_read_peer(r, router);
+
+  count= _rd_u32(r);
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++) {
+    route= _rd_route(r, router);
+    if (route != NULL)
+      routes_list_append(router->local_nets, route);
+  }
+
+  _state_read_rib(r, router, router->loc_rib);
+  for (index= 0; (index < bgp_peers_size(router->peers)) &&
+	 (r->error == ESUCCESS); index++) {
+    peer= bgp_peers_at(router->peers, index);
+    _state_read_rib(r, router, peer->adj_rib[RIB_IN]);
+    _state_read_rib(r, router, peer->adj_rib[RIB_OUT]);
+  }
+}
+
+// -----[ _state_read_bgp ]------------------------------------------
+static void _state_read_bgp(_state_reader_t * r, uint32_t count)
+{
+  unsigned int index;
+
+  for (index= 0; (index < count) && (r->error == ESUCCESS); index++)
+    _state_read_router(r);
+}
+
+// -----[ _state_read_sections ]-------------------------------------
+static void _state_read_sections(_state_reader_t * r)
+{
+  const char * magic= (const char *) _rd(r, NET_STATE_MAGIC_LEN);
+  uint32_t tag, count, size;
+  size_t end;
+
+  if ((magic == NULL) ||
+      (memcmp(magic, NET_STATE_MAGIC, NET_STATE_MAGIC_LEN) != 0)) {
+    r->error= ENET_STATE_FORMAT;
+    return;
+  }
+  if (_rd_u32(r) != NET_STATE_VERSION) {
+    r->error= ENET_STATE_VERSION;
+    return;
+  }
+  if (_rd_u32(r) != NET_STATE_BOM) {
+    r->error= ENET_STATE_FORMAT;
+    return;
+  }
+
+  while (r->error == ESUCCESS) {
+    tag= _rd_u32(r);
+    if ((r->error != ESUCCESS) || (tag == NET_STATE_SECTION_END))
+      break;
+    count= _rd_u32(r);
+    size= _rd_u32(r);
+    // Each item takes at least one byte. This bounds the size of
+    // the dictionaries allocated from the count.
+    if ((r->error != ESUCCESS) || (size > r->size - r->offset) ||
+	(count > size)) {
+      r->error= ENET_STATE_FORMAT;
+      break;
+    }
+    end= r->offset + size;
+
+    switch (tag) {
+    case NET_STATE_SECTION_PATHS:
+      _state_read_paths(r, count);
+      break;
+    case NET_STATE_SECTION_COMMS:
+      _state_read_comms(r, count);
+      break;
+    case NET_STATE_SECTION_NODES:
+      _state_read_nodes(r, count);
+      break;
+    case NET_STATE_SECTION_SUBNETS:
+      _state_read_subnets(r, count);
+      break;
+    case NET_STATE_SECTION_IFACES:
+      _state_read_ifaces(r, count);
+      break;
+    case NET_STATE_SECTION_DOMAINS:
+      _state_read_domains(r, count);
+      break;
+    case NET_STATE_SECTION_RT:
+      _state_read_rt(r, count);
+      break;
+    case NET_STATE_SECTION_BGP:
+      _state_read_bgp(r, count);
+      break;
+    default:
+      // Unknown sections are skipped
+      r->offset= end;
+    }
+
+    if ((r->error == ESUCCESS) && (r->offset != end))
+      r->error= ENET_STATE_FORMAT;
+  }
+}
+
+// -----[ _state_network_is_empty ]----------------------------------
+static inline int _state_network_is_empty(network_t * network)
+{
+  gds_enum_t * nodes= trie_get_enum(network->nodes);
+  int empty= !enum_has_next(nodes);
+
+  enum_destroy(&nodes);
+  return (empty &&
+	  (ptr_array_length(network->subnets) == 0) &&
+	  (ptr_array_length(network->domains) == 0));
+}
+
+// -----[ _state_rollback ]------------------------------------------
+/**
+ * Undo a partial load. Since the network was empty before the load,
+ * all its content is discarded. The BGP routers are removed from
+ * their domain first, since the domains outlive the network.
+ */
+static void _state_rollback(network_t * network)
+{
+  gds_enum_t * nodes= trie_get_enum(network->nodes);
+  net_node_t * node;
+  net_protocol_t * protocol;
+  bgp_router_t * router;
+
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    protocol= node_get_protocol(node, NET_PROTOCOL_BGP);
+    if (protocol == NULL)
+      continue;
+    router= (bgp_router_t *) protocol->handler;
+    if (router->domain != NULL)
+      bgp_domain_del_router(router->domain, router);
+  }
+  enum_destroy(&nodes);
+  network_clear(network);
+}
+
+// -----[ net_state_load ]-------------------------------------------
+int net_state_load(network_t * network, const char * filename)
+{
+  _state_reader_t r;
+  FILE * file;
+  long size;
+  void * data;
+  unsigned int index;
+
+  if (!_state_network_is_empty(network))
+    return ENET_STATE_NOT_EMPTY;
+
+  file= fopen(filename, "rb");
+  if (file == NULL)
+    return ENET_STATE_IO;
+  if ((fseek(file, 0, SEEK_END) != 0) || ((size= ftell(file)) < 0)) {
+    fclose(file);
+    return ENET_STATE_IO;
+  }
+  if (size == 0) {
+    fclose(file);
+    return ENET_STATE_FORMAT;
+  }
+
+#ifdef NET_STATE_USE_MMAP
+  data= mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(file), 0);
+  if (data == MAP_FAILED) {
+    fclose(file);
+    return ENET_STATE_IO;
+  }
+#else
+  data= MALLOC(size);
+  if ((fseek(file, 0, SEEK_SET) != 0) ||
+      ((size > 0) && (fread(data, size, 1, file) != 1))) {
+    FREE(data);
+    fclose(file);
+    return ENET_STATE_IO;
+  }
+#endif /* NET_STATE_USE_MMAP */
+
+  r.data= (const uint8_t *) data;
+  r.size= size;
+  r.offset= 0;
+  r.error= ESUCCESS;
+  r.network= network;
+  r.paths= NULL;
+  r.num_paths= 0;
+  r.comms= NULL;
+  r.num_comms= 0;
+
+  _state_read_sections(&r);
+  if (r.error != ESUCCESS)
+    _state_rollback(network);
+
+  // Release the references held by the dictionaries
+  for (index= 0; index < r.num_paths; index++)
+    path_hash_remove(r.paths[index]);
+  for (index= 0; index < r.num_comms; index++)
+    comm_hash_remove(r.comms[index]);
+  if (r.paths != NULL)
+    FREE(r.paths);
+  if (r.comms != NULL)
+    FREE(r.comms);
+
+#ifdef NET_STATE_USE_MMAP
+  munmap(data, size);
+#else
+  FREE(data);
+#endif /* NET_STATE_USE_MMAP */
+  fclose(file);
+  return r.error;
+}
@@ -0,0 +1,93 @@
+// ==================================================================
+// @(#)state.h
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+/**
+ * \file
+ * Provide functions to save the complete state of a network into a
+ * compact binary file and to restore it later.
+ *
+ * The state file contains the nodes, subnets, interfaces, IGP
+ * domains, routing tables, BGP routers, BGP sessions and the content
+ * of all the Adj-RIBs and Loc-RIBs. The AS-Paths and Communities
+ * referenced by BGP routes are stored once, in dictionaries built
+ * from the global repositories (see path_hash and comm_hash).
+ * Routes only refer to dictionary entries by index.
+ *
+ * The file is a header followed by a sequence of sections. Each
+ * section starts with a tag, an item count and its size in bytes.
+ * The section size lets a reader skip sections it does not need
+ * or does not know. Values are in host byte order; the header
+ * holds a byte-order mark so that a foreign file is rejected.
+ *
+ * Restrictions:
+ *   - BGP filters and route-maps are not saved
+ *   - virtual (tunnel) interfaces are not supported
+ *   - pending simulator events are not saved, so the network
+ *     should be converged before it is saved
+ */
+
+#ifndef __NET_STATE_H__
+#define __NET_STATE_H__
+
+#include <net/net_types.h>
+
+#define NET_STATE_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ net_state_save ]-----------------------------------------
+  /**
+   * Save the state of a network into a file.
+   *
+   * \param network  is the network to be saved.
+   * \param filename is the name of the state file.
+   * \retval ESUCCESS in case of success, a negative error code
+   *         otherwise.
+   */
+  int net_state_save(network_t * network, const char * filename);
+
+  // -----[ net_state_load ]-----------------------------------------
+  /**
+   * Restore the state of a network from a file.
+   *
+   * The network must be empty (no node, no subnet and no IGP
+   * domain). The file is mapped in memory when the platform
+   * supports it. If the load fails, the network is left empty.
+   *
+   * \param network  is the target network.
+   * \param filename is the name of the state file.
+   * \retval ESUCCESS in case of success, a negative error code
+   *         otherwise.
+   */
+  int net_state_load(network_t * network, const char * filename);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_STATE_H__ */
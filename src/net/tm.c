@@ -39,20 +39,41 @@
 #include <config.h>
 #endif
 
+#include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif /* HAVE_UNISTD_H */
+#if defined(_POSIX_MAPPED_FILES) && (_POSIX_MAPPED_FILES > 0)
+# include <fcntl.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# define NET_TM_USE_MMAP
+#endif
 
+#include <libgds/enumerator.h>
+#include <libgds/memory.h>
 #include <libgds/str_util.h>
 #include <libgds/tokenizer.h>
+#include <libgds/trie.h>
 #include <net/network.h>
 #include <net/node.h>
 #include <net/icmp.h>
 #include <net/icmp_options.h>
 #include <net/tm.h>
 #include <net/util.h>
+#include <net/verify.h>
 #include <util/lrp.h>
 
 #define MAX_TM_LINE_LEN 80
 
+#define NET_TM_BIN_MAGIC       "CBTM"
+#define NET_TM_BIN_VERSION     1
+#define NET_TM_BIN_HEADER_SIZE 20
+#define NET_TM_TTL             255
+
 static lrp_t * _parser= NULL;
 
 #define DEBUG
@@ -103,6 +124,10 @@ char * net_tm_strerror(int error)
     return "invalid destination";
   case NET_TM_ERROR_INVALID_LOAD:
     return "invalid load";
+  case NET_TM_ERROR_WRITE:
+    return "failed to write file";
+  case NET_TM_ERROR_FORMAT:
+    return "invalid binary format";
   }
   return NULL;
 }
@@ -126,12 +151,55 @@ const char * flow_field2str(flow_field_t field)
   return "unknown field";
 }
 
-// -----[ _parse ]---------------------------------------------------
-static inline int _parse(lrp_t * parser)
+// -----[ _parse_line ]----------------------------------------------
+static inline int _parse_line(lrp_t * parser, net_addr_t * src_addr,
+			      ip_dest_t * dest, net_link_load_t * load)
 {
   unsigned int num_fields;
   const char * field;
-  const char * field_src, * field_dst;
+
+  if (lrp_get_num_fields(parser, &num_fields) < 0)
+    return -1;
+
+  // We should have at least 4 tokens
+  if (num_fields != 4) {
+    lrp_set_user_error(parser, "incorrect number of fields (4 expected)");
+    return NET_TM_ERROR_NUM_PARAMS;
+  }
+
+  // Source node
+  field= lrp_get_field(parser, 0);
+  if (str2address(field, src_addr) < 0) {
+    lrp_set_user_error(parser, "invalid source \"%s\"", field);
+    return NET_TM_ERROR_INVALID_SRC;
+  }
+
+  // Source interface
+  // Not used for forwarding (yet)
+
+  // Destination prefix
+  field= lrp_get_field(parser, 2);
+  if (ip_string_to_dest(field, dest) < 0) {
+    lrp_set_user_error(parser, "invalid destination \"%s\"", field);
+    return NET_TM_ERROR_INVALID_DST;
+  }
+
+  // Load (volume of traffic)
+  field= lrp_get_field(parser, 3);
+  if (str2capacity(field, load) < 0) {
+    lrp_set_user_error(parser, "invalid load \"%s\"", field);
+    return NET_TM_ERROR_INVALID_LOAD;
+  }
+
+  // Optional TOS ?
+  // --> Not supported (yet)
+
+  return NET_TM_SUCCESS;
+}
+
+// -----[ _parse ]---------------------------------------------------
+static inline int _parse(lrp_t * parser)
+{
   int result;
   net_addr_t src_addr;
   net_node_t * node;
@@ -140,53 +208,23 @@ static inline int _parse(lrp_t * parser)
   network_t * network= network_get_default();
 
   while (lrp_get_next_line(parser)) {
-    if (lrp_get_num_fields(parser, &num_fields) < 0)
-      return -1;
+    result= _parse_line(parser, &src_addr, &dest, &load);
+    if (result != NET_TM_SUCCESS)
+      return result;
 
-    // We should have at least 4 tokens
-    if (num_fields != 4) {
-      lrp_set_user_error(parser, "incorrect number of fields (4 expected)");
-      return NET_TM_ERROR_NUM_PARAMS;
-    }
-
-    // Source node
-    field_src= lrp_get_field(parser, 0);
-    if (str2address(field_src, &src_addr) < 0) {
-      lrp_set_user_error(parser, "invalid source \"%s\"", field_src);
-      return NET_TM_ERROR_INVALID_SRC;
-    }
     node= network_find_node(network, src_addr);
     if (node == NULL) {
-      lrp_set_user_error(parser, "unknown source \"%s\"", field_src);
+      lrp_set_user_error(parser, "unknown source \"%s\"",
+			 lrp_get_field(parser, 0));
       return NET_TM_ERROR_UNKNOWN_SRC;
     }
-    
-    // Source interface
-    field= lrp_get_field(parser, 1);
-    // Not used for forwarding (yet)
-
-    // Destination prefix
-    field_dst= lrp_get_field(parser, 2);
-    if (ip_string_to_dest(field_dst, &dest) < 0) {
-      lrp_set_user_error(parser, "invalid destination \"%s\"", field_dst);
-      return NET_TM_ERROR_INVALID_DST;
-    }
-
-    // Load (volume of traffic)
-    field= lrp_get_field(parser, 3);
-    if (str2capacity(field, &load) < 0) {
-      lrp_set_user_error(parser, "invalid load \"%s\"", field);
-      return NET_TM_ERROR_INVALID_LOAD;
-    }
-
-    // Optional TOS ?
-    // --> Not supported (yet)
 
     __debug("load traffic\n"
 	    "  +-- from  :%s\n"
 	    "  +-- to    :%s\n",
 	    "  +-- volume:%u\n", 
-	    field_src, field_dst, (unsigned int) load);
+	    lrp_get_field(parser, 0), lrp_get_field(parser, 2),
+	    (unsigned int) load);
 
     result= node_load_flow(node, IP_ADDR_ANY, dest.addr, load, NULL, NULL, NULL);
     if (result < 0)
@@ -212,6 +250,726 @@ int net_tm_load(const char * filename)
   return result;
 }
 
+// -----[ _tm_flow_t ]-----------------------------------------------
+typedef struct {
+  net_addr_t      src;
+  net_addr_t      dst;
+  net_link_load_t load;
+} _tm_flow_t;
+
+// -----[ _tm_flow_cmp ]---------------------------------------------
+static int _tm_flow_cmp(const void * item1, const void * item2)
+{
+  const _tm_flow_t * flow1= (const _tm_flow_t *) item1;
+  const _tm_flow_t * flow2= (const _tm_flow_t *) item2;
+
+  if (flow1->src != flow2->src)
+    return (flow1->src < flow2->src) ? -1 : 1;
+  if (flow1->dst != flow2->dst)
+    return (flow1->dst < flow2->dst) ? -1 : 1;
+  return 0;
+}
+
+// -----[ _tm_addr_cmp ]---------------------------------------------
+static int _tm_addr_cmp(const void * item1, const void * item2)
+{
+  net_addr_t addr1= *((const net_addr_t *) item1);
+  net_addr_t addr2= *((const net_addr_t *) item2);
+
+  if (addr1 != addr2)
+    return (addr1 < addr2) ? -1 : 1;
+  return 0;
+}
+
+// -----[ _tm_put32 ]------------------------------------------------
+static inline void _tm_put32(uint8_t * buf, uint32_t value)
+{
+  buf[0]= (uint8_t) (value >> 24);
+  buf[1]= (uint8_t) (value >> 16);
+  buf[2]= (uint8_t) (value >> 8);
+  buf[3]= (uint8_t) value;
+}
+
+// -----[ _tm_get32 ]------------------------------------------------
+static inline uint32_t _tm_get32(const uint8_t * buf)
+{
+  return (((uint32_t) buf[0]) << 24) | (((uint32_t) buf[1]) << 16) |
+    (((uint32_t) buf[2]) << 8) | ((uint32_t) buf[3]);
+}
+
+// -----[ _tm_write ]------------------------------------------------
+/**
+ * Write a record of up to 3 32-bit values.
+ */
+static inline int _tm_write(FILE * file, unsigned int num_values,
+			    uint32_t value1, uint32_t value2, uint32_t value3)
+{
+  uint8_t buf[12];
+
+  _tm_put32(buf, value1);
+  _tm_put32(buf+4, value2);
+  _tm_put32(buf+8, value3);
+  if (fwrite(buf, 4, num_values, file) != num_values)
+    return NET_TM_ERROR_WRITE;
+  return NET_TM_SUCCESS;
+}
+
+// -----[ _tm_write_binary ]-----------------------------------------
+static int _tm_write_binary(FILE * file, _tm_flow_t * flows,
+			    unsigned int num_flows, net_addr_t * dsts,
+			    unsigned int num_dsts)
+{
+  unsigned int index, first, num_srcs= 0;
+  net_addr_t * dst;
+  int result;
+
+  for (index= 0; index < num_flows; index++)
+    if ((index == 0) || (flows[index].src != flows[index-1].src))
+      num_srcs++;
+
+  // Header
+  if (fwrite(NET_TM_BIN_MAGIC, 1, 4, file) != 4)
+    return NET_TM_ERROR_WRITE;
+  result= _tm_write(file, 1, NET_TM_BIN_VERSION, 0, 0);
+  if (result == NET_TM_SUCCESS)
+    result= _tm_write(file, 3, num_srcs, num_dsts, num_flows);
+
+  // Sources
+  first= 0;
+  for (index= 1; (result == NET_TM_SUCCESS) && (index <= num_flows);
+       index++) {
+    if ((index < num_flows) && (flows[index].src == flows[first].src))
+      continue;
+    result= _tm_write(file, 3, flows[first].src, first, index-first);
+    first= index;
+  }
+
+  // Destinations
+  for (index= 0; (result == NET_TM_SUCCESS) && (index < num_dsts); index++)
+    result= _tm_write(file, 1, dsts[index], 0, 0);
+
+  // Entries
+  for (index= 0; (result == NET_TM_SUCCESS) && (index < num_flows);
+       index++) {
+    dst= (net_addr_t *) bsearch(&flows[index].dst, dsts, num_dsts,
+				sizeof(net_addr_t), _tm_addr_cmp);
+    assert(dst != NULL);
+    result= _tm_write(file, 2, dst-dsts, flows[index].load, 0);
+  }
+  return result;
+}
+
+// -----[ net_tm_convert ]-------------------------------------------
+/**
+ * The flows are sorted by source and destination. The flows with the
+ * same source and destination are merged.
+ */
+int net_tm_convert(const char * filename, const char * bin_filename)
+{
+  _tm_flow_t * flows= NULL;
+  net_addr_t * dsts;
+  unsigned int index, size= 0, num_flows= 0, num_dsts= 0;
+  ip_dest_t dest;
+  FILE * file;
+  int result;
+
+  result= lrp_open(_parser, filename);
+  if (result != 0) {
+    lrp_close(_parser);
+    return result;
+  }
+  while (lrp_get_next_line(_parser)) {
+    if (num_flows == size) {
+      size= (size == 0) ? 1024 : 2*size;
+      flows= (_tm_flow_t *) REALLOC(flows, sizeof(_tm_flow_t)*size);
+    }
+    result= _parse_line(_parser, &flows[num_flows].src, &dest,
+			&flows[num_flows].load);
+    if (result != NET_TM_SUCCESS)
+      break;
+    flows[num_flows++].dst= dest.addr;
+  }
+  lrp_close(_parser);
+
+  if (result == NET_TM_SUCCESS) {
+    qsort(flows, num_flows, sizeof(_tm_flow_t), _tm_flow_cmp);
+    size= 0;
+    for (index= 0; index < num_flows; index++) {
+      if ((size > 0) && !_tm_flow_cmp(&flows[size-1], &flows[index]))
+	flows[size-1].load+= flows[index].load;
+      else
+	flows[size++]= flows[index];
+    }
+    num_flows= size;
+
+    // Intern the destinations
+    dsts= (net_addr_t *) MALLOC(sizeof(net_addr_t)*(num_flows+1));
+    for (index= 0; index < num_flows; index++)
+      dsts[index]= flows[index].dst;
+    qsort(dsts, num_flows, sizeof(net_addr_t), _tm_addr_cmp);
+    for (index= 0; index < num_flows; index++)
+      if ((num_dsts == 0) || (dsts[num_dsts-1] != dsts[index]))
+	dsts[num_dsts++]= dsts[index];
+
+    file= fopen(bin_filename, "wb");
+    if (file == NULL) {
+      result= NET_TM_ERROR_OPEN;
+    } else {
+      result= _tm_write_binary(file, flows, num_flows, dsts, num_dsts);
+      if (fclose(file) != 0)
+	result= NET_TM_ERROR_WRITE;
+    }
+    FREE(dsts);
+  }
+
+  if (flows != NULL)
+    FREE(flows);
+  return result;
+}
+
+// -----[ _tm_map ]--------------------------------------------------
+/**
+ * Map the content of a file in memory (read-only). When mmap() is
+ * not available, the file is read into a buffer.
+ */
+static int _tm_map(const char * filename, const uint8_t ** data_ref,
+		   size_t * size_ref)
+{
+#ifdef NET_TM_USE_MMAP
+  struct stat st;
+  void * data;
+  int fd= open(filename, O_RDONLY);
+
+  if (fd < 0)
+    return NET_TM_ERROR_OPEN;
+  if ((fstat(fd, &st) < 0) || (st.st_size < NET_TM_BIN_HEADER_SIZE)) {
+    close(fd);
+    return NET_TM_ERROR_FORMAT;
+  }
+  data= mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED)
+    return NET_TM_ERROR_OPEN;
+  *data_ref= (const uint8_t *) data;
+  *size_ref= st.st_size;
+  return NET_TM_SUCCESS;
+#else
+  uint8_t * data;
+  long size;
+  FILE * file= fopen(filename, "rb");
+
+  if (file == NULL)
+    return NET_TM_ERROR_OPEN;
+  if ((fseek(file, 0, SEEK_END) != 0) || ((size= ftell(file)) < 0) ||
+      (size < NET_TM_BIN_HEADER_SIZE) || (fseek(file, 0, SEEK_SET) != 0)) {
+    fclose(file);
+    return NET_TM_ERROR_FORMAT;
+  }
+  data= (uint8_t *) MALLOC(size);
+  if (fread(data, 1, size, file) != (size_t) size) {
+    FREE(data);
+    fclose(file);
+    return NET_TM_ERROR_OPEN;
+  }
+  fclose(file);
+  *data_ref= data;
+  *size_ref= size;
+  return NET_TM_SUCCESS;
+#endif
+}
+
+// -----[ _tm_unmap ]------------------------------------------------
+static void _tm_unmap(const uint8_t * data, size_t size)
+{
+#ifdef NET_TM_USE_MMAP
+  munmap((void *) data, size);
+#else
+  FREE((void *) data);
+#endif
+}
+
+// Exploration state of a node
+#define _TM_WHITE 0
+#define _TM_GRAY  1
+#define _TM_BLACK 2
+
+// -----[ _tm_ref_t ]------------------------------------------------
+typedef struct {
+  net_node_t   * node;
+  unsigned int   index;
+} _tm_ref_t;
+
+// -----[ _tm_index_t ]----------------------------------------------
+/** Index of the nodes of the network (see _tm_index_init). */
+typedef struct {
+  network_t    * network;
+  /** Nodes (ordered by identifier). */
+  net_node_t  ** nodes;
+  /** Index of the nodes (ordered by address in memory). */
+  _tm_ref_t    * refs;
+  unsigned int   num_nodes;
+} _tm_index_t;
+
+// -----[ _tm_edge_t ]-----------------------------------------------
+/** Routing entry of a node, resolved towards the destination. */
+typedef struct {
+  /** Outgoing interface (NULL if dropped before the interface). */
+  net_iface_t  * oif;
+  /** Next node (-1 if dropped or if the entry closes a loop). */
+  int            next;
+  /** Fraction of the traffic that goes through the tunnel (1 if the
+      interface is not a tunnel) and whether some traffic is lost. */
+  double         ratio;
+  uint8_t        lossy;
+} _tm_edge_t;
+
+// -----[ _tm_run_t ]------------------------------------------------
+/**
+ * Propagation of the traffic towards one destination. The nodes are
+ * visited from the sources and ordered so that each node comes after
+ * all the nodes that forward traffic to it. The load is then
+ * accumulated at each node and split once among its routing entries,
+ * instead of being forwarded flow by flow and path by path.
+ */
+typedef struct {
+  _tm_index_t     * index;
+  net_addr_t        addr;
+  /** Remaining nesting of tunnels. */
+  unsigned int      depth;
+  /** Per node state (indexed as in _tm_index_t). */
+  uint8_t         * color;
+  uint8_t         * local;
+  net_link_load_t * pending;
+  unsigned int    * post;
+  unsigned int    * edge_first;
+  unsigned int    * edge_count;
+  double          * ratio;
+  uint8_t         * lossy;
+  /** Visited nodes (post-order). */
+  unsigned int    * order;
+  unsigned int      num_order;
+  _tm_edge_t      * edges;
+  unsigned int      num_edges;
+  unsigned int      max_edges;
+  net_link_load_t   delivered;
+} _tm_run_t;
+
+// -----[ _tm_ref_cmp ]----------------------------------------------
+static int _tm_ref_cmp(const void * item1, const void * item2)
+{
+  const _tm_ref_t * ref1= (const _tm_ref_t *) item1;
+  const _tm_ref_t * ref2= (const _tm_ref_t *) item2;
+  if (ref1->node != ref2->node)
+    return (ref1->node < ref2->node) ? -1 : 1;
+  return 0;
+}
+
+// -----[ _tm_index_of ]---------------------------------------------
+static inline int _tm_index_of(_tm_index_t * index, net_node_t * node)
+{
+  _tm_ref_t key= { .node= node };
+  _tm_ref_t * ref= (_tm_ref_t *) bsearch(&key, index->refs,
+					 index->num_nodes,
+					 sizeof(_tm_ref_t), _tm_ref_cmp);
+  if (ref == NULL)
+    return -1;
+  return ref->index;
+}
+
+// -----[ _tm_index_init ]-------------------------------------------
+static void _tm_index_init(_tm_index_t * index, network_t * network)
+{
+  gds_enum_t * nodes;
+  net_node_t * node;
+
+  index->network= network;
+  index->num_nodes= 0;
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    enum_get_next(nodes);
+    index->num_nodes++;
+  }
+  enum_destroy(&nodes);
+
+  index->nodes= (net_node_t **) MALLOC(sizeof(net_node_t *)*
+				       (index->num_nodes+1));
+  index->refs= (_tm_ref_t *) MALLOC(sizeof(_tm_ref_t)*
+				    (index->num_nodes+1));
+  index->num_nodes= 0;
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    index->nodes[index->num_nodes]= node;
+    index->refs[index->num_nodes].node= node;
+    index->refs[index->num_nodes].index= index->num_nodes;
+    index->num_nodes++;
+  }
+  enum_destroy(&nodes);
+  qsort(index->refs, index->num_nodes, sizeof(_tm_ref_t), _tm_ref_cmp);
+}
+
+// -----[ _tm_index_destroy ]----------------------------------------
+static void _tm_index_destroy(_tm_index_t * index)
+{
+  FREE(index->nodes);
+  FREE(index->refs);
+}
+
+// -----[ _tm_run_init ]---------------------------------------------
+static void _tm_run_init(_tm_run_t * run, _tm_index_t * index,
+			 unsigned int depth)
+{
+  unsigned int size= index->num_nodes+1;
+
+  run->index= index;
+  run->depth= depth;
+  run->color= (uint8_t *) MALLOC(sizeof(uint8_t)*size);
+  memset(run->color, _TM_WHITE, sizeof(uint8_t)*size);
+  run->local= (uint8_t *) MALLOC(sizeof(uint8_t)*size);
+  run->pending= (net_link_load_t *) MALLOC(sizeof(net_link_load_t)*size);
+  memset(run->pending, 0, sizeof(net_link_load_t)*size);
+  run->post= (unsigned int *) MALLOC(sizeof(unsigned int)*size);
+  run->edge_first= (unsigned int *) MALLOC(sizeof(unsigned int)*size);
+  run->edge_count= (unsigned int *) MALLOC(sizeof(unsigned int)*size);
+  run->ratio= (double *) MALLOC(sizeof(double)*size);
+  run->lossy= (uint8_t *) MALLOC(sizeof(uint8_t)*size);
+  run->order= (unsigned int *) MALLOC(sizeof(unsigned int)*size);
+  run->num_order= 0;
+  run->edges= NULL;
+  run->num_edges= 0;
+  run->max_edges= 0;
+  run->delivered= 0;
+}
+
+// -----[ _tm_run_reset ]--------------------------------------------
+/**
+ * Prepare the run for another destination. Only the nodes visited
+ * for the previous destination are reset.
+ */
+static void _tm_run_reset(_tm_run_t * run, net_addr_t addr)
+{
+  unsigned int index;
+
+  for (index= 0; index < run->num_order; index++) {
+    run->color[run->order[index]]= _TM_WHITE;
+    run->pending[run->order[index]]= 0;
+  }
+  run->addr= addr;
+  run->num_order= 0;
+  run->num_edges= 0;
+  run->delivered= 0;
+}
+
+// -----[ _tm_run_destroy ]------------------------------------------
+static void _tm_run_destroy(_tm_run_t * run)
+{
+  FREE(run->color);
+  FREE(run->local);
+  FREE(run->pending);
+  FREE(run->post);
+  FREE(run->edge_first);
+  FREE(run->edge_count);
+  FREE(run->ratio);
+  FREE(run->lossy);
+  FREE(run->order);
+  if (run->edges != NULL)
+    FREE(run->edges);
+}
+
+// -----[ _tm_visit ]------------------------------------------------
+/**
+ * Resolve the routing entries of a node towards the destination and
+ * visit the next nodes (depth-first). The nodes are appended to the
+ * order when all the nodes they forward to have been visited.
+ */
+static void _tm_visit(_tm_run_t * run, unsigned int index)
+{
+  net_node_t * node= run->index->nodes[index];
+  rt_info_t * rtinfo= NULL;
+  net_node_t * next;
+  const char * reason;
+  _tm_edge_t * edge;
+  unsigned int index2, num_entries= 0;
+
+  if (run->color[index] != _TM_WHITE)
+    return;
+  run->color[index]= _TM_GRAY;
+
+  run->local[index]= (node_has_address(node, run->addr) != NULL);
+  if (!run->local[index] && (node->rt != NULL))
+    rtinfo= rt_find_best(node->rt, run->addr, NET_ROUTE_ANY);
+  if (rtinfo != NULL)
+    num_entries= rt_entries_size(rtinfo->entries);
+
+  // The entries of a node are stored contiguously, before the next
+  // nodes are visited
+  if (run->num_edges + num_entries > run->max_edges) {
+    while (run->num_edges + num_entries > run->max_edges)
+      run->max_edges= (run->max_edges == 0) ? 256 : 2*run->max_edges;
+    run->edges= (_tm_edge_t *) REALLOC(run->edges, sizeof(_tm_edge_t)*
+				       run->max_edges);
+  }
+  run->edge_first[index]= run->num_edges;
+  run->edge_count[index]= num_entries;
+  for (index2= 0; index2 < num_entries; index2++) {
+    edge= &run->edges[run->num_edges++];
+    edge->oif= NULL;
+    edge->ratio= 1;
+    edge->lossy= 0;
+    next= net_verify_next_hop(run->index->network, node,
+			      rt_entries_get_at(rtinfo->entries, index2),
+			      run->addr, &edge->oif, &reason);
+    edge->next= (next != NULL) ? _tm_index_of(run->index, next) : -1;
+  }
+
+  for (index2= 0; index2 < num_entries; index2++)
+    if (run->edges[run->edge_first[index]+index2].next >= 0)
+      _tm_visit(run, run->edges[run->edge_first[index]+index2].next);
+
+  run->color[index]= _TM_BLACK;
+  run->post[index]= run->num_order;
+  run->order[run->num_order++]= index;
+}
+
+static net_link_load_t _tm_tunnel(_tm_run_t * run, unsigned int index,
+				  _tm_edge_t * edge, net_link_load_t load);
+
+// -----[ _tm_propagate ]--------------------------------------------
+/**
+ * Forward the load accumulated at the visited nodes towards the
+ * destination, in topological order. The load of a node is split
+ * evenly among its routing entries (ECMP), the remainder of the
+ * division going to the first entry. The load of the outgoing
+ * interface of each entry is increased by its share (even if the
+ * traffic is dropped after the interface, see _node_ip_output()).
+ *
+ * An entry that leads back to a node already forwarded closes a
+ * forwarding loop: its traffic is counted on the interface once and
+ * then dropped.
+ *
+ * Then, the fraction of the traffic of each node that reaches the
+ * destination is computed, in reverse order.
+ */
+static void _tm_propagate(_tm_run_t * run)
+{
+  unsigned int index, index2, position, first, count;
+  net_link_load_t load, share;
+  _tm_edge_t * edge;
+
+  for (position= run->num_order; position > 0; position--) {
+    index= run->order[position-1];
+    load= run->pending[index];
+    if (run->local[index]) {
+      run->delivered+= load;
+      continue;
+    }
+    first= run->edge_first[index];
+    count= run->edge_count[index];
+    for (index2= 0; index2 < count; index2++) {
+      edge= &run->edges[first+index2];
+      share= load / count;
+      if (index2 == 0)
+	share+= load % count;
+      if ((edge->oif != NULL) && (share > 0))
+	net_iface_add_load(edge->oif, share);
+      if (edge->next < 0)
+	continue;
+      if (run->post[edge->next] >= run->post[index]) {
+	edge->next= -1;
+	continue;
+      }
+      if (edge->oif->type == NET_IFACE_VIRTUAL)
+	share= _tm_tunnel(run, index, edge, share);
+      run->pending[edge->next]+= share;
+    }
+  }
+
+  for (position= 0; position < run->num_order; position++) {
+    index= run->order[position];
+    first= run->edge_first[index];
+    count= run->edge_count[index];
+    run->ratio[index]= run->local[index] ? 1 : 0;
+    run->lossy[index]= (!run->local[index] && (count == 0));
+    for (index2= 0; index2 < count; index2++) {
+      edge= &run->edges[first+index2];
+      if (edge->next < 0) {
+	run->lossy[index]= 1;
+	continue;
+      }
+      run->ratio[index]+= edge->ratio * run->ratio[edge->next] / count;
+      run->lossy[index]|= edge->lossy | run->lossy[edge->next];
+    }
+  }
+}
+
+// -----[ _tm_tunnel ]-----------------------------------------------
+/**
+ * Forward the traffic sent by a node through a tunnel towards the
+ * tunnel endpoint, and return the volume that reaches it. The
+ * fraction delivered through the tunnel is recorded in the entry.
+ */
+static net_link_load_t _tm_tunnel(_tm_run_t * run, unsigned int index,
+				  _tm_edge_t * edge, net_link_load_t load)
+{
+  _tm_run_t tunnel;
+  net_link_load_t delivered;
+
+  if (run->depth == 0) {
+    edge->ratio= 0;
+    edge->lossy= 1;
+    return 0;
+  }
+
+  _tm_run_init(&tunnel, run->index, run->depth-1);
+  _tm_run_reset(&tunnel, edge->oif->dest.end_point);
+  tunnel.pending[index]= load;
+  _tm_visit(&tunnel, index);
+  _tm_propagate(&tunnel);
+  edge->ratio= tunnel.ratio[index];
+  edge->lossy= tunnel.lossy[index];
+  delivered= tunnel.delivered;
+  _tm_run_destroy(&tunnel);
+  return delivered;
+}
+
+// -----[ _tm_bin_flow_t ]-------------------------------------------
+typedef struct {
+  unsigned int    node;
+  net_link_load_t load;
+} _tm_bin_flow_t;
+
+// -----[ net_tm_load_binary ]---------------------------------------
+/**
+ * The flows are grouped by destination. For each destination, the
+ * volumes of all the flows are propagated together (see
+ * _tm_propagate), so that each node and each routing entry is
+ * handled once per destination.
+ *
+ * The flow statistics are computed from the fraction of the traffic
+ * of the source node that reaches the destination. A flow is
+ * successful if none of its traffic is dropped.
+ */
+int net_tm_load_binary(network_t * network, const char * filename,
+		       flow_stats_t * stats)
+{
+  const uint8_t * data, * src, * entry;
+  size_t size;
+  uint32_t num_srcs, num_dsts, num_entries, first, count, dst_index;
+  uint64_t offset_dsts, offset_entries;
+  unsigned int index, index2, * dst_first= NULL, * dst_next= NULL;
+  _tm_bin_flow_t * flows= NULL, * flow;
+  net_link_load_t load, delivered;
+  net_node_t * node;
+  _tm_index_t nodes;
+  _tm_run_t run;
+  int result;
+
+  result= _tm_map(filename, &data, &size);
+  if (result != NET_TM_SUCCESS)
+    return result;
+
+  num_srcs= _tm_get32(data+8);
+  num_dsts= _tm_get32(data+12);
+  num_entries= _tm_get32(data+16);
+  offset_dsts= NET_TM_BIN_HEADER_SIZE + ((uint64_t) num_srcs)*12;
+  offset_entries= offset_dsts + ((uint64_t) num_dsts)*4;
+  if (memcmp(data, NET_TM_BIN_MAGIC, 4) ||
+      (_tm_get32(data+4) != NET_TM_BIN_VERSION) ||
+      (offset_entries + ((uint64_t) num_entries)*8 != size)) {
+    _tm_unmap(data, size);
+    return NET_TM_ERROR_FORMAT;
+  }
+
+  _tm_index_init(&nodes, network);
+
+  // Check the file and group the flows by destination (counting
+  // sort). No load is applied if the file is invalid.
+  dst_first= (unsigned int *) MALLOC(sizeof(unsigned int)*(num_dsts+1));
+  memset(dst_first, 0, sizeof(unsigned int)*(num_dsts+1));
+  for (index= 0; index < num_srcs; index++) {
+    src= data + NET_TM_BIN_HEADER_SIZE + index*12;
+    first= _tm_get32(src+4);
+    count= _tm_get32(src+8);
+    if (((uint64_t) first) + count > num_entries) {
+      result= NET_TM_ERROR_FORMAT;
+      break;
+    }
+    if (network_find_node(network, _tm_get32(src)) == NULL) {
+      result= NET_TM_ERROR_UNKNOWN_SRC;
+      break;
+    }
+    for (index2= first; index2 < first+count; index2++) {
+      dst_index= _tm_get32(data + offset_entries + ((uint64_t) index2)*8);
+      if (dst_index >= num_dsts) {
+	result= NET_TM_ERROR_FORMAT;
+	break;
+      }
+      dst_first[dst_index+1]++;
+    }
+    if (result != NET_TM_SUCCESS)
+      break;
+  }
+
+  if (result == NET_TM_SUCCESS) {
+    for (index= 0; index < num_dsts; index++)
+      dst_first[index+1]+= dst_first[index];
+    dst_next= (unsigned int *) MALLOC(sizeof(unsigned int)*(num_dsts+1));
+    memcpy(dst_next, dst_first, sizeof(unsigned int)*(num_dsts+1));
+    flows= (_tm_bin_flow_t *) MALLOC(sizeof(_tm_bin_flow_t)*
+				     (dst_first[num_dsts]+1));
+    for (index= 0; index < num_srcs; index++) {
+      src= data + NET_TM_BIN_HEADER_SIZE + index*12;
+      first= _tm_get32(src+4);
+      count= _tm_get32(src+8);
+      node= network_find_node(network, _tm_get32(src));
+      for (index2= first; index2 < first+count; index2++) {
+	entry= data + offset_entries + ((uint64_t) index2)*8;
+	flow= &flows[dst_next[_tm_get32(entry)]++];
+	flow->node= _tm_index_of(&nodes, node);
+	flow->load= _tm_get32(entry+4);
+      }
+    }
+
+    _tm_run_init(&run, &nodes, NET_TM_TTL);
+    for (dst_index= 0; dst_index < num_dsts; dst_index++) {
+      if (dst_first[dst_index] == dst_first[dst_index+1])
+	continue;
+      _tm_run_reset(&run, _tm_get32(data + offset_dsts + dst_index*4));
+      for (index= dst_first[dst_index]; index < dst_first[dst_index+1];
+	   index++)
+	run.pending[flows[index].node]+= flows[index].load;
+      for (index= dst_first[dst_index]; index < dst_first[dst_index+1];
+	   index++)
+	_tm_visit(&run, flows[index].node);
+      _tm_propagate(&run);
+
+      for (index= dst_first[dst_index]; index < dst_first[dst_index+1];
+	   index++) {
+	load= flows[index].load;
+	flow_stats_count(stats, load);
+	if (!run.lossy[flows[index].node]) {
+	  flow_stats_success(stats, load);
+	} else {
+	  delivered= (net_link_load_t) (load * run.ratio[flows[index].node]);
+	  flow_stats_failure(stats, load-delivered);
+	  if (stats != NULL)
+	    stats->bytes_ok+= delivered;
+	}
+      }
+    }
+    _tm_run_destroy(&run);
+  }
+
+  if (flows != NULL)
+    FREE(flows);
+  if (dst_next != NULL)
+    FREE(dst_next);
+  FREE(dst_first);
+  _tm_index_destroy(&nodes);
+  _tm_unmap(data, size);
+  return result;
+}
+
 // -----[ _tm_init ]-------------------------------------------------
 void _tm_init()
 {
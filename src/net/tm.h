@@ -48,6 +48,20 @@
  *   (an IP address)
  * \li <dst is the flow destination (IP address or IP prefix).
  * \li <volume> is the flow volume.
+ *
+ * A text traffic matrix can be converted into a compact binary
+ * format that is loaded without parsing (the file is mapped in
+ * memory when mmap() is available). The flows are sorted by source
+ * node and the destinations are interned. All the fields are 32-bit
+ * unsigned integers in network byte order:
+ *
+ *   header      : "CBTM" <version> <#sources> <#destinations> <#flows>
+ *   sources     : <node-id> <first-flow> <#flows>  (one per source)
+ *   destinations: <dst>                          (one per destination)
+ *   flows       : <dst-index> <volume>           (one per flow)
+ *
+ * The inbound interface is not stored. A destination prefix is
+ * replaced by its network address, as done by the text loader.
  */
 
 #ifndef __NET_TM_H__
@@ -57,6 +71,8 @@
 
 #include <util/lrp.h>
 #include <bgp/types.h>
+#include <net/net_types.h>
+#include <net/traffic/stats.h>
 
 typedef struct {
   asn_t        src_asn;
@@ -128,6 +144,8 @@ typedef enum {
   NET_TM_ERROR_UNKNOWN_SRC = LRP_ERROR_USER-4,
   NET_TM_ERROR_INVALID_DST = LRP_ERROR_USER-5,
   NET_TM_ERROR_INVALID_LOAD= LRP_ERROR_USER-6,
+  NET_TM_ERROR_WRITE       = LRP_ERROR_USER-7,
+  NET_TM_ERROR_FORMAT      = LRP_ERROR_USER-8,
 } tm_error_t;
 
 #ifdef __cplusplus
@@ -148,6 +166,36 @@ extern "C" {
   // -----[ net_tm_load ]--------------------------------------------
   int net_tm_load(const char * filename);
 
+  // -----[ net_tm_convert ]-----------------------------------------
+  /**
+   * Convert a text traffic matrix into the binary format.
+   *
+   * \param filename     is the text traffic matrix.
+   * \param bin_filename is the binary file to write.
+   * \retval NET_TM_SUCCESS in case of success,
+   *   or < 0 in case of error.
+   */
+  int net_tm_convert(const char * filename, const char * bin_filename);
+
+  // -----[ net_tm_load_binary ]-------------------------------------
+  /**
+   * Load a binary traffic matrix in a network.
+   *
+   * The volume of each flow is split evenly among the equal-cost
+   * next-hops found along its path, and added to the load of the
+   * outgoing interfaces. The flows towards the same destination are
+   * forwarded together. Traffic caught in a forwarding loop is
+   * counted once on the links of the loop, then dropped.
+   *
+   * \param network  is the network.
+   * \param filename is the binary traffic matrix.
+   * \param stats    is an optional statistics object (can be NULL).
+   * \retval NET_TM_SUCCESS in case of success,
+   *   or < 0 in case of error.
+   */
+  int net_tm_load_binary(network_t * network, const char * filename,
+			 flow_stats_t * stats);
+
   // -----[ _tm_init ]-----------------------------------------------
   void _tm_init();
   // -----[ _tm_done ]-----------------------------------------------
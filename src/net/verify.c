@@ -0,0 +1,499 @@
+// ==================================================================
+// @(#)verify.c
+//
+// Data-plane verification (forwarding loops and black holes).
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <libgds/enumerator.h>
+#include <libgds/memory.h>
+#include <libgds/trie.h>
+
+#include <net/iface.h>
+#include <net/network.h>
+#include <net/node.h>
+#include <net/prefix.h>
+#include <net/routing.h>
+#include <net/subnet.h>
+#include <net/verify.h>
+
+// Outcomes of the forwarding from a node
+#define _VFY_DELIVER 0x01
+#define _VFY_DROP    0x02
+#define _VFY_LOOP    0x04
+
+// Exploration state of a node
+#define _VFY_WHITE 0
+#define _VFY_GRAY  1
+#define _VFY_BLACK 2
+
+// -----[ _vfy_ref_t ]-----------------------------------------------
+typedef struct {
+  net_node_t   * node;
+  unsigned int   index;
+} _vfy_ref_t;
+
+// -----[ _vfy_ctx_t ]-----------------------------------------------
+typedef struct {
+  gds_stream_t       * stream;
+  network_t          * network;
+  net_verify_stats_t * stats;
+  /** Nodes (ordered by identifier). */
+  net_node_t        ** nodes;
+  /** Index of the nodes (ordered by address in memory). */
+  _vfy_ref_t         * refs;
+  unsigned int         num_nodes;
+  /** Boundaries of the equivalence classes. */
+  uint64_t           * bounds;
+  unsigned int         num_bounds;
+  unsigned int         max_bounds;
+  /** Current class and the minimal prefixes that cover it. */
+  net_addr_t           addr;
+  ip_pfx_t             pfxs[64];
+  unsigned int         num_pfxs;
+  /** Exploration state of the current class. */
+  uint8_t            * color;
+  uint8_t            * outcome;
+  unsigned int       * stack;
+  unsigned int         depth;
+} _vfy_ctx_t;
+
+// -----[ _vfy_add_bound ]-------------------------------------------
+static inline void _vfy_add_bound(_vfy_ctx_t * ctx, uint64_t bound)
+{
+  if (ctx->num_bounds >= ctx->max_bounds) {
+    ctx->max_bounds= (ctx->max_bounds == 0) ? 256 : 2*ctx->max_bounds;
+    ctx->bounds= (uint64_t *) REALLOC(ctx->bounds,
+				      sizeof(uint64_t)*ctx->max_bounds);
+  }
+  ctx->bounds[ctx->num_bounds++]= bound;
+}
+
+// -----[ _vfy_add_prefix ]------------------------------------------
+static int _vfy_add_prefix(uint32_t key, uint8_t key_len,
+			   void * item, void * ctx)
+{
+  uint64_t size= ((uint64_t) 1) << (32-key_len);
+  uint64_t start= key & ~(size-1);
+
+  _vfy_add_bound((_vfy_ctx_t *) ctx, start);
+  _vfy_add_bound((_vfy_ctx_t *) ctx, start+size);
+  return 0;
+}
+
+// -----[ _vfy_bound_cmp ]-------------------------------------------
+static int _vfy_bound_cmp(const void * item1, const void * item2)
+{
+  uint64_t bound1= *((const uint64_t *) item1);
+  uint64_t bound2= *((const uint64_t *) item2);
+  if (bound1 != bound2)
+    return (bound1 < bound2) ? -1 : 1;
+  return 0;
+}
+
+// -----[ _vfy_ref_cmp ]---------------------------------------------
+static int _vfy_ref_cmp(const void * item1, const void * item2)
+{
+  const _vfy_ref_t * ref1= (const _vfy_ref_t *) item1;
+  const _vfy_ref_t * ref2= (const _vfy_ref_t *) item2;
+  if (ref1->node != ref2->node)
+    return (ref1->node < ref2->node) ? -1 : 1;
+  return 0;
+}
+
+// -----[ _vfy_index ]-----------------------------------------------
+static inline int _vfy_index(_vfy_ctx_t * ctx, net_node_t * node)
+{
+  _vfy_ref_t key= { .node= node };
+  _vfy_ref_t * ref= (_vfy_ref_t *) bsearch(&key, ctx->refs, ctx->num_nodes,
+					   sizeof(_vfy_ref_t), _vfy_ref_cmp);
+  if (ref == NULL)
+    return -1;
+  return ref->index;
+}
+
+// -----[ _vfy_init ]------------------------------------------------
+/**
+ * Index the nodes and their addresses, then compute the boundaries
+ * of the equivalence classes.
+ */
+static void _vfy_init(_vfy_ctx_t * ctx, network_t * network)
+{
+  gds_enum_t * nodes;
+  net_node_t * node;
+  net_iface_t * iface;
+  unsigned int index, index2;
+
+  ctx->num_nodes= 0;
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    enum_get_next(nodes);
+    ctx->num_nodes++;
+  }
+  enum_destroy(&nodes);
+
+  ctx->nodes= (net_node_t **) MALLOC(sizeof(net_node_t *)*
+				     (ctx->num_nodes+1));
+  ctx->refs= (_vfy_ref_t *) MALLOC(sizeof(_vfy_ref_t)*(ctx->num_nodes+1));
+  ctx->color= (uint8_t *) MALLOC(sizeof(uint8_t)*(ctx->num_nodes+1));
+  ctx->outcome= (uint8_t *) MALLOC(sizeof(uint8_t)*(ctx->num_nodes+1));
+  ctx->stack= (unsigned int *) MALLOC(sizeof(unsigned int)*
+				      (ctx->num_nodes+1));
+  ctx->bounds= NULL;
+  ctx->num_bounds= 0;
+  ctx->max_bounds= 0;
+  _vfy_add_bound(ctx, 0);
+
+  index= 0;
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    ctx->nodes[index]= node;
+    ctx->refs[index].node= node;
+    ctx->refs[index].index= index;
+    index++;
+
+    if (node->rt != NULL)
+      trie_for_each(node->rt->trie, _vfy_add_prefix, ctx);
+
+    // Node addresses are classes of their own (local delivery)
+    for (index2= 0; index2 < net_ifaces_size(node->ifaces); index2++) {
+      iface= net_ifaces_at(node->ifaces, index2);
+      if (iface->type == NET_IFACE_RTR)
+	continue;
+      _vfy_add_prefix(iface->addr, 32, NULL, ctx);
+    }
+  }
+  enum_destroy(&nodes);
+  qsort(ctx->refs, ctx->num_nodes, sizeof(_vfy_ref_t), _vfy_ref_cmp);
+
+  // Sort and remove duplicate boundaries
+  qsort(ctx->bounds, ctx->num_bounds, sizeof(uint64_t), _vfy_bound_cmp);
+  index2= 0;
+  for (index= 0; index < ctx->num_bounds; index++) {
+    if ((index2 > 0) && (ctx->bounds[index2-1] == ctx->bounds[index]))
+      continue;
+    ctx->bounds[index2++]= ctx->bounds[index];
+  }
+  ctx->num_bounds= index2;
+}
+
+// -----[ _vfy_destroy ]---------------------------------------------
+static void _vfy_destroy(_vfy_ctx_t * ctx)
+{
+  FREE(ctx->nodes);
+  FREE(ctx->refs);
+  FREE(ctx->color);
+  FREE(ctx->outcome);
+  FREE(ctx->stack);
+  FREE(ctx->bounds);
+}
+
+// -----[ _vfy_set_class ]-------------------------------------------
+/**
+ * Select the class [first, last] and split it into the minimal set
+ * of prefixes that cover it.
+ */
+static void _vfy_set_class(_vfy_ctx_t * ctx, uint64_t first, uint64_t last)
+{
+  uint8_t mask;
+
+  ctx->addr= (net_addr_t) first;
+  ctx->num_pfxs= 0;
+  while (first <= last) {
+    mask= 32;
+    while ((mask > 0) &&
+	   ((first & ((((uint64_t) 1) << (33-mask))-1)) == 0) &&
+	   (first + (((uint64_t) 1) << (33-mask)) - 1 <= last))
+      mask--;
+    ctx->pfxs[ctx->num_pfxs].network= (net_addr_t) first;
+    ctx->pfxs[ctx->num_pfxs].mask= mask;
+    ctx->num_pfxs++;
+    first+= ((uint64_t) 1) << (32-mask);
+  }
+  memset(ctx->color, _VFY_WHITE, sizeof(uint8_t)*ctx->num_nodes);
+  memset(ctx->outcome, 0, sizeof(uint8_t)*ctx->num_nodes);
+  ctx->depth= 0;
+}
+
+// -----[ _vfy_report ]----------------------------------------------
+/**
+ * Report a problem for each prefix of the current class. The nodes
+ * are either the given node or, for a loop, the nodes on the stack
+ * starting at the given index.
+ */
+static void _vfy_report(_vfy_ctx_t * ctx, const char * type,
+			net_node_t * node, int stack_index,
+			const char * reason)
+{
+  unsigned int index, index2;
+
+  for (index= 0; index < ctx->num_pfxs; index++) {
+    ip_prefix_dump(ctx->stream, ctx->pfxs[index]);
+    stream_printf(ctx->stream, "\t%s\t", type);
+    if (stack_index >= 0) {
+      for (index2= stack_index; index2 < ctx->depth; index2++) {
+	if (index2 > stack_index)
+	  stream_printf(ctx->stream, " ");
+	node_dump_id(ctx->stream, ctx->nodes[ctx->stack[index2]]);
+      }
+    } else
+      node_dump_id(ctx->stream, node);
+    if (reason != NULL)
+      stream_printf(ctx->stream, "\t%s", reason);
+    stream_printf(ctx->stream, "\n");
+  }
+}
+
+// -----[ _vfy_find_owner ]------------------------------------------
+static net_node_t * _vfy_find_owner(network_t * network, net_addr_t addr)
+{
+  gds_enum_t * nodes;
+  net_node_t * node= network_find_node(network, addr);
+
+  if (node != NULL)
+    return node;
+  nodes= trie_get_enum(network->nodes);
+  while (enum_has_next(nodes)) {
+    node= *((net_node_t **) enum_get_next(nodes));
+    if (node_has_address(node, addr) != NULL)
+      break;
+    node= NULL;
+  }
+  enum_destroy(&nodes);
+  return node;
+}
+
+// -----[ net_verify_next_hop ]--------------------------------------
+/**
+ * Follow the same rules as the forwarding (see _node_ip_output()
+ * and the interface send functions).
+ */
+net_node_t * net_verify_next_hop(network_t * network, net_node_t * node,
+				 const rt_entry_t * rtentry,
+				 net_addr_t addr, net_iface_t ** oif_ref,
+				 const char ** reason)
+{
+  rt_info_t * rtinfo;
+  net_iface_t * oif, * dst_iface;
+  net_addr_t l2_addr;
+  net_node_t * next;
+
+  // Recursive lookup (BGP next-hop)
+  if (rtentry->oif == NULL) {
+    rtinfo= rt_find_best(node->rt, rtentry->gateway, NET_ROUTE_ANY);
+    if ((rtinfo == NULL) ||
+	(rt_entries_get_at(rtinfo->entries, 0) == rtentry) ||
+	(rt_entries_get_at(rtinfo->entries, 0)->oif == NULL)) {
+      *reason= "unresolved-next-hop";
+      return NULL;
+    }
+    rtentry= rt_entries_get_at(rtinfo->entries, 0);
+  }
+
+  oif= rtentry->oif;
+  if (oif_ref != NULL)
+    *oif_ref= oif;
+  if (!net_iface_is_connected(oif) || !net_iface_is_enabled(oif)) {
+    *reason= "link-down";
+    return NULL;
+  }
+
+  switch (oif->type) {
+  case NET_IFACE_RTR:
+  case NET_IFACE_PTP:
+    return oif->dest.iface->owner;
+
+  case NET_IFACE_PTMP:
+    l2_addr= rtentry->gateway;
+    if (l2_addr == NET_ADDR_ANY)
+      l2_addr= addr;
+    dst_iface= net_subnet_find_link(oif->dest.subnet, l2_addr);
+    if (dst_iface == NULL) {
+      *reason= "host-unreachable";
+      return NULL;
+    }
+    if (!net_iface_is_enabled(dst_iface)) {
+      *reason= "link-down";
+      return NULL;
+    }
+    return dst_iface->owner;
+
+  case NET_IFACE_VIRTUAL:
+    next= _vfy_find_owner(network, oif->dest.end_point);
+    if (next == NULL) {
+      *reason= "tunnel-unreachable";
+      return NULL;
+    }
+    return next;
+
+  default:
+    *reason= "invalid-iface";
+    return NULL;
+  }
+}
+
+// -----[ _vfy_visit ]-----------------------------------------------
+/**
+ * Explore the forwarding graph of the current class from a node
+ * (depth-first). Returns the set of outcomes of the forwarding from
+ * this node.
+ */
+static uint8_t _vfy_visit(_vfy_ctx_t * ctx, unsigned int index)
+{
+  net_node_t * node= ctx->nodes[index];
+  rt_info_t * rtinfo= NULL;
+  const char * reason= NULL;
+  const char * drop_reason= NULL;
+  net_node_t * next;
+  unsigned int index2, stack_index;
+  uint8_t outcome= 0, branch, first_branch= 0;
+  int next_index, inconsistent= 0;
+
+  if (ctx->color[index] == _VFY_BLACK)
+    return ctx->outcome[index];
+
+  // Node already on the stack: forwarding loop
+  if (ctx->color[index] == _VFY_GRAY) {
+    for (stack_index= 0; ctx->stack[stack_index] != index; stack_index++);
+    _vfy_report(ctx, "LOOP", NULL, stack_index, NULL);
+    ctx->stats->loops++;
+    return _VFY_LOOP;
+  }
+
+  ctx->color[index]= _VFY_GRAY;
+  ctx->stack[ctx->depth++]= index;
+
+  if (node_has_address(node, ctx->addr) != NULL) {
+    outcome= _VFY_DELIVER;
+  } else {
+    if (node->rt != NULL)
+      rtinfo= rt_find_best(node->rt, ctx->addr, NET_ROUTE_ANY);
+    if (rtinfo == NULL) {
+      outcome= _VFY_DROP;
+      drop_reason= "no-route";
+    } else {
+      for (index2= 0; index2 < rt_entries_size(rtinfo->entries); index2++) {
+	next= net_verify_next_hop(ctx->network, node,
+				  rt_entries_get_at(rtinfo->entries, index2),
+				  ctx->addr, NULL, &reason);
+	next_index= (next != NULL) ? _vfy_index(ctx, next) : -1;
+	if (next_index < 0) {
+	  branch= _VFY_DROP;
+	  if (drop_reason == NULL)
+	    drop_reason= (reason != NULL) ? reason : "unknown-node";
+	} else
+	  branch= _vfy_visit(ctx, next_index);
+	if (index2 == 0)
+	  first_branch= branch;
+	else if (branch != first_branch)
+	  inconsistent= 1;
+	outcome|= branch;
+      }
+    }
+  }
+
+  if (drop_reason != NULL) {
+    _vfy_report(ctx, "BLACKHOLE", node, -1, drop_reason);
+    ctx->stats->blackholes++;
+  }
+  if (inconsistent) {
+    _vfy_report(ctx, "ECMP", node, -1, NULL);
+    ctx->stats->ecmp++;
+  }
+
+  ctx->depth--;
+  ctx->color[index]= _VFY_BLACK;
+  ctx->outcome[index]= outcome;
+  return outcome;
+}
+
+// -----[ network_verify ]-------------------------------------------
+/**
+ * The exploration of a class only starts from the nodes that have a
+ * route towards the class (or own its address). A node without
+ * route is only reported if some traffic is forwarded to it.
+ */
+unsigned int network_verify(gds_stream_t * stream, network_t * network,
+			    net_verify_stats_t * stats)
+{
+  _vfy_ctx_t ctx;
+  net_verify_stats_t local_stats;
+  net_node_t * node;
+  unsigned int index, index2;
+  uint64_t last;
+
+  if (stats == NULL)
+    stats= &local_stats;
+  memset(stats, 0, sizeof(net_verify_stats_t));
+  ctx.stream= stream;
+  ctx.network= network;
+  ctx.stats= stats;
+  _vfy_init(&ctx, network);
+
+  for (index= 0; index < ctx.num_bounds; index++) {
+    if (ctx.bounds[index] > 0xFFFFFFFFu)
+      break;
+    last= (index+1 < ctx.num_bounds) ?
+      ctx.bounds[index+1]-1 : 0xFFFFFFFFu;
+    if (last > 0xFFFFFFFFu)
+      last= 0xFFFFFFFFu;
+    _vfy_set_class(&ctx, ctx.bounds[index], last);
+    stats->classes++;
+
+    for (index2= 0; index2 < ctx.num_nodes; index2++) {
+      if (ctx.color[index2] != _VFY_WHITE)
+	continue;
+      node= ctx.nodes[index2];
+      if ((node_has_address(node, ctx.addr) == NULL) &&
+	  ((node->rt == NULL) ||
+	   (rt_find_best(node->rt, ctx.addr, NET_ROUTE_ANY) == NULL)))
+	continue;
+      _vfy_visit(&ctx, index2);
+    }
+  }
+
+  _vfy_destroy(&ctx);
+  stream_flush(stream);
+  return stats->loops + stats->blackholes + stats->ecmp;
+}
+
+// -----[ net_verify_stats_dump ]------------------------------------
+void net_verify_stats_dump(gds_stream_t * stream,
+			   net_verify_stats_t * stats)
+{
+  stream_printf(stream, "classes   : %u\n", stats->classes);
+  stream_printf(stream, "loops     : %u\n", stats->loops);
+  stream_printf(stream, "blackholes: %u\n", stats->blackholes);
+  stream_printf(stream, "ecmp      : %u\n", stats->ecmp);
+}
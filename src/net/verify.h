@@ -0,0 +1,119 @@
+// ==================================================================
+// @(#)verify.h
+//
+// Data-plane verification (forwarding loops and black holes).
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+/**
+ * \file
+ * Provide a network-wide verification of the forwarding state.
+ *
+ * The address space is partitioned into equivalence classes: the
+ * boundaries of the classes are the prefixes found in the routing
+ * tables of all the nodes and the addresses of the nodes. All the
+ * addresses of a class are forwarded in the same way by every node.
+ * For each class, the forwarding graph (one edge per routing entry,
+ * i.e. all ECMP branches) is explored once from each node that has a
+ * route, and the following problems are reported:
+ * \li forwarding loops,
+ * \li black holes (no route, link down, unresolved next-hop),
+ * \li ECMP inconsistencies (branches of a node with different
+ *   outcomes).
+ *
+ * Each problem is reported for the minimal set of prefixes that
+ * cover the class, one per line:
+ *
+ *   <prefix> LOOP <node> ... <node>
+ *   <prefix> BLACKHOLE <node> <reason>
+ *   <prefix> ECMP <node>
+ *
+ * Tunnels are followed up to their endpoint; the reachability of the
+ * endpoint itself is verified within the endpoint's class.
+ */
+
+#ifndef __NET_VERIFY_H__
+#define __NET_VERIFY_H__
+
+#include <libgds/stream.h>
+
+#include <net/net_types.h>
+#include <net/routing.h>
+
+// -----[ net_verify_stats_t ]---------------------------------------
+typedef struct {
+  /** Number of equivalence classes. */
+  unsigned int classes;
+  /** Number of forwarding loops. */
+  unsigned int loops;
+  /** Number of black holes. */
+  unsigned int blackholes;
+  /** Number of ECMP inconsistencies. */
+  unsigned int ecmp;
+} net_verify_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ network_verify ]-----------------------------------------
+  /**
+   * Verify the forwarding state of all the nodes.
+   *
+   * \param stream  is the output stream for the problems found.
+   * \param network is the network.
+   * \param stats   is updated with the number of classes and
+   *   problems (can be NULL).
+   * \retval the number of problems found.
+   */
+  unsigned int network_verify(gds_stream_t * stream, network_t * network,
+			      net_verify_stats_t * stats);
+
+  // -----[ net_verify_next_hop ]-----------------------------------
+  /**
+   * Find the node reached when a packet towards an address is
+   * forwarded through a routing entry.
+   *
+   * \param network is the network.
+   * \param node    is the forwarding node.
+   * \param rtentry is the routing entry.
+   * \param addr    is the destination address.
+   * \param oif_ref is set to the outgoing interface (can be NULL).
+   * \param reason  is set to the reason of the drop (if any).
+   * \retval the next node, or NULL if the packet is dropped.
+   */
+  net_node_t * net_verify_next_hop(network_t * network, net_node_t * node,
+				   const rt_entry_t * rtentry,
+				   net_addr_t addr, net_iface_t ** oif_ref,
+				   const char ** reason);
+
+  // -----[ net_verify_stats_dump ]----------------------------------
+  void net_verify_stats_dump(gds_stream_t * stream,
+			     net_verify_stats_t * stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __NET_VERIFY_H__ */
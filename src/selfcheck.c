@@ -48,6 +48,8 @@
 #include <libgds/utest.h>
 
 #include <api.h>
+#include <cli/common.h>
+#include <cli/script.h>
 #include <selfcheck.h>
 #include <bgp/as.h>
 #include <bgp/attr/comm.h>
@@ -59,6 +61,9 @@
 #include <bgp/filter/parser.h>
 #include <bgp/filter/predicate_parser.h>
 #include <bgp/mrtd.h>
+#ifdef HAVE_BGPDUMP
+# include <external/bgpdump_lib.h>
+#endif
 #include <bgp/peer.h>
 #include <bgp/route.h>
 #include <bgp/route-input.h>
@@ -73,7 +78,9 @@
 #include <net/ipip.h>
 #include <net/node.h>
 #include <net/prefix.h>
+#include <net/rt_lpm.h>
 #include <net/subnet.h>
+#include <util/mem_stats.h>
 
 static inline net_node_t * __node_create(net_addr_t addr) {
   net_node_t * node;
@@ -1276,6 +1283,40 @@ static int test_net_rt_entries()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_net_rt_groups ]---------------------------------------
+static int test_net_rt_groups()
+{
+  rt_info_t * rtinfo1, * rtinfo2, * rtinfo3;
+  unsigned int groups= rt_entries_groups();
+
+  rtinfo1= rt_info_create(IPV4PFX(192,168,1,0,24), 0, NET_ROUTE_BGP);
+  rt_info_add_entry(rtinfo1, NULL, IPV4(1,0,0,0));
+  rt_info_intern(rtinfo1);
+  rtinfo2= rt_info_create(IPV4PFX(192,168,2,0,24), 0, NET_ROUTE_BGP);
+  rt_info_add_entry(rtinfo2, NULL, IPV4(1,0,0,0));
+  rt_info_intern(rtinfo2);
+  rtinfo3= rt_info_create(IPV4PFX(192,168,3,0,24), 0, NET_ROUTE_BGP);
+  rt_info_add_entry(rtinfo3, NULL, IPV4(2,0,0,0));
+  rt_info_intern(rtinfo3);
+  UTEST_ASSERT(rtinfo1->entries == rtinfo2->entries,
+		"routes with same next-hops should share their entries");
+  UTEST_ASSERT(rtinfo1->entries != rtinfo3->entries,
+		"routes with different next-hops should not share entries");
+  UTEST_ASSERT(rt_entries_groups() == groups+2,
+		"2 next-hop groups should exist");
+  rt_info_add_entry(rtinfo2, NULL, IPV4(2,0,0,0));
+  UTEST_ASSERT((rtinfo1->entries != rtinfo2->entries) &&
+		(rt_entries_size(rtinfo1->entries) == 1) &&
+		(rt_entries_size(rtinfo2->entries) == 2),
+		"modified route should not affect shared entries");
+  rt_info_destroy(&rtinfo1);
+  rt_info_destroy(&rtinfo2);
+  rt_info_destroy(&rtinfo3);
+  UTEST_ASSERT(rt_entries_groups() == groups,
+		"next-hop groups should be released with their routes");
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_net_rt ]----------------------------------------------
 static int test_net_rt()
 {
@@ -1364,6 +1405,55 @@ static int test_net_rt_lookup()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_net_rt_lookup_lpm ]-----------------------------------
+static int test_net_rt_lookup_lpm()
+{
+  net_rt_t * rt= rt_create();
+  net_iface_t * iface;
+  ip_pfx_t pfx[4]= { IPV4PFX(0,0,0,0,0),
+		     IPV4PFX(192,168,2,0,24),
+		     IPV4PFX(192,168,2,128,25),
+		     IPV4PFX(255,255,255,255,32) };
+  rt_info_t * rtinfo[4];
+  int index;
+
+  net_iface_factory(NULL, IPV4PFX(10,0,0,1,30), NET_IFACE_PTP, &iface);
+
+  for (index= 0; index < 4; index++) {
+    rtinfo[index]= rt_info_create(pfx[index], 0, NET_ROUTE_STATIC);
+    rt_info_add_entry(rtinfo[index], iface, NET_ADDR_ANY);
+    UTEST_ASSERT(rt_add_route(rt, pfx[index], rtinfo[index]) == ESUCCESS,
+		  "route addition should succeed");
+  }
+
+  // Enough lookups without change to compile the snapshot
+  for (index= 0; index < 2*RT_LPM_MIN_LOOKUPS; index++)
+    rt_find_best(rt, IPV4(192,168,2,1), NET_ROUTE_ANY);
+  UTEST_ASSERT((rt->lpm != NULL) && (rt->lpm->generation == rt->generation),
+		"compiled snapshot should be up-to-date");
+  UTEST_ASSERT(rt_find_best(rt, IPV4(192,168,1,1), NET_ROUTE_ANY)
+		== rtinfo[0], "should return default route for 192.168.1.1");
+  UTEST_ASSERT(rt_find_best(rt, IPV4(192,168,2,127), NET_ROUTE_ANY)
+		== rtinfo[1], "should return a result for 192.168.2.127");
+  UTEST_ASSERT(rt_find_best(rt, IPV4(192,168,2,255), NET_ROUTE_ANY)
+		== rtinfo[2], "should return a result for 192.168.2.255");
+  UTEST_ASSERT(rt_find_best(rt, IPV4(192,168,3,0), NET_ROUTE_ANY)
+		== rtinfo[0], "should return default route for 192.168.3.0");
+  UTEST_ASSERT(rt_find_best(rt, IPV4(255,255,255,255), NET_ROUTE_ANY)
+		== rtinfo[3], "should return a result for 255.255.255.255");
+
+  // A change must make the snapshot outdated
+  UTEST_ASSERT(rt_del_route(rt, &pfx[2], NULL, NULL, NET_ROUTE_STATIC)
+		== ESUCCESS, "route removal should succeed");
+  UTEST_ASSERT(rt->lpm->generation != rt->generation,
+		"compiled snapshot should be outdated");
+  UTEST_ASSERT(rt_find_best(rt, IPV4(192,168,2,255), NET_ROUTE_ANY)
+		== rtinfo[1], "should return a result for 192.168.2.255");
+  rt_destroy(&rt);
+  net_iface_destroy(&iface);
+  return UTEST_SUCCESS;
+}
+
 
 // -----[ test_net_rt_del ]------------------------------------------
 static int test_net_rt_del()
@@ -2178,6 +2268,71 @@ static int test_net_igp_compute_ecmp_complex()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_net_igp_compute_multi ]-------------------------------
+static int test_net_igp_compute_multi()
+{
+  ez_topo_t * eztopo= _ez_topo_triangle_rtr();
+  igp_domain_t * domain= network_find_igp_domain(eztopo->network, 1);
+  net_node_t * node= ez_topo_get_node(eztopo, 0);
+  spt_t * spts[3];
+  spt_t * spt;
+  spt_vertex_t * vertex;
+  rt_info_t * rtinfo;
+  unsigned int index;
+
+  // TOS 1: link 0.0.0.1-0.0.0.3 has weight 10, the other links keep
+  // their TOS 0 weight
+  for (index= 0; index < 3; index++)
+    UTEST_ASSERT(net_iface_set_depth(ez_topo_get_link(eztopo, index),
+				     2, BIDIR) == ESUCCESS,
+		  "should be able to set link depth");
+  UTEST_ASSERT(net_iface_set_metric(ez_topo_get_link(eztopo, 1), 1, 10,
+				    BIDIR) == ESUCCESS,
+		"should be able to set TOS 1 metric");
+  UTEST_ASSERT(net_iface_set_metric(ez_topo_get_link(eztopo, 1), 2, 10,
+				    BIDIR) == ENET_LINK_INVALID_TOS,
+		"should not be able to set metric beyond link depth");
+
+  UTEST_ASSERT(spt_bfs_multi(node, domain, 3, spts) == ESUCCESS,
+		"multi-topology SPT computation should succeed");
+  UTEST_ASSERT(spt_bfs(node, domain, &spt) == ESUCCESS,
+		"SPT computation should succeed");
+  for (index= 1; index <= 3; index++) {
+    vertex= spt_get_vertex(spts[0], IPV4PFX(0,0,0,index,32));
+    UTEST_ASSERT((vertex != NULL) &&
+		  (vertex->weight ==
+		   spt_get_vertex(spt, IPV4PFX(0,0,0,index,32))->weight),
+		  "TOS 0 plane should be equal to single-topology SPT");
+  }
+  vertex= spt_get_vertex(spts[1], IPV4PFX(0,0,0,2,32));
+  UTEST_ASSERT((vertex != NULL) && (vertex->weight == 10),
+		"Cost should be 10 for 0.0.0.2/32 in TOS 1");
+  vertex= spt_get_vertex(spts[1], IPV4PFX(0,0,0,3,32));
+  UTEST_ASSERT((vertex != NULL) && (vertex->weight == 10) &&
+		(spt_vertices_size(vertex->preds) == 1),
+		"Cost should be 10 for 0.0.0.3/32 in TOS 1 (direct link)");
+  UTEST_ASSERT(spt_get_vertex(spts[2], IPV4PFX(0,0,0,2,32)) == NULL,
+		"0.0.0.2/32 should not be reachable in TOS 2 (no weight)");
+  spt_destroy(&spt);
+  for (index= 0; index < 3; index++)
+    spt_destroy(&spts[index]);
+
+  UTEST_ASSERT(igp_compute_domain_multi(domain, 0) == ESUCCESS,
+		"multi-topology computation should succeed");
+  UTEST_ASSERT((node->igp_planes != NULL) &&
+		(node->igp_planes->depth == 2),
+		"2 planes should have been computed");
+  rtinfo= rt_find_exact(node->rt, IPV4PFX(0,0,0,3,32), NET_ROUTE_IGP);
+  UTEST_ASSERT((rtinfo != NULL) && (rtinfo->metric == 1),
+		"TOS 0 route towards 0.0.0.3/32 should have metric 1");
+  rtinfo= rt_find_exact(node->igp_planes->rts[1], IPV4PFX(0,0,0,3,32),
+			NET_ROUTE_IGP);
+  UTEST_ASSERT((rtinfo != NULL) && (rtinfo->metric == 10),
+		"TOS 1 route towards 0.0.0.3/32 should have metric 10");
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_net_igp_ecmp3 ]---------------------------------------
 static int test_net_igp_ecmp3()
 {
@@ -2346,6 +2501,66 @@ static int test_net_traces_recordroute_unreach()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_net_traces_recordroute_ttl ]--------------------------
+static int test_net_traces_recordroute_ttl()
+{
+  ez_topo_t * eztopo= _ez_topo_triangle_rtr();
+  ip_trace_t * trace= NULL;
+  array_t * traces;
+
+  ez_topo_igp_compute(eztopo, 1);
+  traces= icmp_trace_send(ez_topo_get_node(eztopo, 0),
+			   ez_topo_get_node(eztopo, 1)->rid,
+			   1, NULL);
+  UTEST_ASSERT(traces != NULL, "traces should not be NULL");
+  UTEST_ASSERT(_array_length(traces) == 1,
+	       "there should be a unique trace");
+  _array_get_at(traces, 0, &trace);
+  UTEST_ASSERT(trace->status == ENET_TIME_EXCEEDED,
+	       "trace's status should be time-exceeded (%s)",
+	       network_strerror(trace->status));
+  UTEST_ASSERT(ip_trace_length(trace) == 2,
+	       "record-route trace's length should be 2 (%d)",
+	       ip_trace_length(trace));
+  _array_destroy(&traces);
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_net_traces_recordroute_loop ]-------------------------
+static int test_net_traces_recordroute_loop()
+{
+  ez_topo_t * eztopo= _ez_topo_line_rtr();
+  net_node_t * node0= ez_topo_get_node(eztopo, 0);
+  net_node_t * node1= ez_topo_get_node(eztopo, 1);
+  ip_trace_t * trace= NULL;
+  ip_opt_t * opts;
+  array_t * traces;
+
+  node_rt_add_route(node0, IPV4PFX(10,0,0,0,8), net_iface_id_addr(node1->rid),
+		    NET_ADDR_ANY, 0, NET_ROUTE_STATIC);
+  node_rt_add_route(node1, IPV4PFX(10,0,0,0,8), net_iface_id_addr(node0->rid),
+		    NET_ADDR_ANY, 0, NET_ROUTE_STATIC);
+  opts= ip_options_create();
+  ip_options_set(opts, IP_OPT_QUICK_LOOP);
+  traces= icmp_trace_send(node0, IPV4(10,0,0,1), 255, opts);
+  UTEST_ASSERT(traces != NULL, "traces should not be NULL");
+  UTEST_ASSERT(_array_length(traces) == 1,
+	       "there should be a unique trace");
+  _array_get_at(traces, 0, &trace);
+  UTEST_ASSERT(trace->status == ENET_FWD_LOOP,
+	       "trace's status should be loop (%s)",
+	       network_strerror(trace->status));
+  // (0.0.0.1 0.0.0.2 0.0.0.1)
+  UTEST_ASSERT(ip_trace_length(trace) == 3,
+	       "record-route trace's length should be 3 (%d)",
+	       ip_trace_length(trace));
+  ip_options_destroy(&opts);
+  _array_destroy(&traces);
+  ez_topo_destroy(&eztopo);
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_net_traces_recordroute_broken ]-----------------------
 static int test_net_traces_recordroute_broken()
 {
@@ -2942,6 +3157,26 @@ static int test_bgp_attr_aspath_str2()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_bgp_attr_aspath_2array ]------------------------------
+static int test_bgp_attr_aspath_2array()
+{
+  bgp_path_t * path;
+  uint32_t asns[3]= { 0, 0, 0 };
+  path= path_from_string("12 34 56");
+  UTEST_ASSERT(path_to_array(path, asns, 2) == 3,
+		"path_to_array() should return 3");
+  UTEST_ASSERT((asns[0] == 12) && (asns[1] == 34) && (asns[2] == 0),
+		"path_to_array() should not write outside of the array");
+  UTEST_ASSERT(path_to_array(path, asns, 3) == 3,
+		"path_to_array() should return 3");
+  UTEST_ASSERT((asns[0] == 12) && (asns[1] == 34) && (asns[2] == 56),
+		"incorrect array content");
+  path_destroy(&path);
+  UTEST_ASSERT(path_to_array(NULL, asns, 3) == 0,
+		"path_to_array() should return 0 for a null path");
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_bgp_attr_aspath_set_str2 ]----------------------------
 static int test_bgp_attr_aspath_set_str2()
 {
@@ -3104,6 +3339,41 @@ static int test_bgp_attr_communities_remove()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_bgp_attr_communities_mem ]---------------------------
+static int test_bgp_attr_communities_mem()
+{
+  const mem_stats_t * stats= mem_stats_get(MEM_TAG_COMMS);
+  size_t bytes= stats->bytes;
+  unsigned long objects= stats->objects;
+  bgp_comms_t * comms, * comms2;
+
+  mem_stats_reset_peak();
+  comms= comms_create();
+  UTEST_ASSERT((stats->objects == objects+1) &&
+		(stats->bytes == bytes+sizeof(bgp_comms_t)),
+		"creation should be accounted");
+  comms_add(&comms, 1);
+  comms_add(&comms, 2);
+  UTEST_ASSERT(stats->bytes == bytes+sizeof(bgp_comms_t)+
+		2*sizeof(bgp_comm_t),
+		"resize should be accounted");
+  comms2= comms_dup(comms);
+  UTEST_ASSERT(stats->objects == objects+2,
+		"duplication should be accounted");
+  comms_destroy(&comms2);
+  comms_remove(&comms, 1);
+  comms_remove(&comms, 2);
+  UTEST_ASSERT(comms == NULL,
+		"Communities should be destroyed when empty");
+  UTEST_ASSERT((stats->objects == objects) && (stats->bytes == bytes),
+		"destruction should be accounted");
+  UTEST_ASSERT((stats->peak_objects == objects+2) &&
+		(stats->peak_bytes == bytes+2*(sizeof(bgp_comms_t)+
+						2*sizeof(bgp_comm_t))),
+		"peak should be maintained");
+  return UTEST_SUCCESS;
+}
+
 // -----[ test_bgp_attr_communities_2str ]---------------------------
 static int test_bgp_attr_communities_2str()
 {
@@ -3589,6 +3859,65 @@ int test_bgp_filter_action_expression_str2()
 }
 
 
+/////////////////////////////////////////////////////////////////////
+//
+// BGP FILTERS
+//
+/////////////////////////////////////////////////////////////////////
+
+// -----[ test_bgp_filter_share ]------------------------------------
+int test_bgp_filter_share()
+{
+  bgp_filter_t * filter= filter_create();
+  bgp_filter_t * filter2;
+  filter_add_rule(filter, NULL, filter_action_pref_set(100));
+  filter2= filter_add_ref(filter);
+  UTEST_ASSERT((filter2 == filter) && (filter->ref_cnt == 2),
+		"Shared filter should have 2 references");
+  filter_unshare(&filter2);
+  UTEST_ASSERT((filter2 != filter) && (filter->ref_cnt == 1) &&
+		(filter2->ref_cnt == 1),
+		"Unshared filter should be a private copy");
+  UTEST_ASSERT(filter_equals(filter, filter2),
+		"Private copy should be equal to the original filter");
+  filter_add_rule(filter2, NULL, FTA_DENY);
+  UTEST_ASSERT(!filter_equals(filter, filter2),
+		"Modified copy should differ from the original filter");
+  filter_destroy(&filter2);
+  filter_destroy(&filter);
+  UTEST_ASSERT(filter == NULL,
+		"Filter should be NULL when destroyed");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_bgp_filter_intern ]-----------------------------------
+int test_bgp_filter_intern()
+{
+  bgp_filter_t * filter1= filter_create();
+  bgp_filter_t * filter2= filter_create();
+  bgp_filter_t * filter3= filter_create();
+  filter_add_rule(filter1, filter_match_comm_contains(1),
+		  filter_action_pref_set(60));
+  filter_add_rule(filter2, filter_match_comm_contains(1),
+		  filter_action_pref_set(60));
+  filter_add_rule(filter3, filter_match_comm_contains(1),
+		  filter_action_pref_set(80));
+  filter1= filter_intern(filter1);
+  filter2= filter_intern(filter2);
+  filter3= filter_intern(filter3);
+  UTEST_ASSERT((filter1 == filter2) && (filter1->ref_cnt == 2),
+		"Equal filters should be interned as the same instance");
+  UTEST_ASSERT(filter1 != filter3,
+		"Different filters should not be merged");
+  filter_unshare(&filter2);
+  UTEST_ASSERT((filter2 != filter1) && !filter2->interned,
+		"Unshared filter should not be interned");
+  filter_destroy(&filter1);
+  filter_destroy(&filter2);
+  filter_destroy(&filter3);
+  return UTEST_SUCCESS;
+}
+
 /////////////////////////////////////////////////////////////////////
 //
 // BGP FILTER PREDICATES
@@ -4303,6 +4632,47 @@ static int test_mrtd_parse_inv_nexthop()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_mrtd_binary_aspath ]----------------------------------
+/**
+ * Wire-format AS-Path "2 3 {4 5}" (AS_SEQUENCE followed by AS_SET,
+ * 2-bytes ASNs). The origin segment (AS_SET) must come first.
+ */
+static int test_mrtd_binary_aspath()
+{
+#ifdef HAVE_BGPDUMP
+  uint8_t data[]= { AS_SEQUENCE, 2, 0, 2, 0, 3,
+		    AS_SET, 2, 0, 4, 0, 5 };
+  struct aspath wire_path= {
+    .asn_len= ASN16_LEN,
+    .length= sizeof(data),
+    .count= 0,
+    .data= (caddr_t) data,
+    .str= NULL,
+  };
+  bgp_path_t * path, * ref_path;
+  char buf[32];
+
+  path= mrtd_process_aspath(&wire_path);
+  UTEST_ASSERT(path != NULL, "AS-Path should be converted");
+  UTEST_ASSERT(path_num_segments(path) == 2,
+		"AS-Path should have 2 segments");
+  UTEST_ASSERT(((bgp_path_seg_t *) path->data[0])->type ==
+		AS_PATH_SEGMENT_SET,
+		"origin segment (AS_SET) should come first");
+  ref_path= path_from_string("2 3 {4 5}");
+  UTEST_ASSERT(path_cmp(path, ref_path) == 0,
+		"AS-Path should be equal to \"2 3 {4 5}\"");
+  UTEST_ASSERT((path_to_string(path, 1, buf, sizeof(buf)) > 0) &&
+		!strcmp(buf, "2 3 {4 5}"),
+		"AS-Path should be written as \"2 3 {4 5}\"");
+  path_destroy(&ref_path);
+  path_destroy(&path);
+  return UTEST_SUCCESS;
+#else
+  return UTEST_SKIPPED;
+#endif
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -4334,6 +4704,213 @@ static int test_cli_error()
   return UTEST_SUCCESS;
 }
 
+// -----[ test_cli_ctx ]---------------------------------------------
+static int test_cli_ctx()
+{
+  network_t * network= network_get_default();
+  libcbgp_ctx_t * ctx1= libcbgp_ctx_create();
+  libcbgp_ctx_t * ctx2= libcbgp_ctx_create();
+
+  UTEST_ASSERT(network_get_default() == network,
+	       "current context should not change");
+  UTEST_ASSERT(libcbgp_ctx_exec_cmd(ctx1, "net add node 0.45.0.1")
+	       == ESUCCESS,
+	       "node creation should succeed in first context");
+  UTEST_ASSERT(libcbgp_ctx_exec_cmd(ctx2, "net add node 0.45.0.1")
+	       == ESUCCESS,
+	       "node creation should succeed in second context");
+  UTEST_ASSERT(libcbgp_ctx_exec_cmd(ctx1, "net add node 0.45.0.1")
+	       != ESUCCESS,
+	       "node creation should fail (duplicate node)");
+  UTEST_ASSERT(libcbgp_ctx_exec_cmd(ctx1, "bgp options local-pref 45")
+	       == ESUCCESS,
+	       "option change should succeed in first context");
+  UTEST_ASSERT(network_get_default() == network,
+	       "current context should be restored");
+  UTEST_ASSERT(bgp_options_get_local_pref() != 45,
+	       "option should not change in current context");
+  UTEST_ASSERT(network_find_node(network, IPV4(0,45,0,1)) == NULL,
+	       "node should not exist in current context");
+  UTEST_ASSERT(libcbgp_ctx_select(ctx1) == libcbgp_ctx_default(),
+	       "previous context should be the default context");
+  UTEST_ASSERT(network_find_node(network_get_default(),
+				 IPV4(0,45,0,1)) != NULL,
+	       "node should exist in selected context");
+  UTEST_ASSERT(bgp_options_get_local_pref() == 45,
+	       "option should be set in selected context");
+  libcbgp_ctx_destroy(&ctx1);
+  UTEST_ASSERT(network_get_default() == network,
+	       "default context should be selected");
+  libcbgp_ctx_destroy(&ctx2);
+  UTEST_ASSERT((ctx1 == NULL) && (ctx2 == NULL),
+	       "destroyed context should be NULL");
+  return UTEST_SUCCESS;
+}
+
+// -----[ test_cli_script ]------------------------------------------
+static int test_cli_script()
+{
+  libcbgp_ctx_t * ctx= libcbgp_ctx_create();
+  libcbgp_ctx_t * prev_ctx;
+  FILE * script= tmpfile();
+  FILE * compiled= tmpfile();
+  net_node_t * node;
+  net_iface_t * iface;
+  ip_pfx_t prefix= { .network= IPV4(0,48,0,2), .mask= 32 };
+  int result;
+
+  UTEST_ASSERT((script != NULL) && (compiled != NULL),
+	       "could not create temporary files");
+  fprintf(script,
+	  "# compiled script\n"
+	  "net add node 0.48.0.1\n"
+	  "net add node 0.48.0.2\n"
+	  "\n"
+	  "net add link 0.48.0.1 0.48.0.2 --delay=5\n"
+	  "net add domain 48 igp\n"
+	  "net node 0.48.0.1 domain 48\n"
+	  "net link 0.48.0.1 0.48.0.2 igp-weight --bidir 7\n");
+  rewind(script);
+  UTEST_ASSERT(cli_script_compile(script, compiled) == 0,
+	       "script compilation should succeed");
+  UTEST_ASSERT(!cli_script_is_compiled(script),
+	       "text script should not be detected as compiled");
+  rewind(compiled);
+  UTEST_ASSERT(cli_script_is_compiled(compiled),
+	       "compiled script should be detected");
+
+  prev_ctx= libcbgp_ctx_select(ctx);
+  result= cli_script_load(cli_get(), compiled);
+  node= network_find_node(network_get_default(), IPV4(0,48,0,1));
+  iface= (node != NULL)?node_find_iface(node, prefix):NULL;
+  libcbgp_ctx_select(prev_ctx);
+  fclose(script);
+  fclose(compiled);
+
+  UTEST_ASSERT(result == CLI_SUCCESS,
+	       "compiled script should load (%d)", result);
+  UTEST_ASSERT(iface != NULL, "link should exist");
+  UTEST_ASSERT(net_iface_get_delay(iface) == 5, "link delay should be 5");
+  UTEST_ASSERT(net_iface_get_metric(iface, 0) == 7,
+	       "link weight should be 7");
+  libcbgp_ctx_destroy(&ctx);
+  return UTEST_SUCCESS;
+}
+
+// -----[ _test_cli_batch_count ]------------------------------------
+static int _test_cli_batch_count(const libcbgp_route_t * route, void * ctx)
+{
+  (*((unsigned int *) ctx))++;
+  return 0;
+}
+
+// -----[ _test_cli_batch_count_bgp ]--------------------------------
+static int _test_cli_batch_count_bgp(const libcbgp_rt_entry_t * entry,
+				     void * ctx)
+{
+  if (entry->type == NET_ROUTE_BGP)
+    (*((unsigned int *) ctx))++;
+  return 0;
+}
+
+// -----[ test_cli_batch ]-------------------------------------------
+static int test_cli_batch()
+{
+  static char * script[]= {
+    "net add node 0.46.0.1",
+    "net add node 0.46.0.2",
+    "net add link 0.46.0.1 0.46.0.2",
+    "net node 0.46.0.1 route add --oif=0.46.0.2 0.46.0.2/32 1",
+    "bgp add router 1 0.46.0.1",
+    "bgp router 0.46.0.1 add peer 2 0.46.0.2",
+    "bgp router 0.46.0.1 peer 0.46.0.2 virtual",
+    "bgp router 0.46.0.1 peer 0.46.0.2 up",
+  };
+  const uint32_t path1[]= { 2, 3 };
+  const uint32_t path2[]= { 2 };
+  const uint32_t comms[]= { (2 << 16) + 1 };
+  const libcbgp_route_t routes[]= {
+    { .prefix= { IPV4(255,0,0,0), 8 }, .next_hop= IPV4(0,46,0,2),
+      .path= path1, .path_len= 2, .comms= comms, .num_comms= 1 },
+    { .prefix= { IPV4(254,0,0,0), 8 }, .next_hop= IPV4(0,46,0,2),
+      .path= path2, .path_len= 1 },
+    { .prefix= { IPV4(253,0,0,0), 8 }, .next_hop= IPV4(0,46,0,3),
+      .path= path2, .path_len= 1 },
+  };
+  const libcbgp_pfx_t prefixes[]= {
+    { IPV4(255,0,0,0), 8 },
+    { IPV4(253,0,0,0), 8 },
+    { IPV4(255,1,2,3), 32 },
+  };
+  libcbgp_route_t best[3];
+  uint32_t values[3];
+  libcbgp_ctx_t * ctx= libcbgp_ctx_create();
+  libcbgp_ctx_t * prev= libcbgp_ctx_select(ctx);
+  unsigned int index, count;
+
+  for (index= 0; index < sizeof(script)/sizeof(script[0]); index++)
+    UTEST_ASSERT(libcbgp_exec_cmd(script[index]) == ESUCCESS,
+		 "could not execute \"%s\"", script[index]);
+
+  UTEST_ASSERT(libcbgp_bgp_inject_routes(IPV4(0,46,0,9), routes, 3)
+	       == ENET_NODE_UNKNOWN,
+	       "injection should fail (unknown node)");
+  UTEST_ASSERT(libcbgp_bgp_inject_routes(IPV4(0,46,0,2), routes, 3)
+	       == ENET_PROTO_UNKNOWN,
+	       "injection should fail (BGP not supported)");
+  UTEST_ASSERT(libcbgp_bgp_inject_routes(IPV4(0,46,0,1), routes, 3) == 2,
+	       "2 routes should be injected (no peer for 0.46.0.3)");
+
+  UTEST_ASSERT(libcbgp_bgp_get_best_routes(IPV4(0,46,0,1), prefixes,
+					   3, best) == 2,
+	       "2 prefixes should have a best route");
+  UTEST_ASSERT((best[0].route != NULL) &&
+	       (best[0].peer == IPV4(0,46,0,2)) &&
+	       (best[0].path_len == 2) && (best[0].origin_as == 3) &&
+	       (best[0].num_comms == 1),
+	       "incorrect best route for 255/8");
+  UTEST_ASSERT((libcbgp_route_get_path(&best[0], values, 3) == 2) &&
+	       (values[0] == 2) && (values[1] == 3),
+	       "incorrect AS-path for 255/8");
+  UTEST_ASSERT(libcbgp_route_get_path(&best[0], values, 1) == 2,
+	       "truncated AS-path should report 2 AS numbers");
+  UTEST_ASSERT((libcbgp_route_get_comms(&best[0], values, 3) == 1) &&
+	       (values[0] == comms[0]),
+	       "incorrect communities for 255/8");
+  UTEST_ASSERT(best[1].route == NULL,
+	       "253/8 should not have a best route");
+  UTEST_ASSERT((libcbgp_route_get_path(&best[1], values, 3) == 0) &&
+	       (libcbgp_route_get_comms(&best[1], values, 3) == 0),
+	       "253/8 should have no attributes");
+  UTEST_ASSERT((best[2].route == best[0].route) &&
+	       (best[2].prefix.mask == 8),
+	       "255.1.2.3 should match 255/8");
+
+  count= 0;
+  UTEST_ASSERT(libcbgp_bgp_rib_for_each(IPV4(0,46,0,1),
+					_test_cli_batch_count,
+					&count) == 0,
+	       "Loc-RIB iteration should succeed");
+  UTEST_ASSERT(count == 2, "Loc-RIB should contain 2 routes");
+  count= 0;
+  UTEST_ASSERT(libcbgp_bgp_adj_rib_for_each(IPV4(0,46,0,1),
+					    IPV4(0,46,0,2), 1,
+					    _test_cli_batch_count,
+					    &count) == 0,
+	       "Adj-RIB-in iteration should succeed");
+  UTEST_ASSERT(count == 2, "Adj-RIB-in should contain 2 routes");
+  count= 0;
+  UTEST_ASSERT(libcbgp_node_rt_for_each(IPV4(0,46,0,1),
+					_test_cli_batch_count_bgp,
+					&count) == 0,
+	       "routing table iteration should succeed");
+  UTEST_ASSERT(count == 2, "routing table should contain 2 BGP routes");
+
+  libcbgp_ctx_select(prev);
+  libcbgp_ctx_destroy(&ctx);
+  return UTEST_SUCCESS;
+}
+
 
 /////////////////////////////////////////////////////////////////////
 //
@@ -4456,11 +5033,13 @@ unit_test_t TEST_NET_LINK[]= {
 
 unit_test_t TEST_NET_RT[]= {
   {test_net_rt_entries, "entries"},
+  {test_net_rt_groups, "next-hop groups"},
   {test_net_rt, "routing table"},
   {test_net_rt_add, "add"},
   {test_net_rt_add_dup, "add (dup)"},
   {test_net_rt_del, "del"},
   {test_net_rt_lookup, "lookup"},
+  {test_net_rt_lookup_lpm, "lookup (compiled)"},
 };
 #define TEST_NET_RT_SIZE ARRAY_SIZE(TEST_NET_RT)
 
@@ -4510,6 +5089,7 @@ unit_test_t TEST_NET_RT_IGP[]= {
   {test_net_igp_compute_loopback, "igp compute (loopback)"},
   {test_net_igp_compute_ecmp_square, "igp compute ecmp (square)"},
   {test_net_igp_compute_ecmp_complex, "igp compute ecmp (complex)"},
+  {test_net_igp_compute_multi, "igp compute (multi-topology)"},
   {test_net_igp_ecmp3, "igp ecmp (3)"},
 };
 #define TEST_NET_RT_IGP_SIZE ARRAY_SIZE(TEST_NET_RT_IGP)
@@ -4522,6 +5102,8 @@ unit_test_t TEST_NET_TRACES[]= {
   {test_net_traces_ping_no_reply, "ping (no reply)"},
   {test_net_traces_recordroute, "record-route"},
   {test_net_traces_recordroute_unreach, "record-route (unreach)"},
+  {test_net_traces_recordroute_ttl, "record-route (ttl)"},
+  {test_net_traces_recordroute_loop, "record-route (loop)"},
   {test_net_traces_recordroute_broken, "record-route (broken)"},
   {test_net_traces_recordroute_load, "record-route (load)"},
   {test_net_traces_recordroute_qos, "record-route (qos)"},
@@ -4549,6 +5131,7 @@ unit_test_t TEST_BGP_ATTR[]= {
   {test_bgp_attr_aspath_prepend_too_much, "as-path prepend (too much)"},
   {test_bgp_attr_aspath_2str, "as-path (-> string)"},
   {test_bgp_attr_aspath_str2, "as-path (<- string)"},
+  {test_bgp_attr_aspath_2array, "as-path (-> array)"},
   {test_bgp_attr_aspath_set_str2, "as-path set (<- string)"},
   {test_bgp_attr_aspath_cmp, "as-path (compare)"},
   {test_bgp_attr_aspath_contains, "as-path (contains)"},
@@ -4557,6 +5140,7 @@ unit_test_t TEST_BGP_ATTR[]= {
   {test_bgp_attr_communities, "communities"},
   {test_bgp_attr_communities_append, "communities append"},
   {test_bgp_attr_communities_remove, "communities remove"},
+  {test_bgp_attr_communities_mem, "communities (memory stats)"},
   {test_bgp_attr_communities_2str, "communities (-> string)"},
   {test_bgp_attr_communities_str2, "communities (<- string)"},
   {test_bgp_attr_communities_cmp, "communities (compare)"},
@@ -4621,6 +5205,12 @@ unit_test_t TEST_BGP_FILTER_PRED[]= {
 };
 #define TEST_BGP_FILTER_PRED_SIZE ARRAY_SIZE(TEST_BGP_FILTER_PRED)
 
+unit_test_t TEST_BGP_FILTER[]= {
+  {test_bgp_filter_share, "share"},
+  {test_bgp_filter_intern, "intern"},
+};
+#define TEST_BGP_FILTER_SIZE ARRAY_SIZE(TEST_BGP_FILTER)
+
 unit_test_t TEST_BGP_ROUTE_MAPS[]= {
 };
 #define TEST_BGP_ROUTE_MAPS_SIZE ARRAY_SIZE(TEST_BGP_ROUTE_MAPS)
@@ -4657,6 +5247,7 @@ unit_test_t TEST_MRTD[]= {
   {test_mrtd_parse_inv_prefix, "parse (error:invalid prefix)"},
   {test_mrtd_parse_inv_nexthop, "parse (error:invalid nexthop)"},
   {test_mrtd_parse_inv_origin, "parse (error:invalid origin)"},
+  {test_mrtd_binary_aspath, "binary as-path (multi-segment)"},
 };
 #define TEST_MRTD_SIZE ARRAY_SIZE(TEST_MRTD)
 
@@ -4664,6 +5255,9 @@ unit_test_t TEST_CLI[]= {
   {test_cli_empty, "empty line"},
   {test_cli_comment, "comment"},
   {test_cli_error, "error"},
+  {test_cli_ctx, "contexts"},
+  {test_cli_batch, "batch API"},
+  {test_cli_script, "compiled script"},
 };
 #define TEST_CLI_SIZE ARRAY_SIZE(TEST_CLI)
 
@@ -4690,6 +5284,7 @@ unit_test_suite_t TEST_SUITES[]= {
   {"BGP Routes", TEST_BGP_ROUTE_SIZE, TEST_BGP_ROUTE},
   {"BGP Filter Actions", TEST_BGP_FILTER_ACTION_SIZE, TEST_BGP_FILTER_ACTION},
   {"BGP Filter Predicates", TEST_BGP_FILTER_PRED_SIZE, TEST_BGP_FILTER_PRED},
+  {"BGP Filters", TEST_BGP_FILTER_SIZE, TEST_BGP_FILTER},
   {"BGP Route Maps", TEST_BGP_ROUTE_MAPS_SIZE, TEST_BGP_ROUTE_MAPS},
   {"BGP Router", TEST_BGP_ROUTER_SIZE, TEST_BGP_ROUTER},
   {"BGP Peer", TEST_BGP_PEER_SIZE, TEST_BGP_PEER},
@@ -37,6 +37,7 @@
 #include <libgds/stream.h>
 
 #include <sim/scheduler.h>
+#include <util/mem_stats.h>
 
 //#define DEBUG
 #include <libgds/debug.h>
@@ -69,6 +70,7 @@ static inline _event_t * _event_create(const sim_event_ops_t * ops,
 				       void * ctx)
 {
   _event_t * ev= (_event_t *) MALLOC(sizeof(_event_t));
+  mem_stats_alloc(MEM_TAG_EVENT, sizeof(_event_t));
   ev->ops= ops;
   ev->ctx= ctx;
   return ev;
@@ -81,6 +83,7 @@ static inline void _event_destroy(_event_t ** event_ref)
   if (event == NULL)
     return;
   FREE(event);
+  mem_stats_free(MEM_TAG_EVENT, sizeof(_event_t));
   *event_ref= NULL;
 }
 
@@ -37,6 +37,7 @@
 #include <libgds/memory.h>
 #include <sim/static_scheduler.h>
 #include <net/network.h>
+#include <util/mem_stats.h>
 
 #define EVENT_QUEUE_DEPTH 256
 
@@ -60,6 +61,7 @@ static inline _event_t * _event_create(const sim_event_ops_t * ops,
 				       void * ctx)
 {
   _event_t * event= (_event_t *) MALLOC(sizeof(_event_t));
+  mem_stats_alloc(MEM_TAG_EVENT, sizeof(_event_t));
   event->ops= ops;
   event->ctx= ctx;
   return event;
@@ -70,6 +72,7 @@ static void _event_destroy(_event_t ** event_ref)
 {
   if (*event_ref != NULL) {
     FREE(*event_ref);
+    mem_stats_free(MEM_TAG_EVENT, sizeof(_event_t));
     *event_ref= NULL;
   }
 }
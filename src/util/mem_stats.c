@@ -0,0 +1,136 @@
+// ==================================================================
+// @(#)mem_stats.c
+//
+// Per-subsystem memory accounting.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+#include <assert.h>
+
+#include <util/mem_stats.h>
+
+mem_stats_t _mem_stats[MEM_TAG_MAX];
+
+static const char * MEM_TAG_NAMES[MEM_TAG_MAX]= {
+  "route",
+  "attr",
+  "path",
+  "comms",
+  "rib",
+  "fib",
+  "spt",
+  "event",
+  "msg",
+};
+
+// -----[ mem_stats_get ]--------------------------------------------
+const mem_stats_t * mem_stats_get(mem_tag_t tag)
+{
+  assert(tag < MEM_TAG_MAX);
+  return &_mem_stats[tag];
+}
+
+// -----[ mem_stats_reset_peak ]-------------------------------------
+void mem_stats_reset_peak()
+{
+  unsigned int index;
+
+  for (index= 0; index < MEM_TAG_MAX; index++) {
+    _mem_stats[index].peak_bytes= _mem_stats[index].bytes;
+    _mem_stats[index].peak_objects= _mem_stats[index].objects;
+  }
+}
+
+// -----[ mem_tag_name ]---------------------------------------------
+const char * mem_tag_name(mem_tag_t tag)
+{
+  if (tag < MEM_TAG_MAX)
+    return MEM_TAG_NAMES[tag];
+  return "?";
+}
+
+// -----[ _mem_stats_dump_text ]-------------------------------------
+static void _mem_stats_dump_text(gds_stream_t * stream, int peak)
+{
+  mem_stats_t total= { 0, 0, 0, 0 };
+  mem_stats_t * stats;
+  unsigned int index;
+
+  stream_printf(stream, "%-8s %14s %12s", "tag", "bytes", "objects");
+  if (peak)
+    stream_printf(stream, " %14s %12s", "peak-bytes", "peak-objects");
+  stream_printf(stream, "\n");
+  for (index= 0; index < MEM_TAG_MAX; index++) {
+    stats= &_mem_stats[index];
+    stream_printf(stream, "%-8s %14lu %12lu", MEM_TAG_NAMES[index],
+		  (unsigned long) stats->bytes, stats->objects);
+    if (peak)
+      stream_printf(stream, " %14lu %12lu",
+		    (unsigned long) stats->peak_bytes, stats->peak_objects);
+    stream_printf(stream, "\n");
+    total.bytes+= stats->bytes;
+    total.objects+= stats->objects;
+  }
+  // The peak of the total is not the sum of the peaks: only the
+  // current values are totalized.
+  stream_printf(stream, "%-8s %14lu %12lu\n", "total",
+		(unsigned long) total.bytes, total.objects);
+}
+
+// -----[ _mem_stats_dump_json ]-------------------------------------
+static void _mem_stats_dump_json(gds_stream_t * stream)
+{
+  mem_stats_t * stats;
+  unsigned int index;
+
+  stream_printf(stream, "{");
+  for (index= 0; index < MEM_TAG_MAX; index++) {
+    stats= &_mem_stats[index];
+    if (index > 0)
+      stream_printf(stream, ",");
+    stream_printf(stream, "\"%s\":{\"bytes\":%lu,\"objects\":%lu,"
+		  "\"peak_bytes\":%lu,\"peak_objects\":%lu}",
+		  MEM_TAG_NAMES[index],
+		  (unsigned long) stats->bytes, stats->objects,
+		  (unsigned long) stats->peak_bytes, stats->peak_objects);
+  }
+  stream_printf(stream, "}\n");
+}
+
+// -----[ mem_stats_dump ]-------------------------------------------
+void mem_stats_dump(gds_stream_t * stream, mem_stats_format_t format,
+		    int peak)
+{
+  switch (format) {
+  case MEM_STATS_FORMAT_JSON:
+    _mem_stats_dump_json(stream);
+    break;
+  default:
+    _mem_stats_dump_text(stream, peak);
+  }
+}
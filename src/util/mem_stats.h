@@ -0,0 +1,170 @@
+// ==================================================================
+// @(#)mem_stats.h
+//
+// Per-subsystem memory accounting.
+//
+// @author Bruno Quoitin (bruno.quoitin@umons.ac.be)
+// @date 19/10/2026
+// $Id$
+//
+// C-BGP, BGP Routing Solver
+// Copyright (C) 2002-2008 Bruno Quoitin
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program; if not, write to the Free Software
+// Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA
+// 02111-1307  USA
+// ==================================================================
+
+/**
+ * \file
+ * Provide counters of the memory held by the main data structures
+ * of the simulator, grouped by subsystem (tag).
+ *
+ * For each tag, the number of bytes and the number of objects that
+ * are currently allocated are maintained, as well as their peak
+ * values. The counters are updated by the create / destroy functions
+ * of each data structure, next to the corresponding MALLOC / FREE.
+ *
+ * The bytes only cover the data structures themselves, not the
+ * containers of libgds they use internally (arrays, hash tables).
+ * The bytes of the RIB tries are an estimate, since the trie nodes
+ * are allocated by libgds.
+ */
+
+#ifndef __UTIL_MEM_STATS_H__
+#define __UTIL_MEM_STATS_H__
+
+#include <stdlib.h>
+
+#include <libgds/stream.h>
+
+// -----[ mem_tag_t ]------------------------------------------------
+typedef enum {
+  MEM_TAG_ROUTE,
+  MEM_TAG_ATTR,
+  MEM_TAG_PATH,
+  MEM_TAG_COMMS,
+  MEM_TAG_RIB,
+  MEM_TAG_FIB,
+  MEM_TAG_SPT,
+  MEM_TAG_EVENT,
+  MEM_TAG_MSG,
+  MEM_TAG_MAX,
+} mem_tag_t;
+
+// -----[ mem_stats_format_t ]---------------------------------------
+typedef enum {
+  MEM_STATS_FORMAT_TEXT,
+  MEM_STATS_FORMAT_JSON,
+} mem_stats_format_t;
+
+// -----[ mem_stats_t ]----------------------------------------------
+typedef struct {
+  size_t        bytes;
+  size_t        peak_bytes;
+  unsigned long objects;
+  unsigned long peak_objects;
+} mem_stats_t;
+
+/** Estimated size of a RIB entry (trie node + branch). */
+#define MEM_STATS_RIB_ENTRY_SIZE (8*sizeof(void *))
+
+extern mem_stats_t _mem_stats[MEM_TAG_MAX];
+
+// -----[ mem_stats_alloc ]------------------------------------------
+/**
+ * Account for the allocation of one object of the given size.
+ */
+static inline void mem_stats_alloc(mem_tag_t tag, size_t size)
+{
+  mem_stats_t * stats= &_mem_stats[tag];
+  stats->bytes+= size;
+  if (stats->bytes > stats->peak_bytes)
+    stats->peak_bytes= stats->bytes;
+  stats->objects++;
+  if (stats->objects > stats->peak_objects)
+    stats->peak_objects= stats->objects;
+}
+
+// -----[ mem_stats_free ]-------------------------------------------
+/**
+ * Account for the release of one object of the given size.
+ */
+static inline void mem_stats_free(mem_tag_t tag, size_t size)
+{
+  mem_stats_t * stats= &_mem_stats[tag];
+  stats->bytes-= size;
+  stats->objects--;
+}
+
+// -----[ mem_stats_free_n ]-----------------------------------------
+/**
+ * Account for the release of n objects of the given size.
+ */
+static inline void mem_stats_free_n(mem_tag_t tag, size_t size,
+				    unsigned long n)
+{
+  mem_stats_t * stats= &_mem_stats[tag];
+  stats->bytes-= n*size;
+  stats->objects-= n;
+}
+
+// -----[ mem_stats_resize ]-----------------------------------------
+/**
+ * Account for the reallocation of an object (the number of objects
+ * does not change).
+ */
+static inline void mem_stats_resize(mem_tag_t tag, size_t old_size,
+				    size_t new_size)
+{
+  mem_stats_t * stats= &_mem_stats[tag];
+  stats->bytes+= new_size;
+  stats->bytes-= old_size;
+  if (stats->bytes > stats->peak_bytes)
+    stats->peak_bytes= stats->bytes;
+}
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+  // -----[ mem_stats_get ]------------------------------------------
+  const mem_stats_t * mem_stats_get(mem_tag_t tag);
+
+  // -----[ mem_stats_reset_peak ]-----------------------------------
+  /**
+   * Set the peak values of all the tags to their current values.
+   */
+  void mem_stats_reset_peak();
+
+  // -----[ mem_tag_name ]-------------------------------------------
+  const char * mem_tag_name(mem_tag_t tag);
+
+  // -----[ mem_stats_dump ]-----------------------------------------
+  /**
+   * Dump the counters of all the tags.
+   *
+   * In text format, one line is written per tag, with the current
+   * bytes and objects, followed by the peak bytes and objects if
+   * peak is not 0. In JSON format, a single object is written, with
+   * one member per tag that holds all the counters.
+   */
+  void mem_stats_dump(gds_stream_t * stream, mem_stats_format_t format,
+		      int peak);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __UTIL_MEM_STATS_H__ */
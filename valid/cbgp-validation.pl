@@ -295,6 +295,22 @@ sub check_has_error($;$) {
   return 1;
 }
 
+# -----[ cbgp_has_feature ]------------------------------------------
+# Check if C-BGP was built with an optional feature, as reported by
+# "show version" (e.g. "bgpdump" for the binary MRT functions).
+# -------------------------------------------------------------------
+sub cbgp_has_feature($$) {
+  my ($cbgp, $feature)= @_;
+  my $found= 0;
+
+  $cbgp->send_cmd("show version");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    ($line =~ m/^cbgp\s+version:.*\[\Q$feature\E\]/) and $found= 1;
+  }
+  return $found;
+}
+
 # -----[ cbgp_topo_domain ]------------------------------------------
 sub cbgp_topo_domain($$$$)
   {
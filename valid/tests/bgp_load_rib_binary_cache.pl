@@ -0,0 +1,150 @@
+return ["bgp load rib (binary, attribute cache)",
+	"cbgp_valid_bgp_load_rib_binary_cache"];
+
+# -----[ cbgp_valid_bgp_load_rib_binary_cache ]----------------------
+# Check the cache of AS-Paths and Communities used by the MRT
+# loaders. An attribute is converted the first time it is found in
+# a dump; the next routes that carry the same attribute hit the
+# cache. The cache only lives for one load.
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1)
+#   - R2 (2.0.0.1, AS2) virtual peer of R1 and R3
+#   - R3 (3.0.0.1, AS1)
+#
+# Scenario:
+#   * Load into R1 an ASCII dump of 13 routes that use 3 different
+#     AS-Paths and 2 different Communities. Check that the cache
+#     reports 5 misses and 21 hits
+#   * Save the Loc-RIB of R1 in binary MRT format and load it into R3
+#     (--force). Check that the cache reports 5 misses and 21 hits
+#     and that R1 and R3 have the same RIB
+#   * Load into R1 a changed dump (same prefixes, other AS-Paths and
+#     Communities), save it again into the same file and load it
+#     into R3. Check that the cache reports 5 misses again (nothing
+#     is reused from the previous load) and that R1 and R3 still have
+#     the same RIB, with the new attributes
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_load_rib_binary_cache($) {
+  my ($cbgp)= @_;
+  my $rib_file= get_tmp_resource("cbgp-binary-cache.ascii");
+  my $mrt_file= get_tmp_resource("cbgp-binary-cache.mrt.gz");
+  cbgp_has_feature($cbgp, "bgpdump") or return TEST_DISABLED;
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  foreach my $node ("1.0.0.1", "2.0.0.1", "3.0.0.1") {
+    $cbgp->send_cmd("net add node $node");
+    $cbgp->send_cmd("net node $node domain 1");
+  }
+  $cbgp->send_cmd("net add link 1.0.0.1 2.0.0.1");
+  $cbgp->send_cmd("net link 1.0.0.1 2.0.0.1 igp-weight --bidir 10");
+  $cbgp->send_cmd("net add link 3.0.0.1 2.0.0.1");
+  $cbgp->send_cmd("net link 3.0.0.1 2.0.0.1 igp-weight --bidir 10");
+  $cbgp->send_cmd("net domain 1 compute");
+  foreach my $router ("1.0.0.1", "3.0.0.1") {
+    $cbgp->send_cmd("bgp add router 1 $router");
+    $cbgp->send_cmd("bgp router $router");
+    $cbgp->send_cmd("\tadd peer 2 2.0.0.1");
+    $cbgp->send_cmd("\tpeer 2.0.0.1 virtual");
+    $cbgp->send_cmd("\tpeer 2.0.0.1 up");
+    $cbgp->send_cmd("\texit");
+  }
+
+  foreach my $origin (6, 8) {
+    my ($c1, $c2)= ($origin == 6)?("2:1", "2:2"):("2:3", "2:4");
+
+    # 13 routes, paths "2 X" (11), "2 7" (1) and "2 {X}" (1),
+    # communities c1 (12) and c2 (1)
+    open(RIB, ">$rib_file") or die;
+    for (my $index= 200; $index < 210; $index++) {
+      _bgp_load_rib_binary_cache_record("$index/8", "2 $origin", $c1);
+    }
+    _bgp_load_rib_binary_cache_record("210/8", "2 7", $c1);
+    _bgp_load_rib_binary_cache_record("211/8", "2 {$origin}", $c1);
+    _bgp_load_rib_binary_cache_record("212/8", "2 $origin", $c2);
+    close(RIB);
+
+    return TEST_FAILURE
+      if (!_bgp_load_rib_binary_cache_check($cbgp, "1.0.0.1",
+					    "$rib_file", 5, 21));
+
+    unlink $mrt_file;
+    my $msg= cbgp_check_error($cbgp, "bgp router 1.0.0.1 save rib $mrt_file");
+    if (defined($msg)) {
+      $tests->debug("could not save RIB ($msg)");
+      return TEST_FAILURE;
+    }
+
+    return TEST_FAILURE
+      if (!_bgp_load_rib_binary_cache_check($cbgp, "3.0.0.1",
+					    "--force --format=mrt-binary ".
+					    "$mrt_file", 5, 21));
+
+    my $rib1= _bgp_load_rib_binary_cache_dump($cbgp, "1.0.0.1");
+    my $rib3= _bgp_load_rib_binary_cache_dump($cbgp, "3.0.0.1");
+    if ($rib1 ne $rib3) {
+      $tests->debug("RIBs differ\nR1:\n$rib1\nR3:\n$rib3");
+      return TEST_FAILURE;
+    }
+
+    my $rib= cbgp_get_rib($cbgp, "3.0.0.1");
+    return TEST_FAILURE
+      if (!check_has_bgp_route($rib, "200/8", -path=>[2, $origin],
+			       -community=>[$c1]) ||
+	  !check_has_bgp_route($rib, "212/8", -path=>[2, $origin],
+			       -community=>[$c2]));
+  }
+
+  unlink $rib_file;
+  unlink $mrt_file;
+  return TEST_SUCCESS;
+}
+
+# -----[ _bgp_load_rib_binary_cache_record ]-------------------------
+sub _bgp_load_rib_binary_cache_record($$$) {
+  my ($prefix, $path, $comms)= @_;
+  print RIB "TABLE_DUMP|0|B|1.0.0.1|1|$prefix|$path|IGP|2.0.0.1|0|0|".
+    "$comms\n";
+}
+
+# -----[ _bgp_load_rib_binary_cache_check ]--------------------------
+# Load a dump into a router and check the number of cache misses and
+# hits reported by the load summary.
+# -------------------------------------------------------------------
+sub _bgp_load_rib_binary_cache_check($$$$$) {
+  my ($cbgp, $router, $args, $misses, $hits)= @_;
+  my ($cache_hits, $cache_misses);
+
+  $cbgp->send_cmd("bgp router $router load rib --summary $args");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    if ($line =~ m/^Attribute cache hits\s*:\s*(\d+)$/) {
+      $cache_hits= $1;
+    } elsif ($line =~ m/^Attribute cache misses\s*:\s*(\d+)$/) {
+      $cache_misses= $1;
+    }
+  }
+  if (!defined($cache_hits) || !defined($cache_misses)) {
+    $tests->debug("no cache statistics for \"$args\"");
+    return 0;
+  }
+  if (($cache_hits != $hits) || ($cache_misses != $misses)) {
+    $tests->debug("cache statistics mismatch for \"$args\" ".
+		  "(hits: $cache_hits/$hits, misses: $cache_misses/$misses)");
+    return 0;
+  }
+  return 1;
+}
+
+# -----[ _bgp_load_rib_binary_cache_dump ]---------------------------
+sub _bgp_load_rib_binary_cache_dump($$) {
+  my ($cbgp, $router)= @_;
+  my $dump= "";
+
+  $cbgp->send_cmd("bgp router $router show rib *");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    $dump.= "$line\n";
+  }
+  return $dump;
+}
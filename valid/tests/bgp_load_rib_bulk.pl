@@ -0,0 +1,124 @@
+return ["bgp load rib (bulk)", "cbgp_valid_bgp_load_rib_bulk"];
+
+# -----[ cbgp_valid_bgp_load_rib_bulk ]------------------------------
+# Test ability to load a BGP dump into a router with the decision
+# process deferred until all the routes are in the Adj-RIB-Ins.
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1)
+#   - R2 (2.0.0.1, AS2) virtual peer
+#   - R3 (3.0.0.1, AS3) virtual peer
+#   - R4 (4.0.0.1, AS4) virtual peer
+#
+# Scenario:
+#   * Load with option --bulk a BGP dump where R2, R3 and R4 announce
+#     the same 3 prefixes with AS-Paths of different lengths
+#       255/8: best from R3 [3 6]
+#       254/8: best from R4 [4 6]
+#       253/8: best from R2 [2 6]
+#   * Check that the best route towards each prefix is selected
+#   * Check that the decision process was run once per prefix (3
+#     times) and not once per route (9 times)
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_load_rib_bulk($) {
+  my ($cbgp)= @_;
+  my $rib_file= get_tmp_resource("cbgp-bulk.ascii");
+  my %routes= (
+	       "255/8" => { "2.0.0.1" => "2 5 6",
+			    "3.0.0.1" => "3 6",
+			    "4.0.0.1" => "4 7 8 6" },
+	       "254/8" => { "2.0.0.1" => "2 5 6",
+			    "3.0.0.1" => "3 7 8 6",
+			    "4.0.0.1" => "4 6" },
+	       "253/8" => { "2.0.0.1" => "2 6",
+			    "3.0.0.1" => "3 5 6",
+			    "4.0.0.1" => "4 7 8 6" },
+	      );
+  my %best= ( "255/8" => "3.0.0.1",
+	      "254/8" => "4.0.0.1",
+	      "253/8" => "2.0.0.1" );
+
+  open(RIB, ">$rib_file") or die;
+  foreach my $prefix (sort keys %routes) {
+    foreach my $peer (sort keys %{$routes{$prefix}}) {
+      my $path= $routes{$prefix}->{$peer};
+      print RIB "TABLE_DUMP|0|B|1.0.0.1|1|$prefix|$path|IGP|$peer|0|0|\n";
+    }
+  }
+  close(RIB);
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  $cbgp->send_cmd("net add node 1.0.0.1");
+  $cbgp->send_cmd("net node 1.0.0.1 domain 1");
+  foreach my $peer ("2.0.0.1", "3.0.0.1", "4.0.0.1") {
+    $cbgp->send_cmd("net add node $peer");
+    $cbgp->send_cmd("net node $peer domain 1");
+    $cbgp->send_cmd("net add link 1.0.0.1 $peer");
+    $cbgp->send_cmd("net link 1.0.0.1 $peer igp-weight --bidir 10");
+  }
+  $cbgp->send_cmd("net domain 1 compute");
+  $cbgp->send_cmd("bgp add router 1 1.0.0.1");
+  $cbgp->send_cmd("bgp router 1.0.0.1");
+  foreach my $peer ("2.0.0.1", "3.0.0.1", "4.0.0.1") {
+    my $asn= (split /\./, $peer)[0];
+    $cbgp->send_cmd("\tadd peer $asn $peer");
+    $cbgp->send_cmd("\tpeer $peer virtual");
+    $cbgp->send_cmd("\tpeer $peer up");
+  }
+  $cbgp->send_cmd("\texit");
+
+  my $dp_runs= _bgp_load_rib_bulk_dp_runs($cbgp, "1.0.0.1");
+  return TEST_FAILURE
+    if (!defined($dp_runs));
+
+  my $msg= cbgp_check_error($cbgp, "bgp router 1.0.0.1 load rib --bulk ".
+			     "$rib_file");
+  if (defined($msg)) {
+    $tests->debug("load failed: $msg");
+    return TEST_FAILURE;
+  }
+
+  my $rib= cbgp_get_rib($cbgp, "1.0.0.1");
+  if (scalar(keys %$rib) != scalar(keys %best)) {
+    $tests->debug("number of prefixes mismatch");
+    return TEST_FAILURE;
+  }
+  foreach my $prefix (keys %best) {
+    my $peer= $best{$prefix};
+    return TEST_FAILURE
+      if (!check_has_bgp_route($rib, $prefix,
+			       -nexthop=>$peer,
+			       -path=>[split /\s+/, $routes{$prefix}->{$peer}]));
+  }
+
+  my $dp_runs2= _bgp_load_rib_bulk_dp_runs($cbgp, "1.0.0.1");
+  return TEST_FAILURE
+    if (!defined($dp_runs2));
+  if ($dp_runs2-$dp_runs != scalar(keys %best)) {
+    $tests->debug("decision process run ".($dp_runs2-$dp_runs).
+		  " times, expected ".scalar(keys %best));
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
+
+# -----[ _bgp_load_rib_bulk_dp_runs ]--------------------------------
+# Return the number of runs of the decision process reported by
+# "bgp router X show stats".
+# -------------------------------------------------------------------
+sub _bgp_load_rib_bulk_dp_runs($$) {
+  my ($cbgp, $router)= @_;
+  my $dp_runs= undef;
+
+  $cbgp->send_cmd("bgp router $router show stats");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    if ($line =~ m/^num-dp-runs:\s+(\d+)$/) {
+      $dp_runs= $1;
+    }
+  }
+  (defined($dp_runs)) or
+    $tests->debug("could not get number of decision process runs");
+  return $dp_runs;
+}
@@ -0,0 +1,58 @@
+return ["bgp load rib (bulk, recursive next-hop)",
+	"cbgp_valid_bgp_load_rib_bulk_recursive"];
+
+# -----[ cbgp_valid_bgp_load_rib_bulk_recursive ]-------------------
+# Test that the deferred decision process gives the same result as
+# the serial one when the next-hop of a route is only reachable
+# through a BGP route decided in the same run.
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1)
+#   - R2 (2.0.0.1, AS2) virtual peer
+#   - R3 (10.0.0.1, AS3) virtual peer, not reachable through the IGP
+#
+# Scenario:
+#   * Establish the session with R3 through a temporary static route
+#   * Load with option --bulk a BGP dump that contains 10/8 from R2
+#     and 255/8 from R3
+#   * Check that 10/8 is selected and makes the next-hop of 255/8
+#     reachable, so that 255/8 is selected as well
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_load_rib_bulk_recursive($) {
+  my ($cbgp)= @_;
+  my $rib_file= get_tmp_resource("cbgp-bulk-recursive.ascii");
+
+  open(RIB, ">$rib_file") or die;
+  print RIB "TABLE_DUMP|0|B|1.0.0.1|1|10/8|2|IGP|2.0.0.1|0|0|2:1\n";
+  print RIB "TABLE_DUMP|0|B|1.0.0.1|1|255/8|3|IGP|10.0.0.1|0|0|3:1\n";
+  close(RIB);
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  $cbgp->send_cmd("net add node 1.0.0.1");
+  $cbgp->send_cmd("net node 1.0.0.1 domain 1");
+  $cbgp->send_cmd("net add node 2.0.0.1");
+  $cbgp->send_cmd("net node 2.0.0.1 domain 1");
+  $cbgp->send_cmd("net add link 1.0.0.1 2.0.0.1");
+  $cbgp->send_cmd("net link 1.0.0.1 2.0.0.1 igp-weight --bidir 10");
+  $cbgp->send_cmd("net domain 1 compute");
+  $cbgp->send_cmd("net node 1.0.0.1 route add --oif=2.0.0.1 10.0.0.1/32 1");
+  $cbgp->send_cmd("bgp add router 1 1.0.0.1");
+  $cbgp->send_cmd("bgp router 1.0.0.1");
+  $cbgp->send_cmd("\tadd peer 2 2.0.0.1");
+  $cbgp->send_cmd("\tpeer 2.0.0.1 virtual");
+  $cbgp->send_cmd("\tpeer 2.0.0.1 up");
+  $cbgp->send_cmd("\tadd peer 3 10.0.0.1");
+  $cbgp->send_cmd("\tpeer 10.0.0.1 virtual");
+  $cbgp->send_cmd("\tpeer 10.0.0.1 up");
+  $cbgp->send_cmd("\texit");
+  $cbgp->send_cmd("net node 1.0.0.1 route del 10.0.0.1/32 *");
+  $cbgp->send_cmd("bgp router 1.0.0.1 load rib --bulk $rib_file");
+
+  my $rib= cbgp_get_rib($cbgp, "1.0.0.1");
+  return TEST_FAILURE
+    if (!check_has_bgp_route($rib, "10/8", -nexthop=>"2.0.0.1"));
+  return TEST_FAILURE
+    if (!check_has_bgp_route($rib, "255/8", -nexthop=>"10.0.0.1"));
+
+  return TEST_SUCCESS;
+}
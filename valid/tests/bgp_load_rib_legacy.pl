@@ -0,0 +1,148 @@
+return ["bgp load rib (legacy parser)", "cbgp_valid_bgp_load_rib_legacy"];
+
+# -----[ cbgp_valid_bgp_load_rib_legacy ]----------------------------
+# Check that the in-place MRT ASCII parser (default format
+# "mrt-ascii") builds the same RIBs as the tokenizer-based parser
+# (format "mrt-ascii-legacy"), for valid as well as malformed dumps.
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1), loads dumps with format mrt-ascii
+#   - R2 (1.0.0.2, AS1), loads dumps with format mrt-ascii-legacy
+#   - R3 (2.0.0.1, AS2) virtual peer of R1 and R2
+#   - R4 (3.0.0.1, AS3) virtual peer of R1 and R2
+#
+# Scenario:
+#   * Load a dump with various attributes (AS-SETs, communities,
+#     missing MED, origins, CRLF line ends) into R1 and R2
+#   * Check that the Loc-RIBs and Adj-RIB-Ins of R1 and R2 are equal
+#   * For each of a set of malformed records, load a dump where the
+#     malformed record follows a valid one. Check that both loads
+#     fail with the same error and that the RIBs are still equal
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_load_rib_legacy($) {
+  my ($cbgp)= @_;
+  my $rib_file= get_tmp_resource("cbgp-legacy.ascii");
+  my $hdr= "TABLE_DUMP|0|B|1.0.0.1|1";
+  my @records= (
+		"$hdr|255/8|2 5 6|IGP|2.0.0.1|0|0|",
+		"$hdr|255/8|3 6|IGP|3.0.0.1|100|20|3:1 3:2",
+		"$hdr|254/8|2 {7 8} 6|EGP|2.0.0.1|200||",
+		"$hdr|254/8|3 6 6 6|INCOMPLETE|3.0.0.1|0|0|3:1",
+		"$hdr|253.1.0.0/16|2 6|IGP|2.0.0.1|||2:100 2:200 2:300\r",
+		"$hdr|253.2/16|3 5 6|IGP|3.0.0.1|0|5",
+		"$hdr|253.2/16|2 5 6|IGP|2.0.0.1|0|5|2:1",
+	       );
+  my @malformed= (
+		  "$hdr|300/8|2 6|IGP|2.0.0.1|0|0|",
+		  "$hdr|252/8|2 x 6|IGP|2.0.0.1|0|0|",
+		  "$hdr|252/8|2 6|FOO|2.0.0.1|0|0|",
+		  "$hdr|252/8|2 6|IGP|2.0.0.300|0|0|",
+		  "$hdr|252/8|2 6|IGP|2.0.0.1|x|0|",
+		  "$hdr|252/8|2 6|IGP|2.0.0.1|0|1x|",
+		  "$hdr|252/8|2 6|IGP|2.0.0.1|0|0|2:x",
+		  "$hdr|252/8|2 6|IGP",
+		  "TABLE_DUMP|0|A|1.0.0.1|1|252/8|2 6|IGP|2.0.0.1|0|0|",
+		  "BGP4|0|B|1.0.0.1|1|252/8|2 6|IGP|2.0.0.1|0|0|",
+		  "",
+		 );
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  foreach my $node ("1.0.0.1", "1.0.0.2", "2.0.0.1", "3.0.0.1") {
+    $cbgp->send_cmd("net add node $node");
+    $cbgp->send_cmd("net node $node domain 1");
+  }
+  foreach my $router ("1.0.0.1", "1.0.0.2") {
+    foreach my $peer ("2.0.0.1", "3.0.0.1") {
+      $cbgp->send_cmd("net add link $router $peer");
+      $cbgp->send_cmd("net link $router $peer igp-weight --bidir 10");
+    }
+  }
+  $cbgp->send_cmd("net domain 1 compute");
+  foreach my $router ("1.0.0.1", "1.0.0.2") {
+    $cbgp->send_cmd("bgp add router 1 $router");
+    $cbgp->send_cmd("bgp router $router");
+    foreach my $peer ("2.0.0.1", "3.0.0.1") {
+      my $asn= (split /\./, $peer)[0];
+      $cbgp->send_cmd("\tadd peer $asn $peer");
+      $cbgp->send_cmd("\tpeer $peer virtual");
+      $cbgp->send_cmd("\tpeer $peer up");
+    }
+    $cbgp->send_cmd("\texit");
+  }
+
+  _bgp_load_rib_legacy_write($rib_file, @records);
+  return TEST_FAILURE
+    if (!_bgp_load_rib_legacy_check($cbgp, $rib_file, 0));
+
+  foreach my $record (@malformed) {
+    _bgp_load_rib_legacy_write($rib_file, $records[0], $record);
+    return TEST_FAILURE
+      if (!_bgp_load_rib_legacy_check($cbgp, $rib_file, 1));
+  }
+
+  unlink $rib_file;
+  return TEST_SUCCESS;
+}
+
+# -----[ _bgp_load_rib_legacy_write ]--------------------------------
+sub _bgp_load_rib_legacy_write($@) {
+  my ($rib_file, @records)= @_;
+
+  open(RIB, ">$rib_file") or die;
+  foreach my $record (@records) {
+    print RIB "$record\n";
+  }
+  close(RIB);
+}
+
+# -----[ _bgp_load_rib_legacy_check ]--------------------------------
+# Load the dump into R1 with the in-place parser and into R2 with
+# the legacy parser. Check that both loads fail (or succeed) with the
+# same error and that R1 and R2 end up with the same RIBs.
+# -------------------------------------------------------------------
+sub _bgp_load_rib_legacy_check($$$) {
+  my ($cbgp, $rib_file, $error)= @_;
+
+  my $msg1= cbgp_check_error($cbgp, "bgp router 1.0.0.1 load rib ".
+			     "$rib_file");
+  my $msg2= cbgp_check_error($cbgp, "bgp router 1.0.0.2 load rib --force ".
+			     "--format=mrt-ascii-legacy $rib_file");
+  if ((defined($msg1)?1:0) != $error) {
+    $tests->debug("in-place parser: unexpected result (".
+		  (defined($msg1)?$msg1:"success").")");
+    return 0;
+  }
+  if ((defined($msg1) != defined($msg2)) ||
+      (defined($msg1) && ($msg1 ne $msg2))) {
+    $tests->debug("loaders disagree (".
+		  (defined($msg1)?$msg1:"success")." / ".
+		  (defined($msg2)?$msg2:"success").")");
+    return 0;
+  }
+
+  my @cmds= ("show rib *",
+	     "show adj-rib in 2.0.0.1 *",
+	     "show adj-rib in 3.0.0.1 *");
+  foreach my $cmd (@cmds) {
+    my $rib1= _bgp_load_rib_legacy_dump($cbgp, "1.0.0.1", $cmd);
+    my $rib2= _bgp_load_rib_legacy_dump($cbgp, "1.0.0.2", $cmd);
+    if ($rib1 ne $rib2) {
+      $tests->debug("\"$cmd\" differs\nin-place:\n$rib1\nlegacy:\n$rib2");
+      return 0;
+    }
+  }
+  return 1;
+}
+
+# -----[ _bgp_load_rib_legacy_dump ]---------------------------------
+sub _bgp_load_rib_legacy_dump($$$) {
+  my ($cbgp, $router, $cmd)= @_;
+  my $dump= "";
+
+  $cbgp->send_cmd("bgp router $router $cmd");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    $dump.= "$line\n";
+  }
+  return $dump;
+}
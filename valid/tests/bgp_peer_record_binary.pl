@@ -0,0 +1,85 @@
+return ["bgp peer record (binary)",
+	"cbgp_valid_bgp_peer_record_binary"];
+
+# -----[ cbgp_valid_bgp_peer_record_binary ]-------------------------
+# Test that the messages recorded in binary format are decoded into
+# the same text as the messages recorded in text format.
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1)
+#   - R2 (2.0.0.1, AS2) virtual peer
+#   - R3 (3.0.0.1, AS3) virtual peer, recorded in text format
+#   - R4 (4.0.0.1, AS4) virtual peer, recorded in binary format
+#
+# Topology:
+#
+#   (R2) ----- R1 ----- (R3)
+#               |
+#               +------ (R4)
+#
+# Scenario:
+#   * Advertise 255/8 [2:1 2:255] and 254/8 from R2
+#   * Withdraw 254/8 from R2
+#   * Stop the records
+#   * Check that the decoded binary record is equal to the text
+#     record
+#   * Check that decoding the text record fails
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_peer_record_binary($) {
+  my ($cbgp)= @_;
+  my $text_file= get_tmp_resource("cbgp-record-text");
+  my $bin_file= get_tmp_resource("cbgp-record-binary");
+  my $decoded_file= get_tmp_resource("cbgp-record-decoded");
+
+  unlink $text_file, $bin_file, $decoded_file;
+
+  cbgp_topo_dp3($cbgp,
+		["2.0.0.1", 2, 0],
+		["3.0.0.1", 3, 0],
+		["4.0.0.1", 4, 0]);
+  $cbgp->send_cmd("bgp router 1.0.0.1 peer 3.0.0.1 record $text_file");
+  $cbgp->send_cmd("bgp router 1.0.0.1 peer 4.0.0.1 record $bin_file ".
+		  "--format=binary");
+
+  cbgp_recv_update($cbgp, "1.0.0.1", 2, "2.0.0.1",
+		   "255/8|2|IGP|2.0.0.1|0|0|2:1 2:255");
+  cbgp_recv_update($cbgp, "1.0.0.1", 2, "2.0.0.1",
+		   "254/8|2|IGP|2.0.0.1|0|0");
+  $cbgp->send_cmd("sim run");
+  cbgp_recv_withdraw($cbgp, "1.0.0.1", 2, "2.0.0.1", "254/8");
+  $cbgp->send_cmd("sim run");
+
+  $cbgp->send_cmd("bgp router 1.0.0.1 peer 3.0.0.1 record -");
+  $cbgp->send_cmd("bgp router 1.0.0.1 peer 4.0.0.1 record -");
+
+  my $msg= cbgp_check_error($cbgp, "bgp msg-decode $bin_file ".
+			    "--output=$decoded_file");
+  if (defined($msg)) {
+    $tests->debug("could not decode binary record ($msg)");
+    return TEST_FAILURE;
+  }
+
+  open(TEXT_RECORD, "<$text_file") or die;
+  my @text_lines= <TEXT_RECORD>;
+  close(TEXT_RECORD);
+  open(DECODED_RECORD, "<$decoded_file") or die;
+  my @decoded_lines= <DECODED_RECORD>;
+  close(DECODED_RECORD);
+
+  if (scalar(@text_lines) != 3) {
+    $tests->debug("3 messages should have been recorded");
+    return TEST_FAILURE;
+  }
+  if (join('', @text_lines) ne join('', @decoded_lines)) {
+    $tests->debug("decoded binary record differs from text record");
+    return TEST_FAILURE;
+  }
+
+  $msg= cbgp_check_error($cbgp, "bgp msg-decode $text_file");
+  if (!defined($msg)) {
+    $tests->debug("decoding a text record should fail");
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
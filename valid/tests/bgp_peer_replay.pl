@@ -0,0 +1,92 @@
+return ["bgp peer replay (mrt-binary)", "cbgp_valid_bgp_peer_replay"];
+
+# -----[ cbgp_valid_bgp_peer_replay ]--------------------------------
+# Test ability to replay a BGP4MP update stream through a virtual
+# peer, at the original relative times.
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1)
+#   - R2 (2.0.0.1, AS2) peer of R1, virtual peer of R3
+#   - R3 (3.0.0.1, AS3)
+#
+# Topology:
+#
+#   R1 ----- R2 ----- R3
+#
+# Scenario:
+#   * Record the messages exchanged by R1 and R2 in MRT format while
+#     R2 announces 255/8 at t=0, 254/8 at t=10 and withdraws 255/8
+#     at t=20
+#   * Replay the messages sent by R2 into R3 with a speedup of 10
+#   * Check that the replay spans 2 simulated seconds
+#   * Check that R3 has a route towards 254/8 only
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_peer_replay($) {
+  my ($cbgp)= @_;
+  my $mrt_file= get_tmp_resource("cbgp-replay.mrt");
+  cbgp_has_feature($cbgp, "bgpdump") or return TEST_DISABLED;
+
+  unlink $mrt_file;
+
+  $cbgp->send_cmd("sim options scheduler dynamic");
+  foreach my $node ("1.0.0.1", "2.0.0.1", "3.0.0.1") {
+    $cbgp->send_cmd("net add node $node");
+  }
+  $cbgp->send_cmd("net add link 1.0.0.1 2.0.0.1");
+  $cbgp->send_cmd("net add link 3.0.0.1 2.0.0.1");
+  $cbgp->send_cmd("net node 1.0.0.1 route add --oif=2.0.0.1 2.0.0.1/32 1");
+  $cbgp->send_cmd("net node 2.0.0.1 route add --oif=1.0.0.1 1.0.0.1/32 1");
+  $cbgp->send_cmd("net node 3.0.0.1 route add --oif=2.0.0.1 2.0.0.1/32 1");
+  $cbgp->send_cmd("bgp add router 1 1.0.0.1");
+  $cbgp->send_cmd("bgp add router 2 2.0.0.1");
+  $cbgp->send_cmd("bgp add router 3 3.0.0.1");
+  cbgp_peering($cbgp, "1.0.0.1", "2.0.0.1", 2);
+  cbgp_peering($cbgp, "2.0.0.1", "1.0.0.1", 1);
+  cbgp_peering($cbgp, "3.0.0.1", "2.0.0.1", 2, "virtual");
+
+  my $msg= cbgp_check_error($cbgp, "bgp options msg-monitor $mrt_file ".
+			    "--format=mrt");
+  if (defined($msg)) {
+    $tests->debug("could not open MRT monitor ($msg)");
+    return TEST_FAILURE;
+  }
+  $cbgp->send_cmd("bgp router 2.0.0.1 add network 255/8");
+  $cbgp->send_cmd("sim event 10 \"bgp router 2.0.0.1 add network 254/8\"");
+  $cbgp->send_cmd("sim event 20 \"bgp router 2.0.0.1 del network 255/8\"");
+  $cbgp->send_cmd("sim run");
+  $cbgp->send_cmd("bgp options msg-monitor -");
+
+  $msg= cbgp_check_error($cbgp, "bgp router 3.0.0.1 peer 2.0.0.1 replay ".
+			 "$mrt_file --src=2.0.0.1 --speedup=10 --summary");
+  if (defined($msg)) {
+    $tests->debug("could not replay MRT file ($msg)");
+    return TEST_FAILURE;
+  }
+
+  my %summary;
+  $cbgp->send_cmd("sim run");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $result= $cbgp->expect(1)) ne "CHECKPOINT") {
+    if ($result =~ m/^([A-Za-z ]+?)\s*:\s*([0-9.]+)/) {
+      $summary{$1}= $2;
+    }
+  }
+  if (($summary{"Updates replayed"} != 2) ||
+      ($summary{"Withdraws replayed"} != 1)) {
+    $tests->debug("unexpected number of replayed messages");
+    return TEST_FAILURE;
+  }
+  if ($summary{"Simulated time"} != 2) {
+    $tests->debug("replay should span 2 simulated seconds ".
+		  "($summary{'Simulated time'})");
+    return TEST_FAILURE;
+  }
+
+  my $rib= cbgp_get_rib($cbgp, "3.0.0.1");
+  return TEST_FAILURE
+    if (!check_has_bgp_route($rib, "254/8", -path=>[2]));
+  return TEST_FAILURE
+    if (check_has_bgp_route($rib, "255/8"));
+
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,126 @@
+return ["bgp save rib (mrt-binary)", "cbgp_valid_bgp_save_rib_mrt"];
+
+# -----[ cbgp_valid_bgp_save_rib_mrt ]-------------------------------
+# Test ability to save the Loc-RIB of a router in binary MRT format
+# (TABLE_DUMP_V2) and to load it back into another router. The routes
+# of the dump are attributed to R1, hence R3 needs --force.
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1)
+#   - R2 (2.0.0.1, AS2) virtual peer of R1 and R3
+#   - R3 (3.0.0.1, AS1)
+#
+# Scenario:
+#   * Load BGP dump into R1
+#   * R2 announces 253/8 to R1 with a multi-segment AS-Path
+#     "2 3 {4 5}" (AS_SEQUENCE + AS_SET)
+#   * Save Loc-RIB of R1 into a gzip-compressed MRT file
+#   * Load the MRT file into R3 without --force, check that the
+#     routes are rejected
+#   * Load the MRT file into R3 with --force
+#   * Check that R1 and R3 have the same routes
+#
+# Resources:
+#   [simple-rib.ascii]
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_save_rib_mrt($) {
+  my ($cbgp)= @_;
+  my $rib_file= get_resource("simple-rib.ascii");
+  my $mrt_file= get_tmp_resource("cbgp-save-rib.mrt.gz");
+  (-e $rib_file) or return TEST_DISABLED;
+  cbgp_has_feature($cbgp, "bgpdump") or return TEST_DISABLED;
+
+  unlink $mrt_file;
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  foreach my $node ("1.0.0.1", "2.0.0.1", "3.0.0.1") {
+    $cbgp->send_cmd("net add node $node");
+    $cbgp->send_cmd("net node $node domain 1");
+  }
+  $cbgp->send_cmd("net add link 1.0.0.1 2.0.0.1");
+  $cbgp->send_cmd("net link 1.0.0.1 2.0.0.1 igp-weight --bidir 10");
+  $cbgp->send_cmd("net add link 3.0.0.1 2.0.0.1");
+  $cbgp->send_cmd("net link 3.0.0.1 2.0.0.1 igp-weight --bidir 10");
+  $cbgp->send_cmd("net domain 1 compute");
+  foreach my $router ("1.0.0.1", "3.0.0.1") {
+    $cbgp->send_cmd("bgp add router 1 $router");
+    $cbgp->send_cmd("bgp router $router");
+    $cbgp->send_cmd("\tadd peer 2 2.0.0.1");
+    $cbgp->send_cmd("\tpeer 2.0.0.1 virtual");
+    $cbgp->send_cmd("\tpeer 2.0.0.1 up");
+    $cbgp->send_cmd("\texit");
+  }
+  $cbgp->send_cmd("bgp router 1.0.0.1 load rib $rib_file");
+  cbgp_recv_update($cbgp, "1.0.0.1", 1, "2.0.0.1",
+		   "253/8|2 3 {4 5}|IGP|2.0.0.1|0|0");
+  $cbgp->send_cmd("sim run");
+
+  my $msg= cbgp_check_error($cbgp, "bgp router 1.0.0.1 save rib $mrt_file");
+  if (defined($msg)) {
+    $tests->debug("could not save RIB ($msg)");
+    return TEST_FAILURE;
+  }
+  (-e $mrt_file) or return TEST_FAILURE;
+
+  # The routes were collected on R1, not on R3
+  my ($routes_ok, $routes_bad_target);
+  $cbgp->send_cmd("bgp router 3.0.0.1 load rib --summary ".
+		  "--format=mrt-binary $mrt_file");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    if ($line =~ m/^Routes loaded\s*:\s*(\d+)$/) {
+      $routes_ok= $1;
+    } elsif ($line =~ m/^Routes with bad target\s*:\s*(\d+)$/) {
+      $routes_bad_target= $1;
+    }
+  }
+  if (!defined($routes_ok) || ($routes_ok != 0) ||
+      !defined($routes_bad_target) || ($routes_bad_target == 0)) {
+    $tests->debug("routes of R1 should be rejected by R3");
+    return TEST_FAILURE;
+  }
+  my $rib3= cbgp_get_rib($cbgp, "3.0.0.1");
+  if (scalar(keys %$rib3) != 0) {
+    $tests->debug("no route should have been loaded");
+    return TEST_FAILURE;
+  }
+
+  $msg= cbgp_check_error($cbgp, "bgp router 3.0.0.1 load rib --force ".
+			 "--format=mrt-binary $mrt_file");
+  if (defined($msg)) {
+    $tests->debug("could not load RIB ($msg)");
+    return TEST_FAILURE;
+  }
+
+  my $rib1= cbgp_get_rib($cbgp, "1.0.0.1");
+  $rib3= cbgp_get_rib($cbgp, "3.0.0.1");
+  if (scalar(keys %$rib1) == 0) {
+    $tests->debug("no route loaded in R1");
+    return TEST_FAILURE;
+  }
+  if (!exists($rib3->{"253.0.0.0/8"}) ||
+      ($rib3->{"253.0.0.0/8"}->[F_RIB_PATH] ne "2 3 {4 5}")) {
+    $tests->debug("multi-segment AS-Path not restored");
+    return TEST_FAILURE;
+  }
+  if (scalar(keys %$rib1) != scalar(keys %$rib3)) {
+    $tests->debug("number of prefixes mismatch");
+    return TEST_FAILURE;
+  }
+  foreach my $prefix (keys %$rib1) {
+    if (!exists($rib3->{$prefix})) {
+      $tests->debug("no route towards $prefix");
+      return TEST_FAILURE;
+    }
+    foreach my $field (F_RIB_NEXTHOP, F_RIB_PREF, F_RIB_MED, F_RIB_PATH,
+		       F_RIB_ORIGIN) {
+      if ($rib1->{$prefix}->[$field] ne $rib3->{$prefix}->[$field]) {
+	$tests->debug("attribute mismatch for $prefix ".
+		      "($rib1->{$prefix}->[$field] != ".
+		      "$rib3->{$prefix}->[$field])");
+	return TEST_FAILURE;
+      }
+    }
+  }
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,85 @@
+return ["bgp show rib (jsonl, csv)", "cbgp_valid_bgp_show_rib_format"];
+
+# -----[ cbgp_valid_bgp_show_rib_format ]----------------------------
+# Test the machine-readable export of the Loc-RIB in JSON lines and
+# CSV formats.
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1)
+#   - R2 (2.0.0.1, AS2) virtual peer
+#
+# Scenario:
+#   * R2 announces 255/8 with communities 2:1 and 253/8, both with
+#     AS-Path "2 3"
+#   * R1 originates 254/8
+#   * Check the JSON lines of "bgp router 1.0.0.1 show rib *"
+#   * Check the CSV file written by "bgp show rib *"
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_show_rib_format($) {
+  my ($cbgp)= @_;
+  my $csv_file= get_tmp_resource("cbgp-show-rib.csv");
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  $cbgp->send_cmd("net add node 1.0.0.1");
+  $cbgp->send_cmd("net node 1.0.0.1 domain 1");
+  $cbgp->send_cmd("net add node 2.0.0.1");
+  $cbgp->send_cmd("net node 2.0.0.1 domain 1");
+  $cbgp->send_cmd("net add link 1.0.0.1 2.0.0.1");
+  $cbgp->send_cmd("net link 1.0.0.1 2.0.0.1 igp-weight --bidir 10");
+  $cbgp->send_cmd("net domain 1 compute");
+  $cbgp->send_cmd("bgp add router 1 1.0.0.1");
+  cbgp_peering($cbgp, "1.0.0.1", "2.0.0.1", 2, "virtual");
+  $cbgp->send_cmd("bgp router 1.0.0.1 add network 254/8");
+  cbgp_recv_update($cbgp, "1.0.0.1", 1, "2.0.0.1",
+		   "255/8|2 3|IGP|2.0.0.1|0|0|2:1");
+  cbgp_recv_update($cbgp, "1.0.0.1", 1, "2.0.0.1",
+		   "253/8|2 3|IGP|2.0.0.1|0|0");
+  $cbgp->send_cmd("sim run");
+
+  my %lines;
+  $cbgp->send_cmd("bgp router 1.0.0.1 show rib * --format=jsonl");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    if ($line =~ m/^\{\"router\":\"1\.0\.0\.1\",\"prefix\":\"([0-9.\/]+)\"/) {
+      $lines{$1}= $line;
+    } else {
+      $tests->debug("unexpected line \"$line\"");
+      return TEST_FAILURE;
+    }
+  }
+  if (scalar(keys %lines) != 3) {
+    $tests->debug("3 routes expected");
+    return TEST_FAILURE;
+  }
+  if (($lines{"255.0.0.0/8"} !~ m/\"peer\":\"2\.0\.0\.1\",\"peer_asn\":2,\"best\":true,\"next_hop\":\"2\.0\.0\.1\"/) ||
+      ($lines{"255.0.0.0/8"} !~ m/\"origin\":\"IGP\",\"as_path\":\"2 3\",\"communities\":\"2:1\"\}$/) ||
+      ($lines{"253.0.0.0/8"} !~ m/\"as_path\":\"2 3\",\"communities\":\"\"\}$/) ||
+      ($lines{"254.0.0.0/8"} !~ m/\"peer\":null,\"peer_asn\":null,/)) {
+    $tests->debug("invalid JSON lines");
+    return TEST_FAILURE;
+  }
+
+  unlink $csv_file;
+  my $msg= cbgp_check_error($cbgp, "bgp show rib * --format=csv ".
+			    "--output=$csv_file");
+  if (defined($msg)) {
+    $tests->debug("could not export routes ($msg)");
+    return TEST_FAILURE;
+  }
+  open(CSV, "<$csv_file") or return TEST_FAILURE;
+  my @csv= <CSV>;
+  close(CSV);
+  chomp @csv;
+  if ((scalar(@csv) != 4) ||
+      ($csv[0] ne "router,prefix,peer,peer_asn,best,next_hop,".
+       "local_pref,med,origin,as_path,communities")) {
+    $tests->debug("invalid CSV header or number of lines");
+    return TEST_FAILURE;
+  }
+  if (!grep(/^1\.0\.0\.1,255\.0\.0\.0\/8,2\.0\.0\.1,2,1,2\.0\.0\.1,\d+,\d*,IGP,2 3,2:1$/, @csv)) {
+    $tests->debug("route towards 255/8 not found in CSV");
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
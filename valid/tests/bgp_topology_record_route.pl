@@ -0,0 +1,143 @@
+return ["bgp topology record-route",
+	"cbgp_valid_bgp_topology_record_route"];
+
+# -----[ cbgp_valid_bgp_topology_record_route ]---------------------
+# Check that "bgp topology record-route" (memoized traces from all
+# the routers) produces the same traces as "bgp router X
+# record-route" run for each router separately.
+#
+# Setup:
+#   see 'bgp topology run (per-prefix)'
+#
+# Scenario:
+#   * Originate 255/8 from AS6, then converge
+#   * Record the routes from all the routers in one command
+#   * Check that each trace equals the trace recorded from the
+#     router alone
+#   * Check that AS3 reaches 255/8 through AS1
+#   * Inject into AS1 a route towards 200/8 learned from AS4 and into
+#     AS4 a route towards 200/8 learned from AS1 (forwarding loop).
+#     Check that the traces from AS1 and AS4 end with LOOP [1 4] and
+#     [4 1] and that the traces from AS2 end with UNREACHABLE
+#   * Inject into AS4 a route towards 199/8 learned from AS1, which
+#     has no route (black hole). Check that the trace from AS4 ends
+#     with UNREACHABLE [4] as with "bgp router 0.4.0.0 record-route"
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_topology_record_route($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("as-level-record-route.topo");
+  my $rib_file= get_tmp_resource("as-level-record-route.ascii");
+  my @routers= ("0.1.0.0", "0.2.0.0", "0.3.0.0", "0.4.0.0",
+		"0.5.0.0", "0.6.0.0", "0.7.0.0");
+
+  open(AS_LEVEL_TOPO, ">$filename") or die;
+  print AS_LEVEL_TOPO "2 1 1\n";
+  print AS_LEVEL_TOPO "3 1 1\n";
+  print AS_LEVEL_TOPO "1 4 0\n";
+  print AS_LEVEL_TOPO "1 6 1\n";
+  print AS_LEVEL_TOPO "1 5 0\n";
+  print AS_LEVEL_TOPO "1 7 1\n";
+  close(AS_LEVEL_TOPO);
+
+  $cbgp->send_cmd("bgp topology load \"$filename\"");
+  $cbgp->send_cmd("bgp topology install");
+  $cbgp->send_cmd("bgp topology policies");
+  $cbgp->send_cmd("bgp router 0.6.0.0 add network 255/8");
+  $cbgp->send_cmd("bgp topology run");
+  $cbgp->send_cmd("sim run");
+
+  my %expected;
+  foreach my $router (@routers) {
+    $cbgp->send_cmd("bgp router $router record-route 255/8");
+    $expected{$router}= $cbgp->expect(1);
+  }
+
+  $cbgp->send_cmd("bgp topology record-route 255/8");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  my $count= 0;
+  my $result;
+  while (($result= $cbgp->expect(1)) ne "CHECKPOINT") {
+    my @fields= split /\t/, $result;
+    if (!exists($expected{$fields[0]}) ||
+	($expected{$fields[0]} ne $result)) {
+      $tests->debug("unexpected trace \"$result\"");
+      return TEST_FAILURE;
+    }
+    $count++;
+  }
+  if ($count != scalar(@routers)) {
+    $tests->debug("expected ".scalar(@routers)." traces, got $count");
+    return TEST_FAILURE;
+  }
+
+  if (!($expected{"0.3.0.0"} =~ m/\tSUCCESS\t3 1 6$/)) {
+    $tests->debug("unexpected trace from AS3 \"".$expected{"0.3.0.0"}."\"");
+    return TEST_FAILURE;
+  }
+
+  # Forwarding loop between AS1 and AS4, black hole at AS1. The
+  # simulation is not run afterwards, so that the loaded routes are
+  # not propagated.
+  _bgp_topology_record_route_inject($cbgp, $rib_file, "0.1.0.0",
+				    ["200/8", "4 9", "0.4.0.0"]);
+  _bgp_topology_record_route_inject($cbgp, $rib_file, "0.4.0.0",
+				    ["200/8", "1 9", "0.1.0.0"],
+				    ["199/8", "1 9", "0.1.0.0"]);
+  unlink $rib_file;
+
+  my $traces= _bgp_topology_record_route_get($cbgp, "200/8");
+  my %loop= ("0.1.0.0" => "\tLOOP\t1 4\$",
+	     "0.4.0.0" => "\tLOOP\t4 1\$",
+	     "0.2.0.0" => "\tUNREACHABLE\t");
+  foreach my $router (keys %loop) {
+    if (!exists($traces->{$router}) ||
+	!($traces->{$router} =~ m/$loop{$router}/)) {
+      $tests->debug("unexpected trace from $router towards 200/8");
+      return TEST_FAILURE;
+    }
+  }
+
+  $traces= _bgp_topology_record_route_get($cbgp, "199/8");
+  $cbgp->send_cmd("bgp router 0.4.0.0 record-route 199/8");
+  my $trace= $cbgp->expect(1);
+  if (!exists($traces->{"0.4.0.0"}) ||
+      ($traces->{"0.4.0.0"} ne $trace) ||
+      !($trace =~ m/\tUNREACHABLE\t4$/)) {
+    $tests->debug("unexpected trace from 0.4.0.0 towards 199/8");
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
+
+# -----[ _bgp_topology_record_route_inject ]-------------------------
+# Load routes (prefix, AS-path, next-hop) into the RIB of a router.
+# -------------------------------------------------------------------
+sub _bgp_topology_record_route_inject($$$@) {
+  my ($cbgp, $rib_file, $router, @routes)= @_;
+
+  open(RIB, ">$rib_file") or die;
+  foreach my $route (@routes) {
+    my ($prefix, $path, $nexthop)= @$route;
+    print RIB "TABLE_DUMP|0|B|$router|1|$prefix|$path|IGP|$nexthop|0|0|\n";
+  }
+  close(RIB);
+  $cbgp->send_cmd("bgp router $router load rib --force \"$rib_file\"");
+}
+
+# -----[ _bgp_topology_record_route_get ]----------------------------
+# Return the traces of "bgp topology record-route", indexed by
+# router.
+# -------------------------------------------------------------------
+sub _bgp_topology_record_route_get($$) {
+  my ($cbgp, $prefix)= @_;
+  my %traces;
+
+  $cbgp->send_cmd("bgp topology record-route $prefix");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    my @fields= split /\t/, $line;
+    $traces{$fields[0]}= $line;
+  }
+  return \%traces;
+}
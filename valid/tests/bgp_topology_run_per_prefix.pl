@@ -0,0 +1,87 @@
+return ["bgp topology run (per-prefix)",
+	"cbgp_valid_bgp_topology_run_per_prefix"];
+
+# -----[ cbgp_valid_bgp_topology_run_per_prefix ]-------------------
+# Test that "bgp topology run --per-prefix" converges each prefix
+# separately, records the routes towards each prefix and discards
+# the prefixes afterwards.
+#
+# Setup:
+#   see 'bgp topology run (solver)'
+#
+# Scenario:
+#   * Originate 255/8 from AS6, 253/8 from AS2 and 251/8 from AS3
+#     and AS7
+#   * Run with --per-prefix --discard and record the routes
+#   * Check that a route is recorded for each router and prefix
+#   * Check that AS3 cannot reach 253/8 (valley-free) while AS7
+#     reaches it
+#   * Check that the Loc-RIBs are empty afterwards
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_topology_run_per_prefix($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("as-level-run-per-prefix.topo");
+  my $rr_filename= get_tmp_resource("as-level-run-per-prefix.rr");
+
+  open(AS_LEVEL_TOPO, ">$filename") or die;
+  print AS_LEVEL_TOPO "2 1 1\n";
+  print AS_LEVEL_TOPO "3 1 1\n";
+  print AS_LEVEL_TOPO "1 4 0\n";
+  print AS_LEVEL_TOPO "1 6 1\n";
+  print AS_LEVEL_TOPO "1 5 0\n";
+  print AS_LEVEL_TOPO "1 7 1\n";
+  close(AS_LEVEL_TOPO);
+
+  $cbgp->send_cmd("bgp topology load \"$filename\"");
+  $cbgp->send_cmd("bgp topology install");
+  $cbgp->send_cmd("bgp topology policies");
+
+  $cbgp->send_cmd("bgp router 0.6.0.0 add network 255/8");
+  $cbgp->send_cmd("bgp router 0.2.0.0 add network 253/8");
+  $cbgp->send_cmd("bgp router 0.3.0.0 add network 251/8");
+  $cbgp->send_cmd("bgp router 0.7.0.0 add network 251/8");
+
+  my $msg= cbgp_check_error($cbgp, "bgp topology run --per-prefix ".
+			    "--output=\"$rr_filename\" --discard");
+  if (defined($msg)) {
+    $tests->debug("per-prefix run failed ($msg)");
+    return TEST_FAILURE;
+  }
+
+  my %status;
+  open(RECORDED, "<$rr_filename") or die;
+  while (<RECORDED>) {
+    chomp;
+    my @fields= split /\t/;
+    $status{$fields[0]}{$fields[1]}= $fields[2];
+  }
+  close(RECORDED);
+
+  foreach my $router ("0.1.0.0", "0.2.0.0", "0.3.0.0", "0.4.0.0",
+		      "0.5.0.0", "0.6.0.0", "0.7.0.0") {
+    foreach my $prefix ("255.0.0.0/8", "253.0.0.0/8", "251.0.0.0/8") {
+      if (!exists($status{$router}{$prefix})) {
+	$tests->debug("no route recorded from $router to $prefix");
+	return TEST_FAILURE;
+      }
+    }
+  }
+  if ($status{"0.3.0.0"}{"253.0.0.0/8"} ne "UNREACHABLE") {
+    $tests->debug("AS3 should not reach 253/8");
+    return TEST_FAILURE;
+  }
+  if ($status{"0.7.0.0"}{"253.0.0.0/8"} ne "SUCCESS") {
+    $tests->debug("AS7 should reach 253/8");
+    return TEST_FAILURE;
+  }
+
+  foreach my $router ("0.1.0.0", "0.3.0.0", "0.7.0.0") {
+    my $rib= cbgp_get_rib($cbgp, $router);
+    if (scalar(keys %$rib) != 0) {
+      $tests->debug("Loc-RIB of $router should be empty");
+      return TEST_FAILURE;
+    }
+  }
+
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,135 @@
+return ["bgp topology run (per-prefix, retry)",
+	"cbgp_valid_bgp_topology_run_per_prefix_retry"];
+
+# -----[ cbgp_valid_bgp_topology_run_per_prefix_retry ]-------------
+# Test that a "bgp topology run --per-prefix" that fails part-way
+# restores the originated networks and the state of the topology, so
+# that the run can be retried with the same result as a first run.
+#
+# Setup:
+#   see 'bgp topology run (solver)'
+#
+# Scenario:
+#   * Originate 255/8 from AS6, 253/8 from AS2 and 251/8 from AS3
+#     and AS7
+#   * Limit the simulation time ("sim stop --at=30") and check that
+#     the per-prefix run fails
+#   * Check that the networks are still originated
+#   * Remove the limit and run again with --per-prefix
+#   * Check that a route is recorded for each router and prefix
+#   * Check that AS3 cannot reach 253/8 (valley-free) while AS7
+#     reaches it
+#   * In a second instance, let the per-prefix run fail the same way,
+#     then check that "bgp topology run --solver" succeeds (the
+#     topology is still in the policies state)
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_topology_run_per_prefix_retry($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("as-level-run-per-prefix-retry.topo");
+  my $rr_filename= get_tmp_resource("as-level-run-per-prefix-retry.rr");
+  my %networks= ("0.6.0.0" => "255.0.0.0/8",
+		 "0.2.0.0" => "253.0.0.0/8",
+		 "0.3.0.0" => "251.0.0.0/8",
+		 "0.7.0.0" => "251.0.0.0/8");
+
+  open(AS_LEVEL_TOPO, ">$filename") or die;
+  print AS_LEVEL_TOPO "2 1 1\n";
+  print AS_LEVEL_TOPO "3 1 1\n";
+  print AS_LEVEL_TOPO "1 4 0\n";
+  print AS_LEVEL_TOPO "1 6 1\n";
+  print AS_LEVEL_TOPO "1 5 0\n";
+  print AS_LEVEL_TOPO "1 7 1\n";
+  close(AS_LEVEL_TOPO);
+
+  return TEST_FAILURE
+    if (!_bgp_topology_run_per_prefix_retry_fail($cbgp, $filename,
+						 %networks));
+
+  foreach my $router (keys %networks) {
+    my $rib= cbgp_get_rib($cbgp, $router);
+    if (!exists($rib->{$networks{$router}}) || (scalar(keys %$rib) != 1)) {
+      $tests->debug("network of $router not restored");
+      return TEST_FAILURE;
+    }
+  }
+
+  $cbgp->send_cmd("sim stop --at=0");
+  my $msg= cbgp_check_error($cbgp, "bgp topology run --per-prefix ".
+			    "--output=\"$rr_filename\"");
+  if (defined($msg)) {
+    $tests->debug("per-prefix run failed on retry ($msg)");
+    return TEST_FAILURE;
+  }
+
+  my %status;
+  open(RECORDED, "<$rr_filename") or die;
+  while (<RECORDED>) {
+    chomp;
+    my @fields= split /\t/;
+    $status{$fields[0]}{$fields[1]}= $fields[2];
+  }
+  close(RECORDED);
+
+  foreach my $router ("0.1.0.0", "0.2.0.0", "0.3.0.0", "0.4.0.0",
+		      "0.5.0.0", "0.6.0.0", "0.7.0.0") {
+    foreach my $prefix ("255.0.0.0/8", "253.0.0.0/8", "251.0.0.0/8") {
+      if (!exists($status{$router}{$prefix})) {
+	$tests->debug("no route recorded from $router to $prefix");
+	return TEST_FAILURE;
+      }
+    }
+  }
+  if ($status{"0.3.0.0"}{"253.0.0.0/8"} ne "UNREACHABLE") {
+    $tests->debug("AS3 should not reach 253/8");
+    return TEST_FAILURE;
+  }
+  if ($status{"0.7.0.0"}{"253.0.0.0/8"} ne "SUCCESS") {
+    $tests->debug("AS7 should reach 253/8");
+    return TEST_FAILURE;
+  }
+
+  unlink $rr_filename;
+
+  my $result= TEST_SUCCESS;
+  my $cbgp2= $tests->get_cbgp_instance("bgp topology run ".
+				       "(per-prefix, retry) #2");
+  if (!_bgp_topology_run_per_prefix_retry_fail($cbgp2, $filename,
+					       %networks)) {
+    $result= TEST_FAILURE;
+  } else {
+    $cbgp2->send_cmd("sim stop --at=0");
+    $msg= cbgp_check_error($cbgp2, "bgp topology run --solver");
+    if (defined($msg)) {
+      $tests->debug("solver run failed after rollback ($msg)");
+      $result= TEST_FAILURE;
+    }
+  }
+  $cbgp2->finalize();
+
+  unlink $filename;
+  return $result;
+}
+
+# -----[ _bgp_topology_run_per_prefix_retry_fail ]-------------------
+# Load the topology, originate the networks and run with --per-prefix
+# under a simulation time limit. Check that the run fails.
+# -------------------------------------------------------------------
+sub _bgp_topology_run_per_prefix_retry_fail($$%) {
+  my ($cbgp, $filename, %networks)= @_;
+
+  $cbgp->send_cmd("bgp topology load \"$filename\"");
+  $cbgp->send_cmd("bgp topology install");
+  $cbgp->send_cmd("bgp topology policies");
+
+  foreach my $router (keys %networks) {
+    $cbgp->send_cmd("bgp router $router add network $networks{$router}");
+  }
+
+  $cbgp->send_cmd("sim stop --at=30");
+  my $msg= cbgp_check_error($cbgp, "bgp topology run --per-prefix");
+  if (!defined($msg)) {
+    $tests->debug("per-prefix run should fail (time limit)");
+    return 0;
+  }
+  return 1;
+}
@@ -0,0 +1,105 @@
+return ["bgp topology run (solver)",
+	"cbgp_valid_bgp_topology_run_solver"];
+
+# -----[ cbgp_valid_bgp_topology_run_solver ]------------------------
+# Test that the routes computed by "bgp topology run --solver" are
+# valley-free and follow the preferences of the "bgp topology
+# policies" statement.
+#
+# Setup:
+#   see 'bgp topology policies (filters)'
+#
+# Scenario:
+#   * Originate 255/8 from AS6, 254/8 from AS4, 253/8 from AS2 and
+#     252/8 from AS1
+#   * Originate 251/8 from AS3, AS5, AS7, 250/8 from AS3, AS5,
+#     249/8 from AS5, AS7 and 248/8 from AS3, AS7
+#   * Run the solver (no simulation)
+#   * Check that AS3 and AS5 have only AS1 and AS6
+#   * Check that AS7 reaches 253/8 through "1 2"
+#   * Check that AS1 selects AS7, AS5, AS7, AS7 for 248-251/8
+#   * Check that the simulator cannot be started afterwards
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_topology_run_solver($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("as-level-run-solver.topo");
+
+  open(AS_LEVEL_TOPO, ">$filename") or die;
+  print AS_LEVEL_TOPO "2 1 1\n";
+  print AS_LEVEL_TOPO "3 1 1\n";
+  print AS_LEVEL_TOPO "1 4 0\n";
+  print AS_LEVEL_TOPO "1 6 1\n";
+  print AS_LEVEL_TOPO "1 5 0\n";
+  print AS_LEVEL_TOPO "1 7 1\n";
+  close(AS_LEVEL_TOPO);
+
+  $cbgp->send_cmd("bgp topology load \"$filename\"");
+  $cbgp->send_cmd("bgp topology install");
+  $cbgp->send_cmd("bgp topology policies");
+
+  $cbgp->send_cmd("bgp router 0.1.0.0 add network 252/8");
+  $cbgp->send_cmd("bgp router 0.2.0.0 add network 253/8");
+  $cbgp->send_cmd("bgp router 0.4.0.0 add network 254/8");
+  $cbgp->send_cmd("bgp router 0.6.0.0 add network 255/8");
+  $cbgp->send_cmd("bgp router 0.3.0.0 add network 251/8");
+  $cbgp->send_cmd("bgp router 0.5.0.0 add network 251/8");
+  $cbgp->send_cmd("bgp router 0.7.0.0 add network 251/8");
+  $cbgp->send_cmd("bgp router 0.3.0.0 add network 250/8");
+  $cbgp->send_cmd("bgp router 0.5.0.0 add network 250/8");
+  $cbgp->send_cmd("bgp router 0.5.0.0 add network 249/8");
+  $cbgp->send_cmd("bgp router 0.7.0.0 add network 249/8");
+  $cbgp->send_cmd("bgp router 0.3.0.0 add network 248/8");
+  $cbgp->send_cmd("bgp router 0.7.0.0 add network 248/8");
+
+  my $msg= cbgp_check_error($cbgp, "bgp topology run --solver");
+  if (defined($msg)) {
+    $tests->debug("solver failed ($msg)");
+    return TEST_FAILURE;
+  }
+
+  # Check valley-free property for 252-255/8
+  my $rib= cbgp_get_rib($cbgp, "0.3.0.0");
+  if (!exists($rib->{"252.0.0.0/8"}) || exists($rib->{"253.0.0.0/8"}) ||
+      exists($rib->{"254.0.0.0/8"}) || !exists($rib->{"255.0.0.0/8"})) {
+    $tests->debug("AS3 should only receive route from AS1 and AS6");
+    return TEST_FAILURE;
+  }
+  $rib= cbgp_get_rib($cbgp, "0.5.0.0");
+  if (!exists($rib->{"252.0.0.0/8"}) || exists($rib->{"253.0.0.0/8"}) ||
+      exists($rib->{"254.0.0.0/8"}) || !exists($rib->{"255.0.0.0/8"})) {
+    $tests->debug("AS5 should only receive route from AS1 and AS6");
+    return TEST_FAILURE;
+  }
+  $rib= cbgp_get_rib($cbgp, "0.7.0.0");
+  if (!exists($rib->{"253.0.0.0/8"}) ||
+      !aspath_equals($rib->{"253.0.0.0/8"}->[F_RIB_PATH], [1, 2])) {
+    $tests->debug("AS7 should reach 253/8 through \"1 2\"");
+    return TEST_FAILURE;
+  }
+
+  # Check preferences for 248-251/8
+  $rib= cbgp_get_rib($cbgp, "0.1.0.0");
+  if (!exists($rib->{"248.0.0.0/8"}) || !exists($rib->{"249.0.0.0/8"}) ||
+      !exists($rib->{"250.0.0.0/8"}) || !exists($rib->{"251.0.0.0/8"})) {
+    $tests->debug("AS1 should receive all routes");
+    return TEST_FAILURE;
+  }
+  if (($rib->{"248.0.0.0/8"}->[F_RIB_NEXTHOP] ne '0.7.0.0') ||
+      ($rib->{"249.0.0.0/8"}->[F_RIB_NEXTHOP] ne '0.7.0.0') ||
+      ($rib->{"250.0.0.0/8"}->[F_RIB_NEXTHOP] ne '0.5.0.0') ||
+      ($rib->{"251.0.0.0/8"}->[F_RIB_NEXTHOP] ne '0.7.0.0')) {
+    $tests->debug("AS1's route selection is incorrect");
+    return TEST_FAILURE;
+  }
+
+  # The routes are already computed
+  $msg= cbgp_check_error($cbgp, "bgp topology run");
+  if (!defined($msg)) {
+    $tests->debug("simulation should not start after the solver");
+    return TEST_FAILURE;
+  }
+
+  unlink($filename);
+
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,59 @@
+return ["bgp topology solver-check",
+	"cbgp_valid_bgp_topology_solver_check"];
+
+# -----[ cbgp_valid_bgp_topology_solver_check ]----------------------
+# Cross-check the routes computed by the solver with the routes
+# obtained by the message-level simulation.
+#
+# Setup:
+#   see 'valid bgp topology load'
+#
+# Scenario:
+#   * Originate one prefix from each AS, and one prefix from two ASes
+#   * Run the simulation
+#   * Check that "bgp topology solver-check" reports no mismatch
+#   * Withdraw the route of one AS, check that a mismatch is reported
+#
+# Resources:
+#   [valid-bgp-topology.subramanian]
+# -------------------------------------------------------------------
+sub cbgp_valid_bgp_topology_solver_check($) {
+  my ($cbgp)= @_;
+
+  my $topo_file= get_resource("valid-bgp-topology.subramanian");
+  (-e $topo_file) or return TEST_DISABLED;
+
+  my $topo= topo_from_subramanian_file($topo_file);
+
+  $cbgp->send_cmd("bgp topology load \"$topo_file\"");
+  $cbgp->send_cmd("bgp topology install");
+  $cbgp->send_cmd("bgp topology policies");
+  $cbgp->send_cmd("bgp topology run");
+  $cbgp->send_cmd("sim run");
+
+  my $index= 0;
+  my @routers= sort keys %$topo;
+  foreach my $router (@routers) {
+    $index++;
+    $cbgp->send_cmd("bgp router $router add network 10.$index/16");
+  }
+  $cbgp->send_cmd("bgp router $routers[0] add network 255/8");
+  $cbgp->send_cmd("bgp router $routers[-1] add network 255/8");
+  $cbgp->send_cmd("sim run");
+
+  my $msg= cbgp_check_error($cbgp, "bgp topology solver-check");
+  if (defined($msg)) {
+    $tests->debug("solver and simulation differ ($msg)");
+    return TEST_FAILURE;
+  }
+
+  $cbgp->send_cmd("bgp router $routers[0] del network 10.1/16");
+  $cbgp->send_cmd("bgp router $routers[1] add network 10.1/16");
+  $msg= cbgp_check_error($cbgp, "bgp topology solver-check");
+  if (!defined($msg)) {
+    $tests->debug("solver-check should detect a mismatch");
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,76 @@
+return ["cli show mem", "cbgp_valid_cli_show_mem"];
+
+# -----[ cbgp_valid_cli_show_mem ]-----------------------------------
+# Test the per-subsystem memory counters reported by "show mem".
+#
+# Setup:
+#   - R1 (1.0.0.1, AS1)
+#
+# Scenario:
+#   * Check that "show mem --format=json" reports all the tags
+#   * R1 originates 254/8 and 253/8
+#   * Check that the number of routes and of RIB entries increased
+#   * Check that "show mem --peak" reports the peak columns
+# -------------------------------------------------------------------
+sub cbgp_valid_cli_show_mem($) {
+  my ($cbgp)= @_;
+  my @tags= ("route", "attr", "path", "comms", "rib", "fib", "spt",
+	     "event", "msg");
+
+  my $stats= _cli_show_mem_json($cbgp);
+  return TEST_FAILURE
+    if (!defined($stats));
+  foreach my $tag (@tags) {
+    if (!exists($stats->{$tag})) {
+      $tests->debug("tag \"$tag\" not reported");
+      return TEST_FAILURE;
+    }
+  }
+
+  $cbgp->send_cmd("net add node 1.0.0.1");
+  $cbgp->send_cmd("bgp add router 1 1.0.0.1");
+  $cbgp->send_cmd("bgp router 1.0.0.1 add network 254/8");
+  $cbgp->send_cmd("bgp router 1.0.0.1 add network 253/8");
+  $cbgp->send_cmd("sim run");
+
+  my $stats2= _cli_show_mem_json($cbgp);
+  return TEST_FAILURE
+    if (!defined($stats2));
+  if (($stats2->{route}{objects} < $stats->{route}{objects}+2) ||
+      ($stats2->{rib}{objects} < $stats->{rib}{objects}+2)) {
+    $tests->debug("routes / RIB entries not accounted");
+    return TEST_FAILURE;
+  }
+
+  $cbgp->send_cmd("show mem --peak");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  my $header= $cbgp->expect(1);
+  while ($cbgp->expect(1) ne "CHECKPOINT") {}
+  if ($header !~ m/^tag\s+bytes\s+objects\s+peak-bytes\s+peak-objects$/) {
+    $tests->debug("invalid header \"$header\"");
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
+
+# -----[ _cli_show_mem_json ]----------------------------------------
+# Parse the output of "show mem --format=json" into a hash of
+# counters indexed by tag.
+# -------------------------------------------------------------------
+sub _cli_show_mem_json($) {
+  my ($cbgp)= @_;
+  my %stats;
+
+  $cbgp->send_cmd("show mem --format=json");
+  my $line= $cbgp->expect(1);
+  if ($line !~ m/^\{.*\}$/) {
+    $tests->debug("invalid JSON \"$line\"");
+    return undef;
+  }
+  while ($line =~ m/\"([a-z]+)\":\{\"bytes\":(\d+),\"objects\":(\d+),\"peak_bytes\":(\d+),\"peak_objects\":(\d+)\}/g) {
+    $stats{$1}= { bytes => $2, objects => $3,
+		  peak_bytes => $4, peak_objects => $5 };
+  }
+  return \%stats;
+}
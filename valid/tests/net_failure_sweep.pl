@@ -0,0 +1,95 @@
+return ["net failure-sweep", "cbgp_valid_net_failure_sweep"];
+
+# -----[ cbgp_valid_net_failure_sweep ]------------------------------
+# Check that "net failure-sweep" reports the impact of each single
+# link and node failure, and restores the network afterwards.
+#
+# Setup:
+#   - R1 (1.0.0.1)
+#   - R2 (1.0.0.2)
+#   - R3 (1.0.0.3)
+#   - R4 (1.0.0.4)
+#
+# Topology:
+#
+#   R1 ---- R2
+#     \    /
+#      \  /
+#       R3 ---- R4
+#
+# Scenario:
+#   * Sweep over the link failures. Check that 4 links are reported,
+#     that only the failure of R3-R4 disconnects pairs (6 pairs)
+#     and that the failure of R1-R2 reroutes 2 pairs.
+#   * Sweep over the node failures. Check that the failure of R3
+#     disconnects 4 pairs and that the other failures disconnect
+#     nothing.
+#   * Check that R1 still reaches R2 directly afterwards.
+# -------------------------------------------------------------------
+sub cbgp_valid_net_failure_sweep($) {
+  my ($cbgp)= @_;
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  foreach my $node ("1.0.0.1", "1.0.0.2", "1.0.0.3", "1.0.0.4") {
+    $cbgp->send_cmd("net add node $node");
+    $cbgp->send_cmd("net node $node domain 1");
+  }
+  foreach my $link (["1.0.0.1", "1.0.0.2"], ["1.0.0.1", "1.0.0.3"],
+		    ["1.0.0.2", "1.0.0.3"], ["1.0.0.3", "1.0.0.4"]) {
+    $cbgp->send_cmd("net add link $link->[0] $link->[1]");
+    $cbgp->send_cmd("net link $link->[0] $link->[1] igp-weight --bidir 1");
+  }
+  $cbgp->send_cmd("net domain 1 compute");
+
+  my %links= _net_failure_sweep($cbgp, "links", 2);
+  if (scalar(keys %links) != 4) {
+    $tests->debug("expected 4 link failures, got ".scalar(keys %links));
+    return TEST_FAILURE;
+  }
+  foreach my $link (keys %links) {
+    my $lost= ($link eq "1.0.0.3 1.0.0.4") ? 6 : 0;
+    if ($links{$link}->[0] != $lost) {
+      $tests->debug("failure of $link should disconnect $lost pairs");
+      return TEST_FAILURE;
+    }
+  }
+  if ($links{"1.0.0.1 1.0.0.2"}->[1] != 2) {
+    $tests->debug("failure of 1.0.0.1 1.0.0.2 should reroute 2 pairs");
+    return TEST_FAILURE;
+  }
+
+  my %nodes= _net_failure_sweep($cbgp, "nodes", 1);
+  if (scalar(keys %nodes) != 4) {
+    $tests->debug("expected 4 node failures, got ".scalar(keys %nodes));
+    return TEST_FAILURE;
+  }
+  foreach my $node (keys %nodes) {
+    my $lost= ($node eq "1.0.0.3") ? 4 : 0;
+    if ($nodes{$node}->[0] != $lost) {
+      $tests->debug("failure of $node should disconnect $lost pairs");
+      return TEST_FAILURE;
+    }
+  }
+
+  my $trace= cbgp_record_route($cbgp, "1.0.0.1", "1.0.0.2");
+  return TEST_FAILURE
+    if (!check_recordroute($trace, -status=>"SUCCESS",
+			   -path=>[[1, "1.0.0.2"]]));
+
+  return TEST_SUCCESS;
+}
+
+sub _net_failure_sweep($$$) {
+  my ($cbgp, $type, $num_fields)= @_;
+  my %failures;
+  my $result;
+
+  $cbgp->send_cmd("net failure-sweep $type");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while (($result= $cbgp->expect(1)) ne "CHECKPOINT") {
+    my @fields= split /\t/, $result;
+    my $failure= join " ", splice(@fields, 0, $num_fields);
+    $failures{$failure}= \@fields;
+  }
+  return %failures;
+}
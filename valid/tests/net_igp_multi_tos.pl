@@ -0,0 +1,74 @@
+return ["net igp multi-tos", "cbgp_valid_net_igp_multi_tos"];
+
+# -----[ cbgp_valid_net_igp_multi_tos ]------------------------------
+# Test that the IGP model computes the routes of all the TOS in a
+# single computation ("net domain X compute --tos=all").
+#
+# Setup:
+#   - R1 (0.0.0.1)
+#   - R2 (0.0.0.2)
+#   - R3 (0.0.0.3)
+#   - R4 (0.0.0.4)
+#   - all links have 2 IGP weights (TOS 0 and TOS 1)
+#
+# Topology:
+#
+#       0:1    0:1
+#     *-- R2 --*
+#    /  1:10    \ 1:1
+#   R1          R4
+#    \  0:5     / 0:1
+#     *-- R3 --*
+#       1:1    1:1
+#
+# Scenario:
+#   * Compute the routes of all the TOS
+#   * Check that R1 reaches R4 through R2 in TOS 0 and through R3
+#     in TOS 1
+#   * Compute the routes of TOS 0 only, check that the TOS 1 routes
+#     are not available anymore
+# -------------------------------------------------------------------
+sub cbgp_valid_net_igp_multi_tos($) {
+  my ($cbgp)= @_;
+  my %weights= ("0.0.0.1 0.0.0.2" => [1, 10],
+		"0.0.0.1 0.0.0.3" => [5, 1],
+		"0.0.0.2 0.0.0.4" => [1, 1],
+		"0.0.0.3 0.0.0.4" => [1, 1]);
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  foreach my $node ("0.0.0.1", "0.0.0.2", "0.0.0.3", "0.0.0.4") {
+    $cbgp->send_cmd("net add node $node");
+    $cbgp->send_cmd("net node $node domain 1");
+  }
+  foreach my $link (sort keys %weights) {
+    $cbgp->send_cmd("net add link $link --depth=2");
+    $cbgp->send_cmd("net link $link igp-weight --bidir ".
+		    $weights{$link}->[0]);
+    $cbgp->send_cmd("net link $link igp-weight --bidir --tos=1 ".
+		    $weights{$link}->[1]);
+  }
+
+  my $msg= cbgp_check_error($cbgp, "net domain 1 compute --tos=all");
+  if (defined($msg)) {
+    $tests->debug("multi-topology computation failed ($msg)");
+    return TEST_FAILURE;
+  }
+
+  my $rt= cbgp_get_rt($cbgp, "0.0.0.1", "0.0.0.4");
+  return TEST_FAILURE
+    if (!check_has_route($rt, "0.0.0.4/32",
+			 -iface=>"0.0.0.2", -metric=>2));
+  $rt= cbgp_get_rt($cbgp, "0.0.0.1", "0.0.0.4 --tos=1");
+  return TEST_FAILURE
+    if (!check_has_route($rt, "0.0.0.4/32",
+			 -iface=>"0.0.0.3", -metric=>2));
+
+  $cbgp->send_cmd("net domain 1 compute");
+  $msg= cbgp_check_error($cbgp, "net node 0.0.0.1 show rt * --tos=1");
+  if (!defined($msg)) {
+    $tests->debug("TOS 1 routes should not be available anymore");
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
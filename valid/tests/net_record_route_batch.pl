@@ -0,0 +1,89 @@
+return ["net record-route (batch)", "cbgp_valid_net_record_route_batch"];
+
+# -----[ cbgp_valid_net_record_route_batch ]-------------------------
+# Check that "net record-route" traces the routes between all pairs
+# of nodes (*) or between the pairs listed in a file, with the same
+# output as "net node X record-route".
+#
+# Setup:
+#   - R1 (1.0.0.1)
+#   - R2 (1.0.0.2)
+#   - R3 (1.0.0.3)
+#
+# Topology:
+#   R1 ----- R2 ----- R3
+#
+# Scenario:
+#   * Setup topology and compute routes.
+#   * Perform "net record-route *" and check that 6 traces are
+#     output, each one equal to the corresponding single trace.
+#   * Perform "net record-route" with a file containing two pairs
+#     (one towards a prefix) and check the output.
+# -------------------------------------------------------------------
+sub cbgp_valid_net_record_route_batch($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("net-record-route-batch.txt");
+  my @nodes= ("1.0.0.1", "1.0.0.2", "1.0.0.3");
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  foreach my $node (@nodes) {
+    $cbgp->send_cmd("net add node $node");
+    $cbgp->send_cmd("net node $node domain 1");
+  }
+  $cbgp->send_cmd("net add link 1.0.0.1 1.0.0.2");
+  $cbgp->send_cmd("net link 1.0.0.1 1.0.0.2 igp-weight --bidir 1");
+  $cbgp->send_cmd("net add link 1.0.0.2 1.0.0.3");
+  $cbgp->send_cmd("net link 1.0.0.2 1.0.0.3 igp-weight --bidir 1");
+  $cbgp->send_cmd("net domain 1 compute");
+
+  my %expected;
+  foreach my $src (@nodes) {
+    foreach my $dst (@nodes) {
+      next if ($src eq $dst);
+      $cbgp->send_cmd("net node $src record-route $dst");
+      $expected{"$src $dst"}= $cbgp->expect(1);
+    }
+  }
+
+  $cbgp->send_cmd("net record-route *");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  my $count= 0;
+  my $result;
+  while (($result= $cbgp->expect(1)) ne "CHECKPOINT") {
+    my @fields= split /\s+/, $result;
+    my $key= "$fields[0] $fields[1]";
+    if (!exists($expected{$key}) || ($expected{$key} ne $result)) {
+      $tests->debug("unexpected trace \"$result\"");
+      return TEST_FAILURE;
+    }
+    $count++;
+  }
+  if ($count != 6) {
+    $tests->debug("expected 6 traces, got $count");
+    return TEST_FAILURE;
+  }
+
+  open(PAIRS, ">$filename") or die;
+  print PAIRS "# source destination\n";
+  print PAIRS "1.0.0.1 1.0.0.3\n";
+  print PAIRS "\n";
+  print PAIRS "1.0.0.3 1.0.0.1/32\n";
+  close(PAIRS);
+
+  $cbgp->send_cmd("net record-route \"$filename\"");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  my @traces;
+  while (($result= $cbgp->expect(1)) ne "CHECKPOINT") {
+    push @traces, ($result);
+  }
+  if (scalar(@traces) != 2) {
+    $tests->debug("expected 2 traces, got ".scalar(@traces));
+    return TEST_FAILURE;
+  }
+  return TEST_FAILURE
+    if ($traces[0] ne $expected{"1.0.0.1 1.0.0.3"});
+  return TEST_FAILURE
+    if (!($traces[1] =~ m/^1\.0\.0\.3\s+1\.0\.0\.1\/32\s+SUCCESS/));
+
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,27 @@
+return ["net load-state (error)", "cbgp_valid_net_state_load_error"];
+
+# -----[ cbgp_valid_net_state_load_error ]---------------------------
+# Check that "net load-state" rejects a file which is not a state
+# file and that it refuses to load a state in a non-empty network.
+# -------------------------------------------------------------------
+sub cbgp_valid_net_state_load_error($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("net-state-load-error.state");
+  my $msg;
+
+  die if !open(STATE, ">$filename");
+  print STATE "this is not a C-BGP state file\n";
+  close(STATE);
+
+  $msg= cbgp_check_error($cbgp, "net load-state \"$filename\"");
+  (!check_has_error($msg, "invalid state file")) and
+    return TEST_FAILURE;
+
+  $cbgp->send_cmd("net add node 1.0.0.1");
+  $cbgp->send_cmd("net save-state \"$filename\"");
+  $msg= cbgp_check_error($cbgp, "net load-state \"$filename\"");
+  (!check_has_error($msg, "network is not empty")) and
+    return TEST_FAILURE;
+  unlink $filename;
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,111 @@
+return ["net save-state (round-trip)", "cbgp_valid_net_state_round_trip"];
+
+# -----[ cbgp_valid_net_state_round_trip ]---------------------------
+# Check that a network restored with "net load-state" is identical
+# to the network saved with "net save-state".
+#
+# Setup:
+#   - R1 (1.0.0.1), R2 (1.0.0.2), R3 (1.0.0.3) in IGP domain 1
+#   - R1 <-> R2 (weight 10), R2 <-> R3 (weight 20),
+#     R1 <-> R3 (weight 50, one-way 40)
+#   - static route on R1 towards 10/8 via R3
+#   - static route on R2 towards 11/8 via R1
+#
+# Scenario:
+#   * Save the state of the network
+#   * Load the state into a second (empty) C-BGP instance
+#   * Check that both instances report the same nodes, links (and
+#     their IGP weights) and routing tables (IGP and static routes)
+#   * Check that a truncated state file is rejected and leaves the
+#     network empty, so that the complete file can then be loaded
+# -------------------------------------------------------------------
+sub cbgp_valid_net_state_round_trip($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("net-state-round-trip.state");
+  my @nodes= ("1.0.0.1", "1.0.0.2", "1.0.0.3");
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  foreach my $node (@nodes) {
+    $cbgp->send_cmd("net add node $node");
+    $cbgp->send_cmd("net node $node domain 1");
+  }
+  $cbgp->send_cmd("net add link 1.0.0.1 1.0.0.2");
+  $cbgp->send_cmd("net link 1.0.0.1 1.0.0.2 igp-weight --bidir 10");
+  $cbgp->send_cmd("net add link 1.0.0.2 1.0.0.3");
+  $cbgp->send_cmd("net link 1.0.0.2 1.0.0.3 igp-weight --bidir 20");
+  $cbgp->send_cmd("net add link 1.0.0.1 1.0.0.3");
+  $cbgp->send_cmd("net link 1.0.0.1 1.0.0.3 igp-weight 50");
+  $cbgp->send_cmd("net link 1.0.0.3 1.0.0.1 igp-weight 40");
+  $cbgp->send_cmd("net domain 1 compute");
+  $cbgp->send_cmd("net node 1.0.0.1 route add --oif=1.0.0.3 10/8 5");
+  $cbgp->send_cmd("net node 1.0.0.2 route add --oif=1.0.0.1 11/8 7");
+
+  my $msg= cbgp_check_error($cbgp, "net save-state \"$filename\"");
+  if (defined($msg)) {
+    $tests->debug("could not save state: $msg");
+    return TEST_FAILURE;
+  }
+  my $expected= _net_state_round_trip_dump($cbgp, @nodes);
+
+  my $result= TEST_SUCCESS;
+  my $cbgp2= $tests->get_cbgp_instance("net save-state (round-trip) #2");
+
+  # A truncated file must be rejected without side-effect
+  my $truncated= get_tmp_resource("net-state-round-trip-trunc.state");
+  open(STATE, "<$filename") or die;
+  binmode(STATE);
+  my $data;
+  read(STATE, $data, (-s $filename) - 16);
+  close(STATE);
+  open(STATE, ">$truncated") or die;
+  binmode(STATE);
+  print STATE $data;
+  close(STATE);
+  $msg= cbgp_check_error($cbgp2, "net load-state \"$truncated\"");
+  if (!defined($msg)) {
+    $tests->debug("truncated state file accepted");
+    $result= TEST_FAILURE;
+  }
+  unlink $truncated;
+
+  if ($result == TEST_SUCCESS) {
+    $msg= cbgp_check_error($cbgp2, "net load-state \"$filename\"");
+    if (defined($msg)) {
+      $tests->debug("could not load state: $msg");
+      $result= TEST_FAILURE;
+    }
+  }
+
+  if ($result == TEST_SUCCESS) {
+    my $restored= _net_state_round_trip_dump($cbgp2, @nodes);
+    if ($restored ne $expected) {
+      $tests->debug("restored network differs\n".
+		    "expected:\n$expected\nrestored:\n$restored");
+      $result= TEST_FAILURE;
+    }
+  }
+
+  $cbgp2->finalize();
+  unlink $filename;
+  return $result;
+}
+
+# -----[ _net_state_round_trip_dump ]--------------------------------
+# Return the output of "net show nodes" as well as the links and the
+# routing table of each node.
+# -------------------------------------------------------------------
+sub _net_state_round_trip_dump($@) {
+  my ($cbgp, @nodes)= @_;
+  my $dump= "";
+
+  $cbgp->send_cmd("net show nodes");
+  foreach my $node (@nodes) {
+    $cbgp->send_cmd("net node $node show links");
+    $cbgp->send_cmd("net node $node show rt *");
+  }
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $line= $cbgp->expect(1)) ne "CHECKPOINT") {
+    $dump.= "$line\n";
+  }
+  return $dump;
+}
@@ -0,0 +1,100 @@
+return ["net traffic load-binary", "cbgp_valid_net_traffic_load_binary"];
+
+# -----[ cbgp_valid_net_traffic_load_binary ]------------------------
+# Check that a text traffic matrix can be converted into the binary
+# format, and that the binary loader splits the volume of each flow
+# among the equal-cost paths.
+#
+# Setup:
+#   - R1 (1.0.0.1)
+#   - R2 (1.0.0.2)
+#   - R3 (1.0.0.3)
+#   - R4 (1.0.0.4)
+#   - IGP weight equals 1 on all links
+#
+# Topology:
+#
+#     *-- R2 --*
+#    /          \
+#   R1          R4
+#    \          /
+#     *-- R3 --*
+#
+# Scenario:
+#   * Convert a matrix with 1000 units from R1 to R4 (in two
+#     lines), 100 units from R2 to R4 and 50 units from R3 to an
+#     unreachable destination
+#   * Load the binary matrix
+#   * Check that load(R1->R2)=load(R1->R3)=500, load(R2->R4)=600
+#     and load(R3->R4)=500
+#   * Check that 2 flows succeeded and that 1 flow failed
+# -------------------------------------------------------------------
+sub cbgp_valid_net_traffic_load_binary($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("net-traffic-load-binary.tm");
+  my $bin_filename= get_tmp_resource("net-traffic-load-binary.bin");
+  my $msg;
+  my $info;
+
+  open(TM, ">$filename") or die;
+  print TM "1.0.0.1 1.0.0.1 1.0.0.4 600\n";
+  print TM "1.0.0.2 1.0.0.2 1.0.0.4 100\n";
+  print TM "1.0.0.3 1.0.0.3 9.9.9.9 50\n";
+  print TM "1.0.0.1 1.0.0.1 1.0.0.4 400\n";
+  close(TM);
+
+  $cbgp->send_cmd("net add node 1.0.0.1");
+  $cbgp->send_cmd("net add node 1.0.0.2");
+  $cbgp->send_cmd("net add node 1.0.0.3");
+  $cbgp->send_cmd("net add node 1.0.0.4");
+  $cbgp->send_cmd("net add link 1.0.0.1 1.0.0.2");
+  $cbgp->send_cmd("net add link 1.0.0.1 1.0.0.3");
+  $cbgp->send_cmd("net add link 1.0.0.2 1.0.0.4");
+  $cbgp->send_cmd("net add link 1.0.0.3 1.0.0.4");
+  $cbgp->send_cmd("net add domain 1 igp");
+  $cbgp->send_cmd("net node 1.0.0.1 domain 1");
+  $cbgp->send_cmd("net node 1.0.0.2 domain 1");
+  $cbgp->send_cmd("net node 1.0.0.3 domain 1");
+  $cbgp->send_cmd("net node 1.0.0.4 domain 1");
+  $cbgp->send_cmd("net link 1.0.0.1 1.0.0.2 igp-weight --bidir 1");
+  $cbgp->send_cmd("net link 1.0.0.1 1.0.0.3 igp-weight --bidir 1");
+  $cbgp->send_cmd("net link 1.0.0.2 1.0.0.4 igp-weight --bidir 1");
+  $cbgp->send_cmd("net link 1.0.0.3 1.0.0.4 igp-weight --bidir 1");
+  $cbgp->send_cmd("net domain 1 compute");
+
+  $msg= cbgp_check_error($cbgp, "net traffic convert \"$filename\" ".
+			 "\"$bin_filename\"");
+  return TEST_FAILURE
+    if (check_has_error($msg));
+
+  my %summary;
+  $cbgp->send_cmd("net traffic load-binary \"$bin_filename\" --summary");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $result= $cbgp->expect(1)) ne "CHECKPOINT") {
+    if ($result =~ m/^([A-Za-z ]+?)\s*:\s*(\d+)$/) {
+      $summary{$1}= $2;
+    }
+  }
+
+  $info= cbgp_link_info($cbgp, "1.0.0.1", "1.0.0.2");
+  return TEST_FAILURE
+    if (!check_link_info($info, -load=>500));
+  $info= cbgp_link_info($cbgp, "1.0.0.1", "1.0.0.3");
+  return TEST_FAILURE
+    if (!check_link_info($info, -load=>500));
+  $info= cbgp_link_info($cbgp, "1.0.0.2", "1.0.0.4");
+  return TEST_FAILURE
+    if (!check_link_info($info, -load=>600));
+  $info= cbgp_link_info($cbgp, "1.0.0.3", "1.0.0.4");
+  return TEST_FAILURE
+    if (!check_link_info($info, -load=>500));
+
+  if (($summary{"Flows total"} != 3) || ($summary{"Flows ok"} != 2) ||
+      ($summary{"Flows error"} != 1) || ($summary{"Bytes ok"} != 1100) ||
+      ($summary{"Bytes error"} != 50)) {
+    $tests->debug("unexpected summary");
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
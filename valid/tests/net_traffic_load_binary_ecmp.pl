@@ -0,0 +1,97 @@
+return ["net traffic load-binary (ECMP ladder)",
+	"cbgp_valid_net_traffic_load_binary_ecmp"];
+
+# -----[ cbgp_valid_net_traffic_load_binary_ecmp ]-------------------
+# Check that the binary loader handles a number of equal-cost paths
+# that grows exponentially with the length of the path. The traffic
+# towards a destination is accumulated at each node and split once,
+# instead of being forwarded along each path.
+#
+# Setup:
+#   - 24 stages, each made of two equal-cost branches
+#     1.0.0.k -> 1.0.1.k -> 1.0.0.(k+1)
+#     1.0.0.k -> 1.0.2.k -> 1.0.0.(k+1)
+#   - IGP weight equals 1 on all links
+#
+# Scenario:
+#   * Load a matrix with 1000 units from 1.0.0.0 to 1.0.0.24 (2^24
+#     equal-cost paths) and 10 units from 1.0.1.0 to 1.0.0.24
+#   * Check that each branch of the first stage carries half of the
+#     first flow, plus the second flow, and that each branch of the
+#     last stage carries half of the total
+#   * Check that both flows succeeded
+# -------------------------------------------------------------------
+sub cbgp_valid_net_traffic_load_binary_ecmp($) {
+  my ($cbgp)= @_;
+  my $filename= get_tmp_resource("net-traffic-load-binary-ecmp.tm");
+  my $bin_filename= get_tmp_resource("net-traffic-load-binary-ecmp.bin");
+  my $num_stages= 24;
+  my $msg;
+  my $info;
+
+  open(TM, ">$filename") or die;
+  print TM "1.0.0.0 1.0.0.0 1.0.0.$num_stages 1000\n";
+  print TM "1.0.1.0 1.0.1.0 1.0.0.$num_stages 10\n";
+  close(TM);
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  for (my $stage= 0; $stage <= $num_stages; $stage++) {
+    $cbgp->send_cmd("net add node 1.0.0.$stage");
+    $cbgp->send_cmd("net node 1.0.0.$stage domain 1");
+    next if ($stage == $num_stages);
+    foreach my $branch (1, 2) {
+      $cbgp->send_cmd("net add node 1.0.$branch.$stage");
+      $cbgp->send_cmd("net node 1.0.$branch.$stage domain 1");
+    }
+  }
+  for (my $stage= 0; $stage < $num_stages; $stage++) {
+    my $next= $stage+1;
+    foreach my $branch (1, 2) {
+      $cbgp->send_cmd("net add link 1.0.0.$stage 1.0.$branch.$stage");
+      $cbgp->send_cmd("net link 1.0.0.$stage 1.0.$branch.$stage ".
+		      "igp-weight --bidir 1");
+      $cbgp->send_cmd("net add link 1.0.$branch.$stage 1.0.0.$next");
+      $cbgp->send_cmd("net link 1.0.$branch.$stage 1.0.0.$next ".
+		      "igp-weight --bidir 1");
+    }
+  }
+  $cbgp->send_cmd("net domain 1 compute");
+
+  $msg= cbgp_check_error($cbgp, "net traffic convert \"$filename\" ".
+			 "\"$bin_filename\"");
+  return TEST_FAILURE
+    if (check_has_error($msg));
+
+  my %summary;
+  $cbgp->send_cmd("net traffic load-binary \"$bin_filename\" --summary");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while ((my $result= $cbgp->expect(1)) ne "CHECKPOINT") {
+    if ($result =~ m/^([A-Za-z ]+?)\s*:\s*(\d+)$/) {
+      $summary{$1}= $2;
+    }
+  }
+
+  my $last= $num_stages-1;
+  my @checks= (["1.0.0.0", "1.0.1.0", 500],
+	       ["1.0.0.0", "1.0.2.0", 500],
+	       ["1.0.1.0", "1.0.0.1", 510],
+	       ["1.0.2.0", "1.0.0.1", 500],
+	       ["1.0.0.$last", "1.0.1.$last", 505],
+	       ["1.0.0.$last", "1.0.2.$last", 505]);
+  foreach my $check (@checks) {
+    my ($src, $dst, $load)= @$check;
+    $info= cbgp_link_info($cbgp, $src, $dst);
+    return TEST_FAILURE
+      if (!check_link_info($info, -load=>$load));
+  }
+
+  if (($summary{"Flows total"} != 2) || ($summary{"Flows ok"} != 2) ||
+      ($summary{"Bytes ok"} != 1010)) {
+    $tests->debug("unexpected summary");
+    return TEST_FAILURE;
+  }
+
+  unlink $filename;
+  unlink $bin_filename;
+  return TEST_SUCCESS;
+}
@@ -0,0 +1,81 @@
+return ["net verify", "cbgp_valid_net_verify"];
+
+# -----[ cbgp_valid_net_verify ]-------------------------------------
+# Check that "net verify" reports forwarding loops and black holes
+# for the minimal prefixes concerned, and nothing else.
+#
+# Setup:
+#   - R1 (1.0.0.1), NH for 2.0.0.0/24 = R2
+#   - R2 (1.0.0.2), NH for 2.0.0.0/24 = R1
+#   - R3 (1.0.0.3), NH for 3.0.0.0/24 = R2
+#
+# Topology:
+#
+#   R1 -- R2 -- R3
+#
+# Scenario:
+#   * Compute the IGP routes and add the static routes
+#   * Check that a loop R1 R2 is reported for 2.0.0.0/24
+#   * Check that a black hole at R2 is reported for 3.0.0.0/24
+#   * Remove the route of R1 and check that the loop becomes a
+#     black hole at R1
+# -------------------------------------------------------------------
+sub cbgp_valid_net_verify($) {
+  my ($cbgp)= @_;
+
+  $cbgp->send_cmd("net add domain 1 igp");
+  foreach my $node ("1.0.0.1", "1.0.0.2", "1.0.0.3") {
+    $cbgp->send_cmd("net add node $node");
+    $cbgp->send_cmd("net node $node domain 1");
+  }
+  $cbgp->send_cmd("net add link 1.0.0.1 1.0.0.2");
+  $cbgp->send_cmd("net link 1.0.0.1 1.0.0.2 igp-weight --bidir 1");
+  $cbgp->send_cmd("net add link 1.0.0.2 1.0.0.3");
+  $cbgp->send_cmd("net link 1.0.0.2 1.0.0.3 igp-weight --bidir 1");
+  $cbgp->send_cmd("net domain 1 compute");
+
+  $cbgp->send_cmd("net node 1.0.0.1 route add --oif=1.0.0.2 2.0.0.0/24 1");
+  $cbgp->send_cmd("net node 1.0.0.2 route add --oif=1.0.0.1 2.0.0.0/24 1");
+  $cbgp->send_cmd("net node 1.0.0.3 route add --oif=1.0.0.2 3.0.0.0/24 1");
+
+  my @problems= _net_verify($cbgp);
+  if (scalar(@problems) != 2) {
+    $tests->debug("expected 2 problems, got ".scalar(@problems));
+    return TEST_FAILURE;
+  }
+  if ($problems[0] ne "2.0.0.0/24\tLOOP\t1.0.0.1 1.0.0.2") {
+    $tests->debug("unexpected problem \"$problems[0]\"");
+    return TEST_FAILURE;
+  }
+  if ($problems[1] ne "3.0.0.0/24\tBLACKHOLE\t1.0.0.2\tno-route") {
+    $tests->debug("unexpected problem \"$problems[1]\"");
+    return TEST_FAILURE;
+  }
+
+  $cbgp->send_cmd("net node 1.0.0.1 route del 2.0.0.0/24 1.0.0.2");
+
+  @problems= _net_verify($cbgp);
+  if (scalar(@problems) != 2) {
+    $tests->debug("expected 2 problems, got ".scalar(@problems));
+    return TEST_FAILURE;
+  }
+  if ($problems[0] ne "2.0.0.0/24\tBLACKHOLE\t1.0.0.1\tno-route") {
+    $tests->debug("unexpected problem \"$problems[0]\"");
+    return TEST_FAILURE;
+  }
+
+  return TEST_SUCCESS;
+}
+
+sub _net_verify($) {
+  my ($cbgp)= @_;
+  my @problems;
+  my $result;
+
+  $cbgp->send_cmd("net verify");
+  $cbgp->send_cmd("print \"CHECKPOINT\\n\"");
+  while (($result= $cbgp->expect(1)) ne "CHECKPOINT") {
+    push @problems, ($result);
+  }
+  return @problems;
+}